@@ -7,6 +7,11 @@
 
 #define ENDCODE 0xFF
 
+// Control mode（串口 0x10 / 0x11 / 0x12 切换）
+#define MODE_STEP       0x10    // 原始阶梯：>30 Hi，>=20 Lo，其余 Of
+#define MODE_HYSTERESIS 0x11    // 同样的阶梯，降档要多降 1.0C
+#define MODE_PID        0x12    // 对 pid_setpointX10 闭环，输出 0~100%
+
 // PIN SET
 
     // Display
@@ -59,9 +64,36 @@ DHT dht(pin_dht, DHT11);
 constexpr const float convertArg = 150.0/1024.0;
 
 int temp = 0;
+int tempX10 = 0;        // 0.1C，过采样后的温度，控制用
 int fanspeed = 0;
 float humi = 0;
 
+uint8_t controlMode = MODE_STEP;   // 默认保持原阶梯逻辑，回差 / PID 经串口 0x11 / 0x12 选用
+
+// ADC (ISR 累加，主循环取平均)
+    // Timer0 溢出触发转换：~976 Hz，每次 ISR 只做一次加法，
+    // 一个 200ms 周期约 195 个样本取平均，分辨率约 1/16 LSB
+    const uint16_t adc_maxSamples = 4096;   // 主循环卡住时停止累加，防溢出
+
+volatile uint32_t adcSum = 0;
+volatile uint16_t adcCount = 0;
+
+// Hysteresis
+    const int hyst_bandX10 = 10;            // 1.0C
+
+// PID
+    const int   pid_setpointX10 = 250;      // 25.0C
+    const float pid_kp = 15.0;              // %/C
+    const float pid_ki = 0.5;               // %/(C*s)
+    const float pid_kd = 5.0;               // %/(C/s)
+    const int   fan_minSpeed = 20;          // 低于此转速风扇会堵转：直接关
+    const int   fan_offBand = 5;            // 已在转时，降到 min - band 才关
+
+float pid_integral = 0;
+int pid_lastTempX10 = 0;
+unsigned long int pid_lastTime = 0;
+uint8_t pid_started = 0;
+
 int serialInfo = 1;
 
 uint8_t isApplied = 0;
@@ -77,7 +109,13 @@ unsigned long int timestamp_lastSent = 0;
 const int timeInterval_ReadData = 200;
 const int timeInterval_Display = 2000;
 const int timePeriod_Splash = 10000;
-const int timeInterval_Sent = 200;
+const int timeInterval_Sent = 200;          // 两帧之间最短间隔
+const int timeInterval_KeepAlive = 5000;    // 数值不变时的重发间隔
+
+// 上次发出的状态帧（只在变化时重发）
+uint8_t lastUpper[4] = {0};
+uint8_t lastController[2] = {0};
+uint8_t hasSent = 0;
 
 // Debug Function
 /*
@@ -92,6 +130,112 @@ const int timeInterval_Sent = 200;
 
 // Functional Models
 
+// ADC free running on Timer0 overflow, result in ISR
+void adcBegin()
+{
+    const uint8_t channel = (pin_temp - PIN_A0) & 0x07;
+
+    // REFS1:0 = 00 -> AREF（与 analogReference(EXTERNAL) 一致，内部基准关闭）
+    ADMUX = channel;
+    // ADTS = 100: Timer/Counter0 overflow（millis() 的 ISR 会清 TOV0，每次溢出一个上升沿）
+    ADCSRB = (1 << ADTS2);
+    // 数字输入缓冲关掉，少一点噪声
+    DIDR0 |= (1 << channel);
+    // 125 kHz ADC clock，自动触发 + 完成中断
+    ADCSRA = (1 << ADEN) | (1 << ADATE) | (1 << ADIE)
+           | (1 << ADPS2) | (1 << ADPS1) | (1 << ADPS0);
+}
+
+ISR(ADC_vect)
+{
+    if(adcCount < adc_maxSamples){
+        adcSum += ADC;
+        ++adcCount;
+    }
+}
+
+// step mapping, same thresholds as before
+int stepSpeed()
+{
+    if(temp > 30){
+        return 100;
+    }
+    else if(temp >= 20){
+        return 50;
+    }
+    return 0;
+}
+
+// same levels, going down needs hyst_bandX10 more
+int hysteresisSpeed()
+{
+    const int up = (tempX10 > 300) ? 100 : (tempX10 >= 200) ? 50 : 0;
+    const int down = (tempX10 > 300 - hyst_bandX10) ? 100
+                   : (tempX10 >= 200 - hyst_bandX10) ? 50 : 0;
+
+    if(up > fanspeed){
+        return up;
+    }
+    if(down < fanspeed){
+        return down;
+    }
+    return fanspeed;
+}
+
+void pidReset()
+{
+    pid_integral = 0;
+    pid_started = 0;
+}
+
+// PID on tempX10, derivative on measurement, integral clamped to output range
+int pidSpeed()
+{
+    const unsigned long int now = millis();
+    if(!pid_started){
+        pid_lastTempX10 = tempX10;
+        pid_lastTime = now;
+        pid_started = 1;
+    }
+
+    float dt = (now - pid_lastTime) / 1000.0;
+    if(dt <= 0){
+        dt = timeInterval_ReadData / 1000.0;
+    }
+
+    const float error = (tempX10 - pid_setpointX10) / 10.0;
+    const float slope = (tempX10 - pid_lastTempX10) / 10.0 / dt;
+
+    pid_integral += pid_ki * error * dt;
+    if(pid_integral < 0){
+        pid_integral = 0;
+    }
+    if(pid_integral > 100){
+        pid_integral = 100;
+    }
+
+    float out = pid_kp * error + pid_integral + pid_kd * slope;
+    if(out < 0){
+        out = 0;
+    }
+    if(out > 100){
+        out = 100;
+    }
+
+    pid_lastTempX10 = tempX10;
+    pid_lastTime = now;
+
+    int speed = (int)(out + 0.5);
+    // 最低转速，带回差：避免在堵转边缘反复启停
+    if(speed < fan_minSpeed){
+        if(fanspeed == 0 || speed < fan_minSpeed - fan_offBand){
+            return 0;
+        }
+        return fan_minSpeed;
+    }
+    return speed;
+}
+
 void setFanSpeed()
 {
     if(isApplied){
@@ -99,16 +243,23 @@ void setFanSpeed()
     }
 
     // set fanspeed, corresponding with $temp
-    if(temp > 30){
-        fanspeed = 100;
+    if(controlMode == MODE_PID){
+        fanspeed = pidSpeed();
+    }
+    else if(controlMode == MODE_HYSTERESIS){
+        fanspeed = hysteresisSpeed();
+    }
+    else{
+        fanspeed = stepSpeed();
+    }
+
+    if(fanspeed >= 75){
         strPtr = speed_hi_S;
     }
-    else if(temp >= 20){
-        fanspeed = 50;
+    else if(fanspeed > 0){
         strPtr = speed_lo_S;
     }
     else{
-        fanspeed = 0;
         strPtr = speed_of_S;
     }
     analogWrite(pin_fan, fanspeed * 255.0 / 100.0);
@@ -158,10 +309,20 @@ void temperatureFetch()
 {
     // Set reading intervals and detect mills overflow
     if(millis() - timestamp_lastRead >= timeInterval_ReadData || timestamp_lastRead >= millis()){
-        // read and process data from thermal sensor
-        int rawData = analogRead(pin_temp);
-        float Temp = rawData * convertArg;
-        temp = (int)(Temp + 0.5);
+        // take the samples accumulated by ISR(ADC_vect)
+        noInterrupts();
+        uint32_t sum = adcSum;
+        uint16_t count = adcCount;
+        adcSum = 0;
+        adcCount = 0;
+        interrupts();
+
+        if(count > 0){
+            // mean in 1/16 LSB, then 150C / 1024 LSB -> 0.1C
+            uint32_t avgX16 = (sum * 16 + count / 2) / count;
+            tempX10 = (int)((avgX16 * 1500UL + 8192) / 16384);
+            temp = (tempX10 + 5) / 10;
+        }
         // read humi
         humifetch();
         //Serial.println(humi);
@@ -191,6 +352,14 @@ void serialControl()
             LM016l.print(F("Stopped"));
             //Serial.println(F("Stopped"));
             analogWrite(pin_fan, 0 * 255.0 / 100.0);
+            fanspeed = 0;
+            pidReset();
+        }
+        if(serialInfo == MODE_STEP || serialInfo == MODE_HYSTERESIS || serialInfo == MODE_PID){
+            controlMode = serialInfo;
+            pidReset();
+            // re-evaluate with the next reading
+            isApplied = 0;
         }
     }
 }
@@ -243,33 +412,49 @@ void timer(unsigned long int& last, const unsigned long int& interval, uint8_t&
 
 void serialSent()
 {
-    if(!isSent){
-        /*
-        uint32_t messageSent = 0;
-        uint8_t* ptr = reinterpret_cast<uint8_t*>(&messageSent);
-        *ptr = static_cast<uint8_t>(temp);
-        ++ptr;
-        *ptr = static_cast<uint8_t>(humi + 0.5);
-        ++ptr;
-        *ptr = static_cast<uint8_t>(fanspeed);
-        ++ptr;
-        *ptr = static_cast<uint8_t>(isActive);
-        Serial.write(messageSent);
-        */
-
-        // UPPER
-
-        Serial.write(static_cast<uint8_t>(temp));
-        Serial.write(static_cast<uint8_t>(humi + 0.5));
-        Serial.write(static_cast<uint8_t>(fanspeed));
-        Serial.write(static_cast<uint8_t>(isActive));
+    if(isSent){
+        return;
+    }
+
+    const uint8_t upper[4] = {
+        static_cast<uint8_t>(temp),
+        static_cast<uint8_t>(humi + 0.5),
+        static_cast<uint8_t>(fanspeed),
+        static_cast<uint8_t>(isActive)
+    };
+    const uint8_t controller[2] = {
+        static_cast<uint8_t>(fanspeed),
+        static_cast<uint8_t>(isSplash)
+    };
+
+    // only changed values, plus a keep-alive for late listeners
+    const uint8_t keepAlive = millis() - timestamp_lastSent >= (unsigned long int)timeInterval_KeepAlive;
+    const uint8_t upperChanged = memcmp(upper, lastUpper, sizeof(upper)) != 0;
+    const uint8_t controllerChanged = memcmp(controller, lastController, sizeof(controller)) != 0;
+
+    if(hasSent && !keepAlive && !upperChanged && !controllerChanged){
+        return;
+    }
+
+    // UPPER
+    if(!hasSent || keepAlive || upperChanged){
+        Serial.write(upper, sizeof(upper));
         Serial.write(static_cast<uint8_t>(ENDCODE));
+        memcpy(lastUpper, upper, sizeof(upper));
+    }
 
-        // CONTROLLER
-        TX_Serial.write(static_cast<uint8_t>(fanspeed));
-        TX_Serial.write(static_cast<uint8_t>(isSplash));
+    // CONTROLLER
+    if(!hasSent || keepAlive || controllerChanged){
+        TX_Serial.write(controller[0]);
+        TX_Serial.write(controller[1]);
         TX_Serial.write(static_cast<uint8_t>(ENDCODE));
+        memcpy(lastController, controller, sizeof(controller));
     }
+
+    hasSent = 1;
+    // rate limit: timer() reopens after timeInterval_Sent
+    isSent = 1;
+    timestamp_lastSent = millis() - 1;
 }
 
 void patch()
@@ -303,6 +488,9 @@ void setup()
 
     // setting analog reference voltage mode, SET TO 1500mV
     analogReference(EXTERNAL);
+
+    // temperature: ADC sampled in ISR, do not call analogRead() from now on
+    adcBegin();
 }
 
 void loop() 
@@ -1,3 +1,4 @@
+import binascii
 import serial
 import struct
 import keyboard
@@ -9,7 +10,9 @@ import time
 SERIAL_PORT = "COM5"   # 修改为你的 Arduino COM 口
 BAUD_RATE = 115200
 
-ser = serial.Serial(SERIAL_PORT, BAUD_RATE, timeout=0.1)
+ser = serial.Serial(SERIAL_PORT, BAUD_RATE, timeout=0.01)
+time.sleep(2.0)            # 打开串口会复位 Arduino，等 "READY"
+ser.reset_input_buffer()
 
 # ===============================
 # 控制参数
@@ -23,14 +26,47 @@ print("+ - 调整速度    | ESC 退出程序")
 print(f"初始速度: {speed_hz} Hz\n")
 
 # ===============================
-# 发送协议帧
-# BF | motorMask | directionMask | speedHz | durationMs
+# 发送协议帧（serialMotor_pmw.ino）
+# A5 5A | len | seq | 命令 x k | crc16
+# 命令：BF | motorMask | directionMask | speedHz | durationMs
 # ===============================
+ACK_STATUS = {0: "OK", 1: "DUP", 2: "BAD_CMD"}
+ACK_TIMEOUT = 0.05
+RETRIES = 3
+
+seq = int(time.time()) & 0xFF   # 不和上次运行的最后一个 seq 撞上
+
+
+def pack_frame(seq, commands):
+    payload = b"".join(commands)
+    body = bytes([len(payload), seq]) + payload
+    return b"\xA5\x5A" + body + struct.pack("<H", binascii.crc_hqx(body, 0xFFFF))
+
+
+def send_frame(commands):
+    """发送一帧（可含多条命令），等 4 字节应答；超时用同一个 seq 重发"""
+    global seq
+    seq = (seq + 1) & 0xFF
+    frame = pack_frame(seq, commands)
+
+    for _ in range(RETRIES):
+        ser.write(frame)
+        deadline = time.monotonic() + ACK_TIMEOUT
+        buf = b""
+        while time.monotonic() < deadline:
+            buf += ser.read(ser.in_waiting or 1)
+            while len(buf) >= 4:
+                if buf[0] == 0xAC and buf[1] == seq:
+                    return ACK_STATUS.get(buf[2], buf[2]), buf[3]
+                buf = buf[1:]   # 旧应答 / READY
+    return "NO_ACK", None
+
+
 def send_move(motor_id, direction, speed_hz, duration_ms):
     motorMask = (1 << motor_id)
     directionMask = (direction << motor_id)
 
-    packet = struct.pack(
+    command = struct.pack(
         "<BBBii",
         0xBF,               # header
         motorMask,
@@ -39,8 +75,8 @@ def send_move(motor_id, direction, speed_hz, duration_ms):
         int(duration_ms)
     )
 
-    ser.write(packet)
-    print(f"Motor {motor_id} Dir:{direction} Speed:{speed_hz}Hz Duration:{duration_ms}ms")
+    status, errors = send_frame([command])
+    print(f"Motor {motor_id} Dir:{direction} Speed:{speed_hz}Hz Duration:{duration_ms}ms [{status}, rx errors {errors}]")
 
 
 # ===============================
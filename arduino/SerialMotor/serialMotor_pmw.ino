@@ -24,10 +24,12 @@ void timer1_set_freq(uint32_t hz) {
     if (top > 65535) top = 65535;
     if (top < 1) top = 1;
 
-    OCR1A = (uint16_t)top;
+    // AF 可能改过模式：显式回到 CTC toggle，关掉计数中断
+    TIMSK1 &= ~(1 << OCIE1A);
+    TCCR1B = (1 << WGM12);
+    TCCR1A = (1 << COM1A0);
 
-    // 确保 OC1A 连接
-    TCCR1A |= (1 << COM1A0);
+    OCR1A = (uint16_t)top;
 
     // ⭐关键：确保 Timer1 在跑（stop 过必须重启）
     TCCR1B = (TCCR1B & ~((1<<CS12)|(1<<CS11)|(1<<CS10)))
@@ -37,9 +39,10 @@ void timer1_set_freq(uint32_t hz) {
 void timer1_stop() {
     // 停止计数器
     TCCR1B &= ~((1<<CS12)|(1<<CS11)|(1<<CS10));
+    TIMSK1 &= ~(1 << OCIE1A);
 
     // 断开 OC1A
-    TCCR1A &= ~(1 << COM1A0);
+    TCCR1A &= ~((1 << COM1A1) | (1 << COM1A0));
 
     digitalWrite(9, LOW);
 }
@@ -65,7 +68,8 @@ void timer2_init() {
     OCR2A = 124; // 16MHz / (2 * 8 * (124+1)) ≈ 8000 Hz
 }
 
-void timer2_set_freq(uint32_t hz) {
+// CTC toggle 的 (prescaler, OCR2A)：返回 CS 位，ocr 输出误差最小的值
+uint8_t timer2_pick(uint32_t hz, uint8_t& ocrOut) {
     if (hz < 1) hz = 1;
 
     const uint16_t presc[] = {1, 8, 32, 64, 128, 256, 1024};
@@ -81,6 +85,7 @@ void timer2_set_freq(uint32_t hz) {
 
     uint32_t bestErr = 0xFFFFFFFF;
     uint8_t bestIdx = 1;
+    ocrOut = 124;
 
     for (uint8_t i = 0; i < 7; i++) {
         uint32_t ocr = F_CPU / (2UL * presc[i] * hz);
@@ -94,23 +99,181 @@ void timer2_set_freq(uint32_t hz) {
         if (err < bestErr) {
             bestErr = err;
             bestIdx = i;
-            OCR2A = (uint8_t)ocr;
+            ocrOut = (uint8_t)ocr;
         }
     }
+    return bits[bestIdx];
+}
+
+void timer2_set_freq(uint32_t hz) {
+    uint8_t ocr;
+    const uint8_t cs = timer2_pick(hz, ocr);
+
+    TIMSK2 &= ~(1 << OCIE2A);   // AF 计数中断
+    OCR2A = ocr;
 
-    // ✅ 显式启用 OC2A toggle（关键）
-    TCCR2A |= (1 << COM2A0);
+    // ✅ 显式启用 CTC + OC2A toggle（关键，AF 会改成 clear）
+    TCCR2A = (1 << WGM21) | (1 << COM2A0);
 
     // ✅ 启动 Timer2
     TCCR2B = (TCCR2B & ~((1<<CS22)|(1<<CS21)|(1<<CS20)))
-           | bits[bestIdx];
+           | cs;
 }
 
 void timer2_stop() {
-    TCCR2A &= ~(1 << COM2A0);
+    TCCR2B &= ~((1<<CS22)|(1<<CS21)|(1<<CS20));
+    TIMSK2 &= ~(1 << OCIE2A);
+    TCCR2A &= ~((1 << COM2A1) | (1 << COM2A0));
     digitalWrite(11, LOW);
 }
 
+// =========================
+// AF：硬件脉冲 + ISR 计数
+// =========================
+//
+// 脉冲由定时器硬件输出，ISR 只计数，最后一个脉冲靠 "提前一拍" 的
+// 配置收尾，停下时 STEP 一定是低电平，不会多 / 少脉冲：
+//
+//   Timer1 (D9) : Fast PWM (mode 14, TOP = ICR1)，OC1A 反相输出
+//                 OCR1A 处上升、BOTTOM 处下降，COMPA ISR = 第 k 个上升沿
+//                 k == N   : OCR1A = TOP（双缓冲，本周期结束后恒低）
+//                 k == N+1 : 已恒低一个周期，停时钟
+//                 => 每个脉冲 1 次 ISR
+//   Timer2 (D11): CTC toggle（8 bit 只有 OC2A 能变频），COMPA ISR = 每次翻转
+//                 第 2N-1 次（最后一个上升沿）: 改为 compare 时 clear
+//                 第 2N   次（下降沿）      : 停时钟
+//                 => 每个脉冲 2 次 ISR
+//
+// ISR 只需在半个周期内响应；两个轴同时运行，loop() / readSerial() 不再被阻塞。
+// 频率上限按 ISR 负载给出：16 MHz 下每次 ISR 约 5 us，
+// 两轴都跑 20 kHz 时 Timer1 占 ~10%、Timer2 占 ~20% CPU，串口仍有余量。
+
+#define PULSE_MAX_HZ 20000UL
+
+volatile uint32_t t1PulseTarget = 0;
+volatile uint32_t t1PulseCount  = 0;   // 已开始的脉冲（上升沿）
+volatile bool     t1PulseBusy   = false;
+
+volatile uint32_t t2ToggleLeft  = 0;   // 剩余翻转次数
+volatile bool     t2PulseBusy   = false;
+
+void timer1_start_pulses(uint32_t hz, uint32_t pulses) {
+    if (hz < 1) hz = 1;
+    if (hz > PULSE_MAX_HZ) hz = PULSE_MAX_HZ;
+
+    // 单斜率：period = presc * (TOP + 1) / F_CPU
+    const uint16_t presc[] = {1, 8, 64, 256, 1024};
+    const uint8_t  bits[]  = {
+        (1<<CS10),
+        (1<<CS11),
+        (1<<CS11)|(1<<CS10),
+        (1<<CS12),
+        (1<<CS12)|(1<<CS10)
+    };
+
+    uint8_t  idx = 4;
+    uint32_t top = 65535;
+    for (uint8_t i = 0; i < 5; i++) {
+        const uint32_t t = F_CPU / ((uint32_t)presc[i] * hz);
+        if (t >= 2 && t - 1 <= 65535) {
+            idx = i;
+            top = t - 1;
+            break;
+        }
+    }
+
+    // 1. 停下，normal 模式里强制 OC1A 锁存为低（之后接到引脚上不会先高）
+    TCCR1B = 0;
+    TIMSK1 &= ~(1 << OCIE1A);
+    TCCR1A = (1 << COM1A1);          // clear on match
+    TCCR1C = (1 << FOC1A);
+
+    // 2. normal 模式下 OCR1A 直写（PWM 模式下写的是缓冲）
+    TCNT1 = 0;
+    ICR1  = (uint16_t)top;
+    OCR1A = (uint16_t)((top + 1) / 2);
+
+    // 3. Fast PWM 14，反相输出
+    TCCR1A = (1 << COM1A1) | (1 << COM1A0) | (1 << WGM11);
+
+    t1PulseTarget = pulses;
+    t1PulseCount  = 0;
+    t1PulseBusy   = true;
+
+    TIFR1  = (1 << OCF1A);
+    TIMSK1 |= (1 << OCIE1A);
+    TCCR1B = (1 << WGM13) | (1 << WGM12) | bits[idx];
+}
+
+ISR(TIMER1_COMPA_vect) {
+    const uint32_t k = ++t1PulseCount;
+
+    if (k == t1PulseTarget) {
+        OCR1A = ICR1;                 // 下个周期起恒低
+    } else if (k > t1PulseTarget) {
+        TCCR1B = 0;                   // 本周期没有脉冲，安全停下
+        TIMSK1 &= ~(1 << OCIE1A);
+        TCCR1A = 0;
+        t1PulseCount = t1PulseTarget;
+        t1PulseBusy  = false;
+    }
+}
+
+void timer2_start_pulses(uint32_t hz, uint32_t pulses) {
+    if (hz > PULSE_MAX_HZ) hz = PULSE_MAX_HZ;
+
+    uint8_t ocr;
+    const uint8_t cs = timer2_pick(hz, ocr);
+
+    // 1. 停下，强制 OC2A 锁存为低
+    TCCR2B = 0;
+    TIMSK2 &= ~(1 << OCIE2A);
+    TCCR2A = (1 << WGM21) | (1 << COM2A1);   // CTC, clear on match
+    TCCR2B = (1 << FOC2A);
+
+    TCNT2 = 0;
+    OCR2A = ocr;
+
+    // 2. toggle；N == 1 时第一个翻转后立刻改 clear
+    TCCR2A = (1 << WGM21) | (1 << COM2A0);
+
+    t2ToggleLeft = 2UL * pulses;
+    t2PulseBusy  = true;
+
+    TIFR2  = (1 << OCF2A);
+    TIMSK2 |= (1 << OCIE2A);
+    TCCR2B = cs;
+}
+
+ISR(TIMER2_COMPA_vect) {
+    const uint32_t left = --t2ToggleLeft;
+
+    if (left == 1) {
+        TCCR2A = (1 << WGM21) | (1 << COM2A1);   // 下一次 compare 拉低后保持低
+    } else if (left == 0) {
+        TCCR2B = 0;
+        TIMSK2 &= ~(1 << OCIE2A);
+        TCCR2A = 0;
+        t2PulseBusy = false;
+    }
+}
+
+// ISR 写的 32 bit 计数：关中断读
+uint32_t timer1_pulses_done() {
+    noInterrupts();
+    const uint32_t n = t1PulseCount;
+    interrupts();
+    return n;
+}
+
+// 已结束的脉冲（下降沿）
+uint32_t timer2_pulses_done(uint32_t target) {
+    noInterrupts();
+    const uint32_t left = t2ToggleLeft;
+    interrupts();
+    return target - (left + 1) / 2;
+}
+
 class DM542 {
 public:
     int pulPin, dirPin, enaPin;
@@ -158,21 +321,35 @@ public:
         running = true;
     }
 
-    // ===== AF：脉冲数模式（保持原软件逻辑）=====
+    // ===== AF：脉冲数模式（硬件脉冲 + ISR 计数；其它引脚保留软件逻辑）=====
     void startByPulse(bool direction, float speedHz, uint32_t pulses) {
         pulseMode = true;
         pulseCounter = 0;
         targetPulses = pulses;
 
+        // 先停下当前输出，再改 DIR（DIR 不在脉冲中途变化）
+        if (pulPin == 9) timer1_stop();
+        else if (pulPin == 11) timer2_stop();
+
         digitalWrite(dirPin, direction ? dirPolarity : !dirPolarity);
 
         if (speedHz <= 0) speedHz = 1;
         stepIntervalUs = (unsigned long)(1000000.0 / speedHz);
 
-        running = true;
+        running = pulses > 0;
         lastStepTime = micros();
+        if (!running) return;
+
+        const uint32_t hz = (uint32_t)speedHz;
+        if (pulPin == 9) {
+            timer1_start_pulses(hz, pulses);
+        } else if (pulPin == 11) {
+            timer2_start_pulses(hz, pulses);
+        }
     }
 
+    bool hardwarePulse() const { return pulPin == 9 || pulPin == 11; }
+
     void update() {
         if (!running) return;
 
@@ -188,7 +365,19 @@ public:
             return;
         }
 
-        // ===== AF：原样 software step =====
+        // ===== AF：硬件计数，ISR 停下后结束 =====
+        if (hardwarePulse()) {
+            const bool busy = (pulPin == 9) ? t1PulseBusy : t2PulseBusy;
+            pulseCounter = (pulPin == 9) ? timer1_pulses_done()
+                                         : timer2_pulses_done(targetPulses);
+            if (!busy) {
+                pulseCounter = targetPulses;
+                running = false;
+            }
+            return;
+        }
+
+        // ===== AF：无硬件输出的引脚，software step =====
         if ((long)(now - lastStepTime) >= (long)stepIntervalUs) {
             lastStepTime = now;
 
@@ -215,9 +404,41 @@ DM542 motors[NUM_MOTORS] = {
 // =========================
 // SERIAL COMMAND PROTOCOL
 // =========================
+//
+// 链路帧（小端）：
+//   [0xA5][0x5A][len u8][seq u8][命令 x k][crc16 u16]
+//   len = 11 x k（1 <= k <= LINK_MAX_CMDS），一帧 <= 50 字节，放得进一个 USB 包
+//   crc = CRC-16/CCITT-FALSE（0x1021，初值 0xFFFF），覆盖 len / seq / 命令
+//
+// 命令仍是原来的 11 字节记录：
+//   BF | motorMask | directionMask | speedHz i32 | durationMs i32   （时间）
+//   AF | motorMask | directionMask | speedHz i32 | pulses i32       （脉冲数）
+//   一帧内按顺序执行（同一电机后面的覆盖前面的，和连发多帧一样）
+//
+// 应答（每个 CRC 正确的帧一个）：
+//   [0xAC][seq][status][rxErrors]
+//   status：0 = 已执行，1 = 重复 seq（上一帧的重发，不再执行），2 = 有非法命令（整帧不执行）
+//   rxErrors：累计丢弃的坏帧数（CRC / 长度 / 超时，饱和到 255）
+//
+// 接收是累积式的：字节进缓冲区，凑齐一帧才校验；CRC 不对只丢掉一个字节
+// 从下一个 0xA5 重新找帧头，所以 payload 里出现帧头字节不会丢后面的好帧。
+// 半帧超过 LINK_IDLE_US 没有新字节也按坏帧处理。主机收不到应答就用同一个 seq 重发。
 #define FRAME_HEADER_TIME 0xBF
 #define FRAME_HEADER_PULSE 0xAF
-#define FRAME_LENGTH 11
+#define CMD_LENGTH 11
+
+#define LINK_SYNC0 0xA5
+#define LINK_SYNC1 0x5A
+#define LINK_HEADER 4          // sync x2, len, seq
+#define LINK_CRC 2
+#define LINK_MAX_CMDS 4
+#define LINK_MAX_FRAME (LINK_HEADER + CMD_LENGTH * LINK_MAX_CMDS + LINK_CRC)
+#define LINK_IDLE_US 20000UL
+
+#define ACK_HEADER 0xAC
+#define ACK_OK 0
+#define ACK_DUPLICATE 1
+#define ACK_BAD_COMMAND 2
 
 struct CommandFrame {
     uint8_t header;
@@ -227,43 +448,66 @@ struct CommandFrame {
     int32_t durationMs;   // BF: duration | AF: pulseNum
 };
 
-uint8_t buffer[FRAME_LENGTH];
-uint8_t index = 0;
-bool receiving = false;
+uint8_t rxBuf[LINK_MAX_FRAME];
+uint8_t rxLen = 0;
+unsigned long rxLastByte = 0;
+uint8_t rxErrors = 0;
+int16_t lastSeq = -1;    // 上电 / 复位后第一帧任何 seq 都执行
 
 // =========================
-// Serial Reader
+// Helpers
 // =========================
-void readSerial() {
-    while (Serial.available()) {
-        uint8_t byte = Serial.read();
+int32_t read_le32(const uint8_t* p) {
+    return (int32_t)((uint32_t)p[0]
+                   | ((uint32_t)p[1] << 8)
+                   | ((uint32_t)p[2] << 16)
+                   | ((uint32_t)p[3] << 24));
+}
 
-        if (!receiving) {
-            if (byte == FRAME_HEADER_TIME || byte == FRAME_HEADER_PULSE) {
-                receiving = true;
-                index = 0;
-                buffer[index++] = byte;
-            }
-            continue;
+// CRC-16/CCITT-FALSE（主机：binascii.crc_hqx(data, 0xFFFF)）
+uint16_t crc16_ccitt(const uint8_t* p, uint8_t n) {
+    uint16_t crc = 0xFFFF;
+    while (n--) {
+        crc ^= (uint16_t)(*p++) << 8;
+        for (uint8_t b = 0; b < 8; b++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
         }
+    }
+    return crc;
+}
 
-        buffer[index++] = byte;
+// 逐字段解码：不依赖结构体布局
+void decodeCommand(const uint8_t* p, CommandFrame& cmd) {
+    cmd.header        = p[0];
+    cmd.motorMask     = p[1];
+    cmd.directionMask = p[2];
+    cmd.speedHz       = read_le32(p + 3);
+    cmd.durationMs    = read_le32(p + 7);
+}
 
-        if (index >= FRAME_LENGTH) {
-            receiving = false;
-            processFrame();
-        }
+void rxDrop(uint8_t n) {
+    if (n >= rxLen) {
+        rxLen = 0;
+        return;
     }
+    memmove(rxBuf, rxBuf + n, rxLen - n);
+    rxLen -= n;
+}
+
+void rxError() {
+    if (rxErrors < 255) rxErrors++;
+}
+
+void sendAck(uint8_t seq, uint8_t status) {
+    const uint8_t ack[4] = { ACK_HEADER, seq, status, rxErrors };
+    Serial.write(ack, sizeof(ack));
 }
 
 
 // =========================
 // Process Frame
 // =========================
-void processFrame() {
-    CommandFrame frame;
-    memcpy(&frame, buffer, FRAME_LENGTH);
-
+void processCommand(CommandFrame& frame) {
     // 检查指令类别
     bool isTimeMode  = (frame.header == FRAME_HEADER_TIME);
     bool isPulseMode = (frame.header == FRAME_HEADER_PULSE);
@@ -290,8 +534,80 @@ void processFrame() {
             }
         }
     }
+}
+
+void processFrame(uint8_t seq, const uint8_t* payload, uint8_t len) {
+    if ((int16_t)seq == lastSeq) {
+        sendAck(seq, ACK_DUPLICATE);   // 应答丢了，主机重发：已经执行过
+        return;
+    }
+
+    // 先整帧检查，避免执行到一半
+    for (uint8_t off = 0; off < len; off += CMD_LENGTH) {
+        if (payload[off] != FRAME_HEADER_TIME && payload[off] != FRAME_HEADER_PULSE) {
+            sendAck(seq, ACK_BAD_COMMAND);
+            return;
+        }
+    }
+
+    for (uint8_t off = 0; off < len; off += CMD_LENGTH) {
+        CommandFrame frame;
+        decodeCommand(payload + off, frame);
+        processCommand(frame);
+    }
+
+    lastSeq = seq;
+    sendAck(seq, ACK_OK);
+}
+
+void parseFrames() {
+    while (rxLen > 0) {
+        if (rxBuf[0] != LINK_SYNC0 || (rxLen > 1 && rxBuf[1] != LINK_SYNC1)) {
+            rxDrop(1);
+            continue;
+        }
+        if (rxLen < LINK_HEADER) return;
+
+        const uint8_t len = rxBuf[2];
+        if (len == 0 || len % CMD_LENGTH != 0 || len > CMD_LENGTH * LINK_MAX_CMDS) {
+            rxError();
+            rxDrop(1);
+            continue;
+        }
+
+        const uint8_t total = LINK_HEADER + len + LINK_CRC;
+        if (rxLen < total) return;
+
+        const uint16_t crc = (uint16_t)rxBuf[total - 2] | ((uint16_t)rxBuf[total - 1] << 8);
+        if (crc16_ccitt(rxBuf + 2, len + 2) != crc) {
+            rxError();
+            rxDrop(1);
+            continue;
+        }
+
+        processFrame(rxBuf[3], rxBuf + LINK_HEADER, len);
+        rxDrop(total);
+    }
+}
 
-    Serial.println("OK");
+// =========================
+// Serial Reader（不阻塞：每次 loop 只搬走已经到的字节）
+// =========================
+void readSerial() {
+    const unsigned long now = micros();
+
+    // 半帧卡住（主机中途断开 / 丢字节）：丢一个字节重新找帧头
+    if (rxLen > 0 && !Serial.available() && now - rxLastByte > LINK_IDLE_US) {
+        rxError();
+        rxDrop(1);
+        parseFrames();
+    }
+
+    while (Serial.available()) {
+        rxBuf[rxLen++] = (uint8_t)Serial.read();
+        rxLastByte = now;
+        parseFrames();   // 解析后 rxLen < LINK_MAX_FRAME
+    }
 }
 
 void setup() {
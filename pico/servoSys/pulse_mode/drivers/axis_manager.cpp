@@ -0,0 +1,123 @@
+#include "axis_manager.hpp"
+
+#include "hardware/dma.h"
+#include "hardware/pwm.h"
+
+#include "pio/step_position.hpp"
+
+static_assert(NUM_PWM_SLICES <= 32, "slice_mask_ is 32 bits");
+
+// ------------------------------------------------------------
+// lifecycle
+// ------------------------------------------------------------
+
+AxisManager::~AxisManager() {
+    for (size_t i = 0; i < MAX_AXES; ++i) release((int)i);
+}
+
+// ------------------------------------------------------------
+// allocation
+// ------------------------------------------------------------
+
+uint AxisManager::dma_fixed() const {
+    uint n = 0;
+    for (size_t i = 0; i < MAX_AXES; ++i) {
+        if (!axes_[i].in_use) continue;
+        if (axes_[i].has_counter)  n += 1u;        // motor_exec_counter_attach
+        if (axes_[i].has_position) n += 1u;        // step_position
+    }
+    return n;
+}
+
+AxisManager::Error AxisManager::allocate(const AxisRequest& req,
+                                         PS100_P::Config& out,
+                                         int* handle) {
+    int idx = -1;
+    for (size_t i = 0; i < MAX_AXES; ++i) {
+        if (!axes_[i].in_use) { idx = (int)i; break; }
+    }
+    if (idx < 0) return Error::TooManyAxes;
+
+    // ===== 1. PWM slice（pwm_motor 按 slice 计步：一轴一个）=====
+    const uint slice = pwm_gpio_to_slice_num(req.step_pin);
+    if (slice_mask_ & (1u << slice)) return Error::PwmSliceBusy;
+
+    const MotorExecProgram* prog = motor_exec_variant_program(req.variant);
+    if (!prog) return Error::NoStateMachine;
+
+    // ===== 2. DMA：固定通道 + 运行时余量 =====
+    const bool counter = (prog->caps & MOTOR_EXEC_CAP_PROGRESS) != 0;
+    const uint need = dma_fixed() + (counter ? 1u : 0u) + (req.position ? 1u : 0u)
+                    + DMA_RUN_HEADROOM;
+    if (need > NUM_DMA_CHANNELS) return Error::NoDma;
+
+    // ===== 3. motor_exec SM（已装载该程序的 PIO 优先）=====
+    Axis& a = axes_[idx];
+    if (!pio_res_claim(prog->program, 1, a.motor)) return Error::NoStateMachine;
+
+    // ===== 4. step_position SM（尽量不占 motor_exec 的 PIO）=====
+    a.has_position = false;
+    if (req.position) {
+        const bool ok =
+            pio_res_claim(step_position_program_ptr(), 1, a.position, a.motor.pio) ||
+            pio_res_claim(step_position_program_ptr(), 1, a.position);
+        if (!ok) {
+            pio_res_unclaim(a.motor, 1);
+            return Error::NoPositionSm;
+        }
+        a.has_position = true;
+    }
+
+    a.has_counter = counter;
+    a.slice       = slice;
+    a.in_use      = true;
+    slice_mask_ |= (1u << slice);
+    ++count_;
+
+    out.step_pin       = req.step_pin;
+    out.dir_pin        = req.dir_pin;
+    out.dir_invert     = req.dir_invert;
+    out.enable_pin     = req.enable_pin;
+    out.pio            = a.motor.pio;
+    out.sm             = a.motor.sm;
+    out.program_offset = a.motor.offset;
+    out.pio_clk_div    = req.clk_div;
+    out.variant        = req.variant;
+    out.pulse_high_us  = req.pulse_high_us;
+    out.dir_setup_us   = req.dir_setup_us;
+    out.position_pio   = a.has_position ? a.position.pio : nullptr;
+    out.position_sm    = a.has_position ? (int)a.position.sm : -1;
+
+    if (handle) *handle = idx;
+    return Error::Ok;
+}
+
+void AxisManager::release(int handle) {
+    if (handle < 0 || (size_t)handle >= MAX_AXES) return;
+
+    Axis& a = axes_[handle];
+    if (!a.in_use) return;
+
+    pio_res_unclaim(a.motor, 1);
+    if (a.has_position) pio_res_unclaim(a.position, 1);
+
+    slice_mask_ &= ~(1u << a.slice);
+    a.in_use = false;
+    --count_;
+}
+
+// ------------------------------------------------------------
+// diagnostics
+// ------------------------------------------------------------
+
+const char* AxisManager::error_name(Error e) {
+    switch (e) {
+        case Error::Ok:             return "ok";
+        case Error::TooManyAxes:    return "too many axes";
+        case Error::PwmSliceBusy:   return "pwm slice busy";
+        case Error::NoStateMachine: return "no motor_exec sm";
+        case Error::NoPositionSm:   return "no step_position sm";
+        case Error::NoDma:          return "no dma channels";
+        default:                    return "?";
+    }
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "ps100.hpp"
+#include "pio/pio_resources.hpp"
+
+#include <cstdint>
+#include <cstddef>
+
+// ============================================================
+// AxisManager
+//   - Hands out the hardware of the whole chip to PS100_P axes:
+//       * motor_exec SM   : any PIO, one program copy per PIO shared
+//                           by all its SMs (pio_resources); the axis'
+//                           variant decides which program
+//                           (Exec 19 + AdjustableDuty 22 instructions
+//                           never share a PIO)
+//       * step_position SM: preferably on another PIO than motor_exec
+//       * PWM slice       : the step pin's slice, one axis per slice
+//       * DMA channels    : fixed per axis (counter + position), plus
+//                           DMA_RUN_HEADROOM kept free for PWM / ring runs
+//   - Fills one PIO before opening the next, so axes allocated
+//     together can share a PS100_Group (same PIO)
+//   - Exhaustion is an Error, never an alias onto another block
+//
+// RP2040: 2 PIO x 4 SM, RP2350: 3 PIO x 4 SM (pio2).
+//
+// Usage:
+//   AxisManager mgr;
+//   PS100_P::Config cfg{};
+//   if (mgr.allocate({ step, dir }, cfg) != AxisManager::Error::Ok) ...
+//   PS100_P motor(cfg); motor.init();
+// ============================================================
+
+class AxisManager {
+public:
+    static constexpr size_t MAX_AXES = PIO_RES_COUNT * PIO_RES_SMS;
+
+    // channels a PWM count (3) / PIO ring (2) run claims while it runs
+    static constexpr uint DMA_RUN_HEADROOM = 3;
+
+    enum class Error : uint8_t {
+        Ok,
+        TooManyAxes,      // MAX_AXES handed out
+        PwmSliceBusy,     // step pin shares a PWM slice with another axis
+        NoStateMachine,   // no free SM / instruction memory for the motor_exec variant
+        NoPositionSm,     // no free SM / instruction memory for step_position
+        NoDma             // fixed channels would eat the run headroom
+    };
+
+    struct AxisRequest {
+        uint  step_pin;
+        uint  dir_pin;
+        uint  enable_pin = static_cast<uint>(-1);
+        bool  dir_invert = false;
+        float clk_div    = 1.0f;
+        bool  position   = true;   // hardware position register
+
+        MotorExecVariant variant       = MotorExecVariant::Exec;
+        uint32_t         pulse_high_us = 10;   // AdjustableDuty
+        uint32_t         dir_setup_us  = MOTOR_EXEC_DIR_SETUP_US;   // DIR variants
+    };
+
+public:
+    AxisManager() = default;
+    ~AxisManager();
+
+    AxisManager(const AxisManager&)            = delete;
+    AxisManager& operator=(const AxisManager&) = delete;
+
+    // Fills pins, variant, pio / sm / program_offset and position_pio /
+    // position_sm of `out` (other fields untouched). Nothing is claimed on error.
+    // handle (optional): for release()
+    Error allocate(const AxisRequest& req, PS100_P::Config& out, int* handle = nullptr);
+
+    // give the SMs back (the axis must be deinit()ed first)
+    void release(int handle);
+
+    size_t axes() const { return count_; }
+
+    static const char* error_name(Error e);
+
+private:
+    struct Axis {
+        PioResSlot motor;
+        PioResSlot position;
+        bool       has_position;
+        bool       has_counter;   // Exec: progress token counter
+        uint       slice;
+        bool       in_use;
+    };
+
+    uint dma_fixed() const;
+
+    Axis     axes_[MAX_AXES] = {};
+    size_t   count_      = 0;
+    uint32_t slice_mask_ = 0;
+};
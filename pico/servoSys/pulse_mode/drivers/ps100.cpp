@@ -2,27 +2,16 @@
 
 #include "hardware/gpio.h"
 #include "hardware/pio.h"     // pio_sm_* helpers
+#include "hardware/sync.h"    // __dmb
 
 #include "pwm_motor.hpp"
 #include "pio/pio_exec.hpp"
+#include "pio/step_position.hpp"
+#include "pio/pio_resources.hpp"
 #include "motor_exec.pio.h"
+#include "trace/trace.hpp"
 
-// ------------------------------------------------------------
-// helpers
-// ------------------------------------------------------------
-
-static inline absolute_time_t now_ts() {
-    return get_absolute_time();
-}
-
-static inline uint pio_index(PIO pio) {
-    return (pio == pio0) ? 0u : 1u;
-}
-
-// PIO function select for a given PIO instance
-static inline gpio_function_t pio_gpio_func(PIO pio) {
-    return (pio == pio0) ? GPIO_FUNC_PIO0 : GPIO_FUNC_PIO1;
-}
+#include <utility>
 
 // ------------------------------------------------------------
 // internal backend ownership / hard-stop helpers (file-local)
@@ -34,34 +23,49 @@ enum class ActiveBackend : uint8_t {
     None,
     PWM,
     PIO_PARAM,   // xF via PIO FIFO (motor_exec_run)
-    PIO_STREAM   // xE via DMA stream (motor_exec_stream_start)
+    PIO_STREAM,  // xE via DMA stream (motor_exec_stream_start)
+    PIO_RING     // xE via DMA ring   (motor_exec_ring_start)
 };
 
 // Per-(PIO,SM) backend tracker to support multiple PS100_P instances.
-static ActiveBackend g_backend[2][4] = {
-    { ActiveBackend::None, ActiveBackend::None, ActiveBackend::None, ActiveBackend::None },
-    { ActiveBackend::None, ActiveBackend::None, ActiveBackend::None, ActiveBackend::None }
-};
+// Every PIO of the chip (pio2 on RP2350); ActiveBackend::None == 0.
+static ActiveBackend g_backend[PIO_RES_COUNT][PIO_RES_SMS] = {};
+
+// init() rejects an unknown PIO / SM, so the fallback slot is never live
+static ActiveBackend g_backend_invalid = ActiveBackend::None;
 
 static inline ActiveBackend& backend_ref(PIO pio, uint sm) {
-    return g_backend[pio_index(pio)][sm & 0x3u];
+    const int idx = pio_res_index(pio);
+    if (idx < 0 || sm >= PIO_RES_SMS) return g_backend_invalid;
+    return g_backend[idx][sm];
 }
 
 // 兜底：把 STEP 设为 GPIO OUT LOW。
 // 重要：只允许在 “无人占用 / init 安全态” 使用，
 // 不要在 PWM/PIO backend 活跃或刚停止的瞬间滥用。
 static inline void select_step_as_gpio_low(uint pin) {
-    gpio_set_function(pin, GPIO_FUNC_SIO);
-    gpio_set_dir(pin, GPIO_OUT);
+    // 先把 SIO 输出锁存为低，再切 mux（否则旧的 SIO 高电平会闪一个边沿）
     gpio_put(pin, 0);
+    gpio_set_dir(pin, GPIO_OUT);
+    gpio_set_function(pin, GPIO_FUNC_SIO);
 }
 
+// ------------------------------------------------------------
+// STEP mux hand-over
+//   The incoming backend's output must already be LOW when FUNCSEL
+//   changes; then the switch itself can never produce an edge:
+//     PWM: pwm_motor_stop() leaves CC = 0 (idle low)
+//     PIO: SM stopped, pin latch set low before the switch
+//   The outgoing side ends on a whole pulse (see PS100_P::halt).
+// ------------------------------------------------------------
+
 static inline void select_step_for_pwm(uint pin) {
     gpio_set_function(pin, GPIO_FUNC_PWM);
 }
 
-static inline void select_step_for_pio(uint pin, PIO pio) {
-    gpio_set_function(pin, pio_gpio_func(pio));
+static inline void select_step_for_pio(uint pin, PIO pio, uint sm) {
+    pio_sm_exec(pio, sm, pio_encode_set(pio_pins, 0));   // set base == STEP
+    gpio_set_function(pin, pio_res_gpio_func(pio));
 }
 
 // Hard stop PIO SM and try to leave STEP low (PIO side).
@@ -85,6 +89,7 @@ static inline void hard_stop_pio(PIO pio, uint sm) {
 // - PIO：hard_stop_pio() 仅在 PIO 侧 set pins=0，不切 SIO
 static inline void terminate_hardware(PS100_P::Config const& cfg) {
     auto& b = backend_ref(cfg.pio, cfg.sm);
+    PM_TRACE_SCOPE(Terminate, b);
 
     switch (b) {
         case ActiveBackend::PWM:
@@ -94,6 +99,8 @@ static inline void terminate_hardware(PS100_P::Config const& cfg) {
 
         case ActiveBackend::PIO_PARAM:
         case ActiveBackend::PIO_STREAM:
+        case ActiveBackend::PIO_RING:
+            // DMA 由调用方（PS100_P::release_dma）先行中止
             hard_stop_pio(cfg.pio, cfg.sm);
             break;
 
@@ -114,13 +121,26 @@ static inline void terminate_hardware(PS100_P::Config const& cfg) {
 // ------------------------------------------------------------
 
 PS100_P::PS100_P(const Config& cfg)
-    : cfg_(cfg) {}
+    : cfg_(cfg),
+      scale_(make_axis_scale(cfg.units)),
+      prog_(motor_exec_variant_program(cfg.variant)) {}
 
 // ------------------------------------------------------------
 // lifecycle
 // ------------------------------------------------------------
 
 bool PS100_P::init() {
+    // 不认识的 PIO / SM：拒绝，而不是落到别的 block 上
+    if (pio_res_index(cfg_.pio) < 0 || cfg_.sm >= PIO_RES_SMS) return false;
+    if (!prog_) return false;
+
+    // own SM: claimed here unless the caller (AxisManager / pio_res_claim)
+    // already did, so step_position_attach / other drivers cannot pick it
+    if (!owns_sm_ && !pio_sm_is_claimed(cfg_.pio, cfg_.sm)) {
+        pio_sm_claim(cfg_.pio, cfg_.sm);
+        owns_sm_ = true;
+    }
+
     // STEP safe default: GPIO low
     select_step_as_gpio_low(cfg_.step_pin);
 
@@ -142,13 +162,26 @@ bool PS100_P::init() {
 
     // ---- PIO program is NOT owned here ----
     // motor_exec_init will pio_gpio_init(step_pin) => steals pin mux.
-    motor_exec_init(
-        cfg_.pio,
-        cfg_.sm,
-        cfg_.program_offset,
-        cfg_.step_pin,
-        cfg_.pio_clk_div
-    );
+    // timing model of this SM: clock read once, no per-command float
+    if (cfg_.variant == MotorExecVariant::Exec) {
+        motor_exec_init(
+            cfg_.pio,
+            cfg_.sm,
+            cfg_.program_offset,
+            cfg_.step_pin,
+            cfg_.pio_clk_div
+        );
+        timing_ = motor_exec_timing_for(cfg_.pio_clk_div);
+    } else {
+        // DIR variants also take dir_pin (latched at its current level)
+        motor_exec_variant_init(cfg_.pio, cfg_.sm, cfg_.program_offset, *prog_,
+                                cfg_.step_pin, cfg_.dir_pin, cfg_.pio_clk_div);
+
+        const PioTiming base = motor_exec_variant_timing(*prog_, cfg_.pio_clk_div);
+        high_loops_ = motor_exec_variant_high_loops(base, cfg_.pulse_high_us);
+        timing_     = motor_exec_variant_timing(*prog_, cfg_.pio_clk_div, high_loops_);
+        setup_loops_ = motor_exec_variant_setup_loops(timing_, cfg_.dir_setup_us);
+    }
 
     // Keep SM disabled by default; enable only when running a PIO command.
     pio_sm_set_enabled(cfg_.pio, cfg_.sm, false);
@@ -160,7 +193,20 @@ bool PS100_P::init() {
     // -------- state init (COM1/COM2) --------
     com1_reason_ = CompletionReason::Completed;
     com2_state_  = CommandState::Empty;
-    com2_t_end_  = now_ts();
+
+    // hardware pulse counter for the PIO backend (optional: -1 => steps_done()=0)
+    if (counter_dma_ < 0 && (prog_->caps & MOTOR_EXEC_CAP_PROGRESS)) {
+        counter_dma_ = motor_exec_counter_attach(cfg_.pio, cfg_.sm);
+    }
+
+    // absolute position register (optional: -1 => has_position() == false)
+    if (cfg_.position_pio && position_slot_ < 0) {
+        position_slot_ = step_position_attach(cfg_.position_pio,
+                                              cfg_.step_pin,
+                                              cfg_.dir_pin,
+                                              cfg_.dir_invert,
+                                              cfg_.position_sm);
+    }
 
     backend_ref(cfg_.pio, cfg_.sm) = ActiveBackend::None;
 
@@ -169,6 +215,17 @@ bool PS100_P::init() {
 
 void PS100_P::deinit() {
     stop();
+
+    motor_exec_counter_detach(counter_dma_);
+    counter_dma_ = -1;
+
+    step_position_detach(position_slot_);
+    position_slot_ = -1;
+
+    if (owns_sm_) {
+        pio_sm_unclaim(cfg_.pio, cfg_.sm);
+        owns_sm_ = false;
+    }
 }
 
 // ------------------------------------------------------------
@@ -186,6 +243,8 @@ void PS100_P::disable() {
 }
 
 void PS100_P::set_direction(bool forward) {
+    // DIR variants: pin is on the PIO, the level goes into the next round
+    forward_ = forward;
     bool level = forward ^ cfg_.dir_invert;
     gpio_put(cfg_.dir_pin, level);
 }
@@ -197,8 +256,18 @@ void PS100_P::set_direction(bool forward) {
 void PS100_P::update() {
     if (com2_state_ != CommandState::Running) return;
 
-    // Natural completion when time reached
-    if (!time_reached(com2_t_end_)) return;
+    // Natural completion is reported by the hardware itself:
+    //   PWM        : pwm_motor reported the last pulse (DMA chain end / wrap IRQ)
+    //   PIO_PARAM  : SM back at wait_cmd with TX FIFO empty
+    //   PIO_STREAM : DMA drained + SM idle
+    //   PIO_RING   : DMA chain terminated + SM idle
+    if (!hardware_done()) return;
+
+    // DMA side is idle: give channels back
+    if (ring_ >= 0) {
+        ring_underrun_ = motor_exec_ring_underrun(ring_);
+    }
+    release_dma();
 
     // COM2 -> COM1 (Completed), COM2 becomes Empty
     com1_reason_ = CompletionReason::Completed;
@@ -208,6 +277,33 @@ void PS100_P::update() {
     // （硬件在 backend 自己的自然结束语义中完成；PWM 的 mux 收尾靠 pwm_motor_poll_cleanup）
 }
 
+bool PS100_P::hardware_done() const {
+    switch (backend_ref(cfg_.pio, cfg_.sm)) {
+        case ActiveBackend::PWM:
+            return !pwm_motor_busy(cfg_.step_pin);
+
+        case ActiveBackend::PIO_PARAM:
+            return sm_idle();
+
+        case ActiveBackend::PIO_STREAM:
+            if (motor_exec_stream_busy(stream_dma_)) return false;
+            return sm_idle();
+
+        case ActiveBackend::PIO_RING:
+            if (motor_exec_ring_active(ring_)) return false;
+            return sm_idle();
+
+        case ActiveBackend::None:
+        default:
+            return true;
+    }
+}
+
+// SM drained, waiting at a command / round boundary (any variant)
+bool PS100_P::sm_idle() const {
+    return motor_exec_variant_idle(cfg_.pio, cfg_.sm, cfg_.program_offset, *prog_);
+}
+
 // ------------------------------------------------------------
 // State query (update-on-read)
 // ------------------------------------------------------------
@@ -222,65 +318,294 @@ PS100_P::CompletionReason PS100_P::last_completion() {
     return com1_reason_;
 }
 
+bool PS100_P::last_ring_underrun() const {
+    return ring_underrun_;
+}
+
+uint32_t PS100_P::steps_done() const {
+    // 两个计数源在命令结束后都保持不变，直到下一条命令启动
+    if (last_cmd_pwm_) {
+        return pwm_steps_ - pwm_motor_steps_remaining(cfg_.step_pin);
+    }
+    return motor_exec_counter_read(counter_dma_) + pio_adjust_;
+}
+
+// ------------------------------------------------------------
+// Absolute position
+// ------------------------------------------------------------
+
+int32_t PS100_P::position() const {
+    return step_position_read(position_slot_);
+}
+
+void PS100_P::set_position(int32_t steps) {
+    step_position_set(position_slot_, steps);
+}
+
+// ------------------------------------------------------------
+// Physical halt of the current command (interrupt / stop)
+// ------------------------------------------------------------
+
+void PS100_P::halt() {
+    // ---------- 1. freeze: STEP keeps its level, no new edge ----------
+    const ActiveBackend b = backend_ref(cfg_.pio, cfg_.sm);
+    PM_TRACE_SCOPE(Halt, b);
+    if (b == ActiveBackend::PWM) {
+        pwm_motor_freeze(cfg_.step_pin);
+    } else if (b != ActiveBackend::None) {
+        pio_sm_set_enabled(cfg_.pio, cfg_.sm, false);
+    }
+
+    // ---------- 2. pulse in progress: finish it, never a runt ----------
+    // 电平已冻结，读到的就是停下那一刻的输出
+    const bool mid_pulse = (b != ActiveBackend::None) && gpio_get(cfg_.step_pin);
+    if (mid_pulse) {
+        gpio_set_outover(cfg_.step_pin, GPIO_OVERRIDE_HIGH);
+    }
+
+    // ---------- 3. progress: a pulse whose rising edge went out counts ----------
+    if (last_cmd_pwm_) {
+        // remaining 含当前周期（周期以上升沿开始），pwm_motor_stop() 会清零
+        const uint32_t rem = pwm_motor_steps_remaining(cfg_.step_pin);
+        pwm_steps_ -= rem;
+        if (rem > 0) pwm_steps_ += 1;
+    } else if (mid_pulse && counter_dma_ >= 0) {
+        pio_adjust_ = 1;     // token 在高电平结束后才 push
+    }
+
+    release_dma();
+    terminate_hardware(cfg_);
+
+    if (mid_pulse) {
+        busy_wait_us_32(cfg_.min_high_us);
+        gpio_set_outover(cfg_.step_pin, GPIO_OVERRIDE_NORMAL);   // backend 已输出低
+    }
+}
+
+// ------------------------------------------------------------
+// DMA resource release (stream / ring)
+// ------------------------------------------------------------
+
+void PS100_P::release_dma() {
+    if (stream_dma_ >= 0) {
+        motor_exec_stream_abort(stream_dma_);
+        stream_dma_ = -1;
+    }
+    if (ring_ >= 0) {
+        motor_exec_ring_release(ring_);
+        ring_ = -1;
+    }
+    // DMA 已停：words 不会再被读取，queue 也不再有消费者
+    stream_buf_.reset();
+    queue_clear();
+}
+
 // ------------------------------------------------------------
 // motion commands
 // ------------------------------------------------------------
 
-void PS100_P::run_steps(uint32_t steps,
-                        uint32_t freq_hz,
-                        Backend backend) {
-    // settle natural completion first
+// settle natural completion, then interrupt a still-running COM2
+void PS100_P::preempt() {
     update();
 
     // If COM2 still running, interrupt it (physical stop + state shift)
     if (com2_state_ == CommandState::Running) {
-        terminate_hardware(cfg_);
+        halt();
         com1_reason_ = CompletionReason::Interrupted;
         com2_state_  = CommandState::Empty;
     }
 
-    if (steps == 0 || freq_hz == 0) {
-        // no-op command: keep COM2 empty, COM1 becomes Completed
-        com1_reason_ = CompletionReason::Completed;
-        com2_state_  = CommandState::Empty;
+    // staged but never started (group): its DMA is still held
+    release_dma();
+}
 
-        // 兜底：无人占用时保持安全低
-        backend_ref(cfg_.pio, cfg_.sm) = ActiveBackend::None;
-        select_step_as_gpio_low(cfg_.step_pin);
-        return;
-    }
+// no-op command: keep COM2 empty, COM1 becomes Completed
+void PS100_P::complete_empty() {
+    com1_reason_ = CompletionReason::Completed;
+    com2_state_  = CommandState::Empty;
 
-    // start backend (non-blocking) + pin mux ownership
-    if (backend == Backend::PWM) {
-        // Ensure PIO SM is not running, give pin to PWM
-        pio_sm_set_enabled(cfg_.pio, cfg_.sm, false);
-        select_step_for_pwm(cfg_.step_pin);
+    last_cmd_pwm_ = true;   // steps_done() == 0
+    pwm_steps_    = 0;
+
+    // 兜底：无人占用时保持安全低
+    backend_ref(cfg_.pio, cfg_.sm) = ActiveBackend::None;
+    select_step_as_gpio_low(cfg_.step_pin);
+}
+
+// Ensure PWM is stopped, give pin to PIO, and SM is clean + DISABLED
+void PS100_P::prepare_pio(MotorExecFormat fmt) {
+    // 注：pwm_motor_stop 自己会保证 idle low + mux 收尾策略
+    pwm_motor_stop(cfg_.step_pin);
+
+    // SM 先停稳、锁存低电平，再交接 mux
+    pio_sm_set_enabled(cfg_.pio, cfg_.sm, false);
+    pio_sm_clear_fifos(cfg_.pio, cfg_.sm);
+    pio_sm_restart(cfg_.pio, cfg_.sm);
+    select_step_for_pio(cfg_.step_pin, cfg_.pio, cfg_.sm);
 
-        pwm_motor_run(cfg_.step_pin, freq_hz, steps);
-        backend_ref(cfg_.pio, cfg_.sm) = ActiveBackend::PWM;
+    if (cfg_.variant == MotorExecVariant::Exec) {
+        motor_exec_set_format(cfg_.pio, cfg_.sm, cfg_.program_offset, fmt);
     } else {
-        // Ensure PWM is stopped, give pin to PIO, and SM is clean
-        // 注：pwm_motor_stop 自己会保证 idle low + mux 收尾策略
-        pwm_motor_stop(cfg_.step_pin);
+        motor_exec_variant_park(cfg_.pio, cfg_.sm, cfg_.program_offset, *prog_);
+    }
+    fmt_ = fmt;
+    motor_exec_counter_reset(counter_dma_);
+    last_cmd_pwm_ = false;
+    pio_adjust_   = 0;
+}
+
+// ------------------------------------------------------------
+// PIO staging: FIFO / DMA preloaded, SM left disabled.
+//   run_* enable the SM right away, PS100_Group enables several
+//   SMs of one PIO on the same clock edge.
+//   Returns false for a no-op command (COM1 already Completed).
+// ------------------------------------------------------------
 
-        select_step_for_pio(cfg_.step_pin, cfg_.pio);
+bool PS100_P::stage_pio_steps(uint32_t steps, uint32_t freq_hz) {
+    preempt();
 
-        pio_sm_set_enabled(cfg_.pio, cfg_.sm, false);
-        pio_sm_clear_fifos(cfg_.pio, cfg_.sm);
-        pio_sm_restart(cfg_.pio, cfg_.sm);
-        pio_sm_set_enabled(cfg_.pio, cfg_.sm, true);
+    if (steps == 0 || freq_hz == 0) {
+        complete_empty();
+        return false;
+    }
 
-        uint32_t duty = hz_to_duty_period(static_cast<double>(freq_hz));
-        motor_exec_run(cfg_.pio, cfg_.sm, duty, steps);
+    if (cfg_.variant != MotorExecVariant::Exec) {
+        // whole round ([DIR] cmd [end], <= 7 words) into the joined 8-word TX FIFO
+        const MotorExecMove m{ freq_hz, steps, forward_ };
+        uint32_t words[8];
+        const size_t n = motor_exec_variant_encode(*prog_, timing_, high_loops_, setup_loops_,
+                                                   cfg_.dir_invert, &m, 1,
+                                                   words, sizeof(words) / sizeof(words[0]));
+        if (n == 0) {
+            complete_empty();   // e.g. 1 step on HalfDuty
+            return false;
+        }
+
+        prepare_pio(MotorExecFormat::Raw);
+        for (size_t i = 0; i < n; ++i) pio_sm_put(cfg_.pio, cfg_.sm, words[i]);
 
         backend_ref(cfg_.pio, cfg_.sm) = ActiveBackend::PIO_PARAM;
+        return true;
+    }
+
+    prepare_pio(MotorExecFormat::Raw);
+
+    // integer model of this SM's clkdiv (precomputed in init)
+    // FIFO was just cleared: the 2 words never block
+    uint32_t duty = timing_.hz_to_duty(freq_hz);
+    motor_exec_run(cfg_.pio, cfg_.sm, duty, steps);
+    queue_hz_ = freq_hz;   // queue_steps() may blend from here
+
+    backend_ref(cfg_.pio, cfg_.sm) = ActiveBackend::PIO_PARAM;
+    return true;
+}
+
+bool PS100_P::stage_pio_stream(const uint32_t* words,
+                               size_t count,
+                               MotorExecFormat fmt) {
+    if (!supports_pio_stream()) return false;
+    if (fmt == MotorExecFormat::Packed && !(prog_->caps & MOTOR_EXEC_CAP_PACKED)) return false;
+
+    preempt();
+
+    if (!words || count == 0) {
+        complete_empty();
+        return false;
+    }
+
+    prepare_pio(fmt);
+
+    // DMA fills the TX FIFO and waits for the SM
+    stream_dma_ = motor_exec_stream_start(cfg_.pio, cfg_.sm, words, count, false);
+    if (stream_dma_ < 0) {
+        complete_empty();
+        return false;
+    }
+
+    backend_ref(cfg_.pio, cfg_.sm) = ActiveBackend::PIO_STREAM;
+    return true;
+}
+
+bool PS100_P::stage_pio_ring(uint32_t* buf,
+                             size_t half_words,
+                             motor_exec_refill_fn refill,
+                             void* user,
+                             MotorExecFormat fmt) {
+    if (!supports_pio_stream()) return false;
+    // ring 以 0 补齐半区：只有 0 word 为空命令的程序可用
+    if (!(prog_->caps & MOTOR_EXEC_CAP_DWELL)) return false;
+    if (fmt == MotorExecFormat::Packed && !(prog_->caps & MOTOR_EXEC_CAP_PACKED)) return false;
+    // raw 命令为 (duty, steps) 两个 word：奇数半区会把补齐的 0 夹在一条命令中间，
+    // 之后每条命令都错位
+    if (fmt == MotorExecFormat::Raw && (half_words & 1u)) return false;
+
+    preempt();
+    prepare_pio(fmt);
+
+    ring_underrun_ = false;
+    ring_ = motor_exec_ring_start(cfg_.pio, cfg_.sm, buf, half_words, refill, user, false);
+
+    if (ring_ < 0) {
+        // empty stream or no DMA: behave like a no-op command
+        complete_empty();
+        return false;
+    }
+
+    backend_ref(cfg_.pio, cfg_.sm) = ActiveBackend::PIO_RING;
+    return true;
+}
+
+// staged SM is running now: COM2 becomes Running
+void PS100_P::mark_started() {
+    com2_state_ = CommandState::Running;
+}
+
+void PS100_P::start_staged() {
+    pio_sm_set_enabled(cfg_.pio, cfg_.sm, true);
+    mark_started();
+}
+
+// ------------------------------------------------------------
+// motion commands
+// ------------------------------------------------------------
+
+void PS100_P::run_steps(uint32_t steps,
+                        uint32_t freq_hz,
+                        Backend backend) {
+    PM_TRACE_SCOPE(RunSteps, steps);
+
+    if (backend == Backend::Auto) {
+        backend = auto_backend(freq_hz, steps);
+    }
+
+    // DIR driven by the PIO (and the pulse shape is why the variant was chosen)
+    if (prog_->caps & MOTOR_EXEC_CAP_DIR) {
+        backend = Backend::PIO;
+    }
+
+    if (backend == Backend::PIO) {
+        if (stage_pio_steps(steps, freq_hz)) start_staged();
+        return;
+    }
+
+    preempt();
+
+    if (steps == 0 || freq_hz == 0) {
+        complete_empty();
+        return;
     }
 
-    // COM2 becomes Running with deterministic t_end
-    uint64_t duration_us =
-        (static_cast<uint64_t>(steps) * 1000000ULL) / freq_hz;
+    // Ensure PIO SM is not running, give pin to PWM (slice idle low first)
+    pio_sm_set_enabled(cfg_.pio, cfg_.sm, false);
+    pwm_motor_stop(cfg_.step_pin);
+    select_step_for_pwm(cfg_.step_pin);
+
+    last_cmd_pwm_ = true;
+    pwm_steps_    = steps;
+    pwm_motor_run(cfg_.step_pin, freq_hz, steps);
+    backend_ref(cfg_.pio, cfg_.sm) = ActiveBackend::PWM;
 
-    com2_t_end_  = delayed_by_us(now_ts(), duration_us);
+    // COM2 becomes Running; completion comes from the backend itself
     com2_state_  = CommandState::Running;
 }
 
@@ -289,62 +614,272 @@ void PS100_P::run_velocity(uint32_t freq_hz,
                            Backend backend) {
     if (freq_hz == 0 || duration_ms == 0) {
         // treat as no-op completion
-        update();
-        com1_reason_ = CompletionReason::Completed;
-
-        backend_ref(cfg_.pio, cfg_.sm) = ActiveBackend::None;
-        select_step_as_gpio_low(cfg_.step_pin);
+        preempt();
+        complete_empty();
         return;
     }
 
-    const uint64_t duration_us = static_cast<uint64_t>(duration_ms) * 1000ULL;
-    const double duration_s = static_cast<double>(duration_us) / 1e6;
+    // steps = hz * duration (integer, rounded)
+    run_steps(duration_ms_to_steps(duration_ms, freq_hz), freq_hz, backend);
+}
+
+// ------------------------------------------------------------
+// motion in physical units
+// ------------------------------------------------------------
+
+bool PS100_P::move_mm(q16_16 distance_mm,
+                      q16_16 speed_mm_s,
+                      Backend backend) {
+    if (!has_units()) return false;
+
+    const int32_t  steps = scale_.mm_to_steps(distance_mm);
+    const uint32_t hz    = scale_.mm_s_to_hz(speed_mm_s);
+    if (steps == 0 || hz == 0) return false;
 
-    // steps = hz * duration_s
-    const uint32_t steps = duration_to_steps(duration_s, static_cast<double>(freq_hz));
+    // 先停下正在执行的命令（脉冲收尾），再改 DIR：旧脉冲不会带着新方向输出
+    preempt();
 
-    run_steps(steps, freq_hz, backend);
+    const bool turn = (steps > 0) != forward_;
+    set_direction(steps > 0);
+    // CPU 写的 DIR：新命令的第一个 STEP 之前留出建立时间（DIR 变体在流内等待）
+    if (turn && !(prog_->caps & MOTOR_EXEC_CAP_DIR)) busy_wait_us_32(cfg_.dir_setup_us);
+    run_steps((uint32_t)((steps < 0) ? -(int64_t)steps : steps), hz, backend);
+    return true;
+}
+
+bool PS100_P::queue_mm(q16_16 distance_mm,
+                       q16_16 speed_mm_s,
+                       q16_16 accel_mm_s2) {
+    if (!has_units()) return false;
+
+    const int32_t  steps = scale_.mm_to_steps(distance_mm);
+    const uint32_t hz    = scale_.mm_s_to_hz(speed_mm_s);
+    if (steps == 0 || hz == 0) return false;
+
+    // DIR is a GPIO: one direction per queue run
+    const bool forward = steps > 0;
+    const bool turn = forward != forward_;
+    if (turn) {
+        if (busy()) return false;
+        set_direction(forward);
+        // CPU 写的 DIR：第一个 STEP 之前留出建立时间（同 move_mm）
+        if (!(prog_->caps & MOTOR_EXEC_CAP_DIR)) busy_wait_us_32(cfg_.dir_setup_us);
+    }
+
+    return queue_steps((uint32_t)((steps < 0) ? -(int64_t)steps : steps), hz,
+                       scale_.mm_s2_to_steps_s2(accel_mm_s2));
 }
 
 void PS100_P::run_pio_stream(const uint32_t* words,
                              size_t count,
-                             uint64_t estimated_duration_us) {
-    if (!supports_pio_stream()) return;
+                             uint64_t estimated_duration_us,
+                             MotorExecFormat fmt) {
+    // completion is hardware-tracked; the estimate is kept for API compatibility
+    (void)estimated_duration_us;
+    PM_TRACE_SCOPE(RunStream, count);
 
-    // settle natural completion first
-    update();
+    if (stage_pio_stream(words, count, fmt)) start_staged();
+}
 
-    if (!words || count == 0 || estimated_duration_us == 0) {
-        com1_reason_ = CompletionReason::Completed;
-        com2_state_  = CommandState::Empty;
+void PS100_P::run_pio_stream(StreamBuffer&& stream,
+                             uint64_t estimated_duration_us,
+                             MotorExecFormat fmt) {
+    (void)estimated_duration_us;
+    PM_TRACE_SCOPE(RunStream, stream.size());
 
-        backend_ref(cfg_.pio, cfg_.sm) = ActiveBackend::None;
-        select_step_as_gpio_low(cfg_.step_pin);
-        return;
+    // preempt() inside stage releases the previous block first
+    StreamBuffer buf(std::move(stream));
+    if (!stage_pio_stream(buf.data(), buf.size(), fmt)) return;   // buf freed here
+
+    stream_buf_ = std::move(buf);
+    start_staged();
+}
+
+bool PS100_P::run_pio_moves(const MotorExecMove* moves, size_t n) {
+    if (!moves || n == 0) return false;
+
+    StreamBuffer buf = StreamBuffer::acquire(motor_exec_variant_max_words(*prog_, n));
+    if (!buf) return false;
+
+    const size_t words = motor_exec_variant_encode(*prog_, timing_, high_loops_, setup_loops_,
+                                                   cfg_.dir_invert, moves, n,
+                                                   buf.data(), buf.capacity());
+    if (words == 0) return false;
+    buf.set_size(words);
+
+    // DIR 在流外时：先停下正在执行的命令，再由 CPU 设置方向
+    preempt();
+    if (prog_->caps & MOTOR_EXEC_CAP_DIR) {
+        forward_ = moves[n - 1].forward;   // DIR level the stream leaves behind
+    } else {
+        set_direction(moves[0].forward);
     }
 
-    // If COM2 still running, interrupt it (physical stop + state shift)
+    run_pio_stream(std::move(buf), 0, MotorExecFormat::Raw);
+    return com2_state_ == CommandState::Running;
+}
+
+bool PS100_P::run_pio_ring(uint32_t* buf,
+                           size_t half_words,
+                           motor_exec_refill_fn refill,
+                           void* user,
+                           MotorExecFormat fmt) {
+    PM_TRACE_SCOPE(RunRing, half_words);
+
+    if (!stage_pio_ring(buf, half_words, refill, user, fmt)) return false;
+
+    start_staged();
+    return true;
+}
+
+bool PS100_P::resume_pio_ring() {
+    update();
+
+    // ring 与 SM 都已排空时 update() 已经结束了 COM2：由调用者重新启动
+    if (com2_state_ != CommandState::Running) return false;
+    if (backend_ref(cfg_.pio, cfg_.sm) != ActiveBackend::PIO_RING) return false;
+
+    return motor_exec_ring_resume(ring_);
+}
+
+// ------------------------------------------------------------
+// queued motion (blend handoff)
+// ------------------------------------------------------------
+
+bool PS100_P::queue_steps(uint32_t steps,
+                          uint32_t freq_hz,
+                          uint32_t a_max) {
+    PM_TRACE_SCOPE(QueueSteps, steps);
+
+    if (steps == 0 || freq_hz == 0) return false;
+    if (!supports_pio_stream()) return false;
+    if (!(prog_->caps & MOTOR_EXEC_CAP_DWELL)) return false;
+
+    update();
+
+    // ---------- can the segment join what is running? ----------
+    // 只要没有其它 DMA 在向 SM 推送、格式为 raw，就能直接接在后面
+    const ActiveBackend b = backend_ref(cfg_.pio, cfg_.sm);
+
+    bool join = false;
     if (com2_state_ == CommandState::Running) {
-        terminate_hardware(cfg_);
-        com1_reason_ = CompletionReason::Interrupted;
-        com2_state_  = CommandState::Empty;
+        join = queue_mode_
+            || b == ActiveBackend::PIO_PARAM
+            || (b == ActiveBackend::PIO_STREAM && fmt_ == MotorExecFormat::Raw &&
+                !motor_exec_stream_busy(stream_dma_));
     }
 
-    // Stop PWM, switch pin to PIO, clean SM, then start DMA stream
-    pwm_motor_stop(cfg_.step_pin);
-    select_step_for_pio(cfg_.step_pin, cfg_.pio);
+    // ---------- expand: ramp from the previous speed + cruise ----------
+    uint32_t words[2 * (QUEUE_BLEND_CMDS + 1)];
+    const size_t n = motor_exec_blend_segment(timing_, join ? queue_hz_ : 0u, freq_hz, steps,
+                                              a_max, QUEUE_BLEND_CMDS, words,
+                                              sizeof(words) / sizeof(words[0]));
+    if (n == 0) return false;
+
+    const size_t cmds = n / 2;
+    if (join && queue_free() < cmds) return false;
+
+    // PWM / foreign ring / stream still being fed / idle: same as run_*
+    if (!join) preempt();
+
+    // ---------- publish ----------
+    const uint32_t h = queue_head_;
+    for (size_t i = 0; i < cmds; ++i) {
+        uint32_t* c = &queue_[((h + i) & (QUEUE_CMDS - 1u)) * 2u];
+        c[0] = words[2 * i];
+        c[1] = words[2 * i + 1];
+    }
+    __dmb();                 // commands visible before the index
+    queue_head_ = h + (uint32_t)cmds;
+    queue_hz_   = freq_hz;
+
+    if (!join) {
+        if (!queue_start(true)) {
+            complete_empty();
+            return false;
+        }
+        start_staged();
+        return true;
+    }
 
-    pio_sm_set_enabled(cfg_.pio, cfg_.sm, false);
-    pio_sm_clear_fifos(cfg_.pio, cfg_.sm);
-    pio_sm_restart(cfg_.pio, cfg_.sm);
-    pio_sm_set_enabled(cfg_.pio, cfg_.sm, true);
+    // ring consuming the queue: the next refill picks the segment up; a ring
+    // that ran dry is re-linked (at its chain end, or restarted right away)
+    if (queue_mode_) {
+        motor_exec_ring_resume(ring_);
+        return true;
+    }
 
-    motor_exec_stream_start(cfg_.pio, cfg_.sm, words, count);
+    // ---------- attach a new ring behind the running SM ----------
+    if (stream_dma_ >= 0) {
+        // one-shot stream already fully in the FIFO: give the channel back
+        motor_exec_stream_abort(stream_dma_);
+        stream_dma_ = -1;
+        stream_buf_.reset();
+    }
 
-    backend_ref(cfg_.pio, cfg_.sm) = ActiveBackend::PIO_STREAM;
+    // 失败（无 DMA）时丢弃新段，正在执行的命令不受影响
+    return queue_start(false);
+}
 
-    com2_t_end_ = delayed_by_us(now_ts(), estimated_duration_us);
-    com2_state_ = CommandState::Running;
+size_t PS100_P::queue_free() const {
+    return QUEUE_CMDS - (size_t)(queue_head_ - queue_tail_);
+}
+
+bool PS100_P::queue_start(bool fresh) {
+    ring_underrun_ = false;
+
+    if (fresh) {
+        prepare_pio(MotorExecFormat::Raw);
+        ring_ = motor_exec_ring_start(cfg_.pio, cfg_.sm, queue_ring_, QUEUE_RING_HALF,
+                                      &PS100_P::queue_refill, this, false);
+    } else {
+        ring_ = motor_exec_ring_append(cfg_.pio, cfg_.sm, queue_ring_, QUEUE_RING_HALF,
+                                       &PS100_P::queue_refill, this);
+    }
+
+    if (ring_ < 0) {
+        queue_clear();
+        return false;
+    }
+
+    queue_mode_ = true;
+    backend_ref(cfg_.pio, cfg_.sm) = ActiveBackend::PIO_RING;
+    return true;
+}
+
+void PS100_P::queue_clear() {
+    // 仅在没有 ring 消费 queue 时调用
+    queue_tail_ = queue_head_;
+    queue_mode_ = false;
+    queue_hz_   = 0;
+}
+
+size_t PS100_P::queue_refill(uint32_t* dst, size_t capacity, void* user) {
+    return static_cast<PS100_P*>(user)->queue_emit(dst, capacity);
+}
+
+// DMA IRQ: copy queued commands into the free ring half
+size_t PS100_P::queue_emit(uint32_t* dst, size_t capacity) {
+    uint32_t       t = queue_tail_;
+    const uint32_t h = queue_head_;
+    __dmb();                 // index read before the commands
+
+    size_t n = 0;
+    while (t != h && n + 2 <= capacity) {
+        const uint32_t* c = &queue_[(t & (QUEUE_CMDS - 1u)) * 2u];
+        dst[n++] = c[0];
+        dst[n++] = c[1];
+        ++t;
+    }
+
+    if (n > 0) {
+        __dmb();
+        queue_tail_ = t;
+    }
+
+    // queue 为空：返回 0，链在此处停下（不填 dwell，之后入队的段不必排在它后面）；
+    // queue_steps() 用 motor_exec_ring_resume() 接上
+    return n;
 }
 
 // stop(): the only API that is allowed to have real hardware side effects
@@ -354,7 +889,7 @@ void PS100_P::stop() {
 
     if (com2_state_ != CommandState::Running) {
         // still enforce safe hardware termination
-        terminate_hardware(cfg_);
+        halt();
         com2_state_ = CommandState::Empty;
 
         // idle fallback
@@ -363,7 +898,7 @@ void PS100_P::stop() {
     }
 
     // Physical stop
-    terminate_hardware(cfg_);
+    halt();
 
     // COM2 -> COM1 (Stopped), COM2 becomes Empty
     com1_reason_ = CompletionReason::Stopped;
@@ -377,6 +912,33 @@ void PS100_P::stop() {
 // capability
 // ------------------------------------------------------------
 
+PS100_P::Backend PS100_P::auto_backend(uint32_t freq_hz, uint32_t steps) const {
+    // 正在用 / 刚用过的 backend 享有 hysteresis：频段边缘不来回切 mux
+    const bool     on_pwm = last_cmd_pwm_;
+    const uint32_t h      = cfg_.auto_hysteresis_hz;
+
+    uint32_t lo = cfg_.auto_pwm_min_hz;
+    uint32_t hi = cfg_.auto_pwm_max_hz;
+    if (on_pwm) {
+        lo = (lo > h) ? lo - h : 0u;
+        hi = hi + h;
+    } else {
+        lo = lo + h;
+        hi = (hi > h) ? hi - h : 0u;
+    }
+
+    if (freq_hz < lo || freq_hz > hi) return Backend::PIO;
+    if (steps < cfg_.auto_pwm_min_steps) return Backend::PIO;
+
+    // 没有 DMA 计步时 PWM 每个脉冲一次 IRQ：高频交给 PIO
+    if (freq_hz > cfg_.auto_pwm_irq_max_hz &&
+        pwm_motor_expected_count_mode(cfg_.step_pin) == PwmCountMode::Irq) {
+        return Backend::PIO;
+    }
+
+    return Backend::PWM;
+}
+
 bool PS100_P::supports_pio_stream() const {
     // Program ownership is external; we only require a valid execution context.
     // offset can legally be 0, so we cannot treat 0 as "not loaded".
@@ -2,6 +2,10 @@
 
 #include "pico/stdlib.h"
 #include "hardware/pio.h"
+#include "pio/pio_exec.hpp"
+#include "pio/motor_exec_variants.hpp"
+#include "pio/stream_pool.hpp"
+#include "timing/axis_units.hpp"
 #include <cstdint>
 #include <cstddef>
 
@@ -14,14 +18,19 @@
 //   - DOES NOT own PIO program memory
 // ============================================================
 
+class PS100_Group;
+
 class PS100_P {
+    friend class PS100_Group;   // stages + starts several SMs in sync
+
 public:
     // ------------------------------------------------------------
     // Execution backend (API-level choice, NOT state-machine logic)
     // ------------------------------------------------------------
     enum class Backend : uint8_t {
         PWM,   // hardware PWM
-        PIO    // PIO parameter mode (xF)
+        PIO,   // PIO parameter mode (xF)
+        Auto   // per command from freq / steps / PWM counting cost (Config::auto_*)
     };
 
     // ------------------------------------------------------------
@@ -56,10 +65,56 @@ public:
 
         // -------- PIO execution context --------
         // Program MUST already be loaded by upper layer.
-        PIO   pio;              // pio0 or pio1
+        PIO   pio;              // pio0 / pio1 (/ pio2 on RP2350)
         uint  sm;               // state machine index
-        uint  program_offset;   // motor_exec program offset (REQUIRED)
+        uint  program_offset;   // offset of the `variant` program (REQUIRED)
         float pio_clk_div = 1.0f;
+
+        // -------- motor_exec program variant --------
+        // Exec (default): every command type, hardware step counter.
+        // Others (pio/motor_exec_variants.hpp): run_steps / run_velocity /
+        // run_pio_moves / raw run_pio_stream only, steps_done() == 0.
+        //   DIR variants drive dir_pin from the stream (PIO backend only):
+        //   set_direction() takes effect at the next command.
+        //   AdjustableDuty: STEP high is pulse_high_us at any speed
+        //   (so at most ~1 / (pulse_high_us + low) Hz).
+        //   dir_setup_us: DIR -> first STEP edge of every round (>=);
+        //   other variants: waited by move_mm / queue_mm when they reverse.
+        MotorExecVariant variant       = MotorExecVariant::Exec;
+        uint32_t         pulse_high_us = 10;
+        uint32_t         dir_setup_us  = MOTOR_EXEC_DIR_SETUP_US;
+
+        // -------- hardware position register (optional) --------
+        // PIO for the step_position SM (claimed at init); nullptr = none.
+        // Any PIO with 10 free instructions, independent of `pio`
+        // (same PIO: init claims `sm` first, the counter never gets it).
+        PIO   position_pio = nullptr;
+        int   position_sm  = -1;   // SM pre-claimed on position_pio (AxisManager), -1 => any free
+
+        // -------- Backend::Auto policy --------
+        // PWM for a move inside [auto_pwm_min_hz, auto_pwm_max_hz] with
+        // >= auto_pwm_min_steps (fractional divider: closest frequency),
+        // PIO otherwise (no IRQ, no per-run DMA, any frequency).
+        // A PWM run that could not count by DMA right now costs one IRQ
+        // per pulse: PWM then only up to auto_pwm_irq_max_hz.
+        // auto_hysteresis_hz widens the band of the backend in use, so
+        // segments near an edge do not flip the pin mux back and forth.
+        uint32_t auto_pwm_min_hz     = 8;
+        uint32_t auto_pwm_max_hz     = 200000;   // PWM measured up to ~220 kHz
+        uint32_t auto_pwm_min_steps  = 16;       // shorter: PWM setup costs more than the move
+        uint32_t auto_pwm_irq_max_hz = 20000;
+        uint32_t auto_hysteresis_hz  = 2000;
+
+        // -------- interrupt / backend hand-over --------
+        // a command interrupted mid-pulse keeps STEP high at least this
+        // long: the drive never sees a runt pulse, the step is counted
+        uint32_t min_high_us = 3;
+
+        // -------- physical units (move_mm / queue_mm / position_mm) --------
+        // steps_per_mm, or the servo's electronic gear (pulses_per_rev,
+        // e.g. 32767) + mm_per_rev; max_rpm clamps every unit speed.
+        // All-zero: no units, the *_mm calls return false / 0.
+        AxisUnits units{};
     };
 
 public:
@@ -89,35 +144,190 @@ public:
                       uint32_t duration_ms,
                       Backend backend = Backend::PWM);
 
-    // PIO-only raw DMA stream (xE)
+    // PIO-only DMA stream (xE), raw or packed words (see MotorExecFormat)
     void run_pio_stream(const uint32_t* words,
                         size_t count,
-                        uint64_t estimated_duration_us);
+                        uint64_t estimated_duration_us,
+                        MotorExecFormat fmt = MotorExecFormat::Raw);
+
+    // Same, the driver takes the pool block: streams stream.size() words
+    // and releases the block once the hardware is done with it
+    // (completion seen by update-on-read, stop, or the next command).
+    void run_pio_stream(StreamBuffer&& stream,
+                        uint64_t estimated_duration_us,
+                        MotorExecFormat fmt = MotorExecFormat::Raw);
+
+    // PIO-only ring stream (xE, unbounded length, fixed memory)
+    //   - buf: 2 * half_words words, caller keeps it alive until !busy()
+    //   - half_words: even for Raw (whole (duty, steps) pairs per half)
+    //   - refill: called from DMA IRQ whenever one half is free
+    //   - COM2 stays Running until the DMA side is drained
+    //   - fmt: word format produced by refill
+    // Returns false if the ring could not be started (no DMA / empty stream;
+    // odd Raw half_words: refused, the running command is left alone).
+    bool run_pio_ring(uint32_t* buf,
+                      size_t half_words,
+                      motor_exec_refill_fn refill,
+                      void* user,
+                      MotorExecFormat fmt = MotorExecFormat::Raw);
+
+    // refill of the running ring returned 0 (stream ended) and now has
+    // words again: re-link the ring behind what the SM is still
+    // executing, no stop / re-init (motor_exec_ring_resume).
+    // Same core as run_pio_ring (ring IRQ core).
+    // false: no ring running any more / refill still empty
+    bool resume_pio_ring();
+
+    // PIO-only: several moves in ONE stream, encoded for this axis'
+    // variant (pool block, released by the driver). DIR variants
+    // reverse between moves on device, without a CPU write to dir_pin;
+    // other variants need all moves the same way.
+    // false: invalid / too long for one pool block / no DMA
+    bool run_pio_moves(const MotorExecMove* moves, size_t n);
+
+    // ------------------------------------------------------------
+    // Queued motion (blend handoff, PIO only)
+    //   run_* replace the running command: SM stopped, FIFO cleared,
+    //   everything reconfigured. queue_steps() appends the segment
+    //   behind what is executing instead:
+    //     - motor_exec keeps running, no re-init, no gap, no jerk
+    //     - a_max > 0 (steps/s^2): the speed change from the previous
+    //       segment is ramped on device (motor_exec_blend_segment)
+    //   Joins a running queue, a PIO run_steps command, or a raw
+    //   stream whose DMA is done; anything else (PWM, ring, stream
+    //   still being fed) is interrupted first, as with run_*.
+    //   DIR is a GPIO, not part of the stream: one direction per run.
+    //   COM2 stays Running until the queue has drained.
+    //   Exec variant only (needs dwell / zero no-op words).
+    //   false: invalid / no room in the queue (nothing changed)
+    // ------------------------------------------------------------
+    static constexpr size_t QUEUE_CMDS       = 32;   // raw commands (power of 2)
+    static constexpr size_t QUEUE_BLEND_CMDS = 8;    // ramp sub-commands per segment
+
+    bool   queue_steps(uint32_t steps, uint32_t freq_hz, uint32_t a_max = 0);
+    size_t queue_free() const;                       // raw commands
+
+    // ------------------------------------------------------------
+    // Motion in physical units (Config::units, Q16.16 fixed point)
+    //   converted with the scale precomputed at construction: one
+    //   multiply + shift per value, no float / double, no division.
+    //   Sign of distance = direction (set_direction is done here,
+    //   after the running command has been stopped).
+    //   Speeds above units.max_rpm are clamped.
+    //   queue_mm: a running queue keeps its direction, a move the
+    //   other way is refused (false) instead of reversing mid-run.
+    // false: no units / rounds to 0 steps or 0 Hz / queue refused
+    // ------------------------------------------------------------
+    bool move_mm(q16_16 distance_mm,
+                 q16_16 speed_mm_s,
+                 Backend backend = Backend::PWM);
+
+    bool queue_mm(q16_16 distance_mm,
+                  q16_16 speed_mm_s,
+                  q16_16 accel_mm_s2 = 0);
+
+    q16_16 position_mm() const { return scale_.steps_to_mm(position()); }
+
+    bool             has_units() const { return scale_.steps_per_mm != 0; }
+    const AxisScale& scale() const     { return scale_; }
 
     // Immediate termination (HAS real hardware side effects)
     void stop();
 
     // ------------------------------------------------------------
-    // State query (update-on-read)
+    // State query (update-on-read, driven by hardware completion)
     // ------------------------------------------------------------
     bool busy();                         // true iff COM2 is Running
     CompletionReason last_completion();  // COM1 result
+    bool last_ring_underrun() const;     // last ring ended early (refill too late)
+
+    // Pulses emitted by the current / last command.
+    //   PWM : remaining_steps from the wrap IRQ
+    //   PIO : hardware token counter (DMA transfer_count), no CPU load
+    //         (Exec variant only; other variants report 0, use position())
+    // Register reads only, safe to poll at any rate.
+    uint32_t steps_done() const;
+
+    // ------------------------------------------------------------
+    // Absolute position (steps, forward positive)
+    //   STEP edges counted by hardware with the DIR level at each edge,
+    //   i.e. what the drive sees, whatever backend produced them.
+    //   position(): one aligned load, lock-free, any core / IRQ.
+    // ------------------------------------------------------------
+    bool    has_position() const { return position_slot_ >= 0; }
+    int32_t position() const;              // 0 without a position register
+    void    set_position(int32_t steps);   // homing / zeroing, axis idle
 
     // ------------------------------------------------------------
     // Capability query (pure observation)
     // ------------------------------------------------------------
     bool supports_pio_stream() const;
 
+    // backend Backend::Auto picks for this command right now (PWM / PIO)
+    Backend auto_backend(uint32_t freq_hz, uint32_t steps) const;
+
+    // timing model of this axis' SM (use it to encode streams)
+    const PioTiming& timing() const { return timing_; }
+
+    // program of this axis (encoder / capabilities)
+    const MotorExecProgram* program() const { return prog_; }
+
 private:
     // ------------------------------------------------------------
     // Core state transition
-    //   - Pure logic
+    //   - Pure logic + hardware status reads
     //   - No hardware side effects
     // ------------------------------------------------------------
     void update();
+    bool hardware_done() const;
+
+    // interrupt / stop path: freeze progress, release DMA, stop backend
+    void halt();
+
+    // ------------------------------------------------------------
+    // Command start, split in two so several axes can share one edge
+    //   stage_pio_* : interrupt COM2, preload FIFO / DMA, SM disabled
+    //                 (false => no-op command, nothing to start)
+    //   start_staged: enable this SM alone
+    //   mark_started: SM was enabled by someone else (group)
+    // ------------------------------------------------------------
+    void preempt();
+    void complete_empty();
+    void prepare_pio(MotorExecFormat fmt);
+
+    bool stage_pio_steps(uint32_t steps, uint32_t freq_hz);
+    bool stage_pio_stream(const uint32_t* words, size_t count, MotorExecFormat fmt);
+    bool stage_pio_ring(uint32_t* buf,
+                        size_t half_words,
+                        motor_exec_refill_fn refill,
+                        void* user,
+                        MotorExecFormat fmt);
+
+    void start_staged();
+    void mark_started();
+
+    // ------------------------------------------------------------
+    // Queue plumbing (queue_steps)
+    //   queue_start(fresh): ring fed by queue_refill; fresh = clean SM
+    //   start (staged, caller enables), else append to the running SM
+    // ------------------------------------------------------------
+    static size_t queue_refill(uint32_t* dst, size_t capacity, void* user);
+    size_t queue_emit(uint32_t* dst, size_t capacity);
+    bool   queue_start(bool fresh);
+    void   queue_clear();
 
 private:
-    Config cfg_;
+    Config    cfg_;
+    PioTiming timing_{};   // model of cfg_.variant for cfg_.pio_clk_div
+    AxisScale scale_{};    // cfg_.units, precomputed
+    bool      owns_sm_ = false;   // cfg_.sm claimed by init() (not pre-claimed by the caller)
+
+    const MotorExecProgram* prog_ = nullptr;   // cfg_.variant
+    uint32_t high_loops_ = 0;                  // AdjustableDuty STEP high
+    uint32_t setup_loops_ = 0;                 // DIR variants: DIR -> STEP setup
+    bool     forward_    = true;               // last set_direction()
+
+    bool sm_idle() const;
 
     // ------------------------------------------------------------
     // COM1: previous command (already finished)
@@ -128,5 +338,37 @@ private:
     // COM2: current command
     // ------------------------------------------------------------
     CommandState     com2_state_ = CommandState::Empty;
-    absolute_time_t  com2_t_end_{};
+
+    // ------------------------------------------------------------
+    // DMA resources held by the current / last PIO stream
+    // ------------------------------------------------------------
+    int  stream_dma_ = -1;    // one-shot stream channel
+    int  ring_       = -1;    // ring stream id
+    bool ring_underrun_ = false;
+
+    StreamBuffer stream_buf_;    // pool block streamed by stream_dma_ (if owned)
+    MotorExecFormat fmt_ = MotorExecFormat::Raw;   // format of the SM right now
+
+    // ------------------------------------------------------------
+    // Queued segments: producer queue_steps(), consumer ring refill (IRQ)
+    // ------------------------------------------------------------
+    static constexpr size_t QUEUE_RING_HALF = 8;   // words (4 raw commands)
+
+    uint32_t          queue_[2 * QUEUE_CMDS]{};
+    volatile uint32_t queue_head_   = 0;      // commands, written by queue_steps
+    volatile uint32_t queue_tail_   = 0;      // written by queue_refill
+    bool              queue_mode_   = false;  // ring_ is fed by queue_refill
+    uint32_t          queue_hz_     = 0;      // blend reference (last queued speed)
+    uint32_t          queue_ring_[2 * QUEUE_RING_HALF]{};
+
+    // ------------------------------------------------------------
+    // Progress sources
+    // ------------------------------------------------------------
+    int      counter_dma_  = -1;     // motor_exec token counter (PIO)
+    int      position_slot_ = -1;    // step_position register
+    bool     last_cmd_pwm_ = true;   // which source steps_done() reads
+    uint32_t pwm_steps_    = 0;      // commanded (or frozen) PWM steps
+    uint32_t pio_adjust_   = 0;      // pulse completed by halt() (no token)
+
+    void release_dma();
 };
@@ -0,0 +1,119 @@
+#include "ps100_group.hpp"
+
+#include "hardware/pio.h"
+
+// ------------------------------------------------------------
+// membership
+// ------------------------------------------------------------
+
+bool PS100_Group::add(PS100_P& axis) {
+    if (count_ >= MAX_AXES) return false;
+
+    // one PIO block only: the in-sync enable is a single CTRL write
+    if (count_ == 0) {
+        pio_ = axis.cfg_.pio;
+    } else if (axis.cfg_.pio != pio_) {
+        return false;
+    }
+
+    for (size_t i = 0; i < count_; ++i) {
+        if (axes_[i] == &axis || axes_[i]->cfg_.sm == axis.cfg_.sm) return false;
+    }
+
+    axes_[count_++] = &axis;
+    return true;
+}
+
+void PS100_Group::clear() {
+    stop();
+
+    for (size_t i = 0; i < MAX_AXES; ++i) axes_[i] = nullptr;
+    count_ = 0;
+    pio_   = nullptr;
+}
+
+// ------------------------------------------------------------
+// staging
+// ------------------------------------------------------------
+
+void PS100_Group::mark(size_t i, bool staged) {
+    const uint32_t sm_bit   = 1u << axes_[i]->cfg_.sm;
+    const uint8_t  axis_bit = (uint8_t)(1u << i);
+
+    if (staged) {
+        staged_mask_ |= sm_bit;
+        staged_axes_ |= axis_bit;
+    } else {
+        staged_mask_ &= ~sm_bit;
+        staged_axes_ &= (uint8_t)~axis_bit;
+    }
+}
+
+bool PS100_Group::stage_steps(size_t i, uint32_t steps, uint32_t freq_hz) {
+    if (i >= count_) return false;
+
+    const bool ok = axes_[i]->stage_pio_steps(steps, freq_hz);
+    mark(i, ok);
+    return ok;
+}
+
+bool PS100_Group::stage_stream(size_t i,
+                               const uint32_t* words,
+                               size_t count,
+                               MotorExecFormat fmt) {
+    if (i >= count_) return false;
+
+    const bool ok = axes_[i]->stage_pio_stream(words, count, fmt);
+    mark(i, ok);
+    return ok;
+}
+
+bool PS100_Group::stage_ring(size_t i,
+                             uint32_t* buf,
+                             size_t half_words,
+                             motor_exec_refill_fn refill,
+                             void* user,
+                             MotorExecFormat fmt) {
+    if (i >= count_) return false;
+
+    const bool ok = axes_[i]->stage_pio_ring(buf, half_words, refill, user, fmt);
+    mark(i, ok);
+    return ok;
+}
+
+// ------------------------------------------------------------
+// execution
+// ------------------------------------------------------------
+
+bool PS100_Group::start() {
+    if (staged_mask_ == 0) return false;
+
+    // 单次写 CTRL：SM_ENABLE + CLKDIV_RESTART，所有 SM 同一 PIO 时钟沿起步
+    pio_enable_sm_mask_in_sync(pio_, staged_mask_);
+
+    for (size_t i = 0; i < count_; ++i) {
+        if (staged_axes_ & (1u << i)) axes_[i]->mark_started();
+    }
+
+    staged_mask_ = 0;
+    staged_axes_ = 0;
+    return true;
+}
+
+bool PS100_Group::busy() {
+    bool any = false;
+    for (size_t i = 0; i < count_; ++i) {
+        // 不短路：每个轴都做一次 update-on-read
+        any = axes_[i]->busy() || any;
+    }
+    return any;
+}
+
+void PS100_Group::stop() {
+    for (size_t i = 0; i < count_; ++i) {
+        axes_[i]->stop();
+    }
+
+    staged_mask_ = 0;
+    staged_axes_ = 0;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "ps100.hpp"
+
+#include <cstdint>
+#include <cstddef>
+
+// ============================================================
+// PS100_Group
+//   - Synchronized start of several PS100_P axes (PIO backend)
+//   - All axes MUST live on the same PIO block (one SM each)
+//   - Commands are staged per axis (FIFO / DMA preloaded, SM off),
+//     then every staged SM is enabled by ONE register write:
+//       pio_enable_sm_mask_in_sync()
+//     which also restarts their clock dividers => zero start skew
+//   - Does NOT own the axes; they keep their own COM1 / COM2 state
+//
+// Usage:
+//   group.add(x); group.add(y);
+//   x.set_direction(..); y.set_direction(..);
+//   group.stage_steps(0, nx, fx);
+//   group.stage_steps(1, ny, fy);
+//   group.start();
+// ============================================================
+
+class PS100_Group {
+public:
+    static constexpr size_t MAX_AXES = 4;   // SMs per PIO block
+
+public:
+    PS100_Group() = default;
+
+    // ------------------------------------------------------------
+    // membership
+    // ------------------------------------------------------------
+
+    // false: group full / different PIO / SM already in group
+    bool add(PS100_P& axis);
+    void clear();
+
+    size_t   size() const { return count_; }
+    PS100_P& axis(size_t i) { return *axes_[i]; }
+
+    // ------------------------------------------------------------
+    // staging (last-command-wins per axis, SM stays disabled)
+    //   false: bad index or no-op command (axis will not start)
+    // ------------------------------------------------------------
+    bool stage_steps(size_t i, uint32_t steps, uint32_t freq_hz);
+    bool stage_stream(size_t i,
+                      const uint32_t* words,
+                      size_t count,
+                      MotorExecFormat fmt = MotorExecFormat::Raw);
+    bool stage_ring(size_t i,
+                    uint32_t* buf,
+                    size_t half_words,
+                    motor_exec_refill_fn refill,
+                    void* user,
+                    MotorExecFormat fmt = MotorExecFormat::Raw);
+
+    // ------------------------------------------------------------
+    // execution
+    // ------------------------------------------------------------
+
+    // enable every staged SM on the same PIO clock edge
+    // returns false if nothing was staged
+    bool start();
+
+    // state query (update-on-read through each axis)
+    bool busy();          // any axis Running
+    void stop();          // stop all axes (staged ones are discarded)
+
+private:
+    PS100_P* axes_[MAX_AXES] = {};
+    size_t   count_ = 0;
+
+    PIO      pio_ = nullptr;
+    uint32_t staged_mask_ = 0;   // SM bit mask waiting for start()
+    uint8_t  staged_axes_ = 0;   // axis index bit mask (same content)
+
+    void mark(size_t i, bool staged);
+};
@@ -1,10 +1,12 @@
 #include "pwm_motor.hpp"
 
 #include "hardware/pwm.h"
+#include "hardware/dma.h"
 #include "hardware/irq.h"
 #include "hardware/clocks.h"
 
-#include <cmath>
+#include "trace/trace.hpp"
+
 
 // ============================================================
 // Internal state (private to pwm_motor)
@@ -12,12 +14,168 @@
 
 namespace {
 
-// 每个 slice 一份剩余步数（RP2040 一共 8 个 slice）
-volatile uint32_t remaining_steps[8] = {0};
+// 每个 slice 一份剩余步数（RP2040: 8 个 slice，RP2350: 12 个）
+volatile uint32_t remaining_steps[NUM_PWM_SLICES] = {0};
 
 // 记录哪些 slice 被 pwm_motor 使用
 volatile uint32_t active_slice_mask = 0;
 
+// ------------------------------------------------------------
+// DMA step counting
+// ------------------------------------------------------------
+//
+// wrap k 结束第 k 个脉冲并立即开始第 k+1 个；CC 为双缓冲，
+// 在 wrap 处锁存。因此：
+//   wrap N-1 : ch A 最后一次传输 -> chain ch B，立刻写 CC = 0
+//   wrap N   : CC = 0 生效，输出保持低；ch C 清 EN，触发 IRQ
+// 约束：ch B 必须在 wrap N 之前完成（每周期 >= ~32 sys cycles）
+//
+// 通道按 run 申请，完成 / stop 时释放（与 PIO ring 共享 DMA 池）
+
+struct DmaCount {
+    int wrap_ch  = -1;   // A: counts N-1 wraps
+    int level_ch = -1;   // B: CC = 0
+    int stop_ch  = -1;   // C: EN clear + IRQ
+};
+
+DmaCount dma_count[NUM_PWM_SLICES];
+
+// slice 的当前 run 由 DMA 计步
+volatile uint32_t dma_slice_mask = 0;
+
+PwmCountMode count_mode = PwmCountMode::Dma;
+
+// DMA 源 / 目的（搬运必须在 RAM 中）
+uint32_t zero_word = 0;
+uint32_t wrap_sink = 0;
+struct SliceBits {
+    uint32_t bit[NUM_PWM_SLICES];
+    constexpr SliceBits() : bit() {
+        for (uint i = 0; i < NUM_PWM_SLICES; ++i) bit[i] = 1u << i;
+    }
+};
+SliceBits slice_bits;
+uint32_t* const slice_bit = slice_bits.bit;
+
+bool dma_irq_installed = false;
+
+void dma_count_release(uint slice) {
+    DmaCount& d = dma_count[slice];
+
+    dma_channel_set_irq1_enabled((uint)d.stop_ch, false);
+
+    // A -> B -> C 顺序 abort：被 chain 触发的 B 只会写 CC = 0 (无害)，
+    // C 等待的 DREQ 已随 slice 停止
+    dma_channel_abort((uint)d.wrap_ch);
+    dma_channel_abort((uint)d.level_ch);
+    dma_channel_abort((uint)d.stop_ch);
+    dma_channel_acknowledge_irq1((uint)d.stop_ch);
+
+    dma_channel_unclaim((uint)d.wrap_ch);
+    dma_channel_unclaim((uint)d.level_ch);
+    dma_channel_unclaim((uint)d.stop_ch);
+    d = DmaCount{};
+
+    dma_slice_mask &= ~(1u << slice);
+}
+
+void pwm_dma_irq_handler() {
+    PM_TRACE(PwmDmaIrq, 0);
+
+    uint32_t mask = dma_slice_mask;
+    uint32_t done = 0;
+
+    while (mask) {
+        uint slice = __builtin_ctz(mask);
+        mask &= ~(1u << slice);
+
+        const DmaCount& d = dma_count[slice];
+        if (!dma_channel_get_irq1_status((uint)d.stop_ch)) continue;
+
+        dma_channel_acknowledge_irq1((uint)d.stop_ch);
+
+        // EN 已由 ch C 清除
+        remaining_steps[slice] = 0;
+        active_slice_mask &= ~(1u << slice);
+        dma_count_release(slice);
+        done |= 1u << slice;
+    }
+
+    PM_TRACE_END(PwmDmaIrq, done);
+    (void)done;
+}
+
+bool dma_count_claim(uint slice) {
+    DmaCount& d = dma_count[slice];
+
+    d.wrap_ch = dma_claim_unused_channel(false);
+    if (d.wrap_ch < 0) return false;
+
+    d.level_ch = dma_claim_unused_channel(false);
+    if (d.level_ch < 0) {
+        dma_channel_unclaim((uint)d.wrap_ch);
+        d = DmaCount{};
+        return false;
+    }
+
+    d.stop_ch = dma_claim_unused_channel(false);
+    if (d.stop_ch < 0) {
+        dma_channel_unclaim((uint)d.level_ch);
+        dma_channel_unclaim((uint)d.wrap_ch);
+        d = DmaCount{};
+        return false;
+    }
+
+    if (!dma_irq_installed) {
+        irq_add_shared_handler(
+            DMA_IRQ_1,
+            pwm_dma_irq_handler,
+            PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY
+        );
+        irq_set_enabled(DMA_IRQ_1, true);
+        dma_irq_installed = true;
+    }
+    return true;
+}
+
+// 配置 A / B / C，不触发（slice 必须处于 disabled）
+void dma_count_arm(uint slice, uint32_t steps) {
+    PM_TRACE_SCOPE(PwmDmaArm, slice);
+    const DmaCount& d = dma_count[slice];
+    const uint dreq = pwm_get_dreq(slice);
+
+    // A: one dummy transfer per wrap, N-1 wraps
+    dma_channel_config a = dma_channel_get_default_config((uint)d.wrap_ch);
+    channel_config_set_transfer_data_size(&a, DMA_SIZE_32);
+    channel_config_set_read_increment(&a, false);
+    channel_config_set_write_increment(&a, false);
+    channel_config_set_dreq(&a, dreq);
+    channel_config_set_chain_to(&a, (uint)d.level_ch);
+    dma_channel_configure((uint)d.wrap_ch, &a,
+                          &wrap_sink, &zero_word, steps - 1u, false);
+
+    // B: unpaced, CC = 0 (both channels), latched at the next wrap
+    dma_channel_config b = dma_channel_get_default_config((uint)d.level_ch);
+    channel_config_set_transfer_data_size(&b, DMA_SIZE_32);
+    channel_config_set_read_increment(&b, false);
+    channel_config_set_write_increment(&b, false);
+    channel_config_set_chain_to(&b, (uint)d.stop_ch);
+    dma_channel_configure((uint)d.level_ch, &b,
+                          &pwm_hw->slice[slice].cc, &zero_word, 1, false);
+
+    // C: at wrap N clear this slice's EN bit (atomic alias), raise IRQ
+    dma_channel_config c = dma_channel_get_default_config((uint)d.stop_ch);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, dreq);
+    dma_channel_configure((uint)d.stop_ch, &c,
+                          hw_clear_alias(&pwm_hw->en), &slice_bit[slice], 1, false);
+
+    dma_channel_acknowledge_irq1((uint)d.stop_ch);
+    dma_channel_set_irq1_enabled((uint)d.stop_ch, true);
+}
+
 // ------------------------------------------------------------
 // IRQ handler
 // ------------------------------------------------------------
@@ -27,6 +185,7 @@ void pwm_wrap_irq_handler() {
 
     // 只处理被 pwm_motor 管理的 slice
     uint32_t mask = status & active_slice_mask;
+    PM_TRACE_SCOPE(PwmWrapIrq, mask);
 
     while (mask) {
         uint slice = __builtin_ctz(mask);
@@ -36,6 +195,11 @@ void pwm_wrap_irq_handler() {
 
         if (remaining_steps[slice] > 0) {
             remaining_steps[slice]--;
+            // 与 DMA 计步相同：CC = 0 提前一个 wrap 写入，在 wrap N 锁存，
+            // 否则第 N+1 个周期已经拉高，关 slice 会把 STEP 冻结在高电平
+            if (remaining_steps[slice] == 1) {
+                pwm_hw->slice[slice].cc = 0;
+            }
             if (remaining_steps[slice] == 0) {
                 pwm_set_enabled(slice, false);
                 pwm_set_irq_enabled(slice, false);
@@ -54,139 +218,161 @@ inline uint pwm_channel(uint pin) {
 }
 
 // ------------------------------------------------------------
-// NEW: choose clk_div so that wrap <= 65535
+// Integer bounded search over (clk_div, wrap)
 // ------------------------------------------------------------
 //
-// wrap = sys_hz / (freq * clk_div) - 1
-// require: wrap <= 65535
+// Same score as a full float sweep over div16 = 16 .. 4095 (Q32 fixed point):
+//   score = W_FREQ * |f_real - f| / f + W_WRAP * wrap_penalty
+//   f_real = 16 * sys_hz / (div16 * top),  top = wrap + 1
 //
-//inline float choose_clk_div(uint32_t sys_hz, uint32_t freq_hz) {
-//    if (freq_hz == 0) return 1.0f;
+// For a given div16 the best top is round(16 * sys_hz / (f * div16)),
+// its error is at most 1 / (2 * top): the smallest div16 that keeps
+// wrap <= WRAP_MAX has the finest resolution. Starting there,
+// DIV_CANDIDATES dividers are scored (down from the largest one
+// when even that leaves wrap > WRAP_MAX; candidates whose penalty
+// alone exceeds the best score stop the scan).
 //
-//    float div =
-//        (float)sys_hz / (float)(freq_hz * 65536ULL);
+// pwm_div_error_compare_scored.py (bounded vs full, both capped at
+// DIV16_MAX, 8 Hz .. 100 kHz, 125 MHz):
+//   mean 3.9 ppm, max 90 ppm for both; max delta to the full search
+//   1.2 ppm (below crystal tolerance), 256 evaluations max instead
+//   of 4080 float iterations.
 //
-//    if (div < 1.0f)   div = 1.0f;
-//    if (div > 256.0f) div = 256.0f;   // RP2040 PWM 上限
-//
-//    return div;
-//}
+// Results are memoized (DIV_CACHE entries, round robin):
+// repeated frequencies cost one table lookup.
 
-//inline float choose_clk_div(uint32_t sys_hz, uint32_t freq_hz) {
-//    if (freq_hz == 0) return 1.0f;
-//
-//    // ---------- tunable policy ----------
-//    constexpr uint32_t WRAP_MIN = 400;    // 推荐下限（过小会影响分辨率/抖动）
-//    constexpr uint32_t WRAP_MAX = 20000;  // 推荐上限（过大会影响响应/可用频率）
-//
-//    float best_div = 1.0f;
-//    float best_err = 1e30f;
-//
-//    // clk_div is 8.4 fixed-point → step = 1/16
-//    for (int i = 16; i <= 256 * 16; ++i) {
-//        float div = i / 16.0f;
-//
-//        float wrap_f = (float)sys_hz / (div * (float)freq_hz) - 1.0f;
-//        if (wrap_f < (float)WRAP_MIN || wrap_f > (float)WRAP_MAX)
-//            continue;
-//
-//        uint32_t wrap = (uint32_t)(wrap_f + 0.5f);
-//
-//        // 实际频率
-//        float real_freq = (float)sys_hz / (div * (float)(wrap + 1u));
-//        float err = fabsf(real_freq - (float)freq_hz);
-//
-//        if (err < best_err) {
-//            best_err = err;
-//            best_div = div;
-//        }
-//    }
-//
-//    // fallback：保证不会返回非法值（wrap <= 65535）
-//    if (best_err == 1e30f) {
-//        float div = (float)sys_hz / ((float)freq_hz * 65536.0f);
-//        if (div < 1.0f) div = 1.0f;
-//        if (div > 256.0f) div = 256.0f;
-//        best_div = div;
-//    }
-//
-//    return best_div;
-//}
+constexpr uint32_t WRAP_MIN = 400;
+constexpr uint32_t WRAP_MAX = 20000;
 
-inline float choose_clk_div(uint32_t sys_hz, uint32_t freq_hz) {
-    if (freq_hz == 0) return 1.0f;
+constexpr uint64_t W_FREQ_Q32 = 1ull << 32;                               // 1.0
+constexpr uint64_t W_WRAP_Q32 = (uint64_t)(0.02 * 4294967296.0 + 0.5);    // 0.02
 
-    // -------- tunable policy --------
-    constexpr uint32_t WRAP_MIN = 400;
-    constexpr uint32_t WRAP_MAX = 20000;
+constexpr uint32_t DIV16_MIN = 16;      // 1.0
+constexpr uint32_t DIV16_MAX = 4095;    // 255.9375: INT field >= 1 (SDK asserts, 0 would mean 256)
+constexpr uint32_t TOP_MIN   = 3;       // wrap >= 2
+constexpr uint32_t TOP_MAX   = 65536;   // wrap <= 65535
 
-    constexpr float W_FREQ = 1.0f;
-    constexpr float W_WRAP = 0.02f;
+constexpr uint32_t DIV_CANDIDATES = 256;
+constexpr uint32_t DIV_CACHE      = 8;
 
-    float best_div   = 1.0f;
-    float best_score = 1e30f;
+struct DivCacheEntry {
+    uint32_t     sys_hz;
+    uint32_t     freq_hz;   // 0 = empty
+    PwmDivChoice choice;
+};
 
-    // clk_div is 8.4 fixed-point → step = 1/16
-    for (int i = 16; i <= 256 * 16; ++i) {
-        float div = i / 16.0f;
+DivCacheEntry div_cache[DIV_CACHE] = {};
+uint32_t      div_cache_next = 0;
 
-        // continuous wrap estimate
-        float wrap_f = (float)sys_hz / (div * (float)freq_hz) - 1.0f;
+inline uint64_t wrap_penalty_q32(uint32_t wrap) {
+    if (wrap < WRAP_MIN) return W_WRAP_Q32 * (WRAP_MIN - wrap) / WRAP_MIN;
+    if (wrap > WRAP_MAX) return W_WRAP_Q32 * (wrap - WRAP_MAX) / WRAP_MAX;
+    return 0;
+}
 
-        // hard legality check
-        if (wrap_f < 2.0f || wrap_f > 65535.0f)
-            continue;
+PwmDivChoice search_div(uint32_t sys_hz, uint32_t freq_hz) {
+    const uint64_t num = (uint64_t)sys_hz * 16u;    // f_real * div16 * top
 
-        // nearest integer wrap (matches PWM reality)
-        uint32_t wrap = (uint32_t)(wrap_f + 0.5f);
+    // smallest div16 with top <= WRAP_MAX + 1
+    const uint64_t per_div = (uint64_t)freq_hz * (WRAP_MAX + 1u);
+    uint64_t d0 = (num + per_div - 1u) / per_div;
+    if (d0 < DIV16_MIN) d0 = DIV16_MIN;
+    if (d0 > DIV16_MAX) d0 = DIV16_MAX;
 
-        // actual frequency
-        float real_freq =
-            (float)sys_hz / (div * (float)(wrap + 1u));
+    const bool down = (d0 == DIV16_MAX);   // too slow even at the largest divider
 
-        // normalized frequency error
-        float freq_err =
-            fabsf(real_freq - (float)freq_hz) / (float)freq_hz;
+    PwmDivChoice best{(uint16_t)d0, (uint16_t)WRAP_MAX};
+    uint64_t best_score = ~0ull;
 
-        // wrap penalty (soft constraint)
-        float wrap_penalty = 0.0f;
-        if (wrap < WRAP_MIN) {
-            wrap_penalty =
-                (float)(WRAP_MIN - wrap) / (float)WRAP_MIN;
-        } else if (wrap > WRAP_MAX) {
-            wrap_penalty =
-                (float)(wrap - WRAP_MAX) / (float)WRAP_MAX;
-        }
+    uint32_t d = (uint32_t)d0;
+    for (uint32_t n = 0; n < DIV_CANDIDATES; ++n) {
+        const uint64_t den = (uint64_t)freq_hz * d;
+
+        uint64_t top = (num + den / 2u) / den;
+        if (top < TOP_MIN) top = TOP_MIN;
+        if (top > TOP_MAX) top = TOP_MAX;
 
-        float score =
-            W_FREQ * freq_err +
-            W_WRAP * wrap_penalty;
+        const uint32_t wrap = (uint32_t)top - 1u;
+        const uint64_t pen  = wrap_penalty_q32(wrap);
+
+        // penalty grows monotonically away from d0
+        if (pen >= best_score) break;
+
+        const uint64_t real = den * top;   // f * div16 * top, compare with num
+        const uint64_t err  = (real > num) ? real - num : num - real;
+        const uint64_t score = (err * W_FREQ_Q32) / real + pen;
 
         if (score < best_score) {
             best_score = score;
-            best_div   = div;
+            best.div16 = (uint16_t)d;
+            best.wrap  = (uint16_t)wrap;
+            if (score == 0) break;
         }
-    }
 
-    // Fallback: guarantee legality (never fail)
-    if (best_score == 1e30f) {
-        float div =
-            (float)sys_hz / ((float)freq_hz * 65536.0f);
-        if (div < 1.0f)   div = 1.0f;
-        if (div > 256.0f) div = 256.0f;
-        best_div = div;
+        if (down) {
+            if (d == DIV16_MIN) break;
+            d--;
+        } else {
+            if (d == DIV16_MAX) break;
+            d++;
+        }
     }
 
-    return best_div;
+    return best;
 }
 
-
 } // namespace
 
 // ============================================================
 // Public API
 // ============================================================
 
+PwmDivChoice pwm_motor_choose_div(uint32_t sys_hz, uint32_t freq_hz) {
+    if (freq_hz == 0) return PwmDivChoice{(uint16_t)DIV16_MIN, (uint16_t)WRAP_MAX};
+
+    for (const DivCacheEntry& e : div_cache) {
+        if (e.freq_hz == freq_hz && e.sys_hz == sys_hz) return e.choice;
+    }
+
+    const PwmDivChoice c = search_div(sys_hz, freq_hz);
+
+    div_cache[div_cache_next] = DivCacheEntry{sys_hz, freq_hz, c};
+    div_cache_next = (div_cache_next + 1u) % DIV_CACHE;
+    return c;
+}
+
+void pwm_motor_div_cache_clear() {
+    for (DivCacheEntry& e : div_cache) e = DivCacheEntry{};
+    div_cache_next = 0;
+}
+
+void pwm_motor_set_count_mode(PwmCountMode mode) {
+    count_mode = mode;
+}
+
+PwmCountMode pwm_motor_count_mode(uint step_pin) {
+    return (dma_slice_mask & (1u << pwm_slice(step_pin))) ? PwmCountMode::Dma
+                                                           : PwmCountMode::Irq;
+}
+
+PwmCountMode pwm_motor_expected_count_mode(uint step_pin) {
+    if (count_mode != PwmCountMode::Dma) return PwmCountMode::Irq;
+
+    // 本 slice 已持有的通道会在下一次 run 开始时先释放再申请
+    if (dma_slice_mask & (1u << pwm_slice(step_pin))) return PwmCountMode::Dma;
+
+    // 试申请 3 个通道后立即归还（只是快照，不做预留）
+    int ch[3];
+    uint n = 0;
+    for (; n < 3; ++n) {
+        ch[n] = dma_claim_unused_channel(false);
+        if (ch[n] < 0) break;
+    }
+    for (uint i = 0; i < n; ++i) dma_channel_unclaim((uint)ch[i]);
+
+    return (n == 3) ? PwmCountMode::Dma : PwmCountMode::Irq;
+}
+
 void pwm_motor_init(uint step_pin) {
     gpio_set_function(step_pin, GPIO_FUNC_PWM);
 
@@ -215,20 +401,21 @@ void pwm_motor_run(uint step_pin,
 
     uint slice = pwm_slice(step_pin);
     uint chan  = pwm_channel(step_pin);
+    PM_TRACE_SCOPE(PwmRun, slice);
 
     uint32_t sys_hz = clock_get_hz(clk_sys);
 
-    // -------- NEW: dynamic clk_div --------
-    float clk_div = choose_clk_div(sys_hz, freq_hz);
-
-    uint32_t wrap =
-        (uint32_t)((float)sys_hz / (clk_div * freq_hz)) - 1;
-
-    if (wrap < 2) wrap = 2;
-    if (wrap > 65535) wrap = 65535; // 防御性兜底
+    // -------- dynamic clk_div: (div, wrap) chosen together --------
+    // wrap 直接用打分时的值（旧实现重新向下取整，与打分不一致）
+    const PwmDivChoice dc = pwm_motor_choose_div(sys_hz, freq_hz);
+    const uint32_t wrap = dc.wrap;
 
     pwm_set_enabled(slice, false);      // 确保安全修改
-    pwm_set_clkdiv(slice, clk_div);
+    pwm_set_irq_enabled(slice, false);
+    if (dma_slice_mask & (1u << slice)) dma_count_release(slice);
+
+    // div16 <= 4095：INT 字段 1..255，不依赖 INT = 0 表示 256 的编码
+    pwm_set_clkdiv_int_frac(slice, (uint8_t)(dc.div16 >> 4), (uint8_t)(dc.div16 & 0xFu));
     pwm_set_wrap(slice, wrap);
     pwm_set_chan_level(slice, chan, wrap / 2);
     pwm_set_counter(slice, 0);
@@ -236,9 +423,30 @@ void pwm_motor_run(uint step_pin,
     remaining_steps[slice] = steps;
     active_slice_mask |= (1u << slice);
 
+    // -------- DMA counting: 整个 run 只有 ch C 的一次 IRQ --------
+    if (count_mode == PwmCountMode::Dma && dma_count_claim(slice)) {
+        dma_count_arm(slice, steps);
+        dma_slice_mask |= (1u << slice);
+
+        if (steps > 1) dma_channel_start((uint)dma_count[slice].wrap_ch);
+        pwm_set_enabled(slice, true);
+
+        // N == 1: 没有可数的 wrap，CC = 0 直接在 wrap 1 锁存
+        if (steps == 1) dma_channel_start((uint)dma_count[slice].level_ch);
+        return;
+    }
+
+    // -------- IRQ counting (fallback) --------
     pwm_clear_irq(slice);
     pwm_set_irq_enabled(slice, true);
     pwm_set_enabled(slice, true);
+
+    // N == 1: 没有 wrap N-1，CC = 0 直接在 wrap 1 锁存
+    if (steps == 1) pwm_hw->slice[slice].cc = 0;
+}
+
+void pwm_motor_freeze(uint step_pin) {
+    pwm_set_enabled(pwm_slice(step_pin), false);
 }
 
 void pwm_motor_stop(uint step_pin) {
@@ -246,7 +454,27 @@ void pwm_motor_stop(uint step_pin) {
 
     pwm_set_enabled(slice, false);
     pwm_set_irq_enabled(slice, false);
+    if (dma_slice_mask & (1u << slice)) dma_count_release(slice);
+
+    // CC = 0：停在高电平半周期时输出也回到低（idle = LOW，mux 交接无边沿）
+    pwm_set_chan_level(slice, pwm_gpio_to_channel(step_pin), 0);
 
     remaining_steps[slice] = 0;
     active_slice_mask &= ~(1u << slice);
 }
+
+bool pwm_motor_busy(uint step_pin) {
+    return remaining_steps[pwm_slice(step_pin)] != 0;
+}
+
+uint32_t pwm_motor_steps_remaining(uint step_pin) {
+    uint slice = pwm_slice(step_pin);
+
+    // DMA: ch A 的剩余 wrap 数 + 正在输出的最后一个脉冲
+    // （N == 1 时 A 未启动，transfer_count == 0）
+    const int ch = dma_count[slice].wrap_ch;
+    if ((dma_slice_mask & (1u << slice)) && ch >= 0) {
+        return dma_hw->ch[ch].transfer_count + 1u;
+    }
+    return remaining_steps[slice];
+}
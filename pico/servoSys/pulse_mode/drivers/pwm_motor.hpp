@@ -5,8 +5,47 @@
 
 // ============================================================
 // PWM motor backend (STEP only)
+//
+// Step counting modes:
+//   Dma (default) : the slice's wrap DREQ paces a DMA chain
+//                     ch A: N-1 dummy transfers (one per wrap)
+//                     ch B: CC = 0 at once, latched at wrap N
+//                     ch C: at wrap N clear the slice EN bit, 1 IRQ
+//                   => exact N pulses, one interrupt per run
+//   Irq           : PWM_IRQ_WRAP per pulse (legacy, ~220 kHz cap);
+//                   also used when no 3 DMA channels are free
 // ============================================================
 
+enum class PwmCountMode : uint8_t {
+    Dma,
+    Irq
+};
+
+// mode used by the following pwm_motor_run() calls (all pins)
+void pwm_motor_set_count_mode(PwmCountMode mode);
+
+// mode that actually counts the current / last run of this pin
+PwmCountMode pwm_motor_count_mode(uint step_pin);
+
+// mode the next pwm_motor_run() on this pin would get right now
+// (Irq if selected, or if 3 DMA channels are not free at the moment)
+PwmCountMode pwm_motor_expected_count_mode(uint step_pin);
+
+// ------------------------------------------------------------
+// Divider selection (used by pwm_motor_run, exposed for tests)
+//   integer bounded search, memoized; see pwm_motor.cpp
+// ------------------------------------------------------------
+struct PwmDivChoice {
+    uint16_t div16;   // clk_div in 8.4 fixed point (16 = 1.0 .. 4095 = 255.9375)
+    uint16_t wrap;    // TOP, period = wrap + 1 divided clocks
+};
+
+PwmDivChoice pwm_motor_choose_div(uint32_t sys_hz, uint32_t freq_hz);
+
+// drop memoized choices (benchmarks; sys_hz is part of the key,
+// a clk_sys change needs no flush)
+void pwm_motor_div_cache_clear();
+
 // Initialize PWM on STEP pin
 void pwm_motor_init(uint step_pin);
 
@@ -17,5 +56,21 @@ void pwm_motor_run(uint step_pin,
                    uint32_t freq_hz,
                    uint32_t steps);
 
-// Immediately stop PWM output
+// Immediately stop PWM output (STEP driven low: CC = 0)
 void pwm_motor_stop(uint step_pin);
+
+// Stop the counter only: STEP keeps its current level, no edge,
+// progress frozen. Follow with pwm_motor_stop().
+void pwm_motor_freeze(uint step_pin);
+
+// ------------------------------------------------------------
+// Completion / progress (updated by the IRQ, read-only here)
+// ------------------------------------------------------------
+
+// true until the last pulse has disabled the slice
+// (Dma: completion IRQ of ch C, Irq: wrap IRQ of the last pulse)
+bool pwm_motor_busy(uint step_pin);
+
+// pulses still to be emitted for the current run
+// (Dma: read from the DMA transfer_count, no IRQ involved)
+uint32_t pwm_motor_steps_remaining(uint step_pin);
@@ -0,0 +1,268 @@
+#include "radar_sync.hpp"
+
+#include "hardware/dma.h"
+#include "hardware/structs/timer.h"
+
+#include "radar_sync.pio.h"
+#include "radar_sync_dual.pio.h"
+#include "pio/pio_resources.hpp"
+
+// ------------------------------------------------------------
+// helpers
+// ------------------------------------------------------------
+
+namespace {
+
+// hi_ 槽位的“已读 / 未写”标记：TIMEHR 在 2^32 x 71 min 内不会到达
+constexpr uint32_t SLOT_FREE = 0xFFFFFFFFu;
+
+constexpr uint32_t RING_MASK = RadarSync::RING_SIZE - 1u;
+
+static_assert((RadarSync::RING_SIZE & RING_MASK) == 0, "RING_SIZE must be a power of 2");
+
+// DMA write ring size in bits (byte address wrap)
+constexpr uint ring_bits() {
+    uint bits = 0;
+    while ((1u << bits) < RadarSync::RING_SIZE * 4u) ++bits;
+    return bits;
+}
+
+static inline const pio_program_t* mode_program(RadarSync::Mode mode) {
+    return (mode == RadarSync::Mode::Dual) ? &radar_sync_dual_program
+                                           : &radar_sync_program;
+}
+
+} // namespace
+
+int radar_sync_ensure_program(PIO pio, RadarSync::Mode mode) {
+    return pio_res_program(pio, mode_program(mode));
+}
+
+// ------------------------------------------------------------
+// ctor
+// ------------------------------------------------------------
+
+RadarSync::RadarSync(const Config& cfg)
+    : cfg_(cfg) {}
+
+// ------------------------------------------------------------
+// lifecycle
+// ------------------------------------------------------------
+
+bool RadarSync::init() {
+    if (dma_token_ >= 0) return true;
+
+    int ch[3];
+    for (int i = 0; i < 3; ++i) {
+        ch[i] = dma_claim_unused_channel(false);
+        if (ch[i] < 0) {
+            while (--i >= 0) dma_channel_unclaim((uint)ch[i]);
+            return false;
+        }
+    }
+    dma_token_ = ch[0];
+    dma_lo_    = ch[1];
+    dma_hi_    = ch[2];
+
+    // trigger 由 PIO 驱动；STEP 只读，不改 function
+    const uint out_sm = (cfg_.mode == Mode::Dual) ? pulse_sm() : cfg_.sm;
+    pio_gpio_init(cfg_.pio, cfg_.trigger_pin);
+    pio_sm_set_consecutive_pindirs(cfg_.pio, out_sm, cfg_.trigger_pin, 1, true);
+
+    return true;
+}
+
+void RadarSync::deinit() {
+    if (dma_token_ < 0) return;
+
+    disarm();
+
+    dma_channel_unclaim((uint)dma_token_);
+    dma_channel_unclaim((uint)dma_lo_);
+    dma_channel_unclaim((uint)dma_hi_);
+    dma_token_ = dma_lo_ = dma_hi_ = -1;
+}
+
+// ------------------------------------------------------------
+// capture control
+// ------------------------------------------------------------
+
+bool RadarSync::arm(uint32_t step_ratio, uint32_t pulse_len) {
+    if (dma_token_ < 0 || step_ratio == 0 || pulse_len == 0) return false;
+
+    disarm();
+
+    ratio_   = step_ratio;
+    rd_      = 0;
+    seq_     = 0;
+    overrun_ = false;
+    for (size_t i = 0; i < RING_SIZE; ++i) hi_[i] = SLOT_FREE;
+
+    const uint t = (uint)dma_token_;
+    const uint l = (uint)dma_lo_;
+    const uint h = (uint)dma_hi_;
+
+    // ---------- T: pop token (paced by RX DREQ) ----------
+    dma_channel_config ct = dma_channel_get_default_config(t);
+    channel_config_set_transfer_data_size(&ct, DMA_SIZE_32);
+    channel_config_set_read_increment(&ct, false);
+    channel_config_set_write_increment(&ct, false);
+    channel_config_set_dreq(&ct, pio_get_dreq(cfg_.pio, cfg_.sm, false));
+    channel_config_set_chain_to(&ct, l);
+    channel_config_set_high_priority(&ct, true);
+    dma_channel_configure(t, &ct, &token_, &cfg_.pio->rxf[cfg_.sm], 1, false);
+
+    // ---------- L: TIMELR (latches TIMEHR) -> lo ring ----------
+    dma_channel_config cl = dma_channel_get_default_config(l);
+    channel_config_set_transfer_data_size(&cl, DMA_SIZE_32);
+    channel_config_set_read_increment(&cl, false);
+    channel_config_set_write_increment(&cl, true);
+    channel_config_set_ring(&cl, true, ring_bits());
+    channel_config_set_chain_to(&cl, h);
+    channel_config_set_high_priority(&cl, true);
+    dma_channel_configure(l, &cl, lo_, &timer_hw->timelr, 1, false);
+
+    // ---------- H: latched TIMEHR -> hi ring, back to T ----------
+    dma_channel_config chh = dma_channel_get_default_config(h);
+    channel_config_set_transfer_data_size(&chh, DMA_SIZE_32);
+    channel_config_set_read_increment(&chh, false);
+    channel_config_set_write_increment(&chh, true);
+    channel_config_set_ring(&chh, true, ring_bits());
+    channel_config_set_chain_to(&chh, t);
+    channel_config_set_high_priority(&chh, true);
+    dma_channel_configure(h, &chh, hi_, &timer_hw->timehr, 1, false);
+
+    dma_channel_start(t);   // waits for the first token
+
+    start_sms(step_ratio, pulse_len);   // trigger 0 fires now
+    armed_ = true;
+    return true;
+}
+
+void RadarSync::start_sms(uint32_t step_ratio, uint32_t pulse_len) {
+    PIO pio = cfg_.pio;
+    const uint off = cfg_.program_offset;
+
+    if (cfg_.mode == Mode::Single) {
+        pio_sm_config c = radar_sync_program_get_default_config(off);
+        sm_config_set_set_pins(&c, cfg_.trigger_pin, 1);
+        sm_config_set_in_pins(&c, cfg_.step_pin);
+        sm_config_set_clkdiv(&c, 1.0f);   // pulse_us_to_radar_len() assumes div 1
+
+        pio_sm_init(pio, cfg_.sm, off, &c);
+        pio_sm_clear_fifos(pio, cfg_.sm);
+
+        pio_sm_put(pio, cfg_.sm, step_ratio);
+        pio_sm_put(pio, cfg_.sm, pulse_len);
+
+        pio_sm_set_enabled(pio, cfg_.sm, true);
+        return;
+    }
+
+    // ---------- Dual: counter (wrap from the program) ----------
+    pio_sm_config cc = radar_sync_dual_program_get_default_config(off);
+    sm_config_set_in_pins(&cc, cfg_.step_pin);
+    sm_config_set_clkdiv(&cc, 1.0f);
+
+    pio_sm_init(pio, cfg_.sm, off, &cc);
+    pio_sm_clear_fifos(pio, cfg_.sm);
+    pio_sm_put(pio, cfg_.sm, step_ratio);
+
+    // ---------- Dual: pulse (own entry / wrap) ----------
+    const uint ps = pulse_sm();
+    pio_sm_config pc = radar_sync_dual_program_get_default_config(off);
+    sm_config_set_wrap(&pc,
+                       off + radar_sync_dual_offset_pulse,
+                       off + radar_sync_dual_offset_pulse_wrap);
+    sm_config_set_set_pins(&pc, cfg_.trigger_pin, 1);
+    sm_config_set_clkdiv(&pc, 1.0f);
+
+    pio_sm_init(pio, ps, off + radar_sync_dual_offset_pulse_init, &pc);
+    pio_sm_clear_fifos(pio, ps);
+    pio_sm_put(pio, ps, pulse_len);
+
+    pio_interrupt_clear(pio, cfg_.sm);
+
+    // pulse SM 先就位等 flag，两个 SM 同一 PIO 时钟沿启动
+    pio_enable_sm_mask_in_sync(pio, (1u << cfg_.sm) | (1u << ps));
+}
+
+void RadarSync::disarm() {
+    if (!armed_) return;
+
+    const uint out_sm = (cfg_.mode == Mode::Dual) ? pulse_sm() : cfg_.sm;
+
+    pio_sm_set_enabled(cfg_.pio, cfg_.sm, false);
+    if (cfg_.mode == Mode::Dual) {
+        pio_sm_set_enabled(cfg_.pio, out_sm, false);
+        pio_interrupt_clear(cfg_.pio, cfg_.sm);
+    }
+
+    pio_sm_clear_fifos(cfg_.pio, cfg_.sm);
+    pio_sm_restart(cfg_.pio, cfg_.sm);
+    if (cfg_.mode == Mode::Dual) {
+        pio_sm_clear_fifos(cfg_.pio, out_sm);
+        pio_sm_restart(cfg_.pio, out_sm);
+    }
+    pio_sm_exec(cfg_.pio, out_sm, pio_encode_set(pio_pins, 0));
+
+    stop_chain();
+    armed_ = false;
+}
+
+void RadarSync::stop_chain() {
+    // T -> L -> H 顺序 abort；H 被 abort 时可能再 chain 一次 T，
+    // 但 SM 已停且 FIFO 已清，T 不会再有 DREQ，最后再 abort 一次
+    dma_channel_abort((uint)dma_token_);
+    dma_channel_abort((uint)dma_lo_);
+    dma_channel_abort((uint)dma_hi_);
+    dma_channel_abort((uint)dma_token_);
+}
+
+// ------------------------------------------------------------
+// record drain
+// ------------------------------------------------------------
+
+size_t RadarSync::write_slot() const {
+    // H 最后写入：其 write_addr 之前的槽位 lo / hi 都已完整
+    const uint32_t addr = dma_hw->ch[dma_hi_].write_addr;
+    return ((addr - (uint32_t)(uintptr_t)hi_) / 4u) & RING_MASK;
+}
+
+size_t RadarSync::pending() const {
+    if (dma_token_ < 0 || overrun_) return 0;
+    return (write_slot() - rd_) & RING_MASK;
+}
+
+size_t RadarSync::read(Trigger* out, size_t max) {
+    if (dma_token_ < 0 || overrun_ || !out) return 0;
+
+    const uint32_t r0 = rd_;
+    size_t n = (write_slot() - r0) & RING_MASK;
+    if (n > max) n = max;
+
+    uint32_t r = r0;
+    for (size_t i = 0; i < n; ++i) {
+        const uint32_t hi = hi_[r];
+        const uint32_t lo = lo_[r];
+
+        out[i].seq        = seq_ + (uint32_t)i;
+        out[i].step_index = out[i].seq * ratio_;
+        out[i].t_us       = ((uint64_t)hi << 32) | lo;
+
+        hi_[r] = SLOT_FREE;
+        r = (r + 1u) & RING_MASK;
+    }
+
+    // DMA 按槽位顺序写：写到 r0 之前最后一个空槽，说明它已追上（或即将覆盖）
+    // 未读数据 —— 本批记录的序号不再可信，停止采集
+    if (hi_[(r0 - 1u) & RING_MASK] != SLOT_FREE) {
+        stop_chain();
+        overrun_ = true;
+        return 0;
+    }
+
+    rd_   = r;
+    seq_ += (uint32_t)n;
+    return n;
+}
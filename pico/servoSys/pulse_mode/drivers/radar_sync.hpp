@@ -0,0 +1,127 @@
+#pragma once
+
+#include "pico/stdlib.h"
+#include "hardware/pio.h"
+#include <cstdint>
+#include <cstddef>
+
+// ============================================================
+// RadarSync
+//   - Drives pio/radar_sync.pio: one radar trigger every
+//     STEP_RATIO STEP pulses (first trigger at arm, step 0)
+//   - Records every fired trigger without CPU involvement:
+//       SM push token -> DMA chain -> 64-bit timer snapshot
+//     into a fixed ring (no heap, no IRQ)
+//   - read() drains complete records: seq, step index, t_us
+//   - DOES NOT own PIO program memory (see radar_sync_ensure_program)
+//
+// DMA chain (per trigger, 3 channels claimed at init):
+//   T: RX DREQ, pops the token          -> chain L
+//   L: timer TIMELR -> lo ring (latches TIMEHR) -> chain H
+//   H: timer TIMEHR -> hi ring           -> chain T
+//   Timestamp = trigger end + a few DMA cycles (constant).
+//   The TIMELR / TIMEHR latch is reserved for this driver
+//   (SDK time_us_64() uses the raw registers, no conflict).
+//
+// Modes:
+//   Single : radar_sync.pio, one SM counts and pulses. STEP edges
+//            arriving during the pulse are missed (the "blind zone",
+//            ~3.4 MHz ceiling with len 16, R 1).
+//   Dual   : radar_sync_dual.pio, counter SM `sm` + pulse SM
+//            (sm + 1) & 3 linked by IRQ flag `sm`. The counter loop
+//            has no delay, so no edge is dropped up to the PIO STEP
+//            limit. Records are taken at the counting edge.
+//
+// Exactness: a slot is released by read() only. If the DMA ever
+// reaches an unread slot the capture stops and overrun() latches,
+// so a delivered record is never mislabelled; re-arm to recover.
+// ============================================================
+
+class RadarSync {
+public:
+    static constexpr size_t RING_SIZE = 256;   // records, power of 2 (capacity RING_SIZE - 1)
+
+    enum class Mode : uint8_t {
+        Single,   // radar_sync      (1 SM, 14 instructions)
+        Dual      // radar_sync_dual (2 SM, 16 instructions)
+    };
+
+    // ------------------------------------------------------------
+    // Configuration (NO program ownership here)
+    // ------------------------------------------------------------
+    struct Config {
+        uint step_pin;            // STEP input (read only, counted on falling edges)
+        uint trigger_pin;         // radar trigger output (PIO owned)
+
+        // -------- PIO execution context --------
+        // Program MUST already be loaded by upper layer.
+        PIO  pio;                 // pio1 in this system (pio0 holds motor_exec)
+        uint sm;                  // Dual: counter SM, pulse SM is (sm + 1) & 3
+        uint program_offset;      // offset of the program for `mode` (REQUIRED)
+        Mode mode = Mode::Single;
+    };
+
+    // ------------------------------------------------------------
+    // One recorded trigger
+    // ------------------------------------------------------------
+    struct Trigger {
+        uint32_t seq;             // trigger ordinal since arm (0 = arm)
+        uint32_t step_index;      // STEP pulses since arm = seq * step_ratio
+        uint64_t t_us;            // 64-bit timer at the trigger (us)
+    };
+
+public:
+    explicit RadarSync(const Config& cfg);
+
+    // ------------------------------------------------------------
+    // lifecycle
+    // ------------------------------------------------------------
+    bool init();     // claims 3 DMA channels, configures pins
+    void deinit();
+
+    // ------------------------------------------------------------
+    // capture control
+    // ------------------------------------------------------------
+    // step_ratio  : STEP pulses per trigger (>= 1)
+    // pulse_len   : trigger high time, see pulse_us_to_radar_len()
+    // Fires trigger 0 immediately. false if not initialized / bad args.
+    bool arm(uint32_t step_ratio, uint32_t pulse_len);
+    void disarm();
+
+    bool armed()   const { return armed_; }
+    bool overrun() const { return overrun_; }
+
+    // ------------------------------------------------------------
+    // record drain (main loop, single consumer)
+    // ------------------------------------------------------------
+    size_t   pending() const;                 // complete records not yet read
+    size_t   read(Trigger* out, size_t max);  // 0 after an overrun
+    uint32_t delivered() const { return seq_; }
+
+private:
+    size_t write_slot() const;
+    void   stop_chain();
+    void   start_sms(uint32_t step_ratio, uint32_t pulse_len);
+    uint   pulse_sm() const { return (cfg_.sm + 1u) & 3u; }
+
+private:
+    Config cfg_;
+
+    int dma_token_ = -1;
+    int dma_lo_    = -1;
+    int dma_hi_    = -1;
+
+    uint32_t ratio_   = 1;
+    uint32_t token_   = 0;     // T sink
+    uint32_t rd_      = 0;     // next slot to read
+    uint32_t seq_     = 0;     // ordinal of slot rd_
+    bool     armed_   = false;
+    bool     overrun_ = false;
+
+    // SoA rings written by L / H (ring-wrapped, hence aligned to their size)
+    alignas(RING_SIZE * 4) volatile uint32_t lo_[RING_SIZE];
+    alignas(RING_SIZE * 4) volatile uint32_t hi_[RING_SIZE];
+};
+
+// Loads the program for `mode` once per PIO, returns its offset (-1 if no space).
+int radar_sync_ensure_program(PIO pio, RadarSync::Mode mode = RadarSync::Mode::Single);
@@ -0,0 +1,191 @@
+#include "pico/stdlib.h"
+#include <stdio.h>
+#include <string.h>
+
+#include "drivers/ps100.hpp"
+#include "drivers/ps100_group.hpp"
+#include "pio/pio_exec.hpp"
+#include "trajectory/interp2d.hpp"
+
+// ------------------------------------------------------------
+// configuration (adjust to your wiring)
+// ------------------------------------------------------------
+
+static constexpr uint X_STEP_PIN = 3;
+static constexpr uint X_DIR_PIN  = 4;
+static constexpr uint Y_STEP_PIN = 5;
+static constexpr uint Y_DIR_PIN  = 6;
+
+// ------------------------------------------------------------
+// helpers
+// ------------------------------------------------------------
+
+static void print_help() {
+    printf(
+        "\nCommands:\n"
+        "  sync <hzx> <nx> <hzy> <ny>   both axes, same PIO clock edge\n"
+        "  seq  <hzx> <nx> <hzy> <ny>   both axes, started one after another\n"
+        "  line <dx> <dy> <feed>        interpolated line (feed: steps/s)\n"
+        "  arc  <dx> <dy> <i> <j> <cw> <feed>  interpolated arc, center (i, j)\n"
+        "  dir  <x 0|1> <y 0|1>         direction\n"
+        "  stop                         stop both axes\n"
+        "  status                       busy + steps per axis\n"
+        "  help\n\n"
+    );
+}
+
+// ------------------------------------------------------------
+// interpolated move: one synced group start per monotone segment
+// ------------------------------------------------------------
+
+static constexpr size_t RING_HALF = 16;
+
+static void run_interp(Interp2D& ip, PS100_Group& group) {
+    static uint32_t ring_x[2 * RING_HALF];
+    static uint32_t ring_y[2 * RING_HALF];
+
+    uint32_t segs = 0;
+    while (ip.next_segment()) {
+        // DIR only changes between segments (both axes idle)
+        group.axis(0).set_direction(ip.forward(0));
+        group.axis(1).set_direction(ip.forward(1));
+
+        group.stage_ring(0, ring_x, RING_HALF, Interp2D::refill_x, &ip);
+        group.stage_ring(1, ring_y, RING_HALF, Interp2D::refill_y, &ip);
+        group.start();
+
+        while (group.busy()) {
+            tight_loop_contents();
+        }
+
+        printf("  seg %u: x=%u y=%u%s\n", segs++,
+               group.axis(0).steps_done(), group.axis(1).steps_done(),
+               (group.axis(0).last_ring_underrun() ||
+                group.axis(1).last_ring_underrun()) ? "  (underrun)" : "");
+    }
+}
+
+// ------------------------------------------------------------
+// main
+// ------------------------------------------------------------
+
+int main() {
+    stdio_init_all();
+    sleep_ms(2000);
+
+    printf("\nPS100_Group sync start test ready.\n");
+    print_help();
+
+    // -------- create axes (same PIO, different SM) --------
+
+    const uint offset = motor_exec_ensure_program(pio0);
+
+    PS100_P::Config cx{};
+    cx.step_pin = X_STEP_PIN;
+    cx.dir_pin  = X_DIR_PIN;
+    cx.pio = pio0;
+    cx.sm  = 0;
+    cx.program_offset = offset;
+
+    PS100_P::Config cy = cx;
+    cy.step_pin = Y_STEP_PIN;
+    cy.dir_pin  = Y_DIR_PIN;
+    cy.sm       = 1;
+
+    static PS100_P x(cx);
+    static PS100_P y(cy);
+    x.init();
+    y.init();
+    x.enable();
+    y.enable();
+
+    static PS100_Group group;
+    group.add(x);
+    group.add(y);
+
+    // -------- command loop --------
+
+    char line[128];
+
+    while (true) {
+        if (fgets(line, sizeof(line), stdin)) {
+            line[strcspn(line, "\r\n")] = 0;
+
+            uint32_t hzx, nx, hzy, ny;
+
+            // ------------------------------------------------
+            // sync: scope X/Y STEP, first edges must coincide
+            // ------------------------------------------------
+            if (sscanf(line, "sync %u %u %u %u", &hzx, &nx, &hzy, &ny) == 4) {
+                group.stage_steps(0, nx, hzx);
+                group.stage_steps(1, ny, hzy);
+                bool ok = group.start();
+                printf("sync: x=%u@%u y=%u@%u -> %s\n",
+                       nx, hzx, ny, hzy, ok ? "started" : "nothing staged");
+            }
+            // ------------------------------------------------
+            // seq: reference skew of two independent starts
+            // ------------------------------------------------
+            else if (sscanf(line, "seq %u %u %u %u", &hzx, &nx, &hzy, &ny) == 4) {
+                x.run_steps(nx, hzx, PS100_P::Backend::PIO);
+                y.run_steps(ny, hzy, PS100_P::Backend::PIO);
+                printf("seq: x=%u@%u y=%u@%u\n", nx, hzx, ny, hzy);
+            }
+            // ------------------------------------------------
+            // line / arc: on-device interpolation
+            // ------------------------------------------------
+            else if (strncmp(line, "line ", 5) == 0) {
+                static Interp2D ip(x.timing());
+                int dx, dy;
+                float feed;
+                if (sscanf(line, "line %d %d %f", &dx, &dy, &feed) == 3) {
+                    if (ip.plan_line(dx, dy, feed)) {
+                        printf("line: (%d, %d) feed=%.0f\n", dx, dy, feed);
+                        run_interp(ip, group);
+                    } else {
+                        printf("line: invalid\n");
+                    }
+                }
+            }
+            else if (strncmp(line, "arc ", 4) == 0) {
+                static Interp2D ip(x.timing());
+                int dx, dy, ci, cj, cw;
+                float feed;
+                if (sscanf(line, "arc %d %d %d %d %d %f",
+                           &dx, &dy, &ci, &cj, &cw, &feed) == 6) {
+                    if (ip.plan_arc(dx, dy, ci, cj, cw != 0, feed)) {
+                        printf("arc: (%d, %d) c=(%d, %d) %s feed=%.0f\n",
+                               dx, dy, ci, cj, cw ? "cw" : "ccw", feed);
+                        run_interp(ip, group);
+                    } else {
+                        printf("arc: invalid\n");
+                    }
+                }
+            }
+            else if (strncmp(line, "dir ", 4) == 0) {
+                int dx, dy;
+                if (sscanf(line, "dir %d %d", &dx, &dy) == 2) {
+                    x.set_direction(dx != 0);
+                    y.set_direction(dy != 0);
+                    printf("dir x=%d y=%d\n", dx, dy);
+                }
+            }
+            else if (strcmp(line, "stop") == 0) {
+                group.stop();
+                printf("stop\n");
+            }
+            else if (strcmp(line, "status") == 0) {
+                printf("busy=%d  x.steps=%u  y.steps=%u\n",
+                       group.busy() ? 1 : 0, x.steps_done(), y.steps_done());
+            }
+            else if (strcmp(line, "help") == 0) {
+                print_help();
+            }
+            else {
+                printf("Unknown command. Type 'help'.\n");
+            }
+        }
+
+        tight_loop_contents();
+    }
+}
@@ -4,6 +4,7 @@
 
 #include "drivers/ps100.hpp"
 #include "pio/pio_exec.hpp"
+#include "pio/pio_resources.hpp"
 
 // ------------------------------------------------------------
 // configuration (adjust to your wiring)
@@ -13,6 +14,10 @@ static constexpr uint STEP_PIN   = 3;
 static constexpr uint DIR_PIN    = 4;
 static constexpr uint ENABLE_PIN = static_cast<uint>(-1);
 
+// motor_exec program of the axis (pio/motor_exec_variants.hpp)
+//   e.g. AdjustableDuty: 10 us STEP pulses, DIR from the stream
+static constexpr MotorExecVariant AXIS_VARIANT = MotorExecVariant::Exec;
+
 // ------------------------------------------------------------
 // globals
 // ------------------------------------------------------------
@@ -25,7 +30,12 @@ PS100_P::Backend current_backend = PS100_P::Backend::PWM;
 // ------------------------------------------------------------
 
 static const char* backend_name(PS100_P::Backend b) {
-    return (b == PS100_P::Backend::PWM) ? "PWM" : "PIO";
+    switch (b) {
+        case PS100_P::Backend::PWM:  return "PWM";
+        case PS100_P::Backend::PIO:  return "PIO";
+        case PS100_P::Backend::Auto: return "Auto";
+        default: return "?";
+    }
 }
 
 static const char* reason_name(PS100_P::CompletionReason r) {
@@ -40,17 +50,54 @@ static const char* reason_name(PS100_P::CompletionReason r) {
 static void print_help() {
     printf(
         "\nCommands:\n"
-        "  backend pwm|pio      select backend\n"
+        "  backend pwm|pio|auto select backend\n"
         "  run  <hz> <steps>    fixed steps\n"
         "  runv <hz> <ms>       velocity segment\n"
         "  stream <hz> <steps> PIO raw stream (PIO only)\n"
+        "  ring <hz> <steps> <segs>  PIO ring stream, segs x steps\n"
+        "  pring <hz> <steps> <segs> same, packed format (1 word / cmd)\n"
+        "  queue <hz> <steps> [a_max] append segment (blend, PIO only)\n"
+        "  moves <hz> <steps> <n> n moves in one stream, reversing (DIR variants)\n"
         "  stop                 immediate stop\n"
         "  status               show COM1 / COM2 state\n"
         "  dir <0|1>            direction\n"
+        "  pos                  hardware position register\n"
+        "  setpos <n>           load position (axis idle)\n"
         "  help\n\n"
     );
 }
 
+// ------------------------------------------------------------
+// ring stream source (refill from DMA IRQ)
+// ------------------------------------------------------------
+
+struct RingSource {
+    uint32_t duty;
+    uint32_t steps_per_seg;
+    uint32_t segs_left;
+    bool     packed;     // duty / steps <= 0xFFFF
+};
+
+static size_t ring_refill(uint32_t* dst, size_t capacity, void* user) {
+    auto* src = static_cast<RingSource*>(user);
+
+    size_t n = 0;
+    if (src->packed) {
+        while (src->segs_left > 0 && n < capacity) {
+            dst[n++] = motor_exec_pack(src->duty, src->steps_per_seg);
+            src->segs_left--;
+        }
+        return n;
+    }
+
+    while (src->segs_left > 0 && n + 2 <= capacity) {
+        dst[n++] = src->duty;
+        dst[n++] = src->steps_per_seg;
+        src->segs_left--;
+    }
+    return n;
+}
+
 // ------------------------------------------------------------
 // main
 // ------------------------------------------------------------
@@ -73,9 +120,14 @@ int main() {
     cfg.sm  = 0;
     cfg.pio_clk_div = 1.0f;
 
+    // pio0 holds motor_exec; position SM on pio1 (shared with radar_sync)
+    cfg.position_pio = pio1;
+
     // ---- ensure PIO program is loaded (shared responsibility) ----
-    cfg.program_offset = motor_exec_ensure_program(cfg.pio);
-    printf("motor_exec program_offset=%u\n", cfg.program_offset);
+    const MotorExecProgram* prog = motor_exec_variant_program(AXIS_VARIANT);
+    cfg.variant        = AXIS_VARIANT;
+    cfg.program_offset = (uint)pio_res_program(cfg.pio, prog->program);
+    printf("motor_exec[%s] program_offset=%u\n", prog->name, cfg.program_offset);
 
     static PS100_P ps100(cfg);
     motor = &ps100;
@@ -103,6 +155,9 @@ int main() {
                     } else if (strcmp(name, "pio") == 0) {
                         current_backend = PS100_P::Backend::PIO;
                         printf("Backend = PIO\n");
+                    } else if (strcmp(name, "auto") == 0) {
+                        current_backend = PS100_P::Backend::Auto;
+                        printf("Backend = Auto\n");
                     } else {
                         printf("Unknown backend\n");
                     }
@@ -114,9 +169,13 @@ int main() {
             else if (strncmp(line, "run ", 4) == 0) {
                 uint32_t hz, steps;
                 if (sscanf(line, "run %u %u", &hz, &steps) == 2) {
+                    const PS100_P::Backend b =
+                        (current_backend == PS100_P::Backend::Auto) ? motor->auto_backend(hz, steps)
+                                                                    : current_backend;
                     printf(
-                        "run: hz=%u steps=%u backend=%s\n",
-                        hz, steps, backend_name(current_backend)
+                        "run: hz=%u steps=%u backend=%s%s\n",
+                        hz, steps, backend_name(b),
+                        (current_backend == PS100_P::Backend::Auto) ? " (auto)" : ""
                     );
                     motor->run_steps(steps, hz, current_backend);
                 }
@@ -164,6 +223,74 @@ int main() {
                 }
             }
             // ------------------------------------------------
+            // ring (PIO only)
+            // ------------------------------------------------
+            else if (strncmp(line, "ring ", 5) == 0 || strncmp(line, "pring ", 6) == 0) {
+                const bool packed = (line[0] == 'p');
+                uint32_t hz, steps, segs;
+                if (sscanf(line + (packed ? 1 : 0), "ring %u %u %u", &hz, &steps, &segs) == 3) {
+                    static uint32_t ring_buf[2 * 16];
+                    static RingSource src;
+
+                    // 正在运行的 ring 仍在读 src / ring_buf，先停
+                    motor->stop();
+
+                    src.duty          = hz_to_duty_period(hz);
+                    src.steps_per_seg = steps;
+                    src.segs_left     = segs;
+                    src.packed        = packed;
+
+                    if (packed && (src.duty > MOTOR_EXEC_PACKED_MAX || steps > MOTOR_EXEC_PACKED_MAX)) {
+                        printf("pring: duty=%u / steps=%u exceed 16 bit\n", src.duty, steps);
+                        continue;
+                    }
+
+                    bool ok = motor->run_pio_ring(
+                        ring_buf, 16, ring_refill, &src,
+                        packed ? MotorExecFormat::Packed : MotorExecFormat::Raw);
+                    printf(
+                        "%s: hz=%u steps=%u segs=%u -> %s\n",
+                        packed ? "pring" : "ring", hz, steps, segs, ok ? "started" : "failed"
+                    );
+                }
+            }
+            // ------------------------------------------------
+            // queue (PIO only, appends behind the running command)
+            // ------------------------------------------------
+            else if (strncmp(line, "queue ", 6) == 0) {
+                uint32_t hz, steps, a_max = 0;
+                if (sscanf(line, "queue %u %u %u", &hz, &steps, &a_max) >= 2) {
+                    const bool ok = motor->queue_steps(steps, hz, a_max);
+                    printf(
+                        "queue: hz=%u steps=%u a_max=%u -> %s (free=%u)\n",
+                        hz, steps, a_max, ok ? "queued" : "rejected",
+                        (unsigned)motor->queue_free()
+                    );
+                }
+            }
+            // ------------------------------------------------
+            // moves (one stream, direction alternates when the variant has DIR)
+            // ------------------------------------------------
+            else if (strncmp(line, "moves ", 6) == 0) {
+                uint32_t hz, steps, n;
+                if (sscanf(line, "moves %u %u %u", &hz, &steps, &n) == 3) {
+                    static MotorExecMove moves[16];
+                    if (n == 0 || n > 16) {
+                        printf("moves: n must be 1..16\n");
+                        continue;
+                    }
+
+                    const bool rev = (motor->program()->caps & MOTOR_EXEC_CAP_DIR) != 0;
+                    for (uint32_t i = 0; i < n; ++i) {
+                        moves[i] = MotorExecMove{ hz, steps, rev ? (i % 2 == 0) : true };
+                    }
+
+                    const bool ok = motor->run_pio_moves(moves, n);
+                    printf("moves: hz=%u steps=%u n=%u%s -> %s\n", hz, steps, n,
+                           rev ? " (reversing)" : "", ok ? "started" : "failed");
+                }
+            }
+            // ------------------------------------------------
             // stop
             // ------------------------------------------------
             else if (strcmp(line, "stop") == 0) {
@@ -178,9 +305,11 @@ int main() {
                 auto last = motor->last_completion();
 
                 printf(
-                    "COM2=%s  COM1=%s\n",
+                    "COM2=%s  COM1=%s  steps=%u%s\n",
                     busy ? "Running" : "Empty",
-                    reason_name(last)
+                    reason_name(last),
+                    motor->steps_done(),
+                    motor->last_ring_underrun() ? "  (ring underrun)" : ""
                 );
             }
             // ------------------------------------------------
@@ -194,6 +323,27 @@ int main() {
                 }
             }
             // ------------------------------------------------
+            // pos / setpos
+            // ------------------------------------------------
+            else if (strcmp(line, "pos") == 0) {
+                if (motor->has_position()) {
+                    printf("pos=%ld\n", (long)motor->position());
+                } else {
+                    printf("no position register\n");
+                }
+            }
+            else if (strncmp(line, "setpos ", 7) == 0) {
+                long p;
+                if (sscanf(line, "setpos %ld", &p) == 1) {
+                    if (motor->busy()) {
+                        printf("setpos: axis busy\n");
+                    } else {
+                        motor->set_position((int32_t)p);
+                        printf("pos=%ld\n", (long)motor->position());
+                    }
+                }
+            }
+            // ------------------------------------------------
             // help
             // ------------------------------------------------
             else if (strcmp(line, "help") == 0) {
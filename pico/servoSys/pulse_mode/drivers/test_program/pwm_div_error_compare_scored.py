@@ -10,7 +10,12 @@ WRAP_MIN = 400
 WRAP_MAX = 20000
 
 W_FREQ = 1.0      # frequency error weight
-W_WRAP = 0.005     # wrap penalty weight (tunable)
+W_WRAP = 0.02     # wrap penalty weight (must match pwm_motor.cpp)
+
+# bounded integer search (pwm_motor_choose_div)
+DIV16_MIN = 16
+DIV16_MAX = 4095      # 255.9375: INT field >= 1 (pwm_motor.cpp)
+DIV_CANDIDATES = 256
 
 OUT_CSV = "pwm_div_error_compare_scored.csv"
 
@@ -32,7 +37,7 @@ def make_freq_list(max_hz=100_000):
 
 def quantize_div_8p4(div: float) -> float:
     div = round(div * 16.0) / 16.0
-    return min(max(div, 1.0), 256.0)
+    return min(max(div, DIV16_MIN / 16.0), DIV16_MAX / 16.0)
 
 def compute_real_freq(sys_hz, freq_hz, div):
     wrap = int(sys_hz / (div * freq_hz) - 1.0)
@@ -58,7 +63,7 @@ def choose_div_window(sys_hz, freq_hz):
     best_div = None
     best_err = float("inf")
 
-    for i in range(16, 256 * 16 + 1):
+    for i in range(DIV16_MIN, DIV16_MAX + 1):
         div = i / 16.0
         wrap_f = sys_hz / (div * freq_hz) - 1.0
         if wrap_f < WRAP_MIN or wrap_f > WRAP_MAX:
@@ -92,7 +97,7 @@ def choose_div_scored(sys_hz, freq_hz):
     best_div = None
     best_score = float("inf")
 
-    for i in range(16, 256 * 16 + 1):
+    for i in range(DIV16_MIN, DIV16_MAX + 1):
         div = i / 16.0
         wrap_f = sys_hz / (div * freq_hz) - 1.0
         if wrap_f < 2 or wrap_f > 65535:
@@ -116,6 +121,70 @@ def choose_div_scored(sys_hz, freq_hz):
 
     return best_div
 
+# ============================================================
+# Bounded integer search (pwm_motor.cpp, Q32 scoring)
+#   returns (div, wrap, evaluations); wrap is programmed as is
+# ============================================================
+
+Q32 = 1 << 32
+W_FREQ_Q32 = Q32
+W_WRAP_Q32 = int(W_WRAP * Q32 + 0.5)
+
+def wrap_penalty_q32(wrap):
+    if wrap < WRAP_MIN:
+        return W_WRAP_Q32 * (WRAP_MIN - wrap) // WRAP_MIN
+    if wrap > WRAP_MAX:
+        return W_WRAP_Q32 * (wrap - WRAP_MAX) // WRAP_MAX
+    return 0
+
+def choose_div_bounded(sys_hz, freq_hz):
+    num = sys_hz * 16
+
+    per_div = freq_hz * (WRAP_MAX + 1)
+    d0 = min(max((num + per_div - 1) // per_div, DIV16_MIN), DIV16_MAX)
+    down = d0 == DIV16_MAX
+
+    best = (d0, WRAP_MAX)
+    best_score = None
+    evals = 0
+
+    d = d0
+    for _ in range(DIV_CANDIDATES):
+        den = freq_hz * d
+        top = min(max((num + den // 2) // den, 3), 65536)
+        wrap = top - 1
+        pen = wrap_penalty_q32(wrap)
+
+        if best_score is not None and pen >= best_score:
+            break
+
+        evals += 1
+        real = den * top
+        score = abs(real - num) * W_FREQ_Q32 // real + pen
+
+        if best_score is None or score < best_score:
+            best_score = score
+            best = (d, wrap)
+            if score == 0:
+                break
+
+        if down:
+            if d == DIV16_MIN:
+                break
+            d -= 1
+        else:
+            if d == DIV16_MAX:
+                break
+            d += 1
+
+    return best[0] / 16.0, best[1], evals
+
+def scored_real_freq(sys_hz, freq_hz, div):
+    # wrap as scored (rounded), i.e. what the full search intended
+    wrap = int(sys_hz / (div * freq_hz) - 1.0 + 0.5)
+    wrap = max(2, min(wrap, 65535))
+    return wrap, sys_hz / (div * (wrap + 1))
+
 # ============================================================
 # Main
 # ============================================================
@@ -135,6 +204,11 @@ def main():
         # scored
         d_sc = choose_div_scored(CLK_SYS_HZ, freq)
         w_sc, r_sc = compute_real_freq(CLK_SYS_HZ, freq, d_sc)
+        w_sr, r_sr = scored_real_freq(CLK_SYS_HZ, freq, d_sc)
+
+        # bounded
+        d_bd, w_bd, n_bd = choose_div_bounded(CLK_SYS_HZ, freq)
+        r_bd = CLK_SYS_HZ / (d_bd * (w_bd + 1))
 
         rows.append({
             "target_hz": freq,
@@ -153,6 +227,14 @@ def main():
             "scored_wrap": w_sc,
             "scored_real_hz": r_sc,
             "scored_err_ppm": abs(r_sc - freq) / freq * 1e6,
+            "scored_round_wrap": w_sr,
+            "scored_round_err_ppm": abs(r_sr - freq) / freq * 1e6,
+
+            "bounded_div": d_bd,
+            "bounded_wrap": w_bd,
+            "bounded_real_hz": r_bd,
+            "bounded_err_ppm": abs(r_bd - freq) / freq * 1e6,
+            "bounded_evals": n_bd,
         })
 
     df = pd.DataFrame(rows)
@@ -161,5 +243,19 @@ def main():
     print(f"[OK] exported: {OUT_CSV}")
     print(df.head(20))
 
+    # bounded vs full search (both with the scored wrap programmed)
+    valid = df[df["target_hz"] >= 8]
+    delta = valid["bounded_err_ppm"] - valid["scored_round_err_ppm"]
+    full_iters = DIV16_MAX - DIV16_MIN + 1
+    print()
+    print(f"full search (floor wrap)  mean {valid['scored_err_ppm'].mean():8.3f} ppm"
+          f"  max {valid['scored_err_ppm'].max():8.3f} ppm  {full_iters} iterations")
+    print(f"full search (round wrap)  mean {valid['scored_round_err_ppm'].mean():8.3f} ppm"
+          f"  max {valid['scored_round_err_ppm'].max():8.3f} ppm  {full_iters} iterations")
+    print(f"bounded                   mean {valid['bounded_err_ppm'].mean():8.3f} ppm"
+          f"  max {valid['bounded_err_ppm'].max():8.3f} ppm"
+          f"  {valid['bounded_evals'].max()} evaluations max")
+    print(f"bounded - full            max {delta.max():8.3f} ppm")
+
 if __name__ == "__main__":
     main()
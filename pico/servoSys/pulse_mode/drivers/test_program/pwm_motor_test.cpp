@@ -1,4 +1,5 @@
 #include "pico/stdlib.h"
+#include "hardware/clocks.h"
 #include <stdio.h>
 #include <cstring>
 
@@ -14,6 +15,7 @@ int main() {
     printf("Commands:\n");
     printf("  run <hz> <steps>\n");
     printf("  stop\n");
+    printf("  div <hz>        (clk_div choice + search time)\n");
 
     pwm_motor_init(STEP_PIN);
 
@@ -30,6 +32,26 @@ int main() {
                               static_cast<uint32_t>(hz),
                               steps);
             }
+            else if (sscanf(line, "div %lf", &hz) == 1 && hz >= 1.0) {
+                const uint32_t sys_hz = clock_get_hz(clk_sys);
+                const uint32_t f = static_cast<uint32_t>(hz);
+
+                pwm_motor_div_cache_clear();
+                uint64_t t0 = time_us_64();
+                PwmDivChoice c = pwm_motor_choose_div(sys_hz, f);
+                uint64_t t1 = time_us_64();
+                pwm_motor_choose_div(sys_hz, f);          // memoized
+                uint64_t t2 = time_us_64();
+
+                const double real = (double)sys_hz * 16.0 /
+                                    ((double)c.div16 * (double)(c.wrap + 1u));
+                printf("div=%u+%u/16 wrap=%u real=%.4f Hz err=%.3f ppm "
+                       "search=%llu us cached=%llu us\n",
+                       c.div16 >> 4, c.div16 & 0xFu, c.wrap, real,
+                       (real - (double)f) / (double)f * 1e6,
+                       (unsigned long long)(t1 - t0),
+                       (unsigned long long)(t2 - t1));
+            }
             else if (strncmp(line, "stop", 4) == 0) {
                 printf("PWM stop\n");
                 pwm_motor_stop(STEP_PIN);
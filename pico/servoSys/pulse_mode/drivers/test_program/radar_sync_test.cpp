@@ -0,0 +1,234 @@
+#include "pico/stdlib.h"
+#include <stdio.h>
+#include <string.h>
+
+#include "drivers/ps100.hpp"
+#include "drivers/radar_sync.hpp"
+#include "pio/pio_exec.hpp"
+#include "timing/pio_timing.hpp"
+
+// ------------------------------------------------------------
+// configuration (adjust to your wiring)
+// ------------------------------------------------------------
+
+static constexpr uint STEP_PIN    = 3;
+static constexpr uint DIR_PIN     = 4;
+static constexpr uint ENABLE_PIN  = static_cast<uint>(-1);
+static constexpr uint TRIGGER_PIN = 6;
+
+// records per USB batch
+static constexpr size_t BATCH = 32;
+
+// ------------------------------------------------------------
+// globals
+// ------------------------------------------------------------
+
+PS100_P*   motor = nullptr;
+RadarSync* radar = nullptr;
+
+// both modes live on pio1 (14 + 16 instructions), one armed at a time
+static RadarSync* radar_single = nullptr;
+static RadarSync* radar_dual   = nullptr;
+
+static bool streaming = false;
+
+// ------------------------------------------------------------
+// helpers
+// ------------------------------------------------------------
+
+static void print_help() {
+    printf(
+        "\nCommands:\n"
+        "  arm <ratio> <pulse_us>  start radar_sync (trigger 0 fires now)\n"
+        "  disarm                  stop radar_sync\n"
+        "  mode single|dual        1 SM, or counter + pulse SM (no blind zone)\n"
+        "  run <hz> <steps>        move (PIO backend)\n"
+        "  stream on|off           batch records over USB\n"
+        "  status                  armed / pending / delivered / overrun\n"
+        "  help\n\n"
+        "Batch format:\n"
+        "  B <first_seq> <count>\n"
+        "  <step_index> <t_us>     x count\n\n"
+    );
+}
+
+// non-blocking line input, so the batch stream keeps flowing
+static bool poll_line(char* line, size_t cap) {
+    static size_t len = 0;
+
+    int c;
+    while ((c = getchar_timeout_us(0)) != PICO_ERROR_TIMEOUT) {
+        if (c == '\r' || c == '\n') {
+            if (len == 0) continue;
+            line[len] = 0;
+            len = 0;
+            return true;
+        }
+        if (len + 1 < cap) line[len++] = (char)c;
+    }
+    return false;
+}
+
+static void stream_batch() {
+    static RadarSync::Trigger batch[BATCH];
+
+    const size_t n = radar->read(batch, BATCH);
+    if (n == 0) return;
+
+    printf("B %lu %u\n", (unsigned long)batch[0].seq, (unsigned)n);
+    for (size_t i = 0; i < n; ++i) {
+        printf("%lu %llu\n",
+               (unsigned long)batch[i].step_index,
+               (unsigned long long)batch[i].t_us);
+    }
+}
+
+// ------------------------------------------------------------
+// main
+// ------------------------------------------------------------
+
+int main() {
+    stdio_init_all();
+    sleep_ms(2000);
+
+    printf("\nRadarSync test ready.\n");
+    print_help();
+
+    // -------- motor (pio0) --------
+
+    PS100_P::Config mcfg{};
+    mcfg.step_pin   = STEP_PIN;
+    mcfg.dir_pin    = DIR_PIN;
+    mcfg.enable_pin = ENABLE_PIN;
+    mcfg.pio = pio0;
+    mcfg.sm  = 0;
+    mcfg.program_offset = motor_exec_ensure_program(mcfg.pio);
+
+    static PS100_P ps100(mcfg);
+    motor = &ps100;
+    motor->init();
+    motor->enable();
+
+    // -------- radar (pio1: motor_exec leaves no room on pio0) --------
+
+    RadarSync::Config rcfg{};
+    rcfg.step_pin    = STEP_PIN;
+    rcfg.trigger_pin = TRIGGER_PIN;
+    rcfg.pio = pio1;
+    rcfg.sm  = 0;              // Dual: counter sm0, pulse sm1
+
+    const int off_single = radar_sync_ensure_program(rcfg.pio, RadarSync::Mode::Single);
+    const int off_dual   = radar_sync_ensure_program(rcfg.pio, RadarSync::Mode::Dual);
+    if (off_single < 0 || off_dual < 0) {
+        printf("radar_sync: no program space\n");
+        return 0;
+    }
+
+    rcfg.mode           = RadarSync::Mode::Single;
+    rcfg.program_offset = (uint)off_single;
+    static RadarSync rs_single(rcfg);
+
+    rcfg.mode           = RadarSync::Mode::Dual;
+    rcfg.program_offset = (uint)off_dual;
+    static RadarSync rs_dual(rcfg);
+
+    radar_single = &rs_single;
+    radar_dual   = &rs_dual;
+
+    radar = radar_single;
+    if (!radar->init()) {
+        printf("radar_sync: no DMA channels\n");
+        return 0;
+    }
+
+    // -------- command loop --------
+
+    char line[128];
+
+    while (true) {
+        if (streaming) stream_batch();
+
+        if (!poll_line(line, sizeof(line))) {
+            tight_loop_contents();
+            continue;
+        }
+
+        // ------------------------------------------------
+        // arm
+        // ------------------------------------------------
+        if (strncmp(line, "arm ", 4) == 0) {
+            unsigned ratio, pulse_us;
+            if (sscanf(line, "arm %u %u", &ratio, &pulse_us) == 2) {
+                const uint32_t len = pulse_us_to_radar_len(pulse_us);
+                bool ok = radar->arm(ratio, len);
+                printf("arm: ratio=%u len=%lu -> %s\n",
+                       ratio, (unsigned long)len, ok ? "armed" : "failed");
+            }
+        }
+        // ------------------------------------------------
+        // disarm
+        // ------------------------------------------------
+        else if (strcmp(line, "disarm") == 0) {
+            radar->disarm();
+            if (streaming) stream_batch();   // flush what was captured
+            printf("disarmed\n");
+        }
+        // ------------------------------------------------
+        // mode (DMA channels follow the active instance)
+        // ------------------------------------------------
+        else if (strncmp(line, "mode ", 5) == 0) {
+            RadarSync* next = nullptr;
+            if (strcmp(line + 5, "single") == 0) next = radar_single;
+            if (strcmp(line + 5, "dual") == 0)   next = radar_dual;
+
+            if (!next) {
+                printf("Unknown mode\n");
+            } else if (next != radar) {
+                radar->deinit();
+                radar = next;
+                printf("mode=%s -> %s\n", line + 5, radar->init() ? "ok" : "no DMA");
+            }
+        }
+        // ------------------------------------------------
+        // run
+        // ------------------------------------------------
+        else if (strncmp(line, "run ", 4) == 0) {
+            unsigned hz, steps;
+            if (sscanf(line, "run %u %u", &hz, &steps) == 2) {
+                motor->run_steps(steps, hz, PS100_P::Backend::PIO);
+                printf("run: hz=%u steps=%u\n", hz, steps);
+            }
+        }
+        // ------------------------------------------------
+        // stream
+        // ------------------------------------------------
+        else if (strcmp(line, "stream on") == 0) {
+            streaming = true;
+            printf("stream on\n");
+        }
+        else if (strcmp(line, "stream off") == 0) {
+            streaming = false;
+            printf("stream off\n");
+        }
+        // ------------------------------------------------
+        // status
+        // ------------------------------------------------
+        else if (strcmp(line, "status") == 0) {
+            printf("armed=%d  pending=%u  delivered=%lu%s\n",
+                   radar->armed() ? 1 : 0,
+                   (unsigned)radar->pending(),
+                   (unsigned long)radar->delivered(),
+                   radar->overrun() ? "  (OVERRUN: re-arm)" : "");
+        }
+        // ------------------------------------------------
+        // help
+        // ------------------------------------------------
+        else if (strcmp(line, "help") == 0) {
+            print_help();
+        }
+        // ------------------------------------------------
+        else {
+            printf("Unknown command. Type 'help'.\n");
+        }
+    }
+}
@@ -0,0 +1,172 @@
+#include "axis_queue.hpp"
+
+#include "hardware/sync.h"   // __dmb
+
+// ------------------------------------------------------------
+// helpers
+// ------------------------------------------------------------
+
+namespace {
+
+constexpr uint32_t QUEUE_MASK = AxisQueue::DEPTH - 1u;
+
+static_assert((AxisQueue::DEPTH & QUEUE_MASK) == 0, "DEPTH must be a power of 2");
+static_assert(AxisQueue::RING_HALF % 2 == 0, "raw ring halves hold whole commands");
+
+} // namespace
+
+// ------------------------------------------------------------
+// ctor
+// ------------------------------------------------------------
+
+AxisQueue::AxisQueue(const Config& cfg)
+    : cfg_(cfg) {}
+
+// ------------------------------------------------------------
+// producer
+// ------------------------------------------------------------
+
+bool AxisQueue::push(const Segment& seg) {
+    if (seg.hz == 0 || seg.steps == 0) return false;
+    if (free_slots() == 0) return false;
+
+    const uint32_t h = head_;
+    Block& blk = q_[h & QUEUE_MASK];
+
+    // 之前的段都已走完（done_ == head_）：轴已停下，从 0 起步
+    const bool     cont = (done_ != h) && (last_dir_ == seg.forward);
+    const uint32_t v0   = cont ? last_hz_ : 0u;
+
+    // blend v0 -> seg.hz over the first steps, rest at seg.hz
+    const size_t n = motor_exec_blend_segment(cfg_.motor->timing(), v0, seg.hz, seg.steps,
+                                              cfg_.a_max, MAX_BLEND_CMDS,
+                                              reinterpret_cast<uint32_t*>(blk.cmds),
+                                              2 * (MAX_BLEND_CMDS + 1));
+    if (n == 0) return false;
+
+    blk.len     = (uint8_t)(n / 2);
+    blk.forward = seg.forward;
+    blk.steps   = seg.steps;   // blending keeps the total exact
+
+    last_hz_  = seg.hz;
+    last_dir_ = seg.forward;
+
+    __dmb();                 // block visible before the index
+    head_ = h + 1u;
+    return true;
+}
+
+size_t AxisQueue::queued() const {
+    return (size_t)(head_ - tail_);
+}
+
+size_t AxisQueue::free_slots() const {
+    return DEPTH - queued();
+}
+
+// ------------------------------------------------------------
+// consumer
+// ------------------------------------------------------------
+
+void AxisQueue::poll() {
+    if (running_) {
+        track_done();
+
+        // ring 因队列空而结束、队首仍是同方向：接在 SM 剩余命令之后，不等排空
+        if (ring_dry_ && queued() > 0) {
+            __dmb();
+            if (q_[tail_ & QUEUE_MASK].forward == dir_) {
+                ring_dry_ = false;
+                if (cfg_.motor->resume_pio_ring()) return;
+            }
+        }
+
+        if (cfg_.motor->busy()) return;
+        running_ = false;
+        done_    = tail_;    // ring drained: every copied block has gone out
+    }
+
+    if (queued() == 0) return;
+    __dmb();
+
+    // 新一轮：方向取自队首，之后同方向的块由 refill 连续接上
+    dir_       = q_[tail_ & QUEUE_MASK].forward;
+    cur_       = nullptr;
+    cmd_pos_   = 0;
+    run_steps_ = 0;      // steps_done() restarts with the ring
+    ring_dry_  = false;
+
+    cfg_.motor->set_direction(dir_);
+    running_ = cfg_.motor->run_pio_ring(ring_, RING_HALF, &AxisQueue::refill, this,
+                                        MotorExecFormat::Raw);
+
+    // ring 未能启动（无 DMA）：首个半区已消耗的块无法找回，整体丢弃
+    if (!running_) flush_stop();
+}
+
+void AxisQueue::flush_stop(uint32_t upto) {
+    // stop() 释放 ring：之后不会再有 refill 与这里竞争 tail_
+    cfg_.motor->stop();
+
+    // 只丢弃 upto 之前入队的块（之后 push 的保留）
+    const uint32_t t = tail_;
+    if (upto - t <= (uint32_t)queued()) tail_ = upto;
+
+    running_ = false;
+    cur_     = nullptr;
+    cmd_pos_ = 0;
+    done_    = tail_;    // dropped segments count as done (host resyncs on it)
+}
+
+void AxisQueue::track_done() {
+    // ID < tail_：块已整块拷入 ring，run_end_ 已由 refill 写好
+    const uint32_t steps = cfg_.motor->steps_done();
+    const uint32_t t     = tail_;
+    uint32_t       d     = done_;
+
+    while (d != t && steps >= run_end_[d & QUEUE_MASK]) ++d;
+    done_ = d;
+}
+
+size_t AxisQueue::refill(uint32_t* dst, size_t capacity, void* user) {
+    return static_cast<AxisQueue*>(user)->emit(dst, capacity);
+}
+
+size_t AxisQueue::emit(uint32_t* dst, size_t capacity) {
+    size_t n = 0;
+
+    while (n + 2 <= capacity) {
+        if (!cur_ && !load_next()) break;
+
+        dst[n++] = cur_->cmds[cmd_pos_].duty;
+        dst[n++] = cur_->cmds[cmd_pos_].steps;
+
+        if (++cmd_pos_ == cur_->len) {
+            // 块已拷完才释放槽位
+            cur_     = nullptr;
+            cmd_pos_ = 0;
+            __dmb();
+            tail_ = tail_ + 1u;
+        }
+    }
+
+    // 0 => ring ends here; poll() re-links it if the same direction follows
+    ring_dry_ = (n == 0);
+    return n;
+}
+
+bool AxisQueue::load_next() {
+    const uint32_t t = tail_;
+    if (t == head_) return false;
+
+    __dmb();                 // index read before the block
+    const Block* blk = &q_[t & QUEUE_MASK];
+    if (blk->forward != dir_) return false;   // 换向：本轮结束
+
+    cur_     = blk;
+    cmd_pos_ = 0;
+
+    run_steps_ += blk->steps;
+    run_end_[t & QUEUE_MASK] = run_steps_;
+    return true;
+}
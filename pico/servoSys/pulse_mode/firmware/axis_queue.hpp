@@ -0,0 +1,142 @@
+#pragma once
+
+#include "drivers/ps100.hpp"
+#include <cstdint>
+#include <cstddef>
+
+// ============================================================
+// AxisQueue
+//   - Per-axis FIFO of prepared motion blocks, executed back to back
+//   - Execution is ONE motor_exec ring stream per direction run:
+//       the ring refill (DMA IRQ) copies the next queued blocks
+//       while the current half is playing
+//       => no gap between segments, no host round trip in the loop
+//   - A block queued after the ring ran dry (queue empty) is re-linked
+//     by poll() behind the commands still in the SM, no stop / restart
+//   - Only a direction change ends the run (DIR is a GPIO, not
+//     in-stream); poll() starts the next run with the new direction
+//   - No heap: queue, ring buffer and encoder state live here
+//
+// Two sides (may run on different cores, see core1_exec):
+//   producer : push() compiles a segment into a block of motor_exec
+//              commands (planning, float math)
+//   consumer : poll() / flush_stop() / ring refill, words only
+//   Indices are volatile, slots are published with __dmb().
+//
+// Segment IDs / credits (telemetry, lock-free reads from either side):
+//   the k-th pushed segment has ID k (head() before the push)
+//   done()         : first segment not yet fully stepped out
+//                    (= the one executing, or the next one when idle);
+//                    tracked by poll() from the hardware step counter
+//   credit_limit() : IDs below it fit into the queue right now
+//                    (tail + DEPTH, a slot frees when its block has
+//                    been copied into the ring)
+//
+// Lookahead blending (a_max > 0):
+//   between two consecutive segments of one direction the speed
+//   change is spread over the first steps of the new segment as a
+//   linear velocity ramp (v^2 linear in distance, limited by a_max,
+//   up to MAX_BLEND_CMDS sub-commands, motor_exec_blend_segment).
+//   Step counts stay exact.
+//   The reference speed is the previously queued segment while any
+//   segment is still pending (done() != head()); a segment pushed
+//   after everything has stepped out starts from rest.
+// ============================================================
+
+class AxisQueue {
+public:
+    static constexpr size_t DEPTH          = 32;   // segments (power of 2)
+    static constexpr size_t RING_HALF      = 16;   // words per ring half (8 raw commands)
+    static constexpr size_t MAX_BLEND_CMDS = 8;
+
+    struct Segment {
+        uint32_t hz;       // > 0
+        uint32_t steps;    // > 0
+        bool     forward;
+    };
+
+    struct Config {
+        PS100_P* motor;            // PIO-capable axis (REQUIRED)
+        uint32_t a_max = 0;        // steps/s^2 for blending, 0 = off
+    };
+
+public:
+    explicit AxisQueue(const Config& cfg);
+
+    // ------------------------------------------------------------
+    // producer
+    // ------------------------------------------------------------
+    bool   push(const Segment& seg);   // false when full / invalid
+    size_t free_slots() const;
+    size_t queued() const;
+
+    uint32_t head() const { return head_; }
+
+    uint32_t done() const { return done_; }
+    uint32_t credit_limit() const { return tail_ + (uint32_t)DEPTH; }
+
+    // forget the blend reference (segments after a stop start fresh)
+    void reset_blend() { last_hz_ = 0; }
+
+    // ------------------------------------------------------------
+    // consumer
+    // ------------------------------------------------------------
+    // re-link a dry ring / start the next direction run when idle
+    void poll();
+
+    // stop motion now and drop blocks queued before head `upto`
+    void flush_stop(uint32_t upto);
+    void flush_stop() { flush_stop(head_); }
+
+    bool running() const { return running_; }
+
+private:
+    static size_t refill(uint32_t* dst, size_t capacity, void* user);
+    size_t emit(uint32_t* dst, size_t capacity);
+
+    // next queued block becomes current (false: none / other dir)
+    bool load_next();
+
+    // advance done_ along the step counter of the running ring
+    void track_done();
+
+private:
+    struct Cmd {              // one raw motor_exec command
+        uint32_t duty;
+        uint32_t steps;
+    };
+    static_assert(sizeof(Cmd) == 2 * sizeof(uint32_t), "Cmd must match the raw word layout");
+
+    struct Block {
+        Cmd      cmds[MAX_BLEND_CMDS + 1];
+        uint32_t steps;       // sum of cmds[].steps
+        uint8_t  len;
+        bool     forward;
+    };
+
+    Config cfg_;
+
+    // ---------- SPSC queue ----------
+    Block             q_[DEPTH]{};
+    volatile uint32_t head_ = 0;   // written by producer
+    volatile uint32_t tail_ = 0;   // written by consumer
+
+    // ---------- producer state ----------
+    uint32_t last_hz_  = 0;        // blend reference (0 = none)
+    bool     last_dir_ = true;
+
+    // ---------- consumer state ----------
+    uint32_t ring_[2 * RING_HALF]{};
+    bool     running_ = false;
+    bool     dir_     = true;
+
+    volatile bool ring_dry_ = false;   // refill returned 0 (written in the DMA IRQ)
+
+    const Block* cur_     = nullptr;   // block being copied (slot not yet released)
+    uint8_t      cmd_pos_ = 0;
+
+    // ---------- progress (consumer writes, anyone reads) ----------
+    uint32_t          run_steps_ = 0;    // steps copied into the ring this run
+    uint32_t          run_end_[DEPTH]{}; // per ID: run step count at its last step
+    volatile uint32_t done_      = 0;
+};
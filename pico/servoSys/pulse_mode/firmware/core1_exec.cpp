@@ -0,0 +1,87 @@
+#include "core1_exec.hpp"
+
+#include "pico/multicore.h"
+
+// ------------------------------------------------------------
+// helpers
+// ------------------------------------------------------------
+
+namespace {
+
+// FIFO word: [31:28] op | [27:24] axis | [23:0] head (low bits)
+constexpr uint32_t OP_STOP    = 0x1u;
+constexpr uint32_t OP_READY   = 0xAu;     // core1 -> core0, once
+constexpr uint32_t HEAD_MASK  = 0x00FFFFFFu;
+
+static PS100_P*   g_motors[CORE1_EXEC_MAX_AXES] = {};
+static AxisQueue* g_queues[CORE1_EXEC_MAX_AXES] = {};
+static size_t     g_axes = 0;
+
+static inline uint32_t make_msg(uint32_t op, size_t axis, uint32_t head) {
+    return (op << 28) | ((uint32_t)(axis & 0xFu) << 24) | (head & HEAD_MASK);
+}
+
+static void handle_msg(uint32_t msg) {
+    const uint32_t op   = msg >> 28;
+    const size_t   axis = (msg >> 24) & 0xFu;
+
+    if (op != OP_STOP || axis >= g_axes) return;
+
+    // 24 bit head 还原为完整索引：head - tail <= DEPTH，差值不会溢出 24 bit
+    AxisQueue* q = g_queues[axis];
+    const uint32_t h = q->head();
+    const uint32_t upto = h - ((h - msg) & HEAD_MASK);
+    q->flush_stop(upto);
+}
+
+static void core1_main() {
+    // 所有硬件归 core1：IRQ handler 在这里首次 run 时安装到本核
+    for (size_t i = 0; i < g_axes; ++i) {
+        g_motors[i]->init();
+        g_motors[i]->enable();
+    }
+
+    multicore_fifo_push_blocking(make_msg(OP_READY, 0, 0));
+
+    while (true) {
+        while (multicore_fifo_rvalid()) {
+            handle_msg(multicore_fifo_pop_blocking());
+        }
+
+        for (size_t i = 0; i < g_axes; ++i) {
+            g_queues[i]->poll();
+        }
+
+        tight_loop_contents();
+    }
+}
+
+} // namespace
+
+// ------------------------------------------------------------
+// Public API
+// ------------------------------------------------------------
+
+void core1_exec_launch(PS100_P* const* motors, AxisQueue* const* queues, size_t axes) {
+    if (axes > CORE1_EXEC_MAX_AXES) axes = CORE1_EXEC_MAX_AXES;
+
+    for (size_t i = 0; i < axes; ++i) {
+        g_motors[i] = motors[i];
+        g_queues[i] = queues[i];
+    }
+    g_axes = axes;
+
+    multicore_launch_core1(core1_main);
+
+    // 等待 core1 完成初始化（之后 core0 不再碰 PS100_P）
+    while ((multicore_fifo_pop_blocking() >> 28) != OP_READY) {
+    }
+}
+
+void core1_exec_stop(size_t axis) {
+    if (axis >= g_axes) return;
+
+    // 在 core0 侧记录当前 head：只丢弃此刻之前入队的块
+    multicore_fifo_push_blocking(make_msg(OP_STOP, axis, g_queues[axis]->head()));
+    g_queues[axis]->reset_blend();
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "drivers/ps100.hpp"
+#include "firmware/axis_queue.hpp"
+#include <cstdint>
+#include <cstddef>
+
+// ============================================================
+// core1 execution context
+//
+//   core0 : USB, frame parsing, planning (AxisQueue::push)
+//   core1 : owns every PS100_P: init / enable, AxisQueue::poll,
+//           ring refill (DMA_IRQ_0) and PWM IRQs
+//
+// IRQ handlers are installed and enabled by whichever core first
+// starts a ring / PWM run; all of that happens on core1 here, so
+// USB IRQs on core0 can never delay a refill or a wrap IRQ.
+//
+// Hand-over:
+//   motion  : AxisQueue SPSC blocks (prepared on core0)
+//   control : inter-core FIFO words (stop)
+// Nothing else is shared; PS100_P must not be touched from core0
+// after core1_exec_launch() (position() is the lock-free exception).
+// ============================================================
+
+constexpr size_t CORE1_EXEC_MAX_AXES = 8;
+
+// starts core1; returns once every axis is initialized
+// motors / queues: `axes` entries, kept alive by the caller
+void core1_exec_launch(PS100_P* const* motors, AxisQueue* const* queues, size_t axes);
+
+// core0: stop `axis` and drop what was queued before this call
+void core1_exec_stop(size_t axis);
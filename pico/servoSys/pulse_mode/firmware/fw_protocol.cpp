@@ -0,0 +1,113 @@
+#include "fw_protocol.hpp"
+
+// ------------------------------------------------------------
+// helpers
+// ------------------------------------------------------------
+
+namespace {
+
+static inline bool is_header(uint8_t b) {
+    return b == FW_HEADER_PULSE || b == FW_HEADER_TIME || b == FW_HEADER_CONTROL;
+}
+
+// 按字节拼装，不依赖结构体布局（Arduino 版 memcpy 到带 padding 的结构体）
+static inline int32_t read_le32(const uint8_t* p) {
+    return (int32_t)((uint32_t)p[0]
+                   | ((uint32_t)p[1] << 8)
+                   | ((uint32_t)p[2] << 16)
+                   | ((uint32_t)p[3] << 24));
+}
+
+static inline void write_le16(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static inline void write_le32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+} // namespace
+
+// ------------------------------------------------------------
+// parser
+// ------------------------------------------------------------
+
+bool FwFrameParser::feed(uint8_t byte, uint64_t now_us, FwFrame& out) {
+    // 半帧超时：丢弃，避免与下一帧拼接
+    if (len_ > 0 && now_us - last_us_ > FW_FRAME_TIMEOUT_US) {
+        len_ = 0;
+    }
+    last_us_ = now_us;
+
+    if (len_ == 0) {
+        if (is_header(byte)) buf_[len_++] = byte;
+        return false;
+    }
+
+    buf_[len_++] = byte;
+    if (len_ < FW_FRAME_LENGTH) return false;
+
+    len_ = 0;
+
+    out.header = buf_[0];
+    out.mask   = buf_[1];
+    out.arg    = buf_[2];
+    out.a      = read_le32(&buf_[3]);
+    out.b      = read_le32(&buf_[7]);
+    return true;
+}
+
+// ------------------------------------------------------------
+// reply
+// ------------------------------------------------------------
+
+size_t fw_encode_reply(FwStatus status,
+                       const uint8_t* free_slots,
+                       size_t axes,
+                       uint8_t* out,
+                       size_t capacity) {
+    if (!out || capacity < 2 + axes) return 0;
+
+    size_t n = 0;
+    out[n++] = FW_HEADER_REPLY;
+    out[n++] = (uint8_t)status;
+    for (size_t i = 0; i < axes; ++i) {
+        out[n++] = free_slots ? free_slots[i] : 0;
+    }
+    return n;
+}
+
+// ------------------------------------------------------------
+// telemetry
+// ------------------------------------------------------------
+
+size_t fw_encode_telemetry(uint8_t seq,
+                           uint32_t t_us,
+                           const FwAxisTelemetry* axes,
+                           size_t count,
+                           uint8_t* out,
+                           size_t capacity) {
+    const size_t len = FW_TELEMETRY_HEADER + FW_TELEMETRY_AXIS * count;
+    if (!out || !axes || count > 0xFF || capacity < len) return 0;
+
+    out[0] = FW_HEADER_TELEMETRY;
+    out[1] = seq;
+    out[2] = (uint8_t)count;
+    write_le32(&out[3], t_us);
+
+    uint8_t* p = out + FW_TELEMETRY_HEADER;
+    for (size_t i = 0; i < count; ++i, p += FW_TELEMETRY_AXIS) {
+        const FwAxisTelemetry& a = axes[i];
+        const uint32_t depth = a.head - a.segment;
+
+        write_le32(&p[0], (uint32_t)a.position);
+        write_le16(&p[4], a.segment);
+        p[6] = (uint8_t)((depth > 0xFFu) ? 0xFFu : depth);
+        write_le16(&p[7], a.limit);
+    }
+    return len;
+}
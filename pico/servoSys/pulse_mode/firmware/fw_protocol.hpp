@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+// ============================================================
+// Binary command protocol (USB CDC)
+//
+// Same 11-byte frame as arduino/SerialMotor (little endian):
+//   [header][motorMask][arg][a:int32][b:int32]
+//
+//   0xAF  pulse mode : arg = directionMask, a = speed_hz, b = pulses
+//   0xBF  time mode  : arg = directionMask, a = speed_hz, b = duration_ms
+//   0xCF  control    : arg = FwControl,     a / b reserved (0)
+//
+// Difference to the Arduino firmware: motion frames are QUEUED per
+// axis (executed back to back), not last-command-wins. Use
+// FwControl::Stop to abort + flush.
+//
+// Every frame is answered by one reply frame:
+//   [0xFA][FwStatus][free slots axis 0]...[free slots axis N-1]
+// so the host can keep each queue topped up without a round trip
+// per segment.
+//
+// Telemetry (FwControl::Telemetry, a = period_us, 0 = off):
+//   [0xFB][seq u8][axes u8][t_us u32]
+//   then per axis [position i32][segment u16][depth u8][limit u16]
+//     segment : ID of the segment executing (AxisQueue::done())
+//     depth   : accepted but not finished (saturated to 255)
+//     limit   : credit limit, the host may send segment IDs < limit
+//   Credit-based flow control: the host counts the segments it sent
+//   per axis (= their IDs) and keeps sending while ID < limit, without
+//   waiting for a reply. With FW_TELEMETRY_QUIET in b, accepted motion
+//   frames are not answered at all (rejections still are).
+//
+// FwControl::TraceDump: the reply is followed by one trace block per
+// core (trace/trace.hpp, decoded by trace/trace_dump.py); BadArgs when
+// built without PULSE_MODE_TRACE.
+//
+// Framing: resync on a header byte; a partial frame is dropped after
+// FW_FRAME_TIMEOUT_US without a byte (stale bytes never merge with
+// the next frame).
+// ============================================================
+
+constexpr uint8_t FW_HEADER_PULSE   = 0xAF;
+constexpr uint8_t FW_HEADER_TIME    = 0xBF;
+constexpr uint8_t FW_HEADER_CONTROL = 0xCF;
+constexpr uint8_t FW_HEADER_REPLY   = 0xFA;
+constexpr uint8_t FW_HEADER_TELEMETRY = 0xFB;
+
+constexpr size_t   FW_FRAME_LENGTH     = 11;
+constexpr uint32_t FW_FRAME_TIMEOUT_US = 20000;
+
+constexpr size_t   FW_TELEMETRY_HEADER        = 7;
+constexpr size_t   FW_TELEMETRY_AXIS          = 9;
+constexpr uint32_t FW_TELEMETRY_MIN_PERIOD_US = 250;   // 4 kHz: ~100 kB/s, batched USB
+constexpr uint32_t FW_TELEMETRY_QUIET         = 1u << 0;   // b flag
+
+enum class FwControl : uint8_t {
+    Stop      = 0,   // stop masked axes, flush their queues
+    Status    = 1,   // reply only
+    TraceDump = 2,   // reply + drained trace rings (mask ignored)
+    Telemetry = 3    // a = period_us (0 = off), b = FW_TELEMETRY_* flags
+};
+
+enum class FwStatus : uint8_t {
+    Ok      = 0,
+    Full    = 1,  // not queued: a masked axis has no free slot (all-or-nothing)
+    BadArgs = 2   // unknown control / invalid values
+};
+
+struct FwFrame {
+    uint8_t header;
+    uint8_t mask;
+    uint8_t arg;
+    int32_t a;
+    int32_t b;
+};
+
+// ------------------------------------------------------------
+// Accumulating parser (byte at a time, never blocks)
+// ------------------------------------------------------------
+class FwFrameParser {
+public:
+    // true when `out` holds a complete frame
+    bool feed(uint8_t byte, uint64_t now_us, FwFrame& out);
+
+    void reset() { len_ = 0; }
+
+private:
+    uint8_t  buf_[FW_FRAME_LENGTH]{};
+    size_t   len_     = 0;
+    uint64_t last_us_ = 0;
+};
+
+// reply: 2 + axes bytes, returns bytes written
+size_t fw_encode_reply(FwStatus status,
+                       const uint8_t* free_slots,
+                       size_t axes,
+                       uint8_t* out,
+                       size_t capacity);
+
+// one axis of a telemetry frame (full-width counters, truncated on the wire)
+struct FwAxisTelemetry {
+    int32_t  position;
+    uint32_t segment;   // AxisQueue::done()
+    uint32_t head;      // AxisQueue::head()
+    uint32_t limit;     // AxisQueue::credit_limit()
+};
+
+// telemetry: FW_TELEMETRY_HEADER + FW_TELEMETRY_AXIS * axes bytes,
+// returns bytes written (0 if capacity is too small)
+size_t fw_encode_telemetry(uint8_t seq,
+                           uint32_t t_us,
+                           const FwAxisTelemetry* axes,
+                           size_t count,
+                           uint8_t* out,
+                           size_t capacity);
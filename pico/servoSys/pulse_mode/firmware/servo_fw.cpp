@@ -0,0 +1,267 @@
+#include "pico/stdlib.h"
+
+#include "drivers/ps100.hpp"
+#include "drivers/axis_manager.hpp"
+#include "firmware/fw_protocol.hpp"
+#include "firmware/axis_queue.hpp"
+#include "firmware/core1_exec.hpp"
+#include "firmware/usb_link.hpp"
+#include "trace/trace.hpp"
+
+// ============================================================
+// servo_fw: production firmware
+//   USB CDC binary frames (fw_protocol.hpp) -> per-axis AxisQueue
+//   -> motor_exec ring streams, segments back to back.
+//   USB is TinyUSB CDC with batched 64-byte packets (usb_link.hpp).
+//
+//   core0: USB + parsing + planning (push), core1: execution
+//   (see core1_exec.hpp).
+// ============================================================
+
+// ------------------------------------------------------------
+// configuration (adjust to your wiring)
+// ------------------------------------------------------------
+
+static constexpr size_t NUM_AXES = 2;   // motorMask bit 0 / 1, as on the Arduino rail
+
+struct AxisPins {
+    uint step;
+    uint dir;
+    uint enable;
+};
+
+static constexpr AxisPins AXIS_PINS[NUM_AXES] = {
+    { 3, 4, static_cast<uint>(-1) },
+    { 5, 6, static_cast<uint>(-1) },
+};
+
+// blending acceleration between queued segments (steps/s^2), 0 = off
+static constexpr uint32_t BLEND_A_MAX = 200000;
+
+// ------------------------------------------------------------
+// globals
+// ------------------------------------------------------------
+
+static PS100_P*   motors[NUM_AXES] = {};
+static AxisQueue* queues[NUM_AXES] = {};
+
+static AxisManager axis_manager;
+
+// telemetry (FwControl::Telemetry), core0 only
+static uint32_t telemetry_period_us = 0;   // 0 = off
+static uint64_t telemetry_next_us   = 0;
+static uint8_t  telemetry_seq       = 0;
+static bool     quiet_motion        = false;   // credit mode: no reply for accepted motion frames
+
+// ------------------------------------------------------------
+// helpers
+// ------------------------------------------------------------
+
+// SM / program / position SM / PWM slice from the resource manager:
+// a wiring that does not fit the chip stops here, not in the field
+static PS100_P::Config axis_config(size_t i) {
+    AxisManager::AxisRequest req{};
+    req.step_pin   = AXIS_PINS[i].step;
+    req.dir_pin    = AXIS_PINS[i].dir;
+    req.enable_pin = AXIS_PINS[i].enable;
+
+    PS100_P::Config cfg{};
+    const AxisManager::Error err = axis_manager.allocate(req, cfg);
+    if (err != AxisManager::Error::Ok) {
+        panic("axis %u: %s", (unsigned)i, AxisManager::error_name(err));
+    }
+    return cfg;
+}
+
+static AxisQueue::Config queue_config(PS100_P* motor) {
+    AxisQueue::Config cfg{};
+    cfg.motor = motor;
+    cfg.a_max = BLEND_A_MAX;
+    return cfg;
+}
+
+static_assert(NUM_AXES == 2, "motor_objs / queue_objs initializers list every axis");
+
+static inline uint32_t abs32(int32_t v) {
+    return (v < 0) ? (uint32_t)(-(int64_t)v) : (uint32_t)v;
+}
+
+static void send_reply(FwStatus status) {
+    uint8_t free_slots[NUM_AXES];
+    for (size_t i = 0; i < NUM_AXES; ++i) {
+        const size_t f = queues[i]->free_slots();
+        free_slots[i] = (uint8_t)((f > 0xFF) ? 0xFF : f);
+    }
+
+    uint8_t out[2 + NUM_AXES];
+    const size_t n = fw_encode_reply(status, free_slots, NUM_AXES, out, sizeof(out));
+
+    // the host waits for it: out at the end of this RX batch, not after the batch timeout
+    usb_link_write(out, n);
+    usb_link_flush();
+}
+
+// motion frame: all masked axes get the segment, or none does
+static FwStatus handle_motion(const FwFrame& f) {
+    const uint32_t hz = abs32(f.a);
+    const uint32_t b  = abs32(f.b);
+
+    const uint32_t steps = (f.header == FW_HEADER_PULSE)
+                         ? b
+                         : (uint32_t)(((uint64_t)hz * b + 500u) / 1000u);   // BF: ms -> steps
+
+    if (hz == 0 || steps == 0) return FwStatus::BadArgs;
+
+    for (size_t i = 0; i < NUM_AXES; ++i) {
+        if ((f.mask & (1u << i)) && queues[i]->free_slots() == 0) return FwStatus::Full;
+    }
+
+    for (size_t i = 0; i < NUM_AXES; ++i) {
+        if (!(f.mask & (1u << i))) continue;
+
+        AxisQueue::Segment seg{};
+        seg.hz      = hz;
+        seg.steps   = steps;
+        seg.forward = (f.arg & (1u << i)) != 0;
+        queues[i]->push(seg);
+    }
+    return FwStatus::Ok;
+}
+
+// position / segment / credits of every axis, sampled back to back
+// (AxisQueue counters and position() are lock-free reads of core1 state)
+static void send_telemetry(uint64_t now_us) {
+    FwAxisTelemetry axes[NUM_AXES];
+    for (size_t i = 0; i < NUM_AXES; ++i) {
+        axes[i].segment  = queues[i]->done();
+        axes[i].head     = queues[i]->head();
+        axes[i].limit    = queues[i]->credit_limit();
+        axes[i].position = motors[i]->position();
+    }
+
+    uint8_t out[FW_TELEMETRY_HEADER + FW_TELEMETRY_AXIS * NUM_AXES];
+    const size_t n = fw_encode_telemetry(telemetry_seq++, (uint32_t)now_us,
+                                         axes, NUM_AXES, out, sizeof(out));
+
+    // batched: several frames share a packet at high rates
+    usb_link_write(out, n);
+}
+
+static FwStatus handle_telemetry(const FwFrame& f) {
+    const uint32_t period = (uint32_t)f.a;
+    if (f.a < 0 || (period != 0 && period < FW_TELEMETRY_MIN_PERIOD_US)) return FwStatus::BadArgs;
+
+    telemetry_period_us = period;
+    telemetry_next_us   = time_us_64();   // first frame right away
+    quiet_motion        = period != 0 && ((uint32_t)f.b & FW_TELEMETRY_QUIET);
+    return FwStatus::Ok;
+}
+
+static FwStatus handle_control(const FwFrame& f) {
+    switch ((FwControl)f.arg) {
+        case FwControl::Stop:
+            for (size_t i = 0; i < NUM_AXES; ++i) {
+                if (f.mask & (1u << i)) core1_exec_stop(i);
+            }
+            return FwStatus::Ok;
+
+        case FwControl::Status:
+            return FwStatus::Ok;
+
+        case FwControl::TraceDump:
+            return PULSE_MODE_TRACE ? FwStatus::Ok : FwStatus::BadArgs;
+
+        case FwControl::Telemetry:
+            return handle_telemetry(f);
+
+        default:
+            return FwStatus::BadArgs;
+    }
+}
+
+#if PULSE_MODE_TRACE
+// one block per core; core1 keeps recording while its ring is drained
+static void send_trace() {
+    static uint8_t block[TRACE_BLOCK_HEADER + PULSE_MODE_TRACE_RING * sizeof(TraceRecord)];
+
+    for (uint32_t core = 0; core < NUM_CORES; ++core) {
+        const size_t n = trace_encode_block(core, block, sizeof(block));
+        if (!usb_link_write_all(block, n)) return;
+    }
+    usb_link_flush();
+}
+#endif
+
+static void handle_frame(const FwFrame& f) {
+    const FwStatus st = (f.header == FW_HEADER_CONTROL) ? handle_control(f)
+                                                         : handle_motion(f);
+
+    // credit mode: the host paces itself on the telemetry credit limit
+    const bool quiet = quiet_motion && f.header != FW_HEADER_CONTROL && st == FwStatus::Ok;
+    if (!quiet) send_reply(st);
+
+#if PULSE_MODE_TRACE
+    if (f.header == FW_HEADER_CONTROL && (FwControl)f.arg == FwControl::TraceDump) {
+        send_trace();
+    }
+#endif
+}
+
+// ------------------------------------------------------------
+// main
+// ------------------------------------------------------------
+
+int main() {
+    stdio_init_all();
+    usb_link_init();   // binary channel, no stdio on USB
+
+    // -------- axes: one motor_exec SM each (AxisManager) --------
+    static PS100_P motor_objs[NUM_AXES] = {
+        PS100_P(axis_config(0)),
+        PS100_P(axis_config(1)),
+    };
+
+    static AxisQueue queue_objs[NUM_AXES] = {
+        AxisQueue(queue_config(&motor_objs[0])),
+        AxisQueue(queue_config(&motor_objs[1])),
+    };
+
+    for (size_t i = 0; i < NUM_AXES; ++i) {
+        motors[i] = &motor_objs[i];
+        queues[i] = &queue_objs[i];
+    }
+
+    // init / enable / poll / IRQs all on core1 from here on
+    core1_exec_launch(motors, queues, NUM_AXES);
+
+    // -------- main loop (core0): parse + plan only --------
+    FwFrameParser parser;
+    FwFrame       frame{};
+    uint8_t       rx[USB_BATCH_PACKET];
+
+    while (true) {
+        usb_link_task();
+
+        // whole endpoint buffers: every frame of a batch is handled
+        // before the replies go out (one packet for all of them)
+        size_t n;
+        while ((n = usb_link_read(rx, sizeof(rx))) > 0) {
+            const uint64_t now = time_us_64();
+            for (size_t i = 0; i < n; ++i) {
+                if (parser.feed(rx[i], now, frame)) handle_frame(frame);
+            }
+        }
+
+        if (telemetry_period_us) {
+            const uint64_t now = time_us_64();
+            if ((int64_t)(now - telemetry_next_us) >= 0) {
+                send_telemetry(now);
+                // fixed rate; after a stall skip the missed frames, no burst
+                telemetry_next_us += telemetry_period_us;
+                if ((int64_t)(now - telemetry_next_us) >= 0) telemetry_next_us = now + telemetry_period_us;
+            }
+        }
+
+        tight_loop_contents();
+    }
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+// ============================================================
+// TinyUSB configuration of servo_fw (firmware/usb_link.hpp)
+//   one CDC ACM interface, device only, tud_task on core0
+// ============================================================
+
+#ifndef CFG_TUSB_OS
+#define CFG_TUSB_OS OPT_OS_PICO
+#endif
+
+#define CFG_TUSB_RHPORT0_MODE   (OPT_MODE_DEVICE)
+#define CFG_TUD_ENDPOINT0_SIZE  64
+
+#define CFG_TUD_CDC     1
+#define CFG_TUD_MSC     0
+#define CFG_TUD_HID     0
+#define CFG_TUD_MIDI    0
+#define CFG_TUD_VENDOR  0
+
+// FIFOs: several full packets per transfer (batched by UsbTxBatch)
+#define CFG_TUD_CDC_RX_BUFSIZE  512
+#define CFG_TUD_CDC_TX_BUFSIZE  512
+#define CFG_TUD_CDC_EP_BUFSIZE  256
@@ -0,0 +1,70 @@
+#include "usb_batch.hpp"
+
+#include <cstring>
+
+bool UsbTxBatch::write(const uint8_t* data, size_t n, uint64_t now_us) {
+    if (n == 0) return true;
+    if (n > space()) {
+        ++dropped_;
+        return false;
+    }
+
+    // stamp every packet slot this frame opens (or reopens after running empty)
+    if (pending() == 0 || head_ % USB_BATCH_PACKET == 0) stamp(head_) = now_us;
+    for (uint32_t pos = (head_ / USB_BATCH_PACKET + 1) * USB_BATCH_PACKET;
+         pos < head_ + n; pos += USB_BATCH_PACKET) {
+        stamp(pos) = now_us;
+    }
+
+    // at most two pieces around the end of the ring
+    const size_t at    = head_ & MASK;
+    const size_t first = (n < USB_BATCH_CAPACITY - at) ? n : USB_BATCH_CAPACITY - at;
+    std::memcpy(ring_ + at, data, first);
+    std::memcpy(ring_, data + first, n - first);
+
+    head_ += (uint32_t)n;
+    return true;
+}
+
+size_t UsbTxBatch::next_packet(const uint8_t*& p, uint64_t now_us) {
+    const size_t avail = pending();
+    if (avail == 0) {
+        flush_ = false;
+        return 0;
+    }
+
+    size_t n = USB_BATCH_PACKET;
+    if (avail < USB_BATCH_PACKET) {
+        const bool due = flush_ || now_us - stamp(tail_) >= USB_BATCH_FLUSH_US;
+        if (!due) return 0;
+        n = avail;
+    }
+
+    // contiguous in the ring (always, unless a short packet shifted the phase)
+    const size_t at = tail_ & MASK;
+    if (at + n <= USB_BATCH_CAPACITY) {
+        p = ring_ + at;
+    } else {
+        const size_t first = USB_BATCH_CAPACITY - at;
+        std::memcpy(pkt_, ring_ + at, first);
+        std::memcpy(pkt_ + first, ring_, n - first);
+        p = pkt_;
+    }
+    return n;
+}
+
+void UsbTxBatch::consume(size_t n) {
+    if (n > pending()) n = pending();
+    if (n == 0) return;
+
+    tail_ += (uint32_t)n;
+    if (n == USB_BATCH_PACKET) ++packets_;
+    else                       ++partial_;
+
+    if (pending() == 0) flush_ = false;
+}
+
+void UsbTxBatch::clear() {
+    tail_  = head_;
+    flush_ = false;
+}
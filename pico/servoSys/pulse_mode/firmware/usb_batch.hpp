@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+// ============================================================
+// USB TX batching (full-speed bulk: 64-byte packets)
+//
+//   Replies, telemetry and trace frames are appended to one byte
+//   ring; the endpoint side takes them out as FULL 64-byte packets.
+//   A partial packet is only released when it is due:
+//     - flush() was called (a reply the host is waiting for), or
+//     - its oldest byte is USB_BATCH_FLUSH_US old (low-rate traffic)
+//   so kHz telemetry costs one USB transaction per 64 bytes instead
+//   of one (plus a ZLP / short packet) per frame.
+//
+//   - no heap, no locks: producer and consumer are the same core
+//     (servo_fw core0 main loop)
+//   - pure logic (time passed in): runs in the sim as well
+//   - ring full: the frame is dropped whole and counted, never split
+// ============================================================
+
+constexpr size_t   USB_BATCH_PACKET   = 64;
+constexpr size_t   USB_BATCH_CAPACITY = 2048;   // power of 2, multiple of PACKET
+constexpr uint32_t USB_BATCH_FLUSH_US = 1000;   // one full-speed frame
+
+static_assert((USB_BATCH_CAPACITY & (USB_BATCH_CAPACITY - 1)) == 0,
+              "USB_BATCH_CAPACITY must be a power of two");
+static_assert(USB_BATCH_CAPACITY % USB_BATCH_PACKET == 0,
+              "USB_BATCH_CAPACITY must hold whole packets");
+
+class UsbTxBatch {
+public:
+    // append a whole frame; false (dropped) if it does not fit
+    bool write(const uint8_t* data, size_t n, uint64_t now_us);
+
+    // next packet to hand to the endpoint: USB_BATCH_PACKET bytes, or
+    // the partial tail once due; 0 = nothing to send yet.
+    // `p` stays valid until consume(); points into the ring, or into
+    // an internal packet buffer when the packet wraps around the ring
+    size_t next_packet(const uint8_t*& p, uint64_t now_us);
+
+    // n bytes of the last next_packet() were accepted by the endpoint
+    void consume(size_t n);
+
+    // release the partial tail at the next next_packet()
+    void flush() { flush_ = true; }
+
+    // host gone: drop what is pending (no stale burst on reconnect)
+    void clear();
+
+    size_t   pending() const { return (size_t)(head_ - tail_); }
+    size_t   space() const   { return USB_BATCH_CAPACITY - pending(); }
+    uint32_t dropped() const { return dropped_; }
+    uint32_t packets() const { return packets_; }   // full packets taken
+    uint32_t partial() const { return partial_; }   // short packets taken
+
+private:
+    static constexpr size_t MASK  = USB_BATCH_CAPACITY - 1;
+    static constexpr size_t SLOTS = USB_BATCH_CAPACITY / USB_BATCH_PACKET;
+
+    uint64_t& stamp(uint32_t byte) { return stamp_[(byte / USB_BATCH_PACKET) % SLOTS]; }
+
+    alignas(4) uint8_t ring_[USB_BATCH_CAPACITY]{};
+    alignas(4) uint8_t pkt_[USB_BATCH_PACKET]{};
+
+    // first write into each packet slot: age of the oldest pending byte
+    uint64_t stamp_[SLOTS]{};
+
+    uint32_t head_  = 0;          // free running byte counters
+    uint32_t tail_  = 0;
+    bool     flush_ = false;
+
+    uint32_t dropped_ = 0;
+    uint32_t packets_ = 0;
+    uint32_t partial_ = 0;
+};
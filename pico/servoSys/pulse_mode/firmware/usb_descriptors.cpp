@@ -0,0 +1,106 @@
+#include "tusb.h"
+#include "pico/unique_id.h"
+
+// ============================================================
+// USB descriptors of servo_fw: one CDC ACM interface.
+//   Same VID / PID as pico_stdio_usb, so the port shows up as it did
+//   with stdio (host scripts and drivers unchanged).
+// ============================================================
+
+namespace {
+
+constexpr uint16_t USBD_VID = 0x2E8A;   // Raspberry Pi
+constexpr uint16_t USBD_PID = 0x000A;   // Pico SDK CDC
+
+enum : uint8_t {
+    ITF_NUM_CDC = 0,
+    ITF_NUM_CDC_DATA,
+    ITF_NUM_TOTAL
+};
+
+constexpr uint8_t EPNUM_CDC_NOTIF = 0x81;
+constexpr uint8_t EPNUM_CDC_OUT   = 0x02;
+constexpr uint8_t EPNUM_CDC_IN    = 0x82;
+
+constexpr uint16_t CONFIG_TOTAL_LEN = TUD_CONFIG_DESC_LEN + TUD_CDC_DESC_LEN;
+
+enum : uint8_t {
+    STR_LANGID = 0,
+    STR_MANUFACTURER,
+    STR_PRODUCT,
+    STR_SERIAL,
+    STR_CDC,
+    STR_COUNT
+};
+
+static const tusb_desc_device_t desc_device = {
+    sizeof(tusb_desc_device_t),   // bLength
+    TUSB_DESC_DEVICE,             // bDescriptorType
+    0x0200,                       // bcdUSB
+    TUSB_CLASS_MISC,              // IAD: CDC control + data
+    MISC_SUBCLASS_COMMON,
+    MISC_PROTOCOL_IAD,
+    CFG_TUD_ENDPOINT0_SIZE,
+    USBD_VID,
+    USBD_PID,
+    0x0100,                       // bcdDevice
+    STR_MANUFACTURER,
+    STR_PRODUCT,
+    STR_SERIAL,
+    1                             // bNumConfigurations
+};
+
+static const uint8_t desc_configuration[] = {
+    TUD_CONFIG_DESCRIPTOR(1, ITF_NUM_TOTAL, 0, CONFIG_TOTAL_LEN, 0, 250),
+    TUD_CDC_DESCRIPTOR(ITF_NUM_CDC, STR_CDC, EPNUM_CDC_NOTIF, 8,
+                       EPNUM_CDC_OUT, EPNUM_CDC_IN, 64),
+};
+
+static const char* const strings[STR_COUNT] = {
+    nullptr,          // language id (below)
+    "Raspberry Pi",
+    "servo_fw",
+    nullptr,          // board unique id
+    "servo_fw CDC",
+};
+
+static uint16_t desc_str[1 + 2 * PICO_UNIQUE_BOARD_ID_SIZE_BYTES + 1];
+
+} // namespace
+
+uint8_t const* tud_descriptor_device_cb(void) {
+    return reinterpret_cast<uint8_t const*>(&desc_device);
+}
+
+uint8_t const* tud_descriptor_configuration_cb(uint8_t index) {
+    (void)index;
+    return desc_configuration;
+}
+
+uint16_t const* tud_descriptor_string_cb(uint8_t index, uint16_t langid) {
+    (void)langid;
+
+    uint8_t len = 0;
+    if (index == STR_LANGID) {
+        desc_str[1] = 0x0409;   // English (US)
+        len = 1;
+    } else {
+        char serial[2 * PICO_UNIQUE_BOARD_ID_SIZE_BYTES + 1];
+        const char* s = nullptr;
+
+        if (index == STR_SERIAL) {
+            pico_get_unique_board_id_string(serial, sizeof(serial));
+            s = serial;
+        } else if (index < STR_COUNT) {
+            s = strings[index];
+        }
+        if (!s) return nullptr;
+
+        const uint8_t max = (uint8_t)(sizeof(desc_str) / sizeof(desc_str[0]) - 1);
+        for (; s[len] && len < max; ++len) desc_str[1 + len] = (uint8_t)s[len];
+    }
+
+    // header: total length in bytes, string descriptor type
+    desc_str[0] = (uint16_t)((TUSB_DESC_STRING << 8) | (2u * len + 2u));
+    return desc_str;
+}
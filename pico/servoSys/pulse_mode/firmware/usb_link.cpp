@@ -0,0 +1,105 @@
+#include "usb_link.hpp"
+
+#include "pico/stdlib.h"
+#include "pico/bootrom.h"
+#include "tusb.h"
+
+// ------------------------------------------------------------
+// Internal state
+// ------------------------------------------------------------
+
+namespace {
+
+static UsbTxBatch tx;
+
+// due packets -> CDC FIFO. Only whole packets are written while more
+// data follows, so TinyUSB's own flush (FIFO >= one packet) never cuts
+// a short packet in the middle of a batch.
+static void drain() {
+    if (!tud_cdc_connected()) {
+        tx.clear();
+        return;
+    }
+
+    const uint64_t now = time_us_64();
+    const uint8_t* p   = nullptr;
+    size_t         n;
+    bool           wrote = false;
+
+    while ((n = tx.next_packet(p, now)) != 0) {
+        if (tud_cdc_write_available() < n) break;   // endpoint busy: next task round
+
+        tud_cdc_write(p, (uint32_t)n);
+        tx.consume(n);
+        wrote = true;
+        if (n < USB_BATCH_PACKET) break;            // short packet ends the transfer
+    }
+
+    if (wrote) tud_cdc_write_flush();
+}
+
+} // namespace
+
+// ------------------------------------------------------------
+// Public API
+// ------------------------------------------------------------
+
+void usb_link_init() {
+    tusb_init();
+}
+
+void usb_link_task() {
+    tud_task();
+    drain();
+}
+
+bool usb_link_connected() {
+    return tud_cdc_connected();
+}
+
+size_t usb_link_read(uint8_t* dst, size_t capacity) {
+    if (!tud_cdc_available()) return 0;
+    return tud_cdc_read(dst, (uint32_t)capacity);
+}
+
+bool usb_link_write(const uint8_t* data, size_t n) {
+    if (!tud_cdc_connected()) return false;
+    return tx.write(data, n, time_us_64());
+}
+
+bool usb_link_write_all(const uint8_t* data, size_t n) {
+    while (n) {
+        if (!tud_cdc_connected()) return false;
+
+        size_t k = tx.space();
+        if (k == 0) {
+            tx.flush();
+            usb_link_task();
+            continue;
+        }
+        if (k > n) k = n;
+
+        tx.write(data, k, time_us_64());
+        data += k;
+        n    -= k;
+    }
+    return true;
+}
+
+void usb_link_flush() {
+    tx.flush();
+}
+
+const UsbTxBatch& usb_link_tx() {
+    return tx;
+}
+
+// ------------------------------------------------------------
+// TinyUSB callbacks
+// ------------------------------------------------------------
+
+// 1200 baud "touch": reboot into BOOTSEL, as pico_stdio_usb does
+void tud_cdc_line_coding_cb(uint8_t itf, cdc_line_coding_t const* coding) {
+    (void)itf;
+    if (coding->bit_rate == 1200) reset_usb_boot(0, 0);
+}
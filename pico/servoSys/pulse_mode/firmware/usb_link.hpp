@@ -0,0 +1,45 @@
+#pragma once
+
+#include "firmware/usb_batch.hpp"
+
+#include <cstdint>
+#include <cstddef>
+
+// ============================================================
+// servo_fw USB link: TinyUSB CDC, no pico_stdio_usb
+//
+//   stdio (printf / getchar_timeout_us / putchar_raw) takes a mutex
+//   and walks the stack once per byte, and flushes every frame as its
+//   own short packet. Here:
+//     RX : whole endpoint buffers (tud_cdc_read), parsed in place
+//     TX : frames batched into full 64-byte packets (UsbTxBatch);
+//          replies flush at the end of the RX batch that caused them
+//   The device enumerates as before (CDC ACM, same VID / PID), so the
+//   host side (pyserial, rail_stream.py) is unchanged; 1200 baud still
+//   reboots into BOOTSEL (picotool / IDE upload).
+//
+//   core0 only (tud_task runs in usb_link_task, not in an IRQ).
+// ============================================================
+
+void usb_link_init();
+
+// main loop: device task + hand due packets to the endpoint
+void usb_link_task();
+
+bool usb_link_connected();
+
+// received bytes, up to `capacity`; 0 if none
+size_t usb_link_read(uint8_t* dst, size_t capacity);
+
+// one frame into the TX batch; false: dropped (batch full / no host)
+bool usb_link_write(const uint8_t* data, size_t n);
+
+// large block (trace dump): pumps the device until all of it is
+// batched; returns early (false) if the host goes away
+bool usb_link_write_all(const uint8_t* data, size_t n);
+
+// send the partial packet at the next usb_link_task()
+void usb_link_flush();
+
+// counters (dropped frames, full / short packets)
+const UsbTxBatch& usb_link_tx();
@@ -0,0 +1,31 @@
+#include "pio/motor_exec_variants.hpp"
+
+#include "motor_exec_ajustable_duty_cycle.pio.h"
+
+// [DIR] [delay, steps, high] ... [0, 0, 0]
+//   high 2 * high + 4, low 2 * delay + 8 cycles: fixed pulse width at any speed
+static size_t encode_cmd(const PioTiming& t, uint32_t high,
+                         uint32_t hz, uint32_t steps, uint32_t* out) {
+    if (steps < 1) return 0;
+
+    out[0] = t.hz_to_duty(hz);   // t includes the high loops; >= 1
+    out[1] = steps;
+    out[2] = high;
+    return 3;
+}
+
+extern const MotorExecProgram motor_exec_variant_adjustable;
+const MotorExecProgram motor_exec_variant_adjustable = {
+    MotorExecVariant::AdjustableDuty,
+    "adjustable",
+    &motor_exec_adjustable_duty_program,
+    motor_exec_adjustable_duty_program_get_default_config,
+    motor_exec_adjustable_duty_offset_round_start,
+    motor_exec_adjustable_duty_offset_wait_cmd,
+    MOTOR_EXEC_CAP_DIR | MOTOR_EXEC_CAP_PULSE_WIDTH,
+    1,      // min_steps
+    3,      // cmd_words
+    1,      // start_words
+    3,      // end_words
+    encode_cmd
+};
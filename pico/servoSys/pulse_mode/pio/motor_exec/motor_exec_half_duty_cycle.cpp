@@ -0,0 +1,31 @@
+#include "pio/motor_exec_variants.hpp"
+
+#include "motor_exec_half_duty_cycle.pio.h"
+
+// [DIR] [duty, steps - 1] ... [0, 0]
+//   Y + 1 pulses per command, steps - 1 == 0 would end the round
+static size_t encode_cmd(const PioTiming& t, uint32_t high,
+                         uint32_t hz, uint32_t steps, uint32_t* out) {
+    (void)high;
+    if (steps < 2) return 0;
+
+    out[0] = t.hz_to_duty(hz);   // >= 1: duty == 0 would end the round
+    out[1] = steps - 1u;
+    return 2;
+}
+
+extern const MotorExecProgram motor_exec_variant_half_duty;
+const MotorExecProgram motor_exec_variant_half_duty = {
+    MotorExecVariant::HalfDuty,
+    "half_duty",
+    &motor_exec_half_duty_program,
+    motor_exec_half_duty_program_get_default_config,
+    motor_exec_half_duty_offset_round_start,
+    motor_exec_half_duty_offset_wait_cmd,
+    MOTOR_EXEC_CAP_DIR,
+    2,      // min_steps
+    2,      // cmd_words
+    1,      // start_words
+    2,      // end_words
+    encode_cmd
+};
@@ -0,0 +1,30 @@
+#include "pio/motor_exec_variants.hpp"
+
+#include "motor_exec_half_duty_cycle_v2.pio.h"
+
+// [DIR] [duty, steps - 1] ... [0, 0]   (half_duty protocol, symmetric levels)
+static size_t encode_cmd(const PioTiming& t, uint32_t high,
+                         uint32_t hz, uint32_t steps, uint32_t* out) {
+    (void)high;
+    if (steps < 2) return 0;
+
+    out[0] = t.hz_to_duty(hz);
+    out[1] = steps - 1u;
+    return 2;
+}
+
+extern const MotorExecProgram motor_exec_variant_half_duty_v2;
+const MotorExecProgram motor_exec_variant_half_duty_v2 = {
+    MotorExecVariant::HalfDutyV2,
+    "half_duty_v2",
+    &motor_exec_half_duty_v2_program,
+    motor_exec_half_duty_v2_program_get_default_config,
+    motor_exec_half_duty_v2_offset_round_start,
+    motor_exec_half_duty_v2_offset_wait_cmd,
+    MOTOR_EXEC_CAP_DIR,
+    2,      // min_steps
+    2,      // cmd_words
+    1,      // start_words
+    2,      // end_words
+    encode_cmd
+};
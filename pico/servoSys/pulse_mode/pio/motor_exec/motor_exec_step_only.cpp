@@ -0,0 +1,30 @@
+#include "pio/motor_exec_variants.hpp"
+
+#include "motor_exec_step_only.pio.h"
+
+// [duty, steps - 1] ...   Y + 1 pulses, no DIR, no end marker
+static size_t encode_cmd(const PioTiming& t, uint32_t high,
+                         uint32_t hz, uint32_t steps, uint32_t* out) {
+    (void)high;
+    if (steps < 1) return 0;
+
+    out[0] = t.hz_to_duty(hz);
+    out[1] = steps - 1u;
+    return 2;
+}
+
+extern const MotorExecProgram motor_exec_variant_step_only;
+const MotorExecProgram motor_exec_variant_step_only = {
+    MotorExecVariant::StepOnly,
+    "step_only",
+    &motor_exec_step_only_program,
+    motor_exec_step_only_program_get_default_config,
+    motor_exec_step_only_offset_wait_cmd,
+    motor_exec_step_only_offset_wait_cmd,
+    0,
+    1,      // min_steps
+    2,      // cmd_words
+    0,      // start_words
+    0,      // end_words
+    encode_cmd
+};
@@ -0,0 +1,200 @@
+#include "motor_exec_variants.hpp"
+
+#include "pio_exec.hpp"
+
+#include "hardware/gpio.h"
+
+#include "motor_exec.pio.h"
+
+// ------------------------------------------------------------
+// Exec (pio/motor_exec.pio): the default program of PS100_P
+// ------------------------------------------------------------
+
+namespace {
+
+// [duty, steps]
+static size_t exec_encode_cmd(const PioTiming& t, uint32_t high,
+                              uint32_t hz, uint32_t steps, uint32_t* out) {
+    (void)high;
+    if (steps < 1) return 0;
+
+    out[0] = t.hz_to_duty(hz);
+    out[1] = steps;
+    return 2;
+}
+
+const MotorExecProgram exec_program = {
+    MotorExecVariant::Exec,
+    "exec",
+    &motor_exec_program,
+    motor_exec_program_get_default_config,
+    motor_exec_offset_wait_cmd,      // raw entry
+    motor_exec_offset_wait_packed,   // packed entry (idle there too)
+    MOTOR_EXEC_CAP_PROGRESS | MOTOR_EXEC_CAP_PACKED | MOTOR_EXEC_CAP_DWELL,
+    1,      // min_steps
+    2,      // cmd_words
+    0,      // start_words
+    0,      // end_words
+    exec_encode_cmd
+};
+
+} // namespace
+
+// one translation unit per generated header (pio/motor_exec/*.cpp)
+extern const MotorExecProgram motor_exec_variant_step_only;
+extern const MotorExecProgram motor_exec_variant_half_duty;
+extern const MotorExecProgram motor_exec_variant_half_duty_v2;
+extern const MotorExecProgram motor_exec_variant_adjustable;
+
+// ------------------------------------------------------------
+// Registry
+// ------------------------------------------------------------
+
+const MotorExecProgram* motor_exec_variant_program(MotorExecVariant v) {
+    switch (v) {
+        case MotorExecVariant::Exec:           return &exec_program;
+        case MotorExecVariant::StepOnly:       return &motor_exec_variant_step_only;
+        case MotorExecVariant::HalfDuty:       return &motor_exec_variant_half_duty;
+        case MotorExecVariant::HalfDutyV2:     return &motor_exec_variant_half_duty_v2;
+        case MotorExecVariant::AdjustableDuty: return &motor_exec_variant_adjustable;
+        default:                               return nullptr;
+    }
+}
+
+// ------------------------------------------------------------
+// Encoder
+// ------------------------------------------------------------
+
+size_t motor_exec_variant_max_words(const MotorExecProgram& p, size_t n) {
+    return n * (size_t)(p.start_words + p.cmd_words + p.end_words);
+}
+
+size_t motor_exec_variant_encode(const MotorExecProgram& p,
+                                 const PioTiming& t,
+                                 uint32_t high,
+                                 uint32_t dir_setup,
+                                 bool dir_invert,
+                                 const MotorExecMove* moves,
+                                 size_t n,
+                                 uint32_t* out,
+                                 size_t capacity) {
+    if (!moves || !out || n == 0) return 0;
+
+    const bool dir_in_stream = (p.caps & MOTOR_EXEC_CAP_DIR) != 0;
+    if (dir_setup > 0x7FFFFFFFu) return 0;   // bits 31..1 of the DIR word
+
+    size_t w     = 0;
+    bool   open  = false;   // round started (DIR word written)
+    bool   level = false;
+
+    for (size_t i = 0; i < n; ++i) {
+        const MotorExecMove& m = moves[i];
+        if (m.hz == 0 || m.steps < p.min_steps) return 0;
+
+        // DIR 只能由 CPU 设置：整个流必须同一方向
+        if (!dir_in_stream && m.forward != moves[0].forward) return 0;
+
+        const bool l = m.forward ^ dir_invert;
+        if (dir_in_stream && (!open || l != level)) {
+            // 换向：结束当前 round，下一个 round 以新的 DIR 开始
+            if (open) {
+                if (w + p.end_words > capacity) return 0;
+                for (uint i_end = 0; i_end < p.end_words; ++i_end) out[w++] = 0;
+            }
+            if (w + p.start_words > capacity) return 0;
+            // 每个 round 都带建立时间：编码器不知道 DIR 引脚的上一电平
+            out[w++] = (dir_setup << 1) | (l ? 1u : 0u);
+            open  = true;
+            level = l;
+        }
+
+        if (w + p.cmd_words > capacity) return 0;
+        if (p.encode_cmd(t, high, m.hz, m.steps, &out[w]) != p.cmd_words) return 0;
+        w += p.cmd_words;
+    }
+
+    if (open) {
+        if (w + p.end_words > capacity) return 0;
+        for (uint i_end = 0; i_end < p.end_words; ++i_end) out[w++] = 0;
+    }
+    return w;
+}
+
+// ------------------------------------------------------------
+// Timing
+// ------------------------------------------------------------
+
+PioTiming motor_exec_variant_timing(const MotorExecProgram& p, float clk_div, uint32_t high) {
+    uint32_t di = 1, df = 0;
+    pio_timing_split_clkdiv(clk_div, di, df);
+
+    (void)motor_exec_timing();   // make sure f_sys is known
+    return make_pio_timing(p.variant, pio_timing_f_sys(), di, df,
+                           (p.caps & MOTOR_EXEC_CAP_PULSE_WIDTH) ? high : 0u);
+}
+
+uint32_t motor_exec_variant_high_loops(const PioTiming& t, uint32_t pulse_us) {
+    const uint64_t cycles = ((uint64_t)pulse_us * t.f_pio + 500000u) / 1000000u;
+    if (cycles <= MOTOR_EXEC_HIGH_FIXED) return 0;
+    return (uint32_t)((cycles - MOTOR_EXEC_HIGH_FIXED + MOTOR_EXEC_HIGH_PER_LOOP / 2)
+                      / MOTOR_EXEC_HIGH_PER_LOOP);
+}
+
+uint32_t motor_exec_variant_setup_loops(const PioTiming& t, uint32_t setup_us) {
+    const uint64_t cycles = ((uint64_t)setup_us * t.f_pio + 999999u) / 1000000u;
+    if (cycles <= 1) return 0;                  // jmp x-- with X = 0: 1 cycle
+    if (cycles > 0x80000000ull) return 0x7FFFFFFFu;
+    return (uint32_t)(cycles - 1);
+}
+
+// ============================================================
+// PIO init / state
+// ============================================================
+
+void motor_exec_variant_init(PIO pio,
+                             uint sm,
+                             uint offset,
+                             const MotorExecProgram& p,
+                             uint step_pin,
+                             uint dir_pin,
+                             float clk_div) {
+    motor_exec_timing_refresh();
+
+    pio_sm_config c = p.default_config(offset);
+
+    // STEP mapped to SET pins
+    sm_config_set_set_pins(&c, step_pin, 1);
+    pio_sm_set_consecutive_pindirs(pio, sm, step_pin, 1, true);
+    pio_gpio_init(pio, step_pin);
+
+    // DIR mapped to OUT pins: PIO 输出先锁存为 GPIO 当前电平，再切 mux（无毛刺）
+    if (p.caps & MOTOR_EXEC_CAP_DIR) {
+        sm_config_set_out_pins(&c, dir_pin, 1);
+        const uint32_t mask = 1u << dir_pin;
+        pio_sm_set_pins_with_mask(pio, sm, gpio_get_out_level(dir_pin) ? mask : 0u, mask);
+        pio_sm_set_consecutive_pindirs(pio, sm, dir_pin, 1, true);
+        pio_gpio_init(pio, dir_pin);
+    }
+
+    // out pins, 1 takes bit 0 of the DIR word
+    sm_config_set_out_shift(&c, true, false, 32);
+
+    // no progress tokens: RX unused, a whole round fits the 8-word TX FIFO
+    sm_config_set_fifo_join(&c, PIO_FIFO_JOIN_TX);
+
+    sm_config_set_clkdiv(&c, clk_div);
+
+    pio_sm_init(pio, sm, offset + p.entry, &c);
+    pio_sm_set_enabled(pio, sm, false);
+}
+
+void motor_exec_variant_park(PIO pio, uint sm, uint offset, const MotorExecProgram& p) {
+    pio_sm_exec(pio, sm, pio_encode_jmp(offset + p.entry));
+}
+
+bool motor_exec_variant_idle(PIO pio, uint sm, uint offset, const MotorExecProgram& p) {
+    if (!pio_sm_is_tx_fifo_empty(pio, sm)) return false;
+
+    const uint pc = pio_sm_get_pc(pio, sm);
+    return pc == offset + p.entry || pc == offset + p.cmd_entry;
+}
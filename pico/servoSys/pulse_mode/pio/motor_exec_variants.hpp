@@ -0,0 +1,124 @@
+#pragma once
+
+#include "hardware/pio.h"
+#include "timing/pio_timing.hpp"
+#include <stdint.h>
+#include <stddef.h>
+
+// =======================
+// motor_exec program variants (runtime registry)
+// =======================
+//
+// One descriptor per program (pio/motor_exec.pio + pio/motor_exec/*.pio):
+// program, entry, capabilities, command encoder and timing model.
+// An axis picks its variant once (PS100_P::Config::variant); the
+// program is shared by every SM of a PIO that uses it (pio_resources).
+//
+// | variant        | instr | protocol (one round)                     | caps                  |
+// |----------------|-------|------------------------------------------|-----------------------|
+// | Exec           | 19    | [duty, steps] ...                        | progress, packed, dwell |
+// | StepOnly       | 12    | [duty, steps-1] ...                      | -                     |
+// | HalfDuty       | 20    | [DIR] [duty, steps-1] ... [0, 0]         | dir                   |
+// | HalfDutyV2     | 21    | [DIR] [duty, steps-1] ... [0, 0]         | dir                   |
+// | AdjustableDuty | 22    | [DIR] [delay, steps, high] ... [0, 0, 0] | dir, pulse width      |
+//
+// dir: DIR is the OUT pin, set from the stream at every round start.
+//      A stream may hold several rounds => direction reversals with
+//      no CPU write to dir_pin (motor_exec_variant_encode).
+//      DIR word = (setup << 1) | level: the SM waits setup + 1 cycles
+//      after `out pins, 1` before the round's first STEP edge.
+// pulse width: STEP high time fixed by `high` (e.g. 10 us at any speed).
+//
+// Each program has its own name (`.program motor_exec_<variant>`), so the
+// generated symbols never collide; each header still lives in its own
+// translation unit (pio/motor_exec/motor_exec_<name>.cpp).
+
+enum : uint8_t {
+    MOTOR_EXEC_CAP_PROGRESS     = 1u << 0,   // push token per pulse (hardware step counter)
+    MOTOR_EXEC_CAP_PACKED       = 1u << 1,   // MotorExecFormat::Packed
+    MOTOR_EXEC_CAP_DWELL        = 1u << 2,   // [duty, 0] waits, zero words are no-ops (rings)
+    MOTOR_EXEC_CAP_DIR          = 1u << 3,   // DIR in stream (OUT pin)
+    MOTOR_EXEC_CAP_PULSE_WIDTH  = 1u << 4    // adjustable STEP high time
+};
+
+// AdjustableDuty: STEP high = 2 * high + 4 cycles
+constexpr uint32_t MOTOR_EXEC_HIGH_PER_LOOP = 2;
+constexpr uint32_t MOTOR_EXEC_HIGH_FIXED    = 4;
+
+// DIR variants: minimum DIR -> STEP setup (us) at a round start
+// (PS100 / DM542 class drivers ask for ~5 us)
+constexpr uint32_t MOTOR_EXEC_DIR_SETUP_US  = 5;
+
+struct MotorExecMove {
+    uint32_t hz;
+    uint32_t steps;
+    bool     forward;
+};
+
+struct MotorExecProgram {
+    MotorExecVariant     variant;
+    const char*          name;
+    const pio_program_t* program;
+    pio_sm_config        (*default_config)(uint offset);
+
+    uint8_t entry;        // first word of a round (relative to offset)
+    uint8_t cmd_entry;    // between commands (== entry without rounds)
+    uint8_t caps;         // MOTOR_EXEC_CAP_*
+    uint8_t min_steps;    // per command (HalfDuty: Y + 1 pulses, Y > 0)
+    uint8_t cmd_words;
+    uint8_t start_words;  // DIR word (0 / 1)
+    uint8_t end_words;    // end-of-round marker
+
+    // one command of `steps` pulses; `high` = STEP high loops (PULSE_WIDTH only)
+    // returns cmd_words, 0 if steps < min_steps
+    size_t (*encode_cmd)(const PioTiming& t, uint32_t high,
+                         uint32_t hz, uint32_t steps, uint32_t* out);
+};
+
+// nullptr for an unknown variant
+const MotorExecProgram* motor_exec_variant_program(MotorExecVariant v);
+
+// Words of a stream of `n` moves (worst case: a round per move).
+size_t motor_exec_variant_max_words(const MotorExecProgram& p, size_t n);
+
+// Encode `n` moves into one stream: rounds are opened / closed around
+// direction changes (DIR variants). dir_invert as in PS100_P::Config,
+// dir_setup = setup loops of every DIR word (motor_exec_variant_setup_loops).
+// Without MOTOR_EXEC_CAP_DIR every move must go the same way.
+// Returns words written, 0 if invalid (steps < min_steps, direction
+// change without DIR support) or capacity too small.
+size_t motor_exec_variant_encode(const MotorExecProgram& p,
+                                 const PioTiming& t,
+                                 uint32_t high,
+                                 uint32_t dir_setup,
+                                 bool dir_invert,
+                                 const MotorExecMove* moves,
+                                 size_t n,
+                                 uint32_t* out,
+                                 size_t capacity);
+
+// timing model of `p` on an SM with clk_div (high: PULSE_WIDTH loops)
+PioTiming motor_exec_variant_timing(const MotorExecProgram& p, float clk_div, uint32_t high = 0);
+
+// STEP high time -> high loops (AdjustableDuty), >= 0
+uint32_t motor_exec_variant_high_loops(const PioTiming& t, uint32_t pulse_us);
+
+// DIR -> STEP setup time -> DIR word setup loops (rounded up: >= setup_us)
+uint32_t motor_exec_variant_setup_loops(const PioTiming& t, uint32_t setup_us);
+
+// Variant init (not Exec, see motor_exec_init): STEP = SET pin,
+// DIR = OUT pin for DIR variants (pin muxed to the PIO), TX FIFO joined
+// (8 words: a whole round fits the FIFO). SM left disabled at entry.
+void motor_exec_variant_init(PIO pio,
+                             uint sm,
+                             uint offset,
+                             const MotorExecProgram& p,
+                             uint step_pin,
+                             uint dir_pin,
+                             float clk_div);
+
+// PC back to the round entry (stopped SM, FIFOs cleared by caller)
+void motor_exec_variant_park(PIO pio, uint sm, uint offset, const MotorExecProgram& p);
+
+// TX FIFO empty and PC waiting at a command / round boundary (any variant)
+bool motor_exec_variant_idle(PIO pio, uint sm, uint offset, const MotorExecProgram& p);
@@ -3,41 +3,26 @@
 #include "hardware/clocks.h"
 #include "hardware/gpio.h"
 #include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
 
 #include "motor_exec.pio.h"
+#include "pio_resources.hpp"
+#include "trace/trace.hpp"
 
 #include <math.h>
 
-// ------------------------------------------------------------
-// Internal program registry (per PIO)
-// ------------------------------------------------------------
-
-namespace {
-
-// Pico 只有两个 PIO
-static bool     program_loaded[2] = { false, false };
-static uint     program_offset[2] = { 0, 0 };
-
-static inline uint pio_index(PIO pio) {
-    return (pio == pio0) ? 0u : 1u;
-}
-
-} // namespace
-
 // ------------------------------------------------------------
 // Public API
 // ------------------------------------------------------------
 
-uint motor_exec_ensure_program(PIO pio) {
-    const uint idx = pio_index(pio);
-
-    if (!program_loaded[idx]) {
-        program_offset[idx] =
-            pio_add_program(pio, &motor_exec_program);
-        program_loaded[idx] = true;
-    }
+// 每个 PIO 只装一份，所有 SM 共享（pio_resources 按内容去重）
+int motor_exec_ensure_program(PIO pio) {
+    return pio_res_program(pio, &motor_exec_program);
+}
 
-    return program_offset[idx];
+const pio_program_t* motor_exec_program_ptr() {
+    return &motor_exec_program;
 }
 
 // ============================================================
@@ -51,6 +36,9 @@ void motor_exec_init(
     uint step_pin,
     float clk_div
 ) {
+    // 时钟只在 init 时读取一次（timing model 缓存）
+    motor_exec_timing_refresh();
+
     // STEP GPIO
     pio_gpio_init(pio, step_pin);
     pio_sm_set_consecutive_pindirs(pio, sm, step_pin, 1, true);
@@ -63,11 +51,138 @@ void motor_exec_init(
     // Clock divider
     sm_config_set_clkdiv(&c, clk_div);
 
-    // Init + enable
-    pio_sm_init(pio, sm, offset, &c);
+    // packed format: out x, 16 takes the low half first
+    sm_config_set_out_shift(&c, true, false, 32);
+
+    // Init (raw format entry) + enable
+    pio_sm_init(pio, sm, offset + motor_exec_offset_wait_cmd, &c);
     pio_sm_set_enabled(pio, sm, true);
 }
 
+void motor_exec_set_format(
+    PIO pio,
+    uint sm,
+    uint offset,
+    MotorExecFormat fmt
+) {
+    const uint entry = (fmt == MotorExecFormat::Packed)
+                           ? motor_exec_offset_wait_packed
+                           : motor_exec_offset_wait_cmd;
+
+    // wrap bottom == entry: 命令结束后回到本格式的解码入口
+    pio_sm_set_wrap(pio, sm, offset + entry, offset + motor_exec_wrap);
+    pio_sm_exec(pio, sm, pio_encode_jmp(offset + entry));
+}
+
+size_t motor_exec_pack_slow_step(uint32_t duty_period, uint32_t* out, size_t capacity) {
+    const size_t words = motor_exec_packed_step_words(duty_period);
+    if (!out || words > capacity) return 0;
+
+    if (words == 1) {
+        out[0] = motor_exec_pack(duty_period, 1);
+        return 1;
+    }
+
+    // pulse part
+    const uint32_t m = (duty_period - 9u > MOTOR_EXEC_PACKED_MAX) ? MOTOR_EXEC_PACKED_MAX
+                                                                  : duty_period - 9u;
+    out[0] = motor_exec_pack(m, 1);
+
+    // dwell part: 2 * (duty - m) - framing cycles (d + 10 each)
+    uint64_t rest = 2ull * (duty_period - m) - MOTOR_EXEC_CMD_OVERHEAD;
+    size_t   n    = 1;
+
+    while (rest > 0) {
+        const uint64_t one  = MOTOR_EXEC_PACKED_MAX + MOTOR_EXEC_DWELL_FIXED;
+        const uint64_t take = (rest <= one) ? rest
+                            : (rest - one < MOTOR_EXEC_DWELL_FIXED) ? one - MOTOR_EXEC_DWELL_FIXED
+                            : one;
+
+        out[n++] = motor_exec_pack((uint32_t)(take - MOTOR_EXEC_DWELL_FIXED), 0);
+        rest -= take;
+    }
+    return n;
+}
+
+size_t motor_exec_pack_stream(const uint32_t* raw,
+                              size_t raw_words,
+                              uint32_t* out,
+                              size_t capacity) {
+    if (!raw || !out) return 0;
+
+    size_t n = 0;
+    for (size_t i = 0; i + 1 < raw_words; i += 2) {
+        const uint32_t duty  = raw[i];
+        uint32_t       steps = raw[i + 1];
+
+        if (duty > MOTOR_EXEC_PACKED_MAX) {
+            // slow pulses: one encoding per step
+            for (; steps > 0; --steps) {
+                const size_t w = motor_exec_pack_slow_step(duty, out + n, capacity - n);
+                if (w == 0) return 0;
+                n += w;
+            }
+            continue;
+        }
+
+        // dwell / no-op keep their single command
+        do {
+            const uint32_t s = (steps > MOTOR_EXEC_PACKED_MAX) ? MOTOR_EXEC_PACKED_MAX : steps;
+            if (n >= capacity) return 0;
+
+            out[n++] = motor_exec_pack(duty, s);
+            steps -= s;
+        } while (steps > 0);
+    }
+    return n;
+}
+
+size_t motor_exec_blend_segment(const PioTiming& timing,
+                                uint32_t v0_hz,
+                                uint32_t v1_hz,
+                                uint32_t steps,
+                                uint32_t a_max,
+                                size_t max_ramp_cmds,
+                                uint32_t* out,
+                                size_t capacity) {
+    if (!out || v1_hz == 0 || steps == 0) return 0;
+
+    size_t n = 0;
+
+    // ---------- blend v0 -> v1 over the first steps ----------
+    uint32_t ramp = 0;
+    if (a_max > 0 && v0_hz > 0 && v0_hz != v1_hz && max_ramp_cmds > 0) {
+        const float v0sq = (float)v0_hz * (float)v0_hz;
+        const float v1sq = (float)v1_hz * (float)v1_hz;
+        const float dist = fabsf(v1sq - v0sq) / (2.0f * (float)a_max);
+
+        ramp = (dist >= (float)steps) ? steps : (uint32_t)ceilf(dist);
+
+        const uint32_t k = (ramp < max_ramp_cmds) ? ramp : (uint32_t)max_ramp_cmds;
+        if (capacity < 2u * k) return 0;
+
+        for (uint32_t i = 0; i < k; ++i) {
+            const uint32_t s0 = (uint32_t)((uint64_t)ramp * i / k);
+            const uint32_t s1 = (uint32_t)((uint64_t)ramp * (i + 1u) / k);
+
+            // 子命令中点的速度（v^2 随距离线性变化 = 恒加速度）
+            const float mid = 0.5f * (float)(s0 + s1) / (float)ramp;
+            const float v   = sqrtf(v0sq + (v1sq - v0sq) * mid);
+
+            out[n++] = timing.hz_to_duty((uint32_t)(v + 0.5f));
+            out[n++] = s1 - s0;
+        }
+    }
+
+    // ---------- rest of the segment at its own speed ----------
+    if (steps > ramp) {
+        if (n + 2 > capacity) return 0;
+        out[n++] = timing.hz_to_duty(v1_hz);
+        out[n++] = steps - ramp;
+    }
+    return n;
+}
+
 void motor_exec_run(
     PIO pio,
     uint sm,
@@ -79,6 +194,68 @@ void motor_exec_run(
     pio_sm_put_blocking(pio, sm, steps);
 }
 
+bool motor_exec_idle(PIO pio, uint sm, uint offset) {
+    if (!pio_sm_is_tx_fifo_empty(pio, sm)) return false;
+
+    const uint pc = pio_sm_get_pc(pio, sm);
+    return pc == offset + motor_exec_offset_wait_cmd ||
+           pc == offset + motor_exec_offset_wait_packed;
+}
+
+// ============================================================
+// Progress counter (RX token sink)
+// ============================================================
+
+namespace {
+
+// token 内容无意义，只需要一个落点
+static volatile uint32_t counter_sink;
+
+} // namespace
+
+int motor_exec_counter_attach(PIO pio, uint sm) {
+    int chan = dma_claim_unused_channel(false);
+    if (chan < 0) return -1;
+
+    dma_channel_config cfg = dma_channel_get_default_config((uint)chan);
+
+    channel_config_set_transfer_data_size(&cfg, DMA_SIZE_32);
+    channel_config_set_read_increment(&cfg, false);
+    channel_config_set_write_increment(&cfg, false);
+    channel_config_set_dreq(&cfg, pio_get_dreq(pio, sm, false));
+
+    dma_channel_configure(
+        (uint)chan,
+        &cfg,
+        &counter_sink,     // 丢弃 token
+        &pio->rxf[sm],     // 从 PIO RX FIFO 读取
+        MOTOR_EXEC_COUNTER_SPAN,
+        true
+    );
+
+    return chan;
+}
+
+void motor_exec_counter_reset(int chan) {
+    if (chan < 0) return;
+
+    dma_channel_abort((uint)chan);
+    // 写 transfer_count 只设置 RELOAD 值，重新触发后生效
+    dma_channel_set_trans_count((uint)chan, MOTOR_EXEC_COUNTER_SPAN, true);
+}
+
+uint32_t motor_exec_counter_read(int chan) {
+    if (chan < 0) return 0;
+    return MOTOR_EXEC_COUNTER_SPAN - dma_hw->ch[chan].transfer_count;
+}
+
+void motor_exec_counter_detach(int chan) {
+    if (chan < 0) return;
+
+    dma_channel_abort((uint)chan);
+    dma_channel_unclaim((uint)chan);
+}
+
 // ============================================================
 // DMA stream execution (xE)
 // ============================================================
@@ -87,8 +264,11 @@ int motor_exec_stream_start(
     PIO pio,
     uint sm,
     const uint32_t* words,
-    size_t count
+    size_t count,
+    bool enable_sm
 ) {
+    PM_TRACE_SCOPE(StreamStart, count);
+
     if (!words || count == 0) return -1;
 
     // ===== 1. 停止状态机 =====
@@ -101,11 +281,14 @@ int motor_exec_stream_start(
     pio_sm_restart(pio, sm);
 
     // ===== 4. 确保 STEP 初始为低电平 =====
-    pio_sm_set_pins(pio, sm, 0);
+    // 只用 set pins（set base == STEP）：pio_sm_set_pins 会改写整个 PIO 的引脚，
+    // 同一 PIO 上其它轴正在输出的脉冲会被截断
     pio_sm_exec(pio, sm, pio_encode_set(pio_pins, 0));
 
-    // ===== 5. 重新 enable =====
-    pio_sm_set_enabled(pio, sm, true);
+    // ===== 5. 重新 enable（同步启动时由调用者统一使能）=====
+    if (enable_sm) {
+        pio_sm_set_enabled(pio, sm, true);
+    }
 
     // ===== 6. 配置 DMA =====
     int dma_chan = dma_claim_unused_channel(false);
@@ -139,39 +322,413 @@ void motor_exec_stream_abort(int dma_chan) {
     dma_channel_unclaim(dma_chan);
 }
 
+bool motor_exec_stream_busy(int dma_chan) {
+    if (dma_chan < 0) return false;
+    return dma_channel_is_busy((uint)dma_chan);
+}
+
 // ============================================================
-// Timing model
-//   Tstep = (2*duty + 7) / f_sys
+// DMA ring stream (xE, ping-pong)
+//
+//   data ch : buf half -> pio->txf[sm]   (DREQ = PIO TX, chain -> ctrl)
+//   ctrl ch : next[k]  -> data.al3_read_addr_trig   (ring over next[2])
+//
+// 数据通道 transfer count 固定为 half_words（RELOAD 值自动复用），
+// 控制通道只写 1 个 word：下一半区的起始地址，写入即触发数据通道。
+// 地址为 0 时是 null trigger，链在此处自然终止。
 // ============================================================
 
-static inline double pio_freq_hz() {
-    return (double)clock_get_hz(clk_sys);
+namespace {
+
+constexpr uint RING_MAX = 8;   // 每个 SM 最多一条 ring
+
+struct RingSlot {
+    // 控制通道读取的地址表，必须 8 字节对齐（DMA read ring = 3 bits）
+    alignas(8) volatile uint32_t next[2];
+
+    PIO     pio;
+    uint    sm;
+    int     data_ch;
+    int     ctrl_ch;
+
+    uint32_t* half[2];
+    size_t    half_words;
+
+    motor_exec_refill_fn refill;
+    void*                user;
+
+    uint8_t       done_idx;    // 下一次完成中断对应的半区
+    bool          ended;       // refill 已返回 0
+    bool          relink;      // ended 之后 resume() 已到：链尾 IRQ 重新 refill
+    bool          stalled;     // 上一次发布的 next[] 晚于控制通道读取：链停在边界
+    volatile bool active;
+    volatile bool underrun;
+    bool          in_use;
+};
+
+static RingSlot ring_slots[RING_MAX];
+static bool     ring_irq_installed = false;
+
+static inline uint32_t addr_word(const uint32_t* p) {
+    return (uint32_t)(uintptr_t)p;
 }
 
-// Hz → duty_period
-uint32_t hz_to_duty_period(double hz) {
-    if (hz <= 0.0) return 0;
+// 填充一个半区；返回是否有有效数据
+static bool ring_fill(RingSlot& r, uint idx) {
+    if (r.ended) return false;
+
+    size_t n = r.refill(r.half[idx], r.half_words, r.user);
+    if (n > r.half_words) n = r.half_words;
+
+    if (n == 0) {
+        r.ended = true;
+        return false;
+    }
+
+    // 尾部补空命令（duty=0, steps=0），DMA 长度保持固定
+    for (size_t i = n; i < r.half_words; ++i) {
+        r.half[idx][i] = 0;
+    }
+    return true;
+}
+
+// IRQ 中发布刚 refill 的半区 idx。另一半区若在 refill 期间已推送完，
+// 控制通道先读到了 0：null trigger 把数据通道的 READ_ADDR 写成 0（其它情况
+// 都不会是 0）。此时链停在边界，idx 的数据有效但不会被装载，
+// 由另一半区的完成 IRQ（已挂起）从 idx 重启
+static void ring_publish(RingSlot& r, uint idx) {
+    r.next[idx] = addr_word(r.half[idx]);
+    __dmb();
+    r.stalled = dma_hw->ch[r.data_ch].read_addr == 0;
+}
+
+// 链已停（数据 / 控制通道都空闲）：从 done_idx 半区重新开始。
+// 控制通道的读指针此时正指向另一半区的 next[]，交替顺序不变；
+// SM 不受影响，新命令排在 FIFO 里剩下的命令之后
+static bool ring_restart(RingSlot& r) {
+    const uint i = r.done_idx;
+
+    r.ended   = false;
+    r.stalled = false;
+    r.next[0] = 0;
+    r.next[1] = 0;
+    if (!ring_fill(r, i)) return false;
+    if (ring_fill(r, i ^ 1u)) {
+        r.next[i ^ 1u] = addr_word(r.half[i ^ 1u]);
+    }
+
+    r.active = true;
+    dma_channel_set_read_addr((uint)r.data_ch, r.half[i], true);
+    return true;
+}
+
+static void ring_dma_irq_handler() {
+    PM_TRACE(RingIrq, 0);
+    uint32_t refilled = 0;
+
+    for (uint i = 0; i < RING_MAX; ++i) {
+        RingSlot& r = ring_slots[i];
+        if (!r.in_use || !r.active) continue;
+        if (!dma_channel_get_irq0_status((uint)r.data_ch)) continue;
+
+        dma_channel_acknowledge_irq0((uint)r.data_ch);
+
+        const uint k = r.done_idx;   // 刚执行完的半区
+        const uint j = k ^ 1u;       // 控制通道刚装载的半区
+        r.done_idx = (uint8_t)j;
+
+        // next[j] 已被控制通道消费：先置空，
+        // 这样即使下一次 IRQ 迟到，链也只会停在边界而不是重放旧数据
+        const uint32_t loaded = r.next[j];
+        r.next[j] = 0;
+
+        if (loaded == 0 || !dma_channel_is_busy((uint)r.data_ch)) {
+            // 上一次的发布晚了（见 ring_publish）：j 从未执行，从 j 接着推。
+            // 控制通道的读指针正指向 next[k]，k 照常 refill；
+            // 没有 stalled 标记时 j 已推送完（IRQ 迟到），按欠载处理
+            if (loaded != 0 && r.stalled) {
+                r.stalled = false;
+                dma_channel_set_read_addr((uint)r.data_ch, r.half[j], true);
+                if (ring_fill(r, k)) ring_publish(r, k);
+                refilled |= 1u << i;
+                continue;
+            }
+
+            // 最后一个半区推送期间 resume() 到达：两个半区都已空出，接着 refill，
+            // 上一半区的命令还在 FIFO 里，衔接没有停顿
+            if (loaded == 0 && r.ended && r.relink) {
+                r.relink = false;
+                if (ring_restart(r)) {
+                    refilled |= 1u << i;
+                    continue;
+                }
+            }
+            r.relink = false;
+
+            // 链已终止：正常结束 or 来不及 refill
+            r.underrun = !r.ended;
+            r.active   = false;
+            if (r.underrun) PM_TRACE(RingUnderrun, i);
+            continue;
+        }
+
+        // 半区 k 已空出，趁 j 在执行时 refill
+        if (ring_fill(r, k)) {
+            ring_publish(r, k);
+            refilled |= 1u << i;
+        }
+    }
+
+    PM_TRACE_END(RingIrq, refilled);
+    (void)refilled;
+}
+
+static inline bool ring_valid(int ring) {
+    return ring >= 0 && ring < (int)RING_MAX && ring_slots[ring].in_use;
+}
+
+} // namespace
+
+// reset_sm == false: SM 保持运行，FIFO 中已有的命令照常执行（append）
+static int ring_launch(
+    PIO pio,
+    uint sm,
+    uint32_t* buf,
+    size_t half_words,
+    motor_exec_refill_fn refill,
+    void* user,
+    bool reset_sm,
+    bool enable_sm
+) {
+    PM_TRACE_SCOPE(RingStart, half_words);
+
+    if (!buf || !refill || half_words == 0) return -1;
+
+    int id = -1;
+    for (uint i = 0; i < RING_MAX; ++i) {
+        if (!ring_slots[i].in_use) { id = (int)i; break; }
+    }
+    if (id < 0) return -1;
+
+    RingSlot& r = ring_slots[id];
+    r.pio        = pio;
+    r.sm         = sm;
+    r.half[0]    = buf;
+    r.half[1]    = buf + half_words;
+    r.half_words = half_words;
+    r.refill     = refill;
+    r.user       = user;
+    r.done_idx   = 0;
+    r.ended      = false;
+    r.relink     = false;
+    r.stalled    = false;
+    r.active     = false;
+    r.underrun   = false;
+    r.next[0]    = 0;
+    r.next[1]    = 0;
+
+    // ===== 1. 预填两个半区 =====
+    if (!ring_fill(r, 0)) return -1;
+    if (ring_fill(r, 1)) {
+        r.next[1] = addr_word(r.half[1]);
+    }
+
+    // ===== 2. 申请 DMA 通道 =====
+    r.data_ch = dma_claim_unused_channel(false);
+    if (r.data_ch < 0) return -1;
+
+    r.ctrl_ch = dma_claim_unused_channel(false);
+    if (r.ctrl_ch < 0) {
+        dma_channel_unclaim((uint)r.data_ch);
+        return -1;
+    }
+
+    r.in_use = true;
+
+    if (!ring_irq_installed) {
+        irq_add_shared_handler(
+            DMA_IRQ_0,
+            ring_dma_irq_handler,
+            PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY
+        );
+        irq_set_enabled(DMA_IRQ_0, true);
+        ring_irq_installed = true;
+    }
+
+    // ===== 3. 状态机清洁启动（与 motor_exec_stream_start 一致）=====
+    if (reset_sm) {
+        pio_sm_set_enabled(pio, sm, false);
+        pio_sm_clear_fifos(pio, sm);
+        pio_sm_restart(pio, sm);
+        pio_sm_exec(pio, sm, pio_encode_set(pio_pins, 0));   // STEP only (see stream_start)
+        if (enable_sm) {
+            pio_sm_set_enabled(pio, sm, true);
+        }
+    }
+
+    // ===== 4. 控制通道：next[] -> data.al3_read_addr_trig =====
+    dma_channel_config cc = dma_channel_get_default_config((uint)r.ctrl_ch);
+    channel_config_set_transfer_data_size(&cc, DMA_SIZE_32);
+    channel_config_set_read_increment(&cc, true);
+    channel_config_set_write_increment(&cc, false);
+    channel_config_set_ring(&cc, false, 3);          // 在 next[0..1] 之间循环
+
+    dma_channel_configure(
+        (uint)r.ctrl_ch,
+        &cc,
+        &dma_hw->ch[r.data_ch].al3_read_addr_trig,
+        &r.next[1],                                  // A 结束后装载 B
+        1,
+        false
+    );
+
+    // ===== 5. 数据通道：半区 -> PIO TX FIFO =====
+    dma_channel_config dc = dma_channel_get_default_config((uint)r.data_ch);
+    channel_config_set_transfer_data_size(&dc, DMA_SIZE_32);
+    channel_config_set_read_increment(&dc, true);
+    channel_config_set_write_increment(&dc, false);
+    channel_config_set_dreq(&dc, pio_get_dreq(pio, sm, true));
+    channel_config_set_chain_to(&dc, (uint)r.ctrl_ch);
+
+    dma_channel_acknowledge_irq0((uint)r.data_ch);
+    dma_channel_set_irq0_enabled((uint)r.data_ch, true);
+
+    r.active = true;
+
+    dma_channel_configure(
+        (uint)r.data_ch,
+        &dc,
+        &pio->txf[sm],
+        r.half[0],
+        (uint32_t)half_words,
+        true
+    );
+
+    return id;
+}
+
+int motor_exec_ring_start(
+    PIO pio,
+    uint sm,
+    uint32_t* buf,
+    size_t half_words,
+    motor_exec_refill_fn refill,
+    void* user,
+    bool enable_sm
+) {
+    return ring_launch(pio, sm, buf, half_words, refill, user, true, enable_sm);
+}
+
+int motor_exec_ring_append(
+    PIO pio,
+    uint sm,
+    uint32_t* buf,
+    size_t half_words,
+    motor_exec_refill_fn refill,
+    void* user
+) {
+    return ring_launch(pio, sm, buf, half_words, refill, user, false, false);
+}
+
+bool motor_exec_ring_active(int ring) {
+    if (!ring_valid(ring)) return false;
+    return ring_slots[ring].active;
+}
+
+bool motor_exec_ring_resume(int ring) {
+    if (!ring_valid(ring)) return false;
+
+    RingSlot& r = ring_slots[ring];
+    bool ok = true;
+
+    // ring IRQ 与调用者在同一个核上：关中断即与 IRQ 互斥
+    const uint32_t irq = save_and_disable_interrupts();
+    if (r.active) {
+        // 仍在推送：未结束时下一次 refill 自然取到；已结束则由链尾 IRQ 重启
+        if (r.ended) r.relink = true;
+    } else {
+        ok = ring_restart(r);
+    }
+    restore_interrupts(irq);
+    return ok;
+}
+
+bool motor_exec_ring_underrun(int ring) {
+    if (!ring_valid(ring)) return false;
+    return ring_slots[ring].underrun;
+}
+
+void motor_exec_ring_release(int ring) {
+    if (!ring_valid(ring)) return;
+
+    RingSlot& r = ring_slots[ring];
 
-    double f_sys = pio_freq_hz();
+    dma_channel_set_irq0_enabled((uint)r.data_ch, false);
 
-    // duty = (f_sys / hz - 7) / 2
-    double d = (f_sys / hz - 6.0) * 0.5;
+    // 先停控制通道，避免它在 abort 期间重新触发数据通道
+    dma_channel_abort((uint)r.ctrl_ch);
+    dma_channel_abort((uint)r.data_ch);
+    dma_channel_acknowledge_irq0((uint)r.data_ch);
 
-    if (d < 1.0) return 1;
-    return (uint32_t)llround(d);
+    dma_channel_unclaim((uint)r.ctrl_ch);
+    dma_channel_unclaim((uint)r.data_ch);
+
+    r.active = false;
+    r.in_use = false;
+}
+
+// ============================================================
+// Timing model (see timing/pio_timing.hpp)
+//   Tstep = (2*duty + 8) / f_pio     (motor_exec.pio, raw & packed)
+// ============================================================
+
+namespace {
+
+static PioTiming timing_default{};
+static bool      timing_ready = false;
+
+} // namespace
+
+void motor_exec_timing_refresh() {
+    // 唯一一次读时钟的地方；clk_sys 改变后需重新调用
+    pio_timing_configure(clock_get_hz(clk_sys));
+    timing_default = make_pio_timing(MotorExecVariant::Exec, pio_timing_f_sys());
+    timing_ready   = true;
+}
+
+const PioTiming& motor_exec_timing() {
+    if (!timing_ready) motor_exec_timing_refresh();
+    return timing_default;
+}
+
+PioTiming motor_exec_timing_for(float clk_div) {
+    uint32_t di = 1, df = 0;
+    pio_timing_split_clkdiv(clk_div, di, df);
+
+    (void)motor_exec_timing();   // make sure f_sys is known
+    return make_pio_timing(MotorExecVariant::Exec, pio_timing_f_sys(), di, df);
+}
+
+// Hz → duty_period
+uint32_t hz_to_duty_period(uint32_t hz) {
+    return motor_exec_timing().hz_to_duty(hz);
+}
+
+// Duration (ms) → steps, integer: hz * ms / 1000, rounded
+uint32_t duration_ms_to_steps(uint32_t duration_ms, uint32_t hz) {
+    const uint64_t steps = ((uint64_t)hz * duration_ms + 500u) / 1000u;
+    return (steps > 0xFFFFFFFFull) ? 0xFFFFFFFFu : (uint32_t)steps;
 }
 
 // Period (s) → duty_period
 uint32_t period_to_duty_period(double period_s) {
     if (period_s <= 0.0) return 0;
 
-    double f_sys = pio_freq_hz();
-    double cycles = period_s * f_sys;
-
-    double d = (cycles - 7.0) * 0.5;
-    if (d < 1.0) return 1;
+    const PioTiming& t = motor_exec_timing();
+    double cycles = period_s * (double)t.f_pio;
 
-    return (uint32_t)llround(d);
+    if (cycles >= 4294967295.0) cycles = 4294967295.0;
+    return t.cycles_to_duty((uint32_t)llround(cycles));
 }
 
 // RPM → duty_period
@@ -179,7 +736,7 @@ uint32_t rpm_to_duty_period(double rpm, uint32_t pulses_per_rev) {
     if (rpm <= 0.0 || pulses_per_rev == 0) return 0;
 
     double hz = (rpm / 60.0) * pulses_per_rev;
-    return hz_to_duty_period(hz);
+    return hz_to_duty_period((uint32_t)llround(hz));
 }
 
 // Duration (s) → steps
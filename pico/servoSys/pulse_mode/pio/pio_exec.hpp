@@ -1,9 +1,91 @@
 #pragma once
 
 #include "hardware/pio.h"
+#include "timing/pio_timing.hpp"
 #include <stdint.h>
 #include <stddef.h>
 
+// =======================
+// Stream formats (motor_exec.pio)
+// =======================
+//
+//   Raw    : 2 words / command  [duty_period, steps]
+//   Packed : 1 word  / command  duty_period | steps << 16  (both <= 0xFFFF)
+//
+// 两种格式共享同一个程序与脉冲核心，时序模型完全相同；
+// 按 SM 选择（wrap bottom），word 0 在两种格式下都是空命令（ring 补零安全）。
+// PIO 没有加法器，因此 packed 用绝对 duty 而不是 delta。
+
+enum class MotorExecFormat : uint8_t {
+    Raw,
+    Packed
+};
+
+constexpr uint32_t MOTOR_EXEC_PACKED_MAX = 0xFFFFu;
+
+constexpr uint32_t motor_exec_pack(uint32_t duty_period, uint32_t steps) {
+    return (duty_period & MOTOR_EXEC_PACKED_MAX) | (steps << 16);
+}
+
+constexpr size_t motor_exec_cmd_words(MotorExecFormat fmt) {
+    return (fmt == MotorExecFormat::Packed) ? 1u : 2u;
+}
+
+// Slow pulses (duty_period > 0xFFFF) in packed format, per pulse:
+//   [M, 1] + dwell [d, 0] ...   with the same 2 * duty + 8 period
+//   (M = min(0xFFFF, duty - 9); dwell absorbs the rest incl. framing)
+constexpr size_t motor_exec_packed_step_words(uint32_t duty_period) {
+    if (duty_period <= MOTOR_EXEC_PACKED_MAX) return 1;
+
+    const uint32_t m = (duty_period - 9u > MOTOR_EXEC_PACKED_MAX) ? MOTOR_EXEC_PACKED_MAX
+                                                                  : duty_period - 9u;
+    uint64_t rest = 2ull * (duty_period - m) - MOTOR_EXEC_CMD_OVERHEAD;
+
+    size_t n = 1;
+    while (rest > 0) {
+        const uint64_t one = MOTOR_EXEC_PACKED_MAX + MOTOR_EXEC_DWELL_FIXED;
+        // never leave a remainder shorter than the smallest dwell
+        const uint64_t take = (rest <= one) ? rest
+                            : (rest - one < MOTOR_EXEC_DWELL_FIXED) ? one - MOTOR_EXEC_DWELL_FIXED
+                            : one;
+        rest -= take;
+        n++;
+    }
+    return n;
+}
+
+// writes the words of ONE slow pulse; 0 if capacity is too small
+size_t motor_exec_pack_slow_step(uint32_t duty_period, uint32_t* out, size_t capacity);
+
+// raw -> packed
+//   - steps > 0xFFFF are split into several packed commands
+//   - duty_period > 0xFFFF: one slow pulse encoding per step
+//   - returns words written; 0 if capacity is too small
+size_t motor_exec_pack_stream(const uint32_t* raw,
+                              size_t raw_words,
+                              uint32_t* out,
+                              size_t capacity);
+
+// =======================
+// Speed blending (raw format)
+// =======================
+//
+// One segment of `steps` pulses at v1_hz, entered from v0_hz:
+// the speed change is spread over the first steps as a constant
+// acceleration ramp (v^2 linear in distance, limited by a_max),
+// cut into <= max_ramp_cmds commands. Step count stays exact.
+//   - v0_hz == 0 or a_max == 0: no ramp, one command at v1_hz
+//   - returns raw words written (<= 2 * (max_ramp_cmds + 1)),
+//     0 if invalid or capacity is too small
+size_t motor_exec_blend_segment(const PioTiming& timing,
+                                uint32_t v0_hz,
+                                uint32_t v1_hz,
+                                uint32_t steps,
+                                uint32_t a_max,
+                                size_t max_ramp_cmds,
+                                uint32_t* out,
+                                size_t capacity);
+
 // =======================
 // PIO init (STEP only)
 // =======================
@@ -15,6 +97,17 @@ void motor_exec_init(
     float clk_div
 );
 
+// Select the FIFO format of a STOPPED SM (FIFOs cleared by caller).
+// Also parks the PC at the format's entry, so a command interrupted
+// mid-pulse never resumes with stale X / Y.
+void motor_exec_set_format(
+    PIO pio,
+    uint sm,
+    uint offset,
+    MotorExecFormat fmt
+);
+
+// raw format only
 void motor_exec_run(
     PIO pio,
     uint sm,
@@ -22,37 +115,152 @@ void motor_exec_run(
     uint32_t steps
 );
 
+// Hardware idle check (no busy waiting, pure register read)
+//   idle == PC at wait_cmd / wait_packed AND TX FIFO empty
+//   即：所有已写入 FIFO 的命令都已执行完最后一个脉冲
+bool motor_exec_idle(PIO pio, uint sm, uint offset);
+
 // ------------------------------------------------------------
 // PIO program loader (shared, idempotent)
 // ------------------------------------------------------------
 
 // Ensure motor_exec_program is loaded into given PIO.
-// Safe to call multiple times.
-// Returns program offset inside the PIO instruction memory.
-uint motor_exec_ensure_program(PIO pio);
+// Safe to call multiple times; every SM of the PIO shares one copy.
+// Returns program offset inside the PIO instruction memory,
+// -1 if the PIO is unknown or its instruction memory is full.
+int motor_exec_ensure_program(PIO pio);
+
+// the program itself (for pio_res_claim, see pio_resources.hpp)
+const pio_program_t* motor_exec_program_ptr();
 
 // =======================
 // DMA stream execution
 // =======================
 
-// 启动一次 DMA 指令流注入
+// 启动一次 DMA 指令流注入（格式由 motor_exec_set_format 决定，默认 raw）
 // - words: uint32_t 指令流
 // - count: word 数量
+// - enable_sm: false => SM 保持停止，DMA 只预装 TX FIFO，
+//              由调用者统一使能（多轴同步启动，见 PS100_Group）
 // - 返回 DMA channel（>=0），失败返回 -1
 int motor_exec_stream_start(
     PIO pio,
     uint sm,
     const uint32_t* words,
-    size_t count
+    size_t count,
+    bool enable_sm = true
 );
 
-// 中止一次 DMA 指令流
+// 中止一次 DMA 指令流（同时释放 channel）
 void motor_exec_stream_abort(int dma_chan);
 
+// DMA 是否仍在向 FIFO 推送
+bool motor_exec_stream_busy(int dma_chan);
+
+// =======================
+// DMA ring stream (ping-pong, unbounded length)
+// =======================
+//
+// buf 由调用者提供，大小为 2 * half_words，分为 A / B 两半：
+//   - 一个数据通道按 PIO TX DREQ 把当前半区写入 pio->txf[sm]
+//   - 一个控制通道在数据通道结束时把下一半区地址写回数据通道并触发
+//     (data -> ctrl -> data ... 链式，中间没有 CPU 参与)
+//   - 每个半区结束触发 DMA_IRQ_0，在 IRQ 中调用 refill 填充刚空出的半区
+//
+// refill 约定：
+//   - 在 IRQ 上下文中调用，必须短小、不可阻塞
+//   - 向 dst 写入 <= capacity 个 word（完整命令，raw 格式不可截断半条）
+//   - 返回实际写入的 word 数；返回 0 表示流结束
+//     （生产者之后又有数据时可用 motor_exec_ring_resume 接着跑）
+//   - 不足 capacity 的部分由 ring 以 0 补齐（duty=0, steps=0 => 空命令）
+//
+// 若 CPU 来不及 refill（IRQ 延迟超过半区执行时间），控制通道会读到空地址，
+// 流在半区边界处干净停止并记录 underrun，不会重放旧数据或越界读取。
+
+typedef size_t (*motor_exec_refill_fn)(uint32_t* dst, size_t capacity, void* user);
+
+// 启动 ring 流
+// - half_words: 每个半区的 word 数（> 0；raw 格式必须为偶数）
+// - enable_sm: 同 motor_exec_stream_start
+// - 返回 ring id（>=0），失败返回 -1（参数非法 / 首个半区为空 / 无空闲 DMA）
+int motor_exec_ring_start(
+    PIO pio,
+    uint sm,
+    uint32_t* buf,
+    size_t half_words,
+    motor_exec_refill_fn refill,
+    void* user,
+    bool enable_sm = true
+);
+
+// 同 motor_exec_ring_start，但不触碰状态机（不 stop / clear / restart）：
+// 数据接在 SM 当前命令与 TX FIFO 之后，命令之间没有停顿。
+// - 调用者保证此时没有其它 DMA 在向该 SM 推送，且 SM 格式与 refill 一致
+// - SM 必须已使能（通常正在执行上一条命令，或已空闲在 wait_cmd）
+int motor_exec_ring_append(
+    PIO pio,
+    uint sm,
+    uint32_t* buf,
+    size_t half_words,
+    motor_exec_refill_fn refill,
+    void* user
+);
+
+// DMA 侧是否仍在推送（false 之后 FIFO 中最多还有 8 个 word 在执行）
+bool motor_exec_ring_active(int ring);
+
+// refill 返回 0 之后生产者又有了数据：让 ring 接着跑，不等待
+// - DMA 仍在推送最后一个半区：该半区结束的 IRQ 里重新 refill 并重启链
+// - 链已停：立即从空闲半区重启
+// 两种情况 SM 都不受影响，新命令直接排在 FIFO 中剩余命令之后。
+// 只能在 ring IRQ 所在的核上调用（ring 未结束时是 no-op）。
+// 返回 false：ring 无效，或 refill 仍返回 0
+bool motor_exec_ring_resume(int ring);
+
+// 是否因 refill 不及时而提前结束
+bool motor_exec_ring_underrun(int ring);
+
+// 中止并释放 ring（DMA 通道归还）；对已结束的 ring 同样需要调用以释放资源
+void motor_exec_ring_release(int ring);
+
+// =======================
+// Progress counter (RX token sink)
+// =======================
+//
+// motor_exec 每完成一个脉冲 push 一个 token 到 RX FIFO。
+// 一个 DMA 通道按 RX DREQ 把 token 抽到固定的 sink word，
+// 该通道的 transfer_count 递减即为“已完成脉冲数”——纯硬件计数，CPU 零负担。
+//
+// 单次 reset 后可计 MOTOR_EXEC_COUNTER_SPAN 个脉冲（@1 MHz 约 268 s）。
+
+constexpr uint32_t MOTOR_EXEC_COUNTER_SPAN = 0x0FFFFFFFu;
+
+// 申请计数通道并绑定到 (pio, sm)；失败返回 -1
+int motor_exec_counter_attach(PIO pio, uint sm);
+
+// 清零：须在 SM 停止时调用（命令启动前）
+void motor_exec_counter_reset(int chan);
+
+// reset 以来完成的脉冲数
+uint32_t motor_exec_counter_read(int chan);
+
+void motor_exec_counter_detach(int chan);
+
 // =======================
 // Time model helpers
 // =======================
-uint32_t hz_to_duty_period(double hz);
+
+// Active motor_exec timing model (clk_div = 1), integer conversions only.
+// clk_sys 在首次使用 / motor_exec_init 时读取一次并缓存。
+const PioTiming& motor_exec_timing();
+PioTiming        motor_exec_timing_for(float clk_div);
+void             motor_exec_timing_refresh();   // clk_sys 改变后调用
+
+uint32_t hz_to_duty_period(uint32_t hz);
+uint32_t duration_ms_to_steps(uint32_t duration_ms, uint32_t hz);   // rounded
+
+// double 接口：仅供 host / 初始化代码，命令路径用上面的整数接口
+// 或 timing/axis_units.hpp (Q16.16)
 uint32_t period_to_duty_period(double period_s);
 uint32_t rpm_to_duty_period(double rpm, uint32_t pulses_per_rev);
 uint32_t duration_to_steps(double duration_s, double hz);
@@ -0,0 +1,162 @@
+#include "pio_resources.hpp"
+
+#include <string.h>
+
+// ------------------------------------------------------------
+// Internal state
+// ------------------------------------------------------------
+
+namespace {
+
+// 每个 PIO 最多 32 条指令，8 个不同程序足够
+constexpr uint MAX_PROGRAMS = 8;
+
+struct LoadedProgram {
+    const pio_program_t* prog;   // 第一次加载时的实例（静态存储）
+    uint                 offset;
+};
+
+static LoadedProgram loaded[PIO_RES_COUNT][MAX_PROGRAMS];
+static uint          loaded_count[PIO_RES_COUNT];
+
+// 生成的 .pio.h 在每个 TU 里各有一份 static 实例：按内容比较
+static bool same_program(const pio_program_t* a, const pio_program_t* b) {
+    if (a == b) return true;
+    return a->length == b->length &&
+           a->origin == b->origin &&
+           memcmp(a->instructions, b->instructions, a->length * sizeof(uint16_t)) == 0;
+}
+
+static int find_loaded(uint idx, const pio_program_t* prog) {
+    for (uint i = 0; i < loaded_count[idx]; ++i) {
+        if (same_program(loaded[idx][i].prog, prog)) return (int)loaded[idx][i].offset;
+    }
+    return -1;
+}
+
+// count 个连续 SM（mod 4）从 sm 开始全部空闲
+static bool sms_free(PIO pio, uint sm, uint count) {
+    for (uint i = 0; i < count; ++i) {
+        if (pio_sm_is_claimed(pio, (sm + i) % PIO_RES_SMS)) return false;
+    }
+    return true;
+}
+
+static bool try_claim_on(PIO pio, const pio_program_t* prog, uint count, PioResSlot& out) {
+    for (uint sm = 0; sm < PIO_RES_SMS; ++sm) {
+        if (!sms_free(pio, sm, count)) continue;
+
+        const int offset = pio_res_program(pio, prog);
+        if (offset < 0) return false;
+
+        for (uint i = 0; i < count; ++i) pio_sm_claim(pio, (sm + i) % PIO_RES_SMS);
+
+        out.pio    = pio;
+        out.sm     = sm;
+        out.offset = (uint)offset;
+        return true;
+    }
+    return false;
+}
+
+} // namespace
+
+// ------------------------------------------------------------
+// Public API
+// ------------------------------------------------------------
+
+int pio_res_index(PIO pio) {
+    for (uint i = 0; i < PIO_RES_COUNT; ++i) {
+        if (pio_get_instance(i) == pio) return (int)i;
+    }
+    return -1;
+}
+
+PIO pio_res_instance(uint index) {
+    return (index < PIO_RES_COUNT) ? pio_get_instance(index) : nullptr;
+}
+
+gpio_function_t pio_res_gpio_func(PIO pio) {
+    switch (pio_res_index(pio)) {
+        case 0:  return GPIO_FUNC_PIO0;
+        case 1:  return GPIO_FUNC_PIO1;
+#if NUM_PIOS > 2
+        case 2:  return GPIO_FUNC_PIO2;
+#endif
+        default: return GPIO_FUNC_NULL;
+    }
+}
+
+int pio_res_program(PIO pio, const pio_program_t* prog) {
+    const int idx = pio_res_index(pio);
+    if (idx < 0 || !prog) return -1;
+
+    const int offset = find_loaded((uint)idx, prog);
+    if (offset >= 0) return offset;
+
+    if (loaded_count[idx] >= MAX_PROGRAMS) return -1;
+    if (!pio_can_add_program(pio, prog)) return -1;
+
+    LoadedProgram& p = loaded[idx][loaded_count[idx]++];
+    p.prog   = prog;
+    p.offset = pio_add_program(pio, prog);
+    return (int)p.offset;
+}
+
+bool pio_res_program_loaded(PIO pio, const pio_program_t* prog) {
+    const int idx = pio_res_index(pio);
+    if (idx < 0 || !prog) return false;
+    return find_loaded((uint)idx, prog) >= 0;
+}
+
+bool pio_res_program_unload(PIO pio, const pio_program_t* prog) {
+    const int idx = pio_res_index(pio);
+    if (idx < 0 || !prog) return false;
+
+    for (uint i = 0; i < loaded_count[idx]; ++i) {
+        if (!same_program(loaded[idx][i].prog, prog)) continue;
+
+        pio_remove_program(pio, loaded[idx][i].prog, loaded[idx][i].offset);
+
+        // 表保持紧凑：后面的条目前移
+        for (uint k = i + 1; k < loaded_count[idx]; ++k) loaded[idx][k - 1] = loaded[idx][k];
+        --loaded_count[idx];
+        return true;
+    }
+    return false;
+}
+
+bool pio_res_claim(const pio_program_t* prog, uint count, PioResSlot& out, PIO exclude) {
+    if (!prog || count == 0 || count > PIO_RES_SMS) return false;
+
+    // 1. 已有该程序的 PIO（共享指令内存）
+    for (uint i = 0; i < PIO_RES_COUNT; ++i) {
+        PIO pio = pio_get_instance(i);
+        if (pio == exclude || !pio_res_program_loaded(pio, prog)) continue;
+        if (try_claim_on(pio, prog, count, out)) return true;
+    }
+
+    // 2. 其余能装下它的 PIO
+    for (uint i = 0; i < PIO_RES_COUNT; ++i) {
+        PIO pio = pio_get_instance(i);
+        if (pio == exclude || pio_res_program_loaded(pio, prog)) continue;
+        if (try_claim_on(pio, prog, count, out)) return true;
+    }
+    return false;
+}
+
+void pio_res_unclaim(const PioResSlot& slot, uint count) {
+    for (uint i = 0; i < count; ++i) {
+        pio_sm_unclaim(slot.pio, (slot.sm + i) % PIO_RES_SMS);
+    }
+}
+
+uint pio_res_free_sms(PIO pio) {
+    if (pio_res_index(pio) < 0) return 0;
+
+    uint n = 0;
+    for (uint sm = 0; sm < PIO_RES_SMS; ++sm) {
+        if (!pio_sm_is_claimed(pio, sm)) ++n;
+    }
+    return n;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "hardware/pio.h"
+#include "hardware/gpio.h"
+#include <stdint.h>
+
+// =======================
+// PIO resources (every PIO block of the chip)
+// =======================
+//
+// RP2040: pio0 / pio1, RP2350: pio0 / pio1 / pio2 (NUM_PIOS, SDK).
+//
+// Program table per PIO: every module asking for the same program on
+// the same PIO gets the same offset, i.e. ONE copy in instruction
+// memory shared by all SMs. Programs are matched by content, so the
+// per-TU copies of a generated .pio.h header are the same program.
+//
+// Unknown PIO / no SM / no instruction space => -1 / false,
+// never an alias onto another block.
+
+constexpr uint PIO_RES_COUNT = NUM_PIOS;
+constexpr uint PIO_RES_SMS   = NUM_PIO_STATE_MACHINES;
+
+// 0 .. PIO_RES_COUNT - 1, -1 if `pio` is not a PIO of this chip
+int pio_res_index(PIO pio);
+
+// nullptr if index >= PIO_RES_COUNT
+PIO pio_res_instance(uint index);
+
+// GPIO_FUNC_PIOn of `pio`, GPIO_FUNC_NULL if unknown
+gpio_function_t pio_res_gpio_func(PIO pio);
+
+// offset of `prog` in `pio`, loaded on first use; -1 if no space / bad PIO
+int pio_res_program(PIO pio, const pio_program_t* prog);
+
+// already loaded in `pio`?
+bool pio_res_program_loaded(PIO pio, const pio_program_t* prog);
+
+// Remove `prog` from `pio` (test firmware cycling programs through one
+// PIO). The caller guarantees that no SM still runs it: offsets handed
+// out before become invalid. false: not loaded
+bool pio_res_program_unload(PIO pio, const pio_program_t* prog);
+
+// ------------------------------------------------------------
+// SM allocation
+// ------------------------------------------------------------
+
+struct PioResSlot {
+    PIO  pio;
+    uint sm;       // first SM (count SMs: sm, sm+1, ... mod 4)
+    uint offset;   // program offset
+};
+
+// Claims `count` consecutive SMs (mod 4) on one PIO that holds or can
+// load `prog`, and loads it. PIOs that already hold the program are
+// tried first (sharing). `exclude` (optional) is skipped.
+// false: nothing claimed
+bool pio_res_claim(const pio_program_t* prog, uint count, PioResSlot& out,
+                   PIO exclude = nullptr);
+
+void pio_res_unclaim(const PioResSlot& slot, uint count);
+
+// free SMs on `pio` (diagnostics / planning)
+uint pio_res_free_sms(PIO pio);
@@ -0,0 +1,84 @@
+#include "step_capture.hpp"
+
+#include "hardware/dma.h"
+#include "hardware/gpio.h"
+#include "hardware/structs/systick.h"
+
+#include "step_capture.pio.h"
+#include "pio_resources.hpp"
+
+// ------------------------------------------------------------
+// Public API
+// ------------------------------------------------------------
+
+bool step_capture_init(PIO pio, uint sm, uint pin) {
+    const int loaded = pio_res_program(pio, &step_capture_program);
+    if (loaded < 0) return false;
+
+    const uint offset = (uint)loaded;
+
+    // 只读：不调用 pio_gpio_init，pin 的 function 保持不变
+    pio_sm_config c = step_capture_program_get_default_config(offset);
+    sm_config_set_jmp_pin(&c, pin);
+    sm_config_set_in_shift(&c, false, false, 32);
+    sm_config_set_fifo_join(&c, PIO_FIFO_JOIN_RX);   // 8 级 RX，给 DMA 余量
+    sm_config_set_clkdiv(&c, 1.0f);
+
+    pio_sm_init(pio, sm, offset + step_capture_offset_start, &c);
+    pio_sm_set_enabled(pio, sm, false);
+    return true;
+}
+
+int step_capture_start(PIO pio, uint sm, uint32_t* buf, size_t count,
+                       uint32_t* systick_enable) {
+    if (!buf || count == 0) return -1;
+
+    int chan = dma_claim_unused_channel(false);
+    if (chan < 0) return -1;
+
+    // ===== 1. 停止、清 FIFO、PC 回到 start（X 重新装载）=====
+    pio_sm_set_enabled(pio, sm, false);
+    pio_sm_clear_fifos(pio, sm);
+    pio_sm_restart(pio, sm);
+    const int offset = pio_res_program(pio, &step_capture_program);
+    if (offset < 0) {
+        dma_channel_unclaim((uint)chan);
+        return -1;
+    }
+    pio_sm_exec(pio, sm, pio_encode_jmp((uint)offset + step_capture_offset_start));
+
+    // ===== 2. DMA: RX FIFO -> buf =====
+    dma_channel_config cfg = dma_channel_get_default_config((uint)chan);
+
+    channel_config_set_transfer_data_size(&cfg, DMA_SIZE_32);
+    channel_config_set_read_increment(&cfg, false);
+    channel_config_set_write_increment(&cfg, true);
+    channel_config_set_dreq(&cfg, pio_get_dreq(pio, sm, false));
+
+    dma_channel_configure(
+        (uint)chan,
+        &cfg,
+        buf,
+        &pio->rxf[sm],
+        (uint32_t)count,
+        true
+    );
+
+    // ===== 3. 计时起点 =====
+    pio_sm_set_enabled(pio, sm, true);
+    if (systick_enable) *systick_enable = systick_hw->cvr;
+    return chan;
+}
+
+size_t step_capture_count(int dma_chan, size_t count) {
+    if (dma_chan < 0) return 0;
+    return count - dma_hw->ch[dma_chan].transfer_count;
+}
+
+void step_capture_stop(PIO pio, uint sm, int dma_chan) {
+    pio_sm_set_enabled(pio, sm, false);
+
+    if (dma_chan < 0) return;
+    dma_channel_abort((uint)dma_chan);
+    dma_channel_unclaim((uint)dma_chan);
+}
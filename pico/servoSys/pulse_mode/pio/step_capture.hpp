@@ -0,0 +1,47 @@
+#pragma once
+
+#include "hardware/pio.h"
+#include <stdint.h>
+#include <stddef.h>
+
+// =======================
+// STEP edge capture (pio/step_capture.pio)
+// =======================
+//
+// Timestamps every rising edge of a pin with 2-cycle resolution
+// (PIO clock = clk_sys, clk_div 1). One SM + one DMA channel;
+// the observed pin is only read, any backend may drive it.
+//
+// Samples are raw X values (down counter), convert with the helpers:
+//   period  = step_capture_delta(a, b)   (cycles, a before b)
+//   latency = step_capture_first(x0)     (cycles since the SM was enabled)
+
+constexpr uint32_t STEP_CAPTURE_EDGE_FIXED  = 5;   // uncounted cycles per edge
+constexpr uint32_t STEP_CAPTURE_FIRST_FIXED = 4;   // enable .. first sample
+
+constexpr uint32_t step_capture_delta(uint32_t x_prev, uint32_t x) {
+    return 2u * (x_prev - x) + STEP_CAPTURE_EDGE_FIXED;
+}
+
+constexpr uint32_t step_capture_first(uint32_t x) {
+    return 2u * (0xFFFFFFFFu - x) + STEP_CAPTURE_FIRST_FIXED;
+}
+
+// Load the program (idempotent per PIO), configure the SM (stopped).
+// Returns false if the program does not fit.
+bool step_capture_init(PIO pio, uint sm, uint pin);
+
+// Restart the SM at `start` and let DMA write up to `count` samples
+// into buf. Returns the DMA channel (>= 0) or -1.
+// The SM is enabled right before returning: call the command
+// under test immediately after this.
+// systick_enable (optional): SysTick CVR read right after the enable
+// (clk_sys down counter), i.e. the time base of step_capture_first().
+int step_capture_start(PIO pio, uint sm, uint32_t* buf, size_t count,
+                       uint32_t* systick_enable = nullptr);
+
+// samples written so far
+size_t step_capture_count(int dma_chan, size_t count);
+
+// stop SM, abort DMA, release the channel
+void step_capture_stop(PIO pio, uint sm, int dma_chan);
@@ -0,0 +1,152 @@
+#include "step_position.hpp"
+
+#include "hardware/dma.h"
+
+#include "step_position.pio.h"
+#include "pio_resources.hpp"
+
+// ------------------------------------------------------------
+// Internal state
+// ------------------------------------------------------------
+
+namespace {
+
+// DMA 每个 edge 搬 1 word，2^32 - 1 次后由 read() 重新触发
+constexpr uint32_t POSITION_SPAN = 0xFFFFFFFFu;
+
+struct PositionSlot {
+    volatile uint32_t raw;      // DMA 写入的 X（唯一的共享数据）
+    PIO  pio;
+    uint sm;
+    int  dma_ch;
+    bool invert;
+    bool owns_sm;
+    bool in_use;
+};
+
+static PositionSlot slots[STEP_POSITION_MAX_AXES];
+
+static inline bool valid(int slot) {
+    return slot >= 0 && slot < STEP_POSITION_MAX_AXES && slots[slot].in_use;
+}
+
+// 让 SM 立即 push 当前 X（stalled 在 wait 上也会执行）
+static inline void publish_now(const PositionSlot& s) {
+    pio_sm_exec(s.pio, s.sm, pio_encode_mov(pio_isr, pio_x));
+    pio_sm_exec(s.pio, s.sm, pio_encode_push(false, false));
+}
+
+static void dma_arm(PositionSlot& s) {
+    dma_channel_config cfg = dma_channel_get_default_config((uint)s.dma_ch);
+
+    channel_config_set_transfer_data_size(&cfg, DMA_SIZE_32);
+    channel_config_set_read_increment(&cfg, false);
+    channel_config_set_write_increment(&cfg, false);
+    channel_config_set_dreq(&cfg, pio_get_dreq(s.pio, s.sm, false));
+
+    dma_channel_configure(
+        (uint)s.dma_ch,
+        &cfg,
+        &s.raw,               // 只保留最新值
+        &s.pio->rxf[s.sm],
+        POSITION_SPAN,
+        true
+    );
+}
+
+} // namespace
+
+// ------------------------------------------------------------
+// Public API
+// ------------------------------------------------------------
+
+const pio_program_t* step_position_program_ptr() {
+    return &step_position_program;
+}
+
+int step_position_attach(PIO pio, uint step_pin, uint dir_pin, bool dir_invert, int claimed_sm) {
+    int slot = -1;
+    for (int i = 0; i < STEP_POSITION_MAX_AXES; ++i) {
+        if (!slots[i].in_use) { slot = i; break; }
+    }
+    if (slot < 0) return -1;
+
+    const int offset = pio_res_program(pio, &step_position_program);
+    if (offset < 0) return -1;
+
+    // claimed_sm >= 0: 调用者（AxisManager）已占用，detach 时也由它释放
+    const bool owns_sm = (claimed_sm < 0);
+    const int  sm      = owns_sm ? pio_claim_unused_sm(pio, false) : claimed_sm;
+    if (sm < 0 || (uint)sm >= PIO_RES_SMS) return -1;
+
+    const int ch = dma_claim_unused_channel(false);
+    if (ch < 0) {
+        if (owns_sm) pio_sm_unclaim(pio, (uint)sm);
+        return -1;
+    }
+
+    PositionSlot& s = slots[slot];
+    s.raw    = 0;
+    s.pio    = pio;
+    s.sm     = (uint)sm;
+    s.dma_ch = ch;
+    s.invert  = dir_invert;
+    s.owns_sm = owns_sm;
+    s.in_use  = true;
+
+    // 只读：不调用 pio_gpio_init，STEP / DIR 的 function 保持不变
+    pio_sm_config c = step_position_program_get_default_config((uint)offset);
+    sm_config_set_in_pins(&c, step_pin);
+    sm_config_set_jmp_pin(&c, dir_pin);
+    sm_config_set_in_shift(&c, false, false, 32);
+    // 不 join：TX FIFO 留给 step_position_set() 装入 X，RX 4 级由 DMA 持续抽空
+    sm_config_set_clkdiv(&c, 1.0f);
+
+    pio_sm_init(pio, s.sm, (uint)offset, &c);
+
+    // X = 0
+    pio_sm_exec(pio, s.sm, pio_encode_set(pio_x, 0));
+
+    dma_arm(s);
+    pio_sm_set_enabled(pio, s.sm, true);
+    return slot;
+}
+
+void step_position_detach(int slot) {
+    if (!valid(slot)) return;
+    PositionSlot& s = slots[slot];
+
+    pio_sm_set_enabled(s.pio, s.sm, false);
+    dma_channel_abort((uint)s.dma_ch);
+    dma_channel_unclaim((uint)s.dma_ch);
+    if (s.owns_sm) pio_sm_unclaim(s.pio, s.sm);
+
+    s.in_use = false;
+}
+
+int32_t step_position_read(int slot) {
+    if (!valid(slot)) return 0;
+    PositionSlot& s = slots[slot];
+
+    // 2^32 - 1 个 edge 后 DMA 结束：重新触发并补发一次当前值
+    if (!dma_channel_is_busy((uint)s.dma_ch)) {
+        dma_arm(s);
+        publish_now(s);
+    }
+
+    const int32_t p = (int32_t)s.raw;
+    return s.invert ? -p : p;
+}
+
+void step_position_set(int slot, int32_t position) {
+    if (!valid(slot)) return;
+    PositionSlot& s = slots[slot];
+
+    const uint32_t raw = (uint32_t)(s.invert ? -position : position);
+
+    // TX FIFO 未被程序使用：put + pull + mov 装入 X
+    pio_sm_put(s.pio, s.sm, raw);
+    pio_sm_exec(s.pio, s.sm, pio_encode_pull(false, false));
+    pio_sm_exec(s.pio, s.sm, pio_encode_mov(pio_x, pio_osr));
+    publish_now(s);
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "hardware/pio.h"
+#include "pio_resources.hpp"
+#include <stdint.h>
+
+// =======================
+// Hardware step position register (pio/step_position.pio)
+// =======================
+//
+// One SM per axis counts STEP rising edges, +1 / -1 by the DIR level
+// at the edge. DMA copies X into a RAM word after every edge:
+//   - step_position_read() is a single aligned 32-bit load:
+//     lock-free, safe from any core / IRQ, never torn
+//   - exact by construction: RX overflow only delays the update,
+//     the next push carries the absolute count
+//
+// Resources per axis: 1 SM (claimed on `pio`), 1 DMA channel.
+// The program (10 instructions) is loaded once per PIO.
+
+constexpr int STEP_POSITION_MAX_AXES = PIO_RES_COUNT * PIO_RES_SMS;   // every SM of the chip
+
+// the program itself (for pio_res_claim, see pio_resources.hpp)
+const pio_program_t* step_position_program_ptr();
+
+// dir_invert: forward == DIR low (same meaning as PS100_P::Config)
+// claimed_sm: SM already claimed by the caller (AxisManager), which
+//             also unclaims it; -1 => claim a free SM of `pio` here.
+// Returns a slot (>= 0), -1 if no SM / DMA / program space.
+int step_position_attach(PIO pio, uint step_pin, uint dir_pin, bool dir_invert,
+                         int claimed_sm = -1);
+
+void step_position_detach(int slot);
+
+// current position (steps, forward positive)
+int32_t step_position_read(int slot);
+
+// overwrite the register (homing / zeroing). STEP must be idle.
+void step_position_set(int slot, int32_t position);
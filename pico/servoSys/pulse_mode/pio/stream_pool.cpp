@@ -0,0 +1,120 @@
+#include "stream_pool.hpp"
+
+#include "hardware/sync.h"
+
+// ------------------------------------------------------------
+// Internal state
+// ------------------------------------------------------------
+
+namespace {
+
+static uint32_t arena[STREAM_POOL_BLOCKS][STREAM_POOL_BLOCK_WORDS];
+static uint8_t  refs[STREAM_POOL_BLOCKS] = {};   // handles per block, 0 = free
+
+// striped lock：SDK 允许用户代码共享，用于极短临界区（几条指令）
+static inline spin_lock_t* pool_lock() {
+    return spin_lock_instance(PICO_SPINLOCK_ID_STRIPED_FIRST);
+}
+
+static int claim_block() {
+    spin_lock_t* lock = pool_lock();
+    const uint32_t irq = spin_lock_blocking(lock);
+
+    int block = -1;
+    for (size_t i = 0; i < STREAM_POOL_BLOCKS; ++i) {
+        if (refs[i] == 0) {
+            refs[i] = 1;
+            block = (int)i;
+            break;
+        }
+    }
+
+    spin_unlock(lock, irq);
+    return block;
+}
+
+static bool ref_block(int block) {
+    spin_lock_t* lock = pool_lock();
+    const uint32_t irq = spin_lock_blocking(lock);
+    const bool ok = refs[block] < 0xFF;
+    if (ok) ++refs[block];
+    spin_unlock(lock, irq);
+    return ok;
+}
+
+static void unref_block(int block) {
+    spin_lock_t* lock = pool_lock();
+    const uint32_t irq = spin_lock_blocking(lock);
+    --refs[block];
+    spin_unlock(lock, irq);
+}
+
+} // namespace
+
+// ------------------------------------------------------------
+// StreamBuffer
+// ------------------------------------------------------------
+
+StreamBuffer::StreamBuffer(StreamBuffer&& other)
+    : block_(other.block_), size_(other.size_) {
+    other.block_ = -1;
+    other.size_  = 0;
+}
+
+StreamBuffer& StreamBuffer::operator=(StreamBuffer&& other) {
+    if (this != &other) {
+        reset();
+        block_ = other.block_;
+        size_  = other.size_;
+        other.block_ = -1;
+        other.size_  = 0;
+    }
+    return *this;
+}
+
+StreamBuffer StreamBuffer::acquire(size_t words) {
+    if (words > STREAM_POOL_BLOCK_WORDS) return StreamBuffer();
+    return StreamBuffer(claim_block());
+}
+
+void StreamBuffer::reset() {
+    if (block_ < 0) return;
+    unref_block(block_);
+    block_ = -1;
+    size_  = 0;
+}
+
+StreamBuffer StreamBuffer::share() const {
+    if (block_ < 0 || !ref_block(block_)) return StreamBuffer();
+    StreamBuffer other(block_);
+    other.size_ = size_;
+    return other;
+}
+
+unsigned StreamBuffer::use_count() const {
+    return (block_ >= 0) ? refs[block_] : 0u;
+}
+
+uint32_t* StreamBuffer::data() {
+    return (block_ >= 0) ? arena[block_] : nullptr;
+}
+
+const uint32_t* StreamBuffer::data() const {
+    return (block_ >= 0) ? arena[block_] : nullptr;
+}
+
+size_t StreamBuffer::capacity() const {
+    return (block_ >= 0) ? STREAM_POOL_BLOCK_WORDS : 0;
+}
+
+// ------------------------------------------------------------
+// Public API
+// ------------------------------------------------------------
+
+size_t stream_pool_free_blocks() {
+    size_t n = 0;
+    for (size_t i = 0; i < STREAM_POOL_BLOCKS; ++i) {
+        if (refs[i] == 0) ++n;
+    }
+    return n;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// =======================
+// Static stream buffer pool (motor_exec DMA streams)
+// =======================
+//
+// Fixed arena of STREAM_POOL_BLOCKS x STREAM_POOL_BLOCK_WORDS words in
+// .bss, handed out one block per stream. Replaces calloc / free for
+// trajectory buffers:
+//   - no heap: usage is bounded at link time, no fragmentation
+//   - O(1) acquire / release, guarded by a hardware spin lock, so a
+//     buffer planned on core0 may be released by core1 (or an IRQ)
+//
+// StreamBuffer is the owning handle (move-only). Hand it to
+// PS100_P::run_pio_stream() and the driver keeps the block until
+// the hardware has finished with it.
+//
+// share(): a second handle to the same block (reference counted,
+// the block is freed with the last handle). Used for read-only
+// streams that are run many times (trajectory/profile_cache):
+// a shared block must not be written.
+
+constexpr size_t STREAM_POOL_BLOCKS      = 8;
+constexpr size_t STREAM_POOL_BLOCK_WORDS = 256;   // >= SCurvePlanner::max_words(32) + end marker
+
+class StreamBuffer {
+public:
+    StreamBuffer() = default;
+    ~StreamBuffer() { reset(); }
+
+    StreamBuffer(StreamBuffer&& other);
+    StreamBuffer& operator=(StreamBuffer&& other);
+
+    StreamBuffer(const StreamBuffer&)            = delete;
+    StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+    // one free block with room for `words`; empty handle if none / too large
+    static StreamBuffer acquire(size_t words);
+
+    // give the block back (no-op on an empty handle)
+    //   shared block: drops this handle's reference only
+    void reset();
+
+    // another handle to the same block and size (empty if this one is)
+    StreamBuffer share() const;
+
+    // handles on this block (0 if empty)
+    unsigned use_count() const;
+
+    explicit operator bool() const { return block_ >= 0; }
+
+    uint32_t*       data();
+    const uint32_t* data() const;
+    size_t          capacity() const;          // words, 0 if empty
+
+    // words actually filled (what gets streamed)
+    size_t size() const { return size_; }
+    void   set_size(size_t words) { size_ = (words <= capacity()) ? words : capacity(); }
+
+private:
+    explicit StreamBuffer(int block) : block_(block) {}
+
+    int    block_ = -1;
+    size_t size_  = 0;
+};
+
+// free blocks right now (diagnostics)
+size_t stream_pool_free_blocks();
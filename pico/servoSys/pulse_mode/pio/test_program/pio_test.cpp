@@ -19,7 +19,7 @@ void run_pio_test() {
         1.0f    // clk_div
     );
 
-    double hz = 5000.0;
+    uint32_t hz = 5000;
     uint32_t duty = hz_to_duty_period(hz);
     uint32_t steps = 5;
 
@@ -0,0 +1,499 @@
+#include "pico/stdlib.h"
+#include "hardware/pio.h"
+#include "hardware/clocks.h"
+#include "hardware/structs/systick.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "drivers/ps100.hpp"
+#include "drivers/pwm_motor.hpp"
+#include "pio/pio_exec.hpp"
+#include "pio/step_capture.hpp"
+#include "pio/motor_exec_variants.hpp"
+#include "pio/pio_resources.hpp"
+
+// ============================================================
+// step_bench
+//   STEP edge benchmark for every backend, measured on the pin:
+//     - command call -> first rising edge latency
+//     - period histogram (deviation from the expected period)
+//     - achieved vs requested frequency
+//     - max sustainable rate (sweep)
+//
+//   Time base: step_capture SM (2-cycle resolution, clk_sys)
+//   Command reference: SysTick (clk_sys, 24 bit)
+//   No wiring needed: the capture SM reads the STEP pin itself.
+//
+//   Variant targets run the driver's own encoding
+//   (motor_exec_variant_encode, pulse width / DIR setup as
+//   PS100_P::init derives them): their latency includes the
+//   round's DIR setup (dir_setup_us).
+// ============================================================
+
+// ------------------------------------------------------------
+// configuration (adjust to your wiring)
+// ------------------------------------------------------------
+
+static constexpr uint STEP_PIN   = 3;
+static constexpr uint DIR_PIN    = 4;
+static constexpr uint ENABLE_PIN = static_cast<uint>(-1);
+
+// axis under test: pio0 / sm0 (same as ps100_test)
+// capture: pio0 / sm1 (motor_exec 19 + step_capture 11 instructions)
+// variants: any free SM (pio_res_claim), i.e. pio1, which stays empty
+//   for them: loaded for one run and unloaded after it (the variants
+//   do not fit side by side)
+#define BENCH_PIO pio0
+static constexpr uint CAP_SM = 1;
+
+static constexpr size_t   CAP_MAX        = 4096;      // samples per run
+static constexpr size_t   STREAM_MAX     = 1024;      // stream words (packed slow pulses)
+static constexpr size_t   VARIANT_WORDS  = 8;         // one move = one round (joined TX FIFO)
+static constexpr uint32_t DEFAULT_STEPS  = 1000;
+static constexpr uint32_t HIST_BINS      = 17;        // 2-cycle bins, -16 .. +17 cycles
+static constexpr uint32_t SWEEP_PP_MAX   = 4;         // cycles p-p still "sustained"
+
+// ------------------------------------------------------------
+// targets
+// ------------------------------------------------------------
+
+enum class Target : uint8_t {
+    Pwm,
+    PioParam,
+    PioStream,
+    PioPacked,
+    StepOnly,
+    HalfDuty,
+    HalfDutyV2,
+    Adjustable,
+    Count
+};
+
+static const char* const TARGET_NAMES[] = {
+    "pwm", "pio", "stream", "packed",
+    "step_only", "half_duty", "half_duty_v2", "adjustable"
+};
+
+static const MotorExecProgram* variant_of(Target t) {
+    switch (t) {
+        case Target::StepOnly:   return motor_exec_variant_program(MotorExecVariant::StepOnly);
+        case Target::HalfDuty:   return motor_exec_variant_program(MotorExecVariant::HalfDuty);
+        case Target::HalfDutyV2: return motor_exec_variant_program(MotorExecVariant::HalfDutyV2);
+        case Target::Adjustable: return motor_exec_variant_program(MotorExecVariant::AdjustableDuty);
+        default:                 return nullptr;
+    }
+}
+
+static bool parse_target(const char* s, Target& t) {
+    for (uint32_t i = 0; i < (uint32_t)Target::Count; ++i) {
+        if (strcmp(s, TARGET_NAMES[i]) == 0) {
+            t = (Target)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+// ------------------------------------------------------------
+// globals
+// ------------------------------------------------------------
+
+static PS100_P* motor = nullptr;
+
+static uint32_t cap_buf[CAP_MAX];
+static uint32_t stream_words[STREAM_MAX];
+
+// ------------------------------------------------------------
+// SysTick: free-running 24-bit down counter at clk_sys
+// ------------------------------------------------------------
+
+static void systick_init() {
+    systick_hw->rvr = 0x00FFFFFFu;
+    systick_hw->cvr = 0;
+    systick_hw->csr = 0x5u;   // ENABLE | CLKSOURCE = processor clock
+}
+
+static inline uint32_t systick_now() {
+    return systick_hw->cvr;
+}
+
+static inline uint32_t systick_elapsed(uint32_t from, uint32_t to) {
+    return (from - to) & 0x00FFFFFFu;
+}
+
+// ------------------------------------------------------------
+// one measurement
+// ------------------------------------------------------------
+
+struct Result {
+    uint32_t hz;
+    uint32_t steps;
+    uint32_t edges;           // rising edges seen (steps + 1 slots: extra pulses show)
+    uint32_t expected_x16;    // expected period, 1/16 cycle
+    uint32_t latency;         // command call -> first edge (cycles)
+    uint32_t p_min;
+    uint32_t p_max;
+    uint64_t p_sum;           // over edges - 1 periods
+    uint32_t hist[HIST_BINS];
+    uint32_t hist_under;
+    uint32_t hist_over;
+};
+
+// one variant run: the SM and the encoder state of a PS100_P axis
+struct VariantRun {
+    const MotorExecProgram* prog = nullptr;
+    PioTiming  timing{};
+    uint32_t   high  = 0;      // STEP high loops (PULSE_WIDTH)
+    uint32_t   setup = 0;      // DIR word setup loops
+    PioResSlot slot{};
+};
+
+// timing, pulse width and DIR setup exactly as PS100_P::init derives them
+static void variant_prepare(const MotorExecProgram& p, VariantRun& v) {
+    const PS100_P::Config defaults{};
+    const PioTiming base = motor_exec_variant_timing(p, 1.0f);
+
+    v.prog   = &p;
+    v.high   = motor_exec_variant_high_loops(base, defaults.pulse_high_us);
+    v.timing = motor_exec_variant_timing(p, 1.0f, v.high);
+    v.setup  = motor_exec_variant_setup_loops(v.timing, defaults.dir_setup_us);
+}
+
+static bool variant_setup(VariantRun& v) {
+    if (!pio_res_claim(v.prog->program, 1, v.slot)) return false;
+
+    // STEP (+ DIR for DIR variants) mux -> this SM; PS100_P re-muxes STEP on its next command
+    motor_exec_variant_init(v.slot.pio, v.slot.sm, v.slot.offset, *v.prog,
+                            STEP_PIN, DIR_PIN, 1.0f);
+    pio_sm_exec(v.slot.pio, v.slot.sm, pio_encode_set(pio_pins, 0));
+    pio_sm_set_enabled(v.slot.pio, v.slot.sm, true);
+    return true;
+}
+
+static void variant_teardown(const VariantRun& v) {
+    PIO        pio = v.slot.pio;
+    const uint sm  = v.slot.sm;
+
+    pio_sm_set_enabled(pio, sm, false);
+    pio_sm_clear_fifos(pio, sm);
+    pio_sm_restart(pio, sm);
+    pio_sm_exec(pio, sm, pio_encode_set(pio_pins, 0));
+
+    pio_res_unclaim(v.slot, 1);
+    pio_res_program_unload(pio, v.prog->program);   // room for the next variant
+
+    // DIR back to the CPU (PS100_P::set_direction)
+    if (v.prog->caps & MOTOR_EXEC_CAP_DIR) gpio_set_function(DIR_PIN, GPIO_FUNC_SIO);
+}
+
+// false: target cannot run this request (reason printed)
+static bool measure(Target t, uint32_t hz, uint32_t steps, Result& r) {
+    memset(&r, 0, sizeof(r));
+    r.hz    = hz;
+    r.steps = steps;
+
+    if (hz == 0 || steps == 0 || steps + 1u > CAP_MAX) {
+        printf("  invalid hz / steps (steps <= %u)\n", (unsigned)(CAP_MAX - 1));
+        return false;
+    }
+
+    const uint32_t f_sys = clock_get_hz(clk_sys);
+
+    // ========== prepare (not part of the latency) ==========
+    const MotorExecProgram* v = variant_of(t);
+    VariantRun var;
+    uint32_t   var_words[VARIANT_WORDS];
+    size_t     var_n = 0;
+    size_t     stream_n = 0;
+
+    switch (t) {
+        case Target::Pwm: {
+            const PwmDivChoice dc = pwm_motor_choose_div(f_sys, hz);
+            r.expected_x16 = (uint32_t)dc.div16 * (dc.wrap + 1u);
+            break;
+        }
+        case Target::PioParam:
+        case Target::PioStream:
+        case Target::PioPacked: {
+            const PioTiming& tm = motor->timing();
+            const uint32_t duty = tm.hz_to_duty(hz);
+            r.expected_x16 = tm.period_cycles(duty) * 16u;
+
+            if (t == Target::PioStream) {
+                stream_words[0] = duty;
+                stream_words[1] = steps;
+                stream_n = 2;
+            } else if (t == Target::PioPacked) {
+                const uint32_t raw[2] = { duty, steps };
+                stream_n = motor_exec_pack_stream(raw, 2, stream_words, STREAM_MAX);
+                if (stream_n == 0) {
+                    printf("  packed stream does not fit %u words\n", (unsigned)STREAM_MAX);
+                    return false;
+                }
+            }
+            break;
+        }
+        default: {
+            variant_prepare(*v, var);
+
+            const MotorExecMove move = { hz, steps, true };
+            var_n = motor_exec_variant_encode(*v, var.timing, var.high, var.setup, false,
+                                              &move, 1, var_words, VARIANT_WORDS);
+            if (var_n == 0) {
+                printf("  %s cannot encode %u steps\n", v->name, (unsigned)steps);
+                return false;
+            }
+            r.expected_x16 = var.timing.period_cycles(var.timing.hz_to_duty(hz)) * 16u;
+
+            if (!variant_setup(var)) {
+                printf("  %s: no free SM / instruction space\n", v->name);
+                return false;
+            }
+            break;
+        }
+    }
+
+    const uint64_t run_us =
+        (uint64_t)steps * r.expected_x16 / 16u / (f_sys / 1000000u);
+
+    // ========== measure ==========
+    // steps + 1 slots: a spurious extra pulse is captured, not hidden
+    // t_enable: capture SM enabled (time base of the samples)
+    // t_cmd   : right before the command is issued (driver call / FIFO write)
+    uint32_t t_enable = 0;
+    uint32_t t_cmd    = 0;
+    const int cap = step_capture_start(BENCH_PIO, CAP_SM, cap_buf, steps + 1u, &t_enable);
+    if (cap < 0) {
+        printf("  no DMA channel for capture\n");
+        if (v) variant_teardown(var);
+        return false;
+    }
+
+    switch (t) {
+        case Target::Pwm:
+            t_cmd = systick_now();
+            motor->run_steps(steps, hz, PS100_P::Backend::PWM);
+            break;
+        case Target::PioParam:
+            t_cmd = systick_now();
+            motor->run_steps(steps, hz, PS100_P::Backend::PIO);
+            break;
+        case Target::PioStream:
+            t_cmd = systick_now();
+            motor->run_pio_stream(stream_words, stream_n, run_us, MotorExecFormat::Raw);
+            break;
+        case Target::PioPacked:
+            t_cmd = systick_now();
+            motor->run_pio_stream(stream_words, stream_n, run_us, MotorExecFormat::Packed);
+            break;
+        default:
+            t_cmd = systick_now();
+            for (size_t i = 0; i < var_n; ++i) pio_sm_put(var.slot.pio, var.slot.sm, var_words[i]);
+            break;
+    }
+
+    // ========== wait: all edges + 2 periods + 1 ms for extra ones ==========
+    const uint64_t deadline = time_us_64() + run_us * 2u + 100000u;
+
+    while (step_capture_count(cap, steps + 1u) < steps && time_us_64() < deadline) {
+        tight_loop_contents();
+    }
+    sleep_us((uint32_t)(2u * r.expected_x16 / 16u / (f_sys / 1000000u)) + 1000u);
+
+    r.edges = (uint32_t)step_capture_count(cap, steps + 1u);
+    step_capture_stop(BENCH_PIO, CAP_SM, cap);
+
+    if (v) {
+        variant_teardown(var);
+    } else {
+        while (motor->busy() && time_us_64() < deadline) tight_loop_contents();
+        if (motor->busy()) motor->stop();
+    }
+
+    // ========== analyse ==========
+    if (r.edges == 0) return true;
+
+    const uint32_t first = step_capture_first(cap_buf[0]);
+    const uint32_t issue = systick_elapsed(t_enable, t_cmd);   // capture start -> command
+    r.latency = (first > issue) ? first - issue : 0;
+
+    r.p_min = 0xFFFFFFFFu;
+    for (uint32_t i = 1; i < r.edges; ++i) {
+        const uint32_t p = step_capture_delta(cap_buf[i - 1], cap_buf[i]);
+
+        if (p < r.p_min) r.p_min = p;
+        if (p > r.p_max) r.p_max = p;
+        r.p_sum += p;
+
+        // deviation in whole cycles (expected may be fractional for PWM)
+        const int32_t dev = (int32_t)(((int64_t)p * 16 - (int64_t)r.expected_x16) / 16);
+        if (dev < -16)      r.hist_under++;
+        else if (dev > 17)  r.hist_over++;
+        else                r.hist[(uint32_t)(dev + 16) / 2u]++;
+    }
+    if (r.edges < 2) r.p_min = 0;
+    return true;
+}
+
+// ------------------------------------------------------------
+// report
+// ------------------------------------------------------------
+
+static bool result_ok(const Result& r) {
+    return r.edges == r.steps;
+}
+
+static void print_result(Target t, const Result& r) {
+    const double f_sys = (double)clock_get_hz(clk_sys);
+    const double exp_p = r.expected_x16 / 16.0;
+
+    printf("[%s] req %u Hz x %u: edges %u/%u %s\n",
+           TARGET_NAMES[(uint32_t)t], (unsigned)r.hz, (unsigned)r.steps,
+           (unsigned)r.edges, (unsigned)r.steps,
+           result_ok(r) ? "OK" : (r.edges > r.steps ? "EXTRA PULSES" : "MISSING PULSES"));
+
+    if (r.edges == 0) return;
+
+    printf("  latency  %u cyc (%.3f us)\n",
+           (unsigned)r.latency, r.latency * 1e6 / f_sys);
+
+    if (r.edges < 2) return;
+
+    const double mean = (double)r.p_sum / (double)(r.edges - 1u);
+    const double f_meas = f_sys / mean;
+    const double f_exp  = f_sys / exp_p;
+
+    printf("  period   exp %.2f  mean %.3f  min %u  max %u cyc  (p-p %u cyc, %.1f ns)\n",
+           exp_p, mean, (unsigned)r.p_min, (unsigned)r.p_max,
+           (unsigned)(r.p_max - r.p_min), (r.p_max - r.p_min) * 1e9 / f_sys);
+    printf("  freq     req %u  exp %.3f  meas %.3f Hz  (%+.1f ppm vs req, %+.1f ppm vs exp)\n",
+           (unsigned)r.hz, f_exp, f_meas,
+           (f_meas - r.hz) / r.hz * 1e6, (f_meas - f_exp) / f_exp * 1e6);
+
+    printf("  hist     dev[cyc]: count\n");
+    if (r.hist_under) printf("    < -16     : %u\n", (unsigned)r.hist_under);
+    for (uint32_t b = 0; b < HIST_BINS; ++b) {
+        if (!r.hist[b]) continue;
+        const int lo = (int)(2 * b) - 16;
+        printf("    [%+3d,%+3d] : %u\n", lo, lo + 1, (unsigned)r.hist[b]);
+    }
+    if (r.hist_over) printf("    > +17     : %u\n", (unsigned)r.hist_over);
+}
+
+// ------------------------------------------------------------
+// sweep: max sustainable rate
+//   sustained = exact pulse count, p-p <= SWEEP_PP_MAX, mean within 1 cycle
+// ------------------------------------------------------------
+
+static void sweep(Target t, uint32_t steps) {
+    const uint32_t f_sys = clock_get_hz(clk_sys);
+    const uint32_t f_top = f_sys / 12u;   // capture limit (edge path + loops)
+
+    uint32_t best = 0;
+
+    for (uint32_t hz = 1000; hz <= f_top; hz += (hz / 4u > 0 ? hz / 4u : 1u)) {
+        Result r;
+        if (!measure(t, hz, steps, r)) break;
+
+        bool ok = result_ok(r) && r.edges >= 2;
+        if (ok) {
+            const double mean = (double)r.p_sum / (double)(r.edges - 1u);
+            ok = (r.p_max - r.p_min) <= SWEEP_PP_MAX &&
+                 fabs(mean - r.expected_x16 / 16.0) <= 1.0;
+        }
+
+        printf("  %9u Hz  edges %4u  p-p %3u cyc  lat %6u cyc  %s\n",
+               (unsigned)hz, (unsigned)r.edges,
+               (unsigned)(r.edges >= 2 ? r.p_max - r.p_min : 0),
+               (unsigned)r.latency, ok ? "ok" : "FAIL");
+
+        if (!ok) break;
+        best = hz;
+    }
+
+    printf("[%s] max sustainable rate: %u Hz (steps %u)\n",
+           TARGET_NAMES[(uint32_t)t], (unsigned)best, (unsigned)steps);
+}
+
+// ------------------------------------------------------------
+// CLI
+// ------------------------------------------------------------
+
+static void print_help() {
+    printf("\nstep_bench commands:\n");
+    printf("  bench <target> <hz> [steps]\n");
+    printf("  sweep <target> [steps]\n");
+    printf("  all   <hz> [steps]\n");
+    printf("  pwmcount <dma|irq>\n");
+    printf("targets: pwm pio stream packed step_only half_duty half_duty_v2 adjustable\n");
+    printf("STEP=%u (captured on pio0 sm%u), f_sys=%u Hz\n\n",
+           STEP_PIN, CAP_SM, (unsigned)clock_get_hz(clk_sys));
+}
+
+int main() {
+    stdio_init_all();
+    sleep_ms(2000);
+
+    systick_init();
+
+    // -------- axis under test --------
+    PS100_P::Config cfg{};
+    cfg.step_pin   = STEP_PIN;
+    cfg.dir_pin    = DIR_PIN;
+    cfg.enable_pin = ENABLE_PIN;
+    cfg.pio = pio0;
+    cfg.sm  = 0;
+    cfg.pio_clk_div = 1.0f;
+    cfg.program_offset = motor_exec_ensure_program(cfg.pio);
+
+    static PS100_P axis(cfg);
+    motor = &axis;
+    if (!motor->init()) {
+        printf("PS100_P init failed\n");
+    }
+    motor->enable();
+
+    // -------- capture SM (claimed: pio_res_claim never hands it to a variant) --------
+    pio_sm_claim(BENCH_PIO, CAP_SM);
+    if (!step_capture_init(BENCH_PIO, CAP_SM, STEP_PIN)) {
+        printf("step_capture does not fit into pio0\n");
+    }
+
+    print_help();
+
+    char line[96];
+    char name[24];
+
+    while (true) {
+        if (!fgets(line, sizeof(line), stdin)) continue;
+
+        unsigned hz = 0, steps = DEFAULT_STEPS;
+        Target t;
+
+        if (sscanf(line, "bench %23s %u %u", name, &hz, &steps) >= 2) {
+            if (!parse_target(name, t)) { printf("unknown target\n"); continue; }
+
+            Result r;
+            if (measure(t, hz, steps, r)) print_result(t, r);
+        }
+        else if (sscanf(line, "sweep %23s %u", name, &steps) >= 1) {
+            if (!parse_target(name, t)) { printf("unknown target\n"); continue; }
+            sweep(t, steps);
+        }
+        else if (sscanf(line, "all %u %u", &hz, &steps) >= 1) {
+            for (uint32_t i = 0; i < (uint32_t)Target::Count; ++i) {
+                Result r;
+                if (measure((Target)i, hz, steps, r)) print_result((Target)i, r);
+            }
+        }
+        else if (sscanf(line, "pwmcount %23s", name) == 1) {
+            pwm_motor_set_count_mode(strcmp(name, "irq") == 0 ? PwmCountMode::Irq
+                                                              : PwmCountMode::Dma);
+            printf("pwm count mode: %s\n", strcmp(name, "irq") == 0 ? "irq" : "dma");
+        }
+        else {
+            print_help();
+        }
+    }
+}
@@ -0,0 +1,287 @@
+import os
+import re
+import sys
+
+# ============================================================
+# pioasm_lite: host-side .pio -> .pio.h (pioasm "c-sdk" output)
+#
+# Same instruction encoding, wrap / public label defines and
+# <name>_program_get_default_config() as the SDK's pioasm, for the
+# subset of the language used under pio/:
+#   .program .wrap_target .wrap .origin .side_set [opt] [pindirs] .define
+#   labels (public), jmp wait in out push pull mov irq set nop,
+#   [delay], side <v>
+#
+# usage: python3 pioasm_lite.py <in.pio> <out.pio.h>
+# ============================================================
+
+JMP_COND = {'': 0, '!x': 1, 'x--': 2, '!y': 3, 'y--': 4, 'x!=y': 5, 'pin': 6, '!osre': 7}
+IN_SRC   = {'pins': 0, 'x': 1, 'y': 2, 'null': 3, 'isr': 6, 'osr': 7}
+OUT_DEST = {'pins': 0, 'x': 1, 'y': 2, 'null': 3, 'pindirs': 4, 'pc': 5, 'isr': 6, 'exec': 7}
+MOV_DEST = {'pins': 0, 'x': 1, 'y': 2, 'exec': 4, 'pc': 5, 'isr': 6, 'osr': 7}
+MOV_SRC  = {'pins': 0, 'x': 1, 'y': 2, 'null': 3, 'status': 5, 'isr': 6, 'osr': 7}
+SET_DEST = {'pins': 0, 'x': 1, 'y': 2, 'pindirs': 4}
+WAIT_SRC = {'gpio': 0, 'pin': 1, 'irq': 2}
+
+
+class AsmError(Exception):
+    pass
+
+
+class Program:
+    def __init__(self, name):
+        self.name = name
+        self.lines = []          # (lineno, text) of instructions
+        self.labels = {}         # name -> index
+        self.public = []         # public label names (in order)
+        self.defines = {}        # name -> (value, public)
+        self.wrap_target = None
+        self.wrap = None
+        self.origin = -1
+        self.sideset_count = 0
+        self.sideset_opt = False
+        self.sideset_pindirs = False
+
+
+def parse_int(tok, prog):
+    tok = tok.strip()
+    if tok in prog.defines:
+        return prog.defines[tok][0]
+    if tok in prog.labels:
+        return prog.labels[tok]
+    return int(tok, 0)
+
+
+def parse(path):
+    progs = []
+    cur = None
+    for lineno, raw in enumerate(open(path, encoding='utf-8'), 1):
+        s = re.split(r';|//', raw, 1)[0].strip()
+        if not s:
+            continue
+
+        m = re.match(r'\.program\s+(\w+)$', s)
+        if m:
+            cur = Program(m.group(1))
+            progs.append(cur)
+            continue
+        if cur is None:
+            raise AsmError(f'{path}:{lineno}: code before .program')
+
+        m = re.match(r'(public\s+)?(\w+):\s*(.*)$', s)
+        if m and m.group(2) not in ('side',):
+            cur.labels[m.group(2)] = len(cur.lines)
+            if m.group(1):
+                cur.public.append(m.group(2))
+            s = m.group(3).strip()
+            if not s:
+                continue
+
+        if s.startswith('.'):
+            parts = s.split()
+            d = parts[0]
+            if d == '.wrap_target':
+                cur.wrap_target = len(cur.lines)
+            elif d == '.wrap':
+                cur.wrap = len(cur.lines) - 1
+            elif d == '.origin':
+                cur.origin = int(parts[1], 0)
+            elif d == '.side_set':
+                cur.sideset_count = int(parts[1], 0)
+                cur.sideset_opt = 'opt' in parts[2:]
+                cur.sideset_pindirs = 'pindirs' in parts[2:]
+            elif d == '.define':
+                pub = parts[1] == 'public'
+                name, val = (parts[2], parts[3]) if pub else (parts[1], parts[2])
+                cur.defines[name] = (int(val, 0), pub)
+            elif d in ('.lang_opt', '.pio_version', '.clock_div', '.fifo',
+                       '.mov_status', '.in', '.out', '.set'):
+                raise AsmError(f'{path}:{lineno}: {d} not supported by pioasm_lite')
+            else:
+                raise AsmError(f'{path}:{lineno}: unknown directive {d}')
+            continue
+
+        cur.lines.append((lineno, s))
+    return progs
+
+
+def encode(prog, lineno, text):
+    # [delay] / side <v> suffixes
+    delay = 0
+    m = re.search(r'\[\s*([^\]]+)\]\s*$', text)
+    if m:
+        delay = parse_int(m.group(1), prog)
+        text = text[:m.start()].strip()
+
+    side = None
+    m = re.search(r'\bside\s+(\S+)\s*$', text)
+    if m:
+        side = parse_int(m.group(1), prog)
+        text = text[:m.start()].strip()
+
+    tok = text.replace(',', ' ').split()
+    op = tok[0]
+    args = tok[1:]
+
+    def bad(msg='bad operands'):
+        return AsmError(f'{prog.name}:{lineno}: {msg}: {text}')
+
+    if op == 'nop':
+        word = 0xA042                      # mov y, y
+    elif op == 'jmp':
+        cond = ''
+        if len(args) == 2:
+            cond = args[0]
+            target = args[1]
+        elif len(args) == 1:
+            target = args[0]
+        else:
+            raise bad()
+        if cond not in JMP_COND:
+            raise bad('bad jmp condition')
+        word = (0 << 13) | (JMP_COND[cond] << 5) | (parse_int(target, prog) & 0x1F)
+    elif op == 'wait':
+        pol = parse_int(args[0], prog)
+        src = args[1]
+        if src not in WAIT_SRC:
+            raise bad('bad wait source')
+        idx = parse_int(args[2], prog)
+        if src == 'irq' and len(args) > 3 and args[3] == 'rel':
+            idx |= 0x10
+        word = (1 << 13) | ((pol & 1) << 7) | (WAIT_SRC[src] << 5) | (idx & 0x1F)
+    elif op == 'in':
+        n = parse_int(args[1], prog)
+        word = (2 << 13) | (IN_SRC[args[0]] << 5) | (n & 0x1F)
+    elif op == 'out':
+        n = parse_int(args[1], prog)
+        word = (3 << 13) | (OUT_DEST[args[0]] << 5) | (n & 0x1F)
+    elif op in ('push', 'pull'):
+        flag = 'iffull' if op == 'push' else 'ifempty'
+        if_f  = 1 if flag in args else 0
+        block = 0 if 'noblock' in args else 1
+        word = (4 << 13) | ((1 if op == 'pull' else 0) << 7) | (if_f << 6) | (block << 5)
+    elif op == 'mov':
+        if len(args) != 2:
+            raise bad()
+        dest, src = args
+        mop = 0
+        if src.startswith('~') or src.startswith('!'):
+            mop, src = 1, src[1:]
+        elif src.startswith('::'):
+            mop, src = 2, src[2:]
+        if dest not in MOV_DEST or src not in MOV_SRC:
+            raise bad()
+        word = (5 << 13) | (MOV_DEST[dest] << 5) | (mop << 3) | MOV_SRC[src]
+    elif op == 'irq':
+        clr, wait = 0, 0
+        a = list(args)
+        if a and a[0] in ('set', 'nowait', 'wait', 'clear'):
+            mode = a.pop(0)
+            clr = 1 if mode == 'clear' else 0
+            wait = 1 if mode == 'wait' else 0
+        idx = parse_int(a[0], prog)
+        if len(a) > 1 and a[1] == 'rel':
+            idx |= 0x10
+        word = (6 << 13) | (clr << 6) | (wait << 5) | (idx & 0x1F)
+    elif op == 'set':
+        v = parse_int(args[1], prog)
+        word = (7 << 13) | (SET_DEST[args[0]] << 5) | (v & 0x1F)
+    else:
+        raise bad('unknown instruction')
+
+    # delay / side-set field (bits 12..8)
+    ss_bits = prog.sideset_count + (1 if prog.sideset_opt else 0)
+    delay_bits = 5 - ss_bits
+    if delay >= (1 << delay_bits):
+        raise bad('delay too large')
+    field = delay
+    if side is not None:
+        if prog.sideset_count == 0:
+            raise bad('side without .side_set')
+        sv = side & ((1 << prog.sideset_count) - 1)
+        if prog.sideset_opt:
+            sv |= 1 << prog.sideset_count
+        field |= sv << delay_bits
+    elif prog.sideset_count and not prog.sideset_opt:
+        raise bad('side-set is not optional')
+    return word | (field << 8)
+
+
+def emit(progs, src, out_path):
+    base = os.path.basename(src)
+    o = []
+    o.append('// -------------------------------------------------- //')
+    o.append('// This file is autogenerated by pioasm_lite; do not edit! //')
+    o.append('// -------------------------------------------------- //')
+    o.append('')
+    o.append('#pragma once')
+    o.append('')
+    o.append('#include "hardware/pio.h"')
+    o.append('')
+
+    for p in progs:
+        words = [encode(p, ln, t) for (ln, t) in p.lines]
+        if not words:
+            raise AsmError(f'{src}: program {p.name} is empty')
+
+        wt = p.wrap_target if p.wrap_target is not None else 0
+        wr = p.wrap if p.wrap is not None else len(words) - 1
+
+        o.append('// ' + '-' * (len(p.name) + 2) + ' //')
+        o.append(f'// {p.name} //')
+        o.append('// ' + '-' * (len(p.name) + 2) + ' //')
+        o.append('')
+        o.append(f'#define {p.name}_wrap_target {wt}')
+        o.append(f'#define {p.name}_wrap {wr}')
+        o.append(f'#define {p.name}_pio_version 0')
+        o.append('')
+        for name, (val, pub) in p.defines.items():
+            if pub:
+                o.append(f'#define {p.name}_{name} {val}')
+        for name in p.public:
+            o.append(f'#define {p.name}_offset_{name} {p.labels[name]}u')
+        o.append('')
+        o.append(f'static const uint16_t {p.name}_program_instructions[] = {{')
+        for i, w in enumerate(words):
+            mark = '    //     .wrap_target' if i == wt else None
+            if mark:
+                o.append(mark)
+            o.append(f'    0x{w:04x}, // {i:2d}: {p.lines[i][1]}')
+            if i == wr:
+                o.append('    //     .wrap')
+        o.append('};')
+        o.append('')
+        o.append(f'static const struct pio_program {p.name}_program = {{')
+        o.append(f'    .instructions = {p.name}_program_instructions,')
+        o.append(f'    .length = {len(words)},')
+        o.append(f'    .origin = {p.origin},')
+        o.append('};')
+        o.append('')
+        o.append(f'static inline pio_sm_config {p.name}_program_get_default_config(uint offset) {{')
+        o.append('    pio_sm_config c = pio_get_default_sm_config();')
+        o.append(f'    sm_config_set_wrap(&c, offset + {p.name}_wrap_target, offset + {p.name}_wrap);')
+        if p.sideset_count:
+            o.append(f'    sm_config_set_sideset(&c, {p.sideset_count + (1 if p.sideset_opt else 0)}, '
+                     f'{"true" if p.sideset_opt else "false"}, {"true" if p.sideset_pindirs else "false"});')
+        o.append('    return c;')
+        o.append('}')
+        o.append('')
+
+    with open(out_path, 'w', encoding='utf-8') as f:
+        f.write('\n'.join(o))
+
+
+def main():
+    if len(sys.argv) != 3:
+        print('usage: pioasm_lite.py <in.pio> <out.pio.h>', file=sys.stderr)
+        return 2
+    try:
+        emit(parse(sys.argv[1]), sys.argv[1], sys.argv[2])
+    except AsmError as e:
+        print(f'pioasm_lite: {e}', file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
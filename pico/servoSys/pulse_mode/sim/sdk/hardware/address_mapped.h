@@ -0,0 +1,48 @@
+#pragma once
+
+#include "pico/types.h"
+
+// ============================================================
+// Register access
+//   Every peripheral block is a 16 KiB window in host memory with
+//   the RP2xxx alias layout (+0x1000 XOR, +0x2000 SET, +0x3000 CLR).
+//   The CPU touches registers through the SDK functions of this
+//   directory; DMA reads / writes go through sim::bus_* and reach
+//   the peripheral models (FIFOs, triggers, double buffers).
+// ============================================================
+
+typedef volatile uint32_t io_rw_32;
+typedef const volatile uint32_t io_ro_32;
+typedef volatile uint32_t io_wo_32;
+typedef volatile uint16_t io_rw_16;
+typedef volatile uint8_t  io_rw_8;
+
+#define REG_ALIAS_RW_BITS  (0x0u << 12u)
+#define REG_ALIAS_XOR_BITS (0x1u << 12u)
+#define REG_ALIAS_SET_BITS (0x2u << 12u)
+#define REG_ALIAS_CLR_BITS (0x3u << 12u)
+
+#define hw_xor_alias(p)   ((__typeof__(p))((uintptr_t)(p) | REG_ALIAS_XOR_BITS))
+#define hw_set_alias(p)   ((__typeof__(p))((uintptr_t)(p) | REG_ALIAS_SET_BITS))
+#define hw_clear_alias(p) ((__typeof__(p))((uintptr_t)(p) | REG_ALIAS_CLR_BITS))
+
+namespace sim {
+// 32-bit bus as seen by the DMA (size in bytes: 1 / 2 / 4)
+uint32_t bus_read(uint32_t addr, uint size);
+void     bus_write(uint32_t addr, uint32_t value, uint size);
+
+// host pointer -> bus address (panics above 4 GiB, see sim/README.md)
+uint32_t bus_addr(const volatile void* p);
+}
+
+static inline void hw_set_bits(io_rw_32* addr, uint32_t mask) {
+    sim::bus_write(sim::bus_addr(hw_set_alias(addr)), mask, 4);
+}
+
+static inline void hw_clear_bits(io_rw_32* addr, uint32_t mask) {
+    sim::bus_write(sim::bus_addr(hw_clear_alias(addr)), mask, 4);
+}
+
+static inline void hw_xor_bits(io_rw_32* addr, uint32_t mask) {
+    sim::bus_write(sim::bus_addr(hw_xor_alias(addr)), mask, 4);
+}
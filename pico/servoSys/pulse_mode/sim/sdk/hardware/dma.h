@@ -0,0 +1,164 @@
+#pragma once
+
+// ============================================================
+// hardware/dma.h for the host simulation (sim/sim_dma.cpp)
+//   Channel register window with the RP2040 alias layout, so
+//   DMA-to-DMA control blocks (al3_read_addr_trig) work as on chip.
+// ============================================================
+
+#include "pico/types.h"
+#include "hardware/platform_defs.h"
+#include "hardware/address_mapped.h"
+
+typedef struct {
+    io_rw_32 read_addr;
+    io_rw_32 write_addr;
+    io_rw_32 transfer_count;
+    io_rw_32 ctrl_trig;
+    io_rw_32 al1_ctrl;
+    io_rw_32 al1_read_addr;
+    io_rw_32 al1_write_addr;
+    io_rw_32 al1_transfer_count_trig;
+    io_rw_32 al2_ctrl;
+    io_rw_32 al2_transfer_count;
+    io_rw_32 al2_read_addr;
+    io_rw_32 al2_write_addr_trig;
+    io_rw_32 al3_ctrl;
+    io_rw_32 al3_write_addr;
+    io_rw_32 al3_transfer_count;
+    io_rw_32 al3_read_addr_trig;
+} dma_channel_hw_t;
+
+typedef struct {
+    dma_channel_hw_t ch[NUM_DMA_CHANNELS];
+    io_rw_32 intr;
+    io_rw_32 inte0;
+    io_rw_32 intf0;
+    io_rw_32 ints0;
+    io_rw_32 inte1;
+    io_rw_32 intf1;
+    io_rw_32 ints1;
+} dma_hw_t;
+
+namespace sim { dma_hw_t* dma_regs(); }
+
+#define dma_hw (sim::dma_regs())
+
+enum dma_channel_transfer_size {
+    DMA_SIZE_8  = 0,
+    DMA_SIZE_16 = 1,
+    DMA_SIZE_32 = 2
+};
+
+// DREQ numbering of the simulated chip
+#if SIM_RP2350
+#define DREQ_PIO0_TX0   0u
+#define DREQ_PIO0_RX0   4u
+#define DREQ_PIO1_TX0   8u
+#define DREQ_PIO1_RX0   12u
+#define DREQ_PIO2_TX0   16u
+#define DREQ_PIO2_RX0   20u
+#define DREQ_PWM_WRAP0  32u
+#else
+#define DREQ_PIO0_TX0   0u
+#define DREQ_PIO0_RX0   4u
+#define DREQ_PIO1_TX0   8u
+#define DREQ_PIO1_RX0   12u
+#define DREQ_PWM_WRAP0  24u
+#endif
+#define DREQ_FORCE      0x3fu
+
+// CTRL (RP2040 layout)
+#define DMA_CH0_CTRL_TRIG_EN_BITS          (1u << 0u)
+#define DMA_CH0_CTRL_TRIG_HIGH_PRIORITY_BITS (1u << 1u)
+#define DMA_CH0_CTRL_TRIG_DATA_SIZE_LSB    2u
+#define DMA_CH0_CTRL_TRIG_INCR_READ_BITS   (1u << 4u)
+#define DMA_CH0_CTRL_TRIG_INCR_WRITE_BITS  (1u << 5u)
+#define DMA_CH0_CTRL_TRIG_RING_SIZE_LSB    6u
+#define DMA_CH0_CTRL_TRIG_RING_SEL_BITS    (1u << 10u)
+#define DMA_CH0_CTRL_TRIG_CHAIN_TO_LSB     11u
+#define DMA_CH0_CTRL_TRIG_TREQ_SEL_LSB     15u
+#define DMA_CH0_CTRL_TRIG_IRQ_QUIET_BITS   (1u << 21u)
+#define DMA_CH0_CTRL_TRIG_BSWAP_BITS       (1u << 22u)
+#define DMA_CH0_CTRL_TRIG_SNIFF_EN_BITS    (1u << 23u)
+#define DMA_CH0_CTRL_TRIG_BUSY_BITS        (1u << 24u)
+
+typedef struct {
+    uint32_t ctrl;
+} dma_channel_config;
+
+static inline void channel_config_set_read_increment(dma_channel_config* c, bool incr) {
+    c->ctrl = incr ? (c->ctrl | DMA_CH0_CTRL_TRIG_INCR_READ_BITS) : (c->ctrl & ~DMA_CH0_CTRL_TRIG_INCR_READ_BITS);
+}
+
+static inline void channel_config_set_write_increment(dma_channel_config* c, bool incr) {
+    c->ctrl = incr ? (c->ctrl | DMA_CH0_CTRL_TRIG_INCR_WRITE_BITS) : (c->ctrl & ~DMA_CH0_CTRL_TRIG_INCR_WRITE_BITS);
+}
+
+static inline void channel_config_set_dreq(dma_channel_config* c, uint dreq) {
+    c->ctrl = (c->ctrl & ~(0x3fu << DMA_CH0_CTRL_TRIG_TREQ_SEL_LSB)) | ((dreq & 0x3fu) << DMA_CH0_CTRL_TRIG_TREQ_SEL_LSB);
+}
+
+static inline void channel_config_set_chain_to(dma_channel_config* c, uint chain_to) {
+    c->ctrl = (c->ctrl & ~(0xfu << DMA_CH0_CTRL_TRIG_CHAIN_TO_LSB)) | ((chain_to & 0xfu) << DMA_CH0_CTRL_TRIG_CHAIN_TO_LSB);
+}
+
+static inline void channel_config_set_transfer_data_size(dma_channel_config* c, enum dma_channel_transfer_size size) {
+    c->ctrl = (c->ctrl & ~(3u << DMA_CH0_CTRL_TRIG_DATA_SIZE_LSB)) | ((uint32_t)size << DMA_CH0_CTRL_TRIG_DATA_SIZE_LSB);
+}
+
+static inline void channel_config_set_ring(dma_channel_config* c, bool write, uint size_bits) {
+    c->ctrl = (c->ctrl & ~(DMA_CH0_CTRL_TRIG_RING_SEL_BITS | (0xfu << DMA_CH0_CTRL_TRIG_RING_SIZE_LSB))) |
+              ((size_bits & 0xfu) << DMA_CH0_CTRL_TRIG_RING_SIZE_LSB) |
+              (write ? DMA_CH0_CTRL_TRIG_RING_SEL_BITS : 0u);
+}
+
+static inline void channel_config_set_bswap(dma_channel_config* c, bool bswap) {
+    c->ctrl = bswap ? (c->ctrl | DMA_CH0_CTRL_TRIG_BSWAP_BITS) : (c->ctrl & ~DMA_CH0_CTRL_TRIG_BSWAP_BITS);
+}
+
+static inline void channel_config_set_irq_quiet(dma_channel_config* c, bool irq_quiet) {
+    c->ctrl = irq_quiet ? (c->ctrl | DMA_CH0_CTRL_TRIG_IRQ_QUIET_BITS) : (c->ctrl & ~DMA_CH0_CTRL_TRIG_IRQ_QUIET_BITS);
+}
+
+static inline void channel_config_set_high_priority(dma_channel_config* c, bool high_priority) {
+    c->ctrl = high_priority ? (c->ctrl | DMA_CH0_CTRL_TRIG_HIGH_PRIORITY_BITS)
+                            : (c->ctrl & ~DMA_CH0_CTRL_TRIG_HIGH_PRIORITY_BITS);
+}
+
+static inline void channel_config_set_enable(dma_channel_config* c, bool enable) {
+    c->ctrl = enable ? (c->ctrl | DMA_CH0_CTRL_TRIG_EN_BITS) : (c->ctrl & ~DMA_CH0_CTRL_TRIG_EN_BITS);
+}
+
+static inline void channel_config_set_sniff_enable(dma_channel_config* c, bool sniff_enable) {
+    c->ctrl = sniff_enable ? (c->ctrl | DMA_CH0_CTRL_TRIG_SNIFF_EN_BITS) : (c->ctrl & ~DMA_CH0_CTRL_TRIG_SNIFF_EN_BITS);
+}
+
+dma_channel_config dma_channel_get_default_config(uint channel);
+dma_channel_config dma_get_channel_config(uint channel);
+
+void dma_channel_claim(uint channel);
+void dma_channel_unclaim(uint channel);
+int  dma_claim_unused_channel(bool required);
+bool dma_channel_is_claimed(uint channel);
+
+void dma_channel_set_config(uint channel, const dma_channel_config* config, bool trigger);
+void dma_channel_set_read_addr(uint channel, const volatile void* read_addr, bool trigger);
+void dma_channel_set_write_addr(uint channel, volatile void* write_addr, bool trigger);
+void dma_channel_set_trans_count(uint channel, uint32_t trans_count, bool trigger);
+void dma_channel_configure(uint channel, const dma_channel_config* config,
+                           volatile void* write_addr, const volatile void* read_addr,
+                           uint transfer_count, bool trigger);
+
+void dma_channel_start(uint channel);
+void dma_start_channel_mask(uint32_t chan_mask);
+void dma_channel_abort(uint channel);
+bool dma_channel_is_busy(uint channel);
+void dma_channel_wait_for_finish_blocking(uint channel);
+
+void dma_channel_set_irq0_enabled(uint channel, bool enabled);
+void dma_channel_set_irq1_enabled(uint channel, bool enabled);
+bool dma_channel_get_irq0_status(uint channel);
+bool dma_channel_get_irq1_status(uint channel);
+void dma_channel_acknowledge_irq0(uint channel);
+void dma_channel_acknowledge_irq1(uint channel);
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "pico/types.h"
+#include "hardware/platform_defs.h"
+
+typedef enum gpio_function {
+#if SIM_RP2350
+    GPIO_FUNC_HSTX = 0,
+    GPIO_FUNC_SPI  = 1,
+    GPIO_FUNC_UART = 2,
+    GPIO_FUNC_I2C  = 3,
+    GPIO_FUNC_PWM  = 4,
+    GPIO_FUNC_SIO  = 5,
+    GPIO_FUNC_PIO0 = 6,
+    GPIO_FUNC_PIO1 = 7,
+    GPIO_FUNC_PIO2 = 8,
+    GPIO_FUNC_GPCK = 9,
+    GPIO_FUNC_USB  = 10,
+#else
+    GPIO_FUNC_XIP  = 0,
+    GPIO_FUNC_SPI  = 1,
+    GPIO_FUNC_UART = 2,
+    GPIO_FUNC_I2C  = 3,
+    GPIO_FUNC_PWM  = 4,
+    GPIO_FUNC_SIO  = 5,
+    GPIO_FUNC_PIO0 = 6,
+    GPIO_FUNC_PIO1 = 7,
+    GPIO_FUNC_GPCK = 8,
+    GPIO_FUNC_USB  = 9,
+#endif
+    GPIO_FUNC_NULL = 0x1f
+} gpio_function_t;
+
+enum gpio_override {
+    GPIO_OVERRIDE_NORMAL = 0,
+    GPIO_OVERRIDE_INVERT = 1,
+    GPIO_OVERRIDE_LOW    = 2,
+    GPIO_OVERRIDE_HIGH   = 3
+};
+
+#define GPIO_OUT 1
+#define GPIO_IN  0
+
+void gpio_init(uint gpio);
+void gpio_set_function(uint gpio, gpio_function_t fn);
+gpio_function_t gpio_get_function(uint gpio);
+void gpio_set_dir(uint gpio, bool out);
+void gpio_put(uint gpio, bool value);
+bool gpio_get(uint gpio);               // pad level
+bool gpio_get_out_level(uint gpio);     // SIO output latch
+void gpio_set_outover(uint gpio, uint value);
+void gpio_pull_down(uint gpio);
+void gpio_pull_up(uint gpio);
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "pico/types.h"
+#include "hardware/platform_defs.h"
+
+typedef void (*irq_handler_t)();
+
+#if SIM_RP2350
+#define PWM_IRQ_WRAP_0 8u
+#define PWM_IRQ_WRAP   PWM_IRQ_WRAP_0
+#define DMA_IRQ_0      10u
+#define DMA_IRQ_1      11u
+#else
+#define PWM_IRQ_WRAP   4u
+#define DMA_IRQ_0      11u
+#define DMA_IRQ_1      12u
+#endif
+
+#define SIM_NUM_IRQS   32u
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler);
+void irq_add_shared_handler(uint num, irq_handler_t handler, uint8_t order_priority);
+void irq_remove_handler(uint num, irq_handler_t handler);
+void irq_set_enabled(uint num, bool enabled);
+bool irq_is_enabled(uint num);
@@ -0,0 +1,278 @@
+#pragma once
+
+// ============================================================
+// hardware/pio.h for the host simulation
+//   Same API as the SDK for everything under pio/ and drivers/;
+//   the state machines are executed by sim/sim_pio.cpp.
+// ============================================================
+
+#include "pico/types.h"
+#include "hardware/platform_defs.h"
+#include "hardware/address_mapped.h"
+#include "hardware/gpio.h"
+#include "hardware/pio_instructions.h"
+
+// register window (addresses only: the TX / RX FIFOs are DMA targets)
+typedef struct {
+    io_rw_32 clkdiv;
+    io_rw_32 execctrl;
+    io_rw_32 shiftctrl;
+    io_ro_32 addr;
+    io_rw_32 instr;
+    io_rw_32 pinctrl;
+} pio_sm_hw_t;
+
+typedef struct {
+    io_rw_32    ctrl;
+    io_ro_32    fstat;
+    io_rw_32    fdebug;
+    io_ro_32    flevel;
+    io_wo_32    txf[NUM_PIO_STATE_MACHINES];
+    io_ro_32    rxf[NUM_PIO_STATE_MACHINES];
+    io_rw_32    irq;
+    io_wo_32    irq_force;
+    io_rw_32    input_sync_bypass;
+    io_ro_32    dbg_padout;
+    io_ro_32    dbg_padoe;
+    io_ro_32    dbg_cfginfo;
+    io_wo_32    instr_mem[32];
+    pio_sm_hw_t sm[NUM_PIO_STATE_MACHINES];
+    io_rw_32    intr;
+    io_rw_32    inte0;
+    io_rw_32    intf0;
+    io_ro_32    ints0;
+    io_rw_32    inte1;
+    io_rw_32    intf1;
+    io_ro_32    ints1;
+} pio_hw_t;
+
+typedef pio_hw_t* PIO;
+
+namespace sim { PIO pio_regs(uint index); }
+
+#define pio0 (sim::pio_regs(0))
+#define pio1 (sim::pio_regs(1))
+#if NUM_PIOS > 2
+#define pio2 (sim::pio_regs(2))
+#endif
+
+typedef struct pio_program {
+    const uint16_t* instructions;
+    uint8_t         length;
+    int8_t          origin;   // -1 = relocatable
+} pio_program_t;
+
+// ------------------------------------------------------------
+// SM config (RP2040 register layout)
+// ------------------------------------------------------------
+typedef struct {
+    uint32_t clkdiv;
+    uint32_t execctrl;
+    uint32_t shiftctrl;
+    uint32_t pinctrl;
+} pio_sm_config;
+
+enum pio_fifo_join {
+    PIO_FIFO_JOIN_NONE = 0,
+    PIO_FIFO_JOIN_TX   = 1,
+    PIO_FIFO_JOIN_RX   = 2,
+};
+
+enum pio_mov_status_type {
+    STATUS_TX_LESSTHAN = 0,
+    STATUS_RX_LESSTHAN = 1
+};
+
+#define PIO_SM0_CLKDIV_INT_LSB                 16u
+#define PIO_SM0_CLKDIV_FRAC_LSB                8u
+#define PIO_SM0_EXECCTRL_SIDE_EN_BITS          (1u << 30u)
+#define PIO_SM0_EXECCTRL_SIDE_PINDIR_BITS      (1u << 29u)
+#define PIO_SM0_EXECCTRL_JMP_PIN_LSB           24u
+#define PIO_SM0_EXECCTRL_OUT_EN_SEL_LSB        19u
+#define PIO_SM0_EXECCTRL_INLINE_OUT_EN_BITS    (1u << 18u)
+#define PIO_SM0_EXECCTRL_OUT_STICKY_BITS       (1u << 17u)
+#define PIO_SM0_EXECCTRL_WRAP_TOP_LSB          12u
+#define PIO_SM0_EXECCTRL_WRAP_BOTTOM_LSB       7u
+#define PIO_SM0_EXECCTRL_STATUS_SEL_BITS       (1u << 4u)
+#define PIO_SM0_EXECCTRL_STATUS_N_LSB          0u
+#define PIO_SM0_SHIFTCTRL_FJOIN_RX_BITS        (1u << 31u)
+#define PIO_SM0_SHIFTCTRL_FJOIN_TX_BITS        (1u << 30u)
+#define PIO_SM0_SHIFTCTRL_PULL_THRESH_LSB      25u
+#define PIO_SM0_SHIFTCTRL_PUSH_THRESH_LSB      20u
+#define PIO_SM0_SHIFTCTRL_OUT_SHIFTDIR_BITS    (1u << 19u)
+#define PIO_SM0_SHIFTCTRL_IN_SHIFTDIR_BITS     (1u << 18u)
+#define PIO_SM0_SHIFTCTRL_AUTOPULL_BITS        (1u << 17u)
+#define PIO_SM0_SHIFTCTRL_AUTOPUSH_BITS        (1u << 16u)
+#define PIO_SM0_PINCTRL_SIDESET_COUNT_LSB      29u
+#define PIO_SM0_PINCTRL_SET_COUNT_LSB          26u
+#define PIO_SM0_PINCTRL_OUT_COUNT_LSB          20u
+#define PIO_SM0_PINCTRL_IN_BASE_LSB            15u
+#define PIO_SM0_PINCTRL_SIDESET_BASE_LSB       10u
+#define PIO_SM0_PINCTRL_SET_BASE_LSB           5u
+#define PIO_SM0_PINCTRL_OUT_BASE_LSB           0u
+
+static inline void sm_config_set_out_pins(pio_sm_config* c, uint out_base, uint out_count) {
+    c->pinctrl = (c->pinctrl & ~((0x1fu << PIO_SM0_PINCTRL_OUT_BASE_LSB) |
+                                 (0x3fu << PIO_SM0_PINCTRL_OUT_COUNT_LSB))) |
+                 (out_base << PIO_SM0_PINCTRL_OUT_BASE_LSB) |
+                 (out_count << PIO_SM0_PINCTRL_OUT_COUNT_LSB);
+}
+
+static inline void sm_config_set_set_pins(pio_sm_config* c, uint set_base, uint set_count) {
+    c->pinctrl = (c->pinctrl & ~((0x1fu << PIO_SM0_PINCTRL_SET_BASE_LSB) |
+                                 (0x7u << PIO_SM0_PINCTRL_SET_COUNT_LSB))) |
+                 (set_base << PIO_SM0_PINCTRL_SET_BASE_LSB) |
+                 (set_count << PIO_SM0_PINCTRL_SET_COUNT_LSB);
+}
+
+static inline void sm_config_set_in_pins(pio_sm_config* c, uint in_base) {
+    c->pinctrl = (c->pinctrl & ~(0x1fu << PIO_SM0_PINCTRL_IN_BASE_LSB)) |
+                 (in_base << PIO_SM0_PINCTRL_IN_BASE_LSB);
+}
+
+static inline void sm_config_set_sideset_pins(pio_sm_config* c, uint sideset_base) {
+    c->pinctrl = (c->pinctrl & ~(0x1fu << PIO_SM0_PINCTRL_SIDESET_BASE_LSB)) |
+                 (sideset_base << PIO_SM0_PINCTRL_SIDESET_BASE_LSB);
+}
+
+static inline void sm_config_set_sideset(pio_sm_config* c, uint bit_count, bool optional, bool pindirs) {
+    c->pinctrl = (c->pinctrl & ~(0x7u << PIO_SM0_PINCTRL_SIDESET_COUNT_LSB)) |
+                 (bit_count << PIO_SM0_PINCTRL_SIDESET_COUNT_LSB);
+    c->execctrl = (c->execctrl & ~(PIO_SM0_EXECCTRL_SIDE_EN_BITS | PIO_SM0_EXECCTRL_SIDE_PINDIR_BITS)) |
+                  (optional ? PIO_SM0_EXECCTRL_SIDE_EN_BITS : 0u) |
+                  (pindirs ? PIO_SM0_EXECCTRL_SIDE_PINDIR_BITS : 0u);
+}
+
+static inline void sm_config_set_clkdiv_int_frac(pio_sm_config* c, uint16_t div_int, uint8_t div_frac) {
+    c->clkdiv = ((uint32_t)div_frac << PIO_SM0_CLKDIV_FRAC_LSB) |
+                ((uint32_t)div_int << PIO_SM0_CLKDIV_INT_LSB);
+}
+
+static inline void sm_config_set_clkdiv(pio_sm_config* c, float div) {
+    const uint16_t di = (uint16_t)div;
+    const uint8_t  df = (di == 0) ? 0 : (uint8_t)((div - (float)di) * 256.0f);
+    sm_config_set_clkdiv_int_frac(c, di, df);
+}
+
+static inline void sm_config_set_wrap(pio_sm_config* c, uint wrap_target, uint wrap) {
+    c->execctrl = (c->execctrl & ~((0x1fu << PIO_SM0_EXECCTRL_WRAP_TOP_LSB) |
+                                   (0x1fu << PIO_SM0_EXECCTRL_WRAP_BOTTOM_LSB))) |
+                  (wrap_target << PIO_SM0_EXECCTRL_WRAP_BOTTOM_LSB) |
+                  (wrap << PIO_SM0_EXECCTRL_WRAP_TOP_LSB);
+}
+
+static inline void sm_config_set_jmp_pin(pio_sm_config* c, uint pin) {
+    c->execctrl = (c->execctrl & ~(0x1fu << PIO_SM0_EXECCTRL_JMP_PIN_LSB)) |
+                  (pin << PIO_SM0_EXECCTRL_JMP_PIN_LSB);
+}
+
+static inline void sm_config_set_in_shift(pio_sm_config* c, bool shift_right, bool autopush, uint push_threshold) {
+    c->shiftctrl = (c->shiftctrl & ~(PIO_SM0_SHIFTCTRL_IN_SHIFTDIR_BITS |
+                                     PIO_SM0_SHIFTCTRL_AUTOPUSH_BITS |
+                                     (0x1fu << PIO_SM0_SHIFTCTRL_PUSH_THRESH_LSB))) |
+                   (shift_right ? PIO_SM0_SHIFTCTRL_IN_SHIFTDIR_BITS : 0u) |
+                   (autopush ? PIO_SM0_SHIFTCTRL_AUTOPUSH_BITS : 0u) |
+                   ((push_threshold & 0x1fu) << PIO_SM0_SHIFTCTRL_PUSH_THRESH_LSB);
+}
+
+static inline void sm_config_set_out_shift(pio_sm_config* c, bool shift_right, bool autopull, uint pull_threshold) {
+    c->shiftctrl = (c->shiftctrl & ~(PIO_SM0_SHIFTCTRL_OUT_SHIFTDIR_BITS |
+                                     PIO_SM0_SHIFTCTRL_AUTOPULL_BITS |
+                                     (0x1fu << PIO_SM0_SHIFTCTRL_PULL_THRESH_LSB))) |
+                   (shift_right ? PIO_SM0_SHIFTCTRL_OUT_SHIFTDIR_BITS : 0u) |
+                   (autopull ? PIO_SM0_SHIFTCTRL_AUTOPULL_BITS : 0u) |
+                   ((pull_threshold & 0x1fu) << PIO_SM0_SHIFTCTRL_PULL_THRESH_LSB);
+}
+
+static inline void sm_config_set_fifo_join(pio_sm_config* c, enum pio_fifo_join join) {
+    c->shiftctrl = (c->shiftctrl & ~(PIO_SM0_SHIFTCTRL_FJOIN_TX_BITS | PIO_SM0_SHIFTCTRL_FJOIN_RX_BITS)) |
+                   (join == PIO_FIFO_JOIN_TX ? PIO_SM0_SHIFTCTRL_FJOIN_TX_BITS : 0u) |
+                   (join == PIO_FIFO_JOIN_RX ? PIO_SM0_SHIFTCTRL_FJOIN_RX_BITS : 0u);
+}
+
+static inline void sm_config_set_out_special(pio_sm_config* c, bool sticky, bool has_enable_pin, uint enable_pin_index) {
+    c->execctrl = (c->execctrl & ~(PIO_SM0_EXECCTRL_OUT_STICKY_BITS |
+                                   PIO_SM0_EXECCTRL_INLINE_OUT_EN_BITS |
+                                   (0x1fu << PIO_SM0_EXECCTRL_OUT_EN_SEL_LSB))) |
+                  (sticky ? PIO_SM0_EXECCTRL_OUT_STICKY_BITS : 0u) |
+                  (has_enable_pin ? PIO_SM0_EXECCTRL_INLINE_OUT_EN_BITS : 0u) |
+                  ((enable_pin_index & 0x1fu) << PIO_SM0_EXECCTRL_OUT_EN_SEL_LSB);
+}
+
+static inline void sm_config_set_mov_status(pio_sm_config* c, enum pio_mov_status_type status_sel, uint status_n) {
+    c->execctrl = (c->execctrl & ~(PIO_SM0_EXECCTRL_STATUS_SEL_BITS | 0xfu)) |
+                  (status_sel == STATUS_RX_LESSTHAN ? PIO_SM0_EXECCTRL_STATUS_SEL_BITS : 0u) |
+                  (status_n & 0xfu);
+}
+
+static inline pio_sm_config pio_get_default_sm_config() {
+    pio_sm_config c = {0, 0, 0, 0};
+    sm_config_set_clkdiv_int_frac(&c, 1, 0);
+    sm_config_set_wrap(&c, 0, 31);
+    sm_config_set_in_shift(&c, true, false, 32);
+    sm_config_set_out_shift(&c, true, false, 32);
+    return c;
+}
+
+// ------------------------------------------------------------
+// Program memory / SM claims
+// ------------------------------------------------------------
+PIO  pio_get_instance(uint instance);
+uint pio_get_index(PIO pio);
+uint pio_get_dreq(PIO pio, uint sm, bool is_tx);
+
+bool pio_can_add_program(PIO pio, const pio_program_t* program);
+bool pio_can_add_program_at_offset(PIO pio, const pio_program_t* program, uint offset);
+uint pio_add_program(PIO pio, const pio_program_t* program);
+void pio_add_program_at_offset(PIO pio, const pio_program_t* program, uint offset);
+void pio_remove_program(PIO pio, const pio_program_t* program, uint loaded_offset);
+void pio_clear_instruction_memory(PIO pio);
+
+void pio_sm_claim(PIO pio, uint sm);
+void pio_sm_unclaim(PIO pio, uint sm);
+int  pio_claim_unused_sm(PIO pio, bool required);
+bool pio_sm_is_claimed(PIO pio, uint sm);
+
+void pio_gpio_init(PIO pio, uint pin);
+
+// ------------------------------------------------------------
+// SM control
+// ------------------------------------------------------------
+int  pio_sm_init(PIO pio, uint sm, uint initial_pc, const pio_sm_config* config);
+void pio_sm_set_config(PIO pio, uint sm, const pio_sm_config* config);
+void pio_sm_set_enabled(PIO pio, uint sm, bool enabled);
+void pio_set_sm_mask_enabled(PIO pio, uint32_t mask, bool enabled);
+void pio_enable_sm_mask_in_sync(PIO pio, uint32_t mask);
+void pio_sm_restart(PIO pio, uint sm);
+void pio_sm_clkdiv_restart(PIO pio, uint sm);
+void pio_sm_exec(PIO pio, uint sm, uint instr);
+bool pio_sm_is_exec_stalled(PIO pio, uint sm);
+void pio_sm_exec_wait_blocking(PIO pio, uint sm, uint instr);
+void pio_sm_set_wrap(PIO pio, uint sm, uint wrap_target, uint wrap);
+void pio_sm_set_clkdiv(PIO pio, uint sm, float div);
+void pio_sm_set_clkdiv_int_frac(PIO pio, uint sm, uint16_t div_int, uint8_t div_frac);
+uint8_t pio_sm_get_pc(PIO pio, uint sm);
+
+void pio_sm_set_pins(PIO pio, uint sm, uint32_t pin_values);
+void pio_sm_set_pins_with_mask(PIO pio, uint sm, uint32_t pin_values, uint32_t pin_mask);
+void pio_sm_set_pindirs_with_mask(PIO pio, uint sm, uint32_t pin_dirs, uint32_t pin_mask);
+int  pio_sm_set_consecutive_pindirs(PIO pio, uint sm, uint pin_base, uint pin_count, bool is_out);
+
+void pio_interrupt_clear(PIO pio, uint pio_interrupt_num);
+bool pio_interrupt_get(PIO pio, uint pio_interrupt_num);
+
+// ------------------------------------------------------------
+// FIFOs
+// ------------------------------------------------------------
+bool     pio_sm_is_rx_fifo_full(PIO pio, uint sm);
+bool     pio_sm_is_rx_fifo_empty(PIO pio, uint sm);
+uint     pio_sm_get_rx_fifo_level(PIO pio, uint sm);
+bool     pio_sm_is_tx_fifo_full(PIO pio, uint sm);
+bool     pio_sm_is_tx_fifo_empty(PIO pio, uint sm);
+uint     pio_sm_get_tx_fifo_level(PIO pio, uint sm);
+void     pio_sm_put(PIO pio, uint sm, uint32_t data);
+void     pio_sm_put_blocking(PIO pio, uint sm, uint32_t data);
+uint32_t pio_sm_get(PIO pio, uint sm);
+uint32_t pio_sm_get_blocking(PIO pio, uint sm);
+void     pio_sm_clear_fifos(PIO pio, uint sm);
+void     pio_sm_drain_tx_fifo(PIO pio, uint sm);
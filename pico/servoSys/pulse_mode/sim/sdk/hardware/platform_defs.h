@@ -0,0 +1,34 @@
+#pragma once
+
+// ============================================================
+// Simulated chip (host build, see sim/README.md)
+//   default RP2040, -DSIM_RP2350=1: RP2350A (pio2, 12 slices, 16 DMA)
+// ============================================================
+
+#ifndef SIM_RP2350
+#define SIM_RP2350 0
+#endif
+
+#if SIM_RP2350
+#define PICO_RP2350              1
+#define NUM_PIOS                 3u
+#define NUM_PWM_SLICES           12u
+#define NUM_DMA_CHANNELS         16u
+#define SIM_SYS_CLK_HZ           150000000u
+#else
+#define PICO_RP2040              1
+#define NUM_PIOS                 2u
+#define NUM_PWM_SLICES           8u
+#define NUM_DMA_CHANNELS         12u
+#define SIM_SYS_CLK_HZ           125000000u
+#endif
+
+#define NUM_CORES                2u
+#define NUM_PIO_STATE_MACHINES   4u
+#define NUM_BANK0_GPIOS          30u
+#define NUM_SPIN_LOCKS           32u
+
+#define PICO_SPINLOCK_ID_STRIPED_FIRST 16u
+#define PICO_SPINLOCK_ID_STRIPED_LAST  23u
+
+#define PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY 0x80u
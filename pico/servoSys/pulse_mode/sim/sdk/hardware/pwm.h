@@ -0,0 +1,117 @@
+#pragma once
+
+// ============================================================
+// hardware/pwm.h for the host simulation (sim/sim_pwm.cpp)
+//   Free-running (trailing edge) mode; CC / TOP double buffered,
+//   latched at wrap (immediately while the slice is disabled).
+// ============================================================
+
+#include "pico/types.h"
+#include "hardware/platform_defs.h"
+#include "hardware/address_mapped.h"
+
+typedef struct {
+    io_rw_32 csr;
+    io_rw_32 div;
+    io_rw_32 ctr;
+    io_rw_32 cc;
+    io_rw_32 top;
+} pwm_slice_hw_t;
+
+typedef struct {
+    pwm_slice_hw_t slice[NUM_PWM_SLICES];
+    io_rw_32 en;
+    io_rw_32 intr;
+    io_rw_32 inte;
+    io_rw_32 intf;
+    io_ro_32 ints;
+} pwm_hw_t;
+
+namespace sim { pwm_hw_t* pwm_regs(); }
+
+#define pwm_hw (sim::pwm_regs())
+
+enum pwm_chan {
+    PWM_CHAN_A = 0,
+    PWM_CHAN_B = 1
+};
+
+enum pwm_clkdiv_mode {
+    PWM_DIV_FREE_RUNNING = 0,
+    PWM_DIV_B_HIGH       = 1,
+    PWM_DIV_B_RISING     = 2,
+    PWM_DIV_B_FALLING    = 3
+};
+
+#define PWM_CH0_CSR_EN_BITS        (1u << 0u)
+#define PWM_CH0_CSR_PH_CORRECT_BITS (1u << 1u)
+#define PWM_CH0_CSR_A_INV_BITS     (1u << 2u)
+#define PWM_CH0_CSR_B_INV_BITS     (1u << 3u)
+#define PWM_CH0_CSR_DIVMODE_LSB    4u
+#define PWM_CH0_DIV_INT_LSB        4u
+#define PWM_CH0_CC_B_LSB           16u
+
+typedef struct {
+    uint32_t csr;
+    uint32_t div;
+    uint32_t top;
+} pwm_config;
+
+static inline uint pwm_gpio_to_slice_num(uint gpio) {
+    return (gpio >> 1u) & 7u;
+}
+
+static inline uint pwm_gpio_to_channel(uint gpio) {
+    return gpio & 1u;
+}
+
+static inline void pwm_config_set_clkdiv_int_frac(pwm_config* c, uint8_t integer, uint8_t fract) {
+    c->div = ((uint32_t)integer << PWM_CH0_DIV_INT_LSB) | fract;
+}
+
+static inline void pwm_config_set_clkdiv_int(pwm_config* c, uint div) {
+    c->div = (div & 0xffu) << PWM_CH0_DIV_INT_LSB;
+}
+
+static inline void pwm_config_set_clkdiv(pwm_config* c, float div) {
+    c->div = (uint32_t)(div * (float)(1u << PWM_CH0_DIV_INT_LSB));
+}
+
+static inline void pwm_config_set_wrap(pwm_config* c, uint16_t wrap) {
+    c->top = wrap;
+}
+
+static inline void pwm_config_set_phase_correct(pwm_config* c, bool phase_correct) {
+    c->csr = (c->csr & ~PWM_CH0_CSR_PH_CORRECT_BITS) | (phase_correct ? PWM_CH0_CSR_PH_CORRECT_BITS : 0u);
+}
+
+static inline void pwm_config_set_output_polarity(pwm_config* c, bool a, bool b) {
+    c->csr = (c->csr & ~(PWM_CH0_CSR_A_INV_BITS | PWM_CH0_CSR_B_INV_BITS)) |
+             (a ? PWM_CH0_CSR_A_INV_BITS : 0u) | (b ? PWM_CH0_CSR_B_INV_BITS : 0u);
+}
+
+static inline pwm_config pwm_get_default_config() {
+    pwm_config c = {0, 0, 0};
+    pwm_config_set_phase_correct(&c, false);
+    pwm_config_set_clkdiv_int(&c, 1);
+    pwm_config_set_wrap(&c, 0xffffu);
+    return c;
+}
+
+void pwm_init(uint slice_num, const pwm_config* c, bool start);
+void pwm_set_enabled(uint slice_num, bool enabled);
+void pwm_set_mask_enabled(uint32_t mask);
+void pwm_set_clkdiv_int_frac(uint slice_num, uint8_t integer, uint8_t fract);
+void pwm_set_clkdiv(uint slice_num, float divider);
+void pwm_set_wrap(uint slice_num, uint16_t wrap);
+void pwm_set_chan_level(uint slice_num, uint chan, uint16_t level);
+void pwm_set_both_levels(uint slice_num, uint16_t level_a, uint16_t level_b);
+void pwm_set_gpio_level(uint gpio, uint16_t level);
+void pwm_set_counter(uint slice_num, uint16_t c);
+uint16_t pwm_get_counter(uint slice_num);
+void pwm_set_output_polarity(uint slice_num, bool a, bool b);
+
+void     pwm_set_irq_enabled(uint slice_num, bool enabled);
+void     pwm_clear_irq(uint slice_num);
+uint32_t pwm_get_irq_status_mask();
+uint     pwm_get_dreq(uint slice_num);
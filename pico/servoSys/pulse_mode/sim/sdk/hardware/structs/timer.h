@@ -0,0 +1,25 @@
+#pragma once
+
+#include "hardware/address_mapped.h"
+
+// TIMELR read latches TIMEHR (DMA reads go through the timer model)
+typedef struct {
+    io_wo_32 timehw;
+    io_wo_32 timelw;
+    io_ro_32 timehr;
+    io_ro_32 timelr;
+    io_rw_32 alarm[4];
+    io_rw_32 armed;
+    io_ro_32 timerawh;
+    io_ro_32 timerawl;
+    io_rw_32 dbgpause;
+    io_rw_32 pause;
+    io_rw_32 intr;
+    io_rw_32 inte;
+    io_rw_32 intf;
+    io_ro_32 ints;
+} timer_hw_t;
+
+namespace sim { timer_hw_t* timer_regs(); }
+
+#define timer_hw (sim::timer_regs())
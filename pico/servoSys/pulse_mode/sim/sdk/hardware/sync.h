@@ -0,0 +1,21 @@
+#pragma once
+
+#include "pico/types.h"
+#include "hardware/platform_defs.h"
+
+// single host thread: barriers compile to compiler fences, spin locks
+// only mask the simulated IRQ dispatch
+
+typedef volatile uint32_t spin_lock_t;
+
+static inline void __dmb() { __atomic_signal_fence(__ATOMIC_SEQ_CST); }
+static inline void __dsb() { __atomic_signal_fence(__ATOMIC_SEQ_CST); }
+static inline void __sev() {}
+static inline void __wfe() {}
+
+uint32_t save_and_disable_interrupts();
+void     restore_interrupts(uint32_t status);
+
+spin_lock_t* spin_lock_instance(uint lock_num);
+uint32_t     spin_lock_blocking(spin_lock_t* lock);
+void         spin_unlock(spin_lock_t* lock, uint32_t saved_irq);
@@ -0,0 +1,10 @@
+#pragma once
+
+#include "pico/types.h"
+#include "hardware/structs/timer.h"
+
+uint64_t time_us_64();
+uint32_t time_us_32();
+
+void busy_wait_us_32(uint32_t us);
+void busy_wait_us(uint64_t us);
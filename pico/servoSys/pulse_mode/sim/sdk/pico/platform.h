@@ -0,0 +1,12 @@
+#pragma once
+
+#include "pico/types.h"
+#include "hardware/platform_defs.h"
+
+// one simulated core; the exception number follows the IRQ dispatch
+// of the chip model (sim_sdk.cpp)
+
+static inline uint get_core_num() { return 0; }
+
+// IPSR: 0 = thread mode, 16 + n while the handler of IRQ n runs
+uint __get_current_exception();
@@ -0,0 +1,23 @@
+#pragma once
+
+// ============================================================
+// pico/stdlib.h for the host simulation
+//   time is simulated: sleeps / busy waits run the chip model
+// ============================================================
+
+#include "pico/types.h"
+#include "hardware/platform_defs.h"
+#include "hardware/gpio.h"
+#include "hardware/timer.h"
+
+#include <stdio.h>
+
+bool stdio_init_all();
+
+void sleep_us(uint64_t us);
+void sleep_ms(uint32_t ms);
+
+// one CPU polling iteration (sim::Options::poll_cycles)
+void tight_loop_contents();
+
+[[noreturn]] void panic(const char* fmt, ...);
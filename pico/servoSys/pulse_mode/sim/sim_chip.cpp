@@ -0,0 +1,537 @@
+#include "sim_model.hpp"
+
+#include "hardware/gpio.h"
+#include "hardware/irq.h"
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// ============================================================
+// chip: register windows, bus decode, pads, timer, scheduler, IRQs
+// ============================================================
+
+namespace sim {
+
+namespace {
+
+// ------------------------------------------------------------
+// register windows (16 KiB aligned, alias in address bits 13:12)
+// ------------------------------------------------------------
+struct alignas(BLOCK_SIZE) Block {
+    uint8_t b[BLOCK_SIZE];
+};
+
+enum BlockId : uint {
+    BLK_PIO0  = 0,
+    BLK_DMA   = NUM_PIOS,
+    BLK_PWM,
+    BLK_TIMER,
+    BLK_COUNT
+};
+
+Block blocks[BLK_COUNT];
+
+inline uint32_t block_base(uint id) { return (uint32_t)(uintptr_t)blocks[id].b; }
+
+// ------------------------------------------------------------
+// pads
+// ------------------------------------------------------------
+constexpr uint HISTORY = 16;   // changes kept per pin (input synchronizer look-back)
+
+struct Pin {
+    gpio_function_t fn;
+    bool     sio_out;
+    bool     sio_oe;
+    uint8_t  outover;
+    bool     level;
+
+    // ring of the most recent changes
+    uint64_t when[HISTORY];
+    bool     lvl[HISTORY];
+    uint8_t  head;
+    uint8_t  count;
+    bool     before;          // level before the oldest kept change
+};
+
+Pin      pins[NUM_BANK0_GPIOS];
+uint64_t last_change = 0;
+
+PadListener listener      = nullptr;
+void*       listener_user = nullptr;
+
+bool pad_compute(uint pin) {
+    const Pin& p = pins[pin];
+    bool v = false;
+
+    switch (p.fn) {
+        case GPIO_FUNC_SIO:
+            v = p.sio_oe && p.sio_out;
+            break;
+        case GPIO_FUNC_PWM:
+            v = pwm_sim::out_level(pin);
+            break;
+        case GPIO_FUNC_PIO0:
+        case GPIO_FUNC_PIO1:
+#if NUM_PIOS > 2
+        case GPIO_FUNC_PIO2:
+#endif
+        {
+            const uint pio = (uint)p.fn - (uint)GPIO_FUNC_PIO0;
+            v = pio_sim::out_enable(pio, pin) && pio_sim::out_level(pio, pin);
+            break;
+        }
+        default:
+            v = false;   // pulled down
+            break;
+    }
+
+    switch (p.outover) {
+        case GPIO_OVERRIDE_INVERT: return !v;
+        case GPIO_OVERRIDE_LOW:    return false;
+        case GPIO_OVERRIDE_HIGH:   return true;
+        default:                   return v;
+    }
+}
+
+// ------------------------------------------------------------
+// time / IRQs
+// ------------------------------------------------------------
+Options  opts;
+Counters ctrs{};
+uint64_t now_ = 0;
+
+struct IrqLine {
+    bool          enabled;
+    bool          pending;
+    uint64_t      since;
+    irq_handler_t exclusive;
+    irq_handler_t shared[4];
+    uint8_t       shared_order[4];
+    uint8_t       shared_count;
+};
+
+IrqLine  irqs[SIM_NUM_IRQS];
+bool     masked       = false;
+bool     in_handler   = false;
+uint     active_irq   = 0;       // valid while in_handler
+
+bool line_level(uint num) {
+    switch (num) {
+        case PWM_IRQ_WRAP: return pwm_sim::irq_line();
+        case DMA_IRQ_0:    return dma_sim::irq_line(0);
+        case DMA_IRQ_1:    return dma_sim::irq_line(1);
+        default:           return false;
+    }
+}
+
+void dispatch(uint num) {
+    IrqLine& l = irqs[num];
+    in_handler = true;
+    active_irq = num;
+    ctrs.irqs++;
+
+    if (l.exclusive) {
+        l.exclusive();
+    } else {
+        for (uint i = 0; i < l.shared_count; ++i) l.shared[i]();
+    }
+    in_handler = false;
+
+    // still asserted: taken again after a fresh latency
+    l.pending = false;
+    if (line_level(num)) {
+        l.pending = true;
+        l.since   = now_;
+    }
+}
+
+void irq_poll() {
+    if (in_handler) return;
+
+    for (uint num = 0; num < SIM_NUM_IRQS; ++num) {
+        IrqLine& l = irqs[num];
+        if (!l.enabled) continue;
+
+        if (!l.pending) {
+            if (!line_level(num)) continue;
+            l.pending = true;
+            l.since   = now_;
+        }
+        if (masked) continue;
+        if (l.since + opts.irq_latency_cycles > now_) continue;
+
+        if (!line_level(num)) {   // acknowledged before it was taken
+            l.pending = false;
+            continue;
+        }
+        dispatch(num);
+    }
+}
+
+uint64_t irq_next_due() {
+    if (in_handler || masked) return NEVER;
+
+    uint64_t e = NEVER;
+    for (uint num = 0; num < SIM_NUM_IRQS; ++num) {
+        const IrqLine& l = irqs[num];
+        if (!l.enabled || !l.pending) continue;
+        const uint64_t due = l.since + opts.irq_latency_cycles;
+        if (due < e) e = due;
+    }
+    return e;
+}
+
+uint64_t components_next(uint64_t t) {
+    uint64_t e = pio_sim::next_event(t);
+    const uint64_t w = pwm_sim::next_event(t);
+    const uint64_t d = dma_sim::next_event(t);
+    if (w < e) e = w;
+    if (d < e) e = d;
+    return e;
+}
+
+// ------------------------------------------------------------
+// timer
+// ------------------------------------------------------------
+uint32_t timehr_latch = 0;
+
+inline uint64_t time_us() { return now_ / (SIM_SYS_CLK_HZ / 1000000u); }
+
+uint32_t timer_read(uint32_t reg) {
+    const uint64_t us = time_us();
+    switch (reg) {
+        case offsetof(timer_hw_t, timelr):
+            timehr_latch = (uint32_t)(us >> 32);
+            return (uint32_t)us;
+        case offsetof(timer_hw_t, timehr):   return timehr_latch;
+        case offsetof(timer_hw_t, timerawl): return (uint32_t)us;
+        case offsetof(timer_hw_t, timerawh): return (uint32_t)(us >> 32);
+        default:
+            return *(const volatile uint32_t*)(blocks[BLK_TIMER].b + reg);
+    }
+}
+
+// ------------------------------------------------------------
+// power-on state
+// ------------------------------------------------------------
+struct PowerOn {
+    PowerOn() {
+        for (uint p = 0; p < NUM_PIOS; ++p) {
+            pio_hw_t* h = pio_regs(p);
+            for (uint i = 0; i < NUM_PIO_STATE_MACHINES; ++i) {
+                h->sm[i].clkdiv    = 1u << PIO_SM0_CLKDIV_INT_LSB;
+                h->sm[i].execctrl  = 31u << PIO_SM0_EXECCTRL_WRAP_TOP_LSB;
+                h->sm[i].shiftctrl = PIO_SM0_SHIFTCTRL_IN_SHIFTDIR_BITS | PIO_SM0_SHIFTCTRL_OUT_SHIFTDIR_BITS;
+                h->sm[i].pinctrl   = 5u << PIO_SM0_PINCTRL_SET_COUNT_LSB;
+            }
+        }
+        for (uint s = 0; s < NUM_PWM_SLICES; ++s) {
+            pwm_regs()->slice[s].div = 1u << PWM_CH0_DIV_INT_LSB;
+            pwm_regs()->slice[s].top = 0xFFFFu;
+        }
+        for (uint pin = 0; pin < NUM_BANK0_GPIOS; ++pin) pins[pin].fn = GPIO_FUNC_NULL;
+
+        pio_sim::reset();
+        dma_sim::reset();
+        pwm_sim::reset();
+    }
+};
+
+PowerOn power_on;
+
+} // namespace
+
+// ============================================================
+// internal interface (sim_model.hpp)
+// ============================================================
+
+void fatal(const char* fmt, ...) {
+    std::fprintf(stderr, "sim: fatal at cycle %llu: ", (unsigned long long)now_);
+    va_list ap;
+    va_start(ap, fmt);
+    std::vfprintf(stderr, fmt, ap);
+    va_end(ap);
+    std::fputc('\n', stderr);
+    std::exit(3);
+}
+
+Counters& counters_mut() { return ctrs; }
+
+void pad_refresh(uint pin, uint64_t cycle) {
+    Pin& p = pins[pin];
+    const bool v = pad_compute(pin);
+    if (v == p.level) return;
+
+    if (p.count == HISTORY) {
+        p.before = p.lvl[p.head];
+        p.head   = (uint8_t)((p.head + 1u) % HISTORY);
+        p.count--;
+    }
+    const uint slot = (p.head + p.count) % HISTORY;
+    p.when[slot] = cycle;
+    p.lvl[slot]  = v;
+    p.count++;
+
+    p.level     = v;
+    last_change = cycle;
+
+    if (listener) listener(cycle, pin, v, listener_user);
+}
+
+bool pad_synced(uint pin, uint64_t cycle) {
+    const Pin& p = pins[pin];
+    const uint64_t at = (cycle >= 2) ? cycle - 2 : 0;
+
+    for (uint k = p.count; k-- > 0;) {
+        const uint slot = (p.head + k) % HISTORY;
+        if (p.when[slot] <= at) return p.lvl[slot];
+    }
+    if (p.count == HISTORY) fatal("gpio %u: input synchronizer look-back exceeded", pin);
+    return p.before;
+}
+
+uint64_t pad_last_change() { return last_change; }
+
+gpio_function_t pad_function(uint pin) { return pins[pin].fn; }
+
+// ============================================================
+// register windows / bus
+// ============================================================
+
+PIO pio_regs(uint index) { return (PIO)blocks[BLK_PIO0 + index].b; }
+dma_hw_t* dma_regs() { return (dma_hw_t*)blocks[BLK_DMA].b; }
+pwm_hw_t* pwm_regs() { return (pwm_hw_t*)blocks[BLK_PWM].b; }
+timer_hw_t* timer_regs() { return (timer_hw_t*)blocks[BLK_TIMER].b; }
+
+uint32_t bus_addr(const volatile void* p) {
+    const uintptr_t a = (uintptr_t)p;
+    if (a > 0xFFFFFFFFu) {
+        fatal("address %p is not reachable by the 32-bit bus (build with -no-pie, keep DMA buffers static)",
+              (const void*)p);
+    }
+    return (uint32_t)a;
+}
+
+namespace {
+
+// peripheral block of addr (BLK_COUNT = plain memory)
+inline uint decode(uint32_t addr) {
+    const uint32_t base = addr & ~(BLOCK_SIZE - 1u);
+    for (uint id = 0; id < BLK_COUNT; ++id) {
+        if (block_base(id) == base) return id;
+    }
+    return BLK_COUNT;
+}
+
+uint32_t peri_read(uint id, uint32_t reg) {
+    if (id < BLK_DMA)   return pio_sim::bus_read(id - BLK_PIO0, reg);
+    if (id == BLK_DMA)  return dma_sim::bus_read(reg);
+    if (id == BLK_PWM)  return pwm_sim::bus_read(reg);
+    return timer_read(reg);
+}
+
+void peri_write(uint id, uint32_t reg, uint32_t v, uint32_t alias) {
+    if (id < BLK_DMA)       pio_sim::bus_write(id - BLK_PIO0, reg, v, alias);
+    else if (id == BLK_DMA) dma_sim::bus_write(reg, v, alias);
+    else if (id == BLK_PWM) pwm_sim::bus_write(reg, v, alias);
+    else fatal("timer: write to register 0x%03x", reg);
+}
+
+} // namespace
+
+uint32_t bus_read(uint32_t addr, uint size) {
+    const uint id = decode(addr);
+    if (id != BLK_COUNT) {
+        const uint32_t w = peri_read(id, addr & REG_MASK & ~3u);
+        return (size == 4) ? w : (w >> (8u * (addr & 3u))) & ((1u << (8u * size)) - 1u);
+    }
+
+    const void* p = (const void*)(uintptr_t)addr;
+    switch (size) {
+        case 1:  { uint8_t v;  std::memcpy(&v, p, 1); return v; }
+        case 2:  { uint16_t v; std::memcpy(&v, p, 2); return v; }
+        default: { uint32_t v; std::memcpy(&v, p, 4); return v; }
+    }
+}
+
+void bus_write(uint32_t addr, uint32_t value, uint size) {
+    const uint id = decode(addr);
+    if (id != BLK_COUNT) {
+        // narrow writes to peripherals are replicated across the word
+        uint32_t v = value;
+        if (size == 1) v = (value & 0xFFu) * 0x01010101u;
+        if (size == 2) v = (value & 0xFFFFu) * 0x00010001u;
+        peri_write(id, addr & REG_MASK & ~3u, v, (addr >> ALIAS_SHIFT) & 3u);
+        return;
+    }
+
+    void* p = (void*)(uintptr_t)addr;
+    switch (size) {
+        case 1:  { const uint8_t v = (uint8_t)value;   std::memcpy(p, &v, 1); break; }
+        case 2:  { const uint16_t v = (uint16_t)value; std::memcpy(p, &v, 2); break; }
+        default: std::memcpy(p, &value, 4); break;
+    }
+}
+
+// ============================================================
+// public interface (sim_chip.hpp)
+// ============================================================
+
+Options& options() { return opts; }
+
+uint64_t now() { return now_; }
+uint32_t f_sys() { return SIM_SYS_CLK_HZ; }
+uint32_t cycles_per_us() { return SIM_SYS_CLK_HZ / 1000000u; }
+
+void run_until(uint64_t cycle) {
+    while (now_ < cycle) {
+        irq_poll();
+
+        const uint64_t t = now_ + 1;
+        uint64_t e = components_next(t);
+        const uint64_t due = irq_next_due();
+        if (due < e) e = due;
+        if (cycle < e) e = cycle;
+        if (e < t) e = t;
+
+        if (e > t) {
+            pio_sim::skip(e - 1);
+            pwm_sim::skip(e - 1);
+            dma_sim::skip(e - 1);
+            ctrs.skipped_cycles += e - t;
+        }
+
+        pio_sim::step(e);
+        pwm_sim::step(e);
+        dma_sim::step(e);
+        now_ = e;
+        ctrs.events++;
+    }
+    irq_poll();
+}
+
+void run_cycles(uint64_t n) { run_until(now_ + n); }
+
+void run_us(uint64_t us) { run_cycles(us * cycles_per_us()); }
+
+bool run_until_quiet(uint64_t timeout_cycles) {
+    const uint64_t end = now_ + timeout_cycles;
+    for (;;) {
+        irq_poll();
+        uint64_t e = components_next(now_ + 1);
+        const uint64_t due = irq_next_due();
+        if (due < e) e = due;
+        if (e == NEVER) return true;
+        if (now_ >= end) return false;
+        run_until(e < end ? e : end);
+    }
+}
+
+bool pad(uint pin) { return pins[pin].level; }
+
+void set_pad_listener(PadListener fn, void* user) {
+    listener      = fn;
+    listener_user = user;
+}
+
+const Counters& counters() { return ctrs; }
+
+// called by the SDK shims (sim_sdk.cpp)
+void irq_mask(bool disable) {
+    masked = disable;
+    if (!masked) irq_poll();   // pending handlers run right after cpsie
+}
+
+bool irq_masked() { return masked; }
+
+int irq_active() { return in_handler ? (int)active_irq : -1; }
+
+void irq_enable_line(uint num, bool enabled) {
+    irqs[num].enabled = enabled;
+    if (!enabled) irqs[num].pending = false;
+}
+
+bool irq_line_enabled(uint num) { return irqs[num].enabled; }
+
+void irq_set_handler(uint num, irq_handler_t h) {
+    if (irqs[num].exclusive || irqs[num].shared_count) fatal("irq %u: handler already installed", num);
+    irqs[num].exclusive = h;
+}
+
+void irq_add_handler(uint num, irq_handler_t h, uint8_t order) {
+    IrqLine& l = irqs[num];
+    if (l.exclusive) fatal("irq %u: exclusive handler installed", num);
+    if (l.shared_count == 4) fatal("irq %u: too many shared handlers", num);
+
+    // higher order priority runs first
+    uint i = l.shared_count++;
+    while (i > 0 && l.shared_order[i - 1] < order) {
+        l.shared[i]       = l.shared[i - 1];
+        l.shared_order[i] = l.shared_order[i - 1];
+        --i;
+    }
+    l.shared[i]       = h;
+    l.shared_order[i] = order;
+}
+
+void irq_drop_handler(uint num, irq_handler_t h) {
+    IrqLine& l = irqs[num];
+    if (l.exclusive == h) {
+        l.exclusive = nullptr;
+        return;
+    }
+    for (uint i = 0; i < l.shared_count; ++i) {
+        if (l.shared[i] != h) continue;
+        for (uint k = i + 1; k < l.shared_count; ++k) {
+            l.shared[k - 1]       = l.shared[k];
+            l.shared_order[k - 1] = l.shared_order[k];
+        }
+        l.shared_count--;
+        return;
+    }
+}
+
+} // namespace sim
+
+// ============================================================
+// GPIO (hardware/gpio.h)
+// ============================================================
+
+using sim::pins;
+
+void gpio_init(uint gpio) {
+    pins[gpio].sio_oe  = false;
+    pins[gpio].sio_out = false;
+    gpio_set_function(gpio, GPIO_FUNC_SIO);
+}
+
+void gpio_set_function(uint gpio, gpio_function_t fn) {
+    pins[gpio].fn = fn;
+    sim::pad_refresh(gpio, sim::now());
+}
+
+gpio_function_t gpio_get_function(uint gpio) { return pins[gpio].fn; }
+
+void gpio_set_dir(uint gpio, bool out) {
+    pins[gpio].sio_oe = out;
+    sim::pad_refresh(gpio, sim::now());
+}
+
+void gpio_put(uint gpio, bool value) {
+    pins[gpio].sio_out = value;
+    sim::pad_refresh(gpio, sim::now());
+}
+
+bool gpio_get(uint gpio) { return pins[gpio].level; }
+
+bool gpio_get_out_level(uint gpio) { return pins[gpio].sio_out; }
+
+void gpio_set_outover(uint gpio, uint value) {
+    pins[gpio].outover = (uint8_t)value;
+    sim::pad_refresh(gpio, sim::now());
+}
+
+void gpio_pull_down(uint) {}
+void gpio_pull_up(uint) {}
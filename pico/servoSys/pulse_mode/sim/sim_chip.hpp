@@ -0,0 +1,92 @@
+#pragma once
+
+#include "pico/types.h"
+#include "hardware/platform_defs.h"
+
+#include <cstdint>
+
+// ============================================================
+// sim: host model of the RP2040 / RP2350 peripherals used by
+//      PS100_P, pio_exec, pwm_motor and RadarSync
+//
+//   - PIO   : every instruction, cycle exact (delays, stalls,
+//             clock divider, 2-cycle input synchronizer, FIFOs)
+//   - DMA   : one transfer per cycle, DREQ pacing, chains,
+//             trigger aliases, ring wrap, null triggers, IRQ 0 / 1
+//   - PWM   : free-running slices, double buffered CC / TOP,
+//             wrap IRQ + DREQ
+//   - GPIO  : function select, SIO, output override, pad levels
+//   - timer : 1 MHz from f_sys, TIMELR -> TIMEHR latch
+//
+// The CPU is not modelled: driver code runs between two cycles in
+// zero time. Time only advances in the run_* calls below and in the
+// SDK waits (sleep_us, busy_wait_us, tight_loop_contents, blocking
+// FIFO puts). Interrupt handlers are taken irq_latency_cycles after
+// their line rises and also run in zero time.
+//
+// Event driven: each component reports the next cycle it can change
+// anything visible (pad, FIFO, flag, DREQ); everything in between is
+// skipped, including PIO delay loops (jmp x-- over nops) and stalls.
+// ============================================================
+
+namespace sim {
+
+// ------------------------------------------------------------
+// Options (change before the drivers are initialized)
+// ------------------------------------------------------------
+struct Options {
+    uint32_t irq_latency_cycles = 50;   // line rise -> handler entry
+    uint32_t poll_cycles        = 8;    // one tight_loop_contents()
+};
+
+Options& options();
+
+// ------------------------------------------------------------
+// Time
+// ------------------------------------------------------------
+uint64_t now();                  // cycles since power-up (last simulated cycle)
+uint32_t f_sys();                // SIM_SYS_CLK_HZ
+uint32_t cycles_per_us();
+
+void run_cycles(uint64_t n);
+void run_until(uint64_t cycle);
+void run_us(uint64_t us);
+
+// every component stalled with nothing pending (timeout: false)
+bool run_until_quiet(uint64_t timeout_cycles);
+
+// poll `done()` every poll_cycles until it holds (timeout: false)
+template <typename Pred>
+bool run_until_true(Pred done, uint64_t timeout_cycles, uint64_t poll_cycles = 64) {
+    const uint64_t end = now() + timeout_cycles;
+    while (!done()) {
+        if (now() >= end) return false;
+        const uint64_t left = end - now();
+        run_cycles(left < poll_cycles ? left : poll_cycles);
+    }
+    return true;
+}
+
+// ------------------------------------------------------------
+// Pads
+// ------------------------------------------------------------
+bool pad(uint pin);
+
+// called on every pad change (cycle of the change, new level)
+typedef void (*PadListener)(uint64_t cycle, uint pin, bool level, void* user);
+void set_pad_listener(PadListener fn, void* user);
+
+// ------------------------------------------------------------
+// Statistics
+// ------------------------------------------------------------
+struct Counters {
+    uint64_t pio_instructions;   // executed (fast-forwarded loops included)
+    uint64_t dma_transfers;
+    uint64_t irqs;               // handler dispatches
+    uint64_t events;             // scheduler steps
+    uint64_t skipped_cycles;     // cycles covered without a step
+};
+
+const Counters& counters();
+
+} // namespace sim
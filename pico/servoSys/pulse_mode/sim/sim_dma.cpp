@@ -0,0 +1,297 @@
+#include "sim_model.hpp"
+
+// ============================================================
+// DMA model
+//   - at most one transfer per cycle (whole controller), high
+//     priority channels first, then round robin
+//   - READ_ADDR / WRITE_ADDR / TRANS_COUNT / CTRL live in dma_hw,
+//     so drivers polling transfer_count / write_addr see them move
+//   - TRANS_COUNT writes set the reload value (copied on trigger)
+//   - null trigger (0 written to a trigger alias): no start,
+//     IRQ only with IRQ_QUIET
+//   - PWM wrap DREQs counted as credits while the channel is busy
+// ============================================================
+
+namespace sim {
+namespace dma_sim {
+
+namespace {
+
+struct Chan {
+    uint32_t reload;
+    uint32_t credit;   // pending wrap DREQs
+    bool     busy;
+};
+
+Chan     chans[NUM_DMA_CHANNELS];
+uint32_t busy_mask;    // scheduler scans only these
+uint32_t intr_raw;
+uint     rr_next;      // round robin start
+
+inline dma_channel_hw_t& regs(uint ch) { return dma_regs()->ch[ch]; }
+
+inline uint32_t ctrl_of(uint ch) { return regs(ch).ctrl_trig & ~DMA_CH0_CTRL_TRIG_BUSY_BITS; }
+
+inline void set_busy(uint ch, bool b) {
+    chans[ch].busy = b;
+    busy_mask = b ? (busy_mask | (1u << ch)) : (busy_mask & ~(1u << ch));
+    dma_channel_hw_t& r = regs(ch);
+    r.ctrl_trig = b ? (r.ctrl_trig | DMA_CH0_CTRL_TRIG_BUSY_BITS) : (r.ctrl_trig & ~DMA_CH0_CTRL_TRIG_BUSY_BITS);
+}
+
+inline uint treq_of(uint32_t ctrl) { return (ctrl >> DMA_CH0_CTRL_TRIG_TREQ_SEL_LSB) & 0x3Fu; }
+
+inline bool is_pwm_dreq(uint treq) {
+    return treq >= DREQ_PWM_WRAP0 && treq < DREQ_PWM_WRAP0 + NUM_PWM_SLICES;
+}
+
+bool dreq_ready(uint ch) {
+    const uint treq = treq_of(ctrl_of(ch));
+    if (treq == DREQ_FORCE) return true;
+    if (is_pwm_dreq(treq)) return chans[ch].credit > 0;
+
+    if (treq < NUM_PIOS * 8u) {
+        const uint p  = treq / 8u;
+        const uint sm = treq % 4u;
+        return ((treq % 8u) < 4u) ? pio_sim::tx_ready(p, sm) : pio_sim::rx_ready(p, sm);
+    }
+    fatal("dma ch%u: unsupported TREQ_SEL %u", ch, treq);
+}
+
+inline bool can_run(uint ch) {
+    return chans[ch].busy && (ctrl_of(ch) & DMA_CH0_CTRL_TRIG_EN_BITS) && dreq_ready(ch);
+}
+
+void complete(uint ch);
+
+void trigger(uint ch) {
+    Chan& c = chans[ch];
+    if (c.busy) return;
+
+    regs(ch).transfer_count = c.reload;
+    c.credit = 0;
+    set_busy(ch, true);
+
+    if (c.reload == 0) complete(ch);
+}
+
+void complete(uint ch) {
+    set_busy(ch, false);
+
+    const uint32_t ctrl = ctrl_of(ch);
+    if (!(ctrl & DMA_CH0_CTRL_TRIG_IRQ_QUIET_BITS)) intr_raw |= 1u << ch;
+
+    const uint chain = (ctrl >> DMA_CH0_CTRL_TRIG_CHAIN_TO_LSB) & 0xFu;
+    if (chain != ch && chain < NUM_DMA_CHANNELS) trigger(chain);
+}
+
+inline uint32_t advance(uint32_t addr, uint32_t inc, uint ring_bits) {
+    if (ring_bits == 0) return addr + inc;
+    const uint32_t mask = (1u << ring_bits) - 1u;
+    return (addr & ~mask) | ((addr + inc) & mask);
+}
+
+void transfer(uint ch) {
+    dma_channel_hw_t& r    = regs(ch);
+    const uint32_t    ctrl = ctrl_of(ch);
+
+    const uint size = 1u << ((ctrl >> DMA_CH0_CTRL_TRIG_DATA_SIZE_LSB) & 3u);
+    uint32_t   v    = sim::bus_read(r.read_addr, size);
+    if ((ctrl & DMA_CH0_CTRL_TRIG_BSWAP_BITS) && size > 1) {
+        v = (size == 2) ? (uint32_t)__builtin_bswap16((uint16_t)v) : __builtin_bswap32(v);
+    }
+    sim::bus_write(r.write_addr, v, size);
+
+    const uint ring  = (ctrl >> DMA_CH0_CTRL_TRIG_RING_SIZE_LSB) & 0xFu;
+    const bool ringw = (ctrl & DMA_CH0_CTRL_TRIG_RING_SEL_BITS) != 0;
+
+    if (ctrl & DMA_CH0_CTRL_TRIG_INCR_READ_BITS)  r.read_addr  = advance(r.read_addr, size, ringw ? 0 : ring);
+    if (ctrl & DMA_CH0_CTRL_TRIG_INCR_WRITE_BITS) r.write_addr = advance(r.write_addr, size, ringw ? ring : 0);
+
+    Chan& c = chans[ch];
+    if (is_pwm_dreq(treq_of(ctrl))) c.credit--;
+
+    counters_mut().dma_transfers++;
+
+    r.transfer_count = r.transfer_count - 1u;
+    if (r.transfer_count == 0) complete(ch);
+}
+
+// register index inside a channel window
+enum Word : uint32_t {
+    W_READ = 0, W_WRITE, W_COUNT, W_CTRL_TRIG,
+    W_AL1_CTRL, W_AL1_READ, W_AL1_WRITE, W_AL1_COUNT_TRIG,
+    W_AL2_CTRL, W_AL2_COUNT, W_AL2_READ, W_AL2_WRITE_TRIG,
+    W_AL3_CTRL, W_AL3_WRITE, W_AL3_COUNT, W_AL3_READ_TRIG
+};
+
+enum Field { F_READ, F_WRITE, F_COUNT, F_CTRL };
+
+struct WordInfo {
+    Field f;
+    bool  trig;
+};
+
+constexpr WordInfo WORDS[16] = {
+    {F_READ, false},  {F_WRITE, false}, {F_COUNT, false}, {F_CTRL, true},
+    {F_CTRL, false},  {F_READ, false},  {F_WRITE, false}, {F_COUNT, true},
+    {F_CTRL, false},  {F_COUNT, false}, {F_READ, false},  {F_WRITE, true},
+    {F_CTRL, false},  {F_WRITE, false}, {F_COUNT, false}, {F_READ, true},
+};
+
+constexpr uint32_t CH_WINDOW  = sizeof(dma_channel_hw_t);
+constexpr uint32_t REG_INTR   = NUM_DMA_CHANNELS * CH_WINDOW;
+constexpr uint32_t REG_INTE0  = REG_INTR + 4;
+constexpr uint32_t REG_INTF0  = REG_INTR + 8;
+constexpr uint32_t REG_INTS0  = REG_INTR + 12;
+constexpr uint32_t REG_INTE1  = REG_INTR + 16;
+constexpr uint32_t REG_INTF1  = REG_INTR + 20;
+constexpr uint32_t REG_INTS1  = REG_INTR + 24;
+
+inline uint32_t ints(uint index) {
+    dma_hw_t* h = dma_regs();
+    const uint32_t inte = index ? h->inte1 : h->inte0;
+    const uint32_t intf = index ? h->intf1 : h->intf0;
+    return (intr_raw & inte) | intf;
+}
+
+} // namespace
+
+// ============================================================
+// scheduler interface
+// ============================================================
+
+void reset() {
+    for (uint ch = 0; ch < NUM_DMA_CHANNELS; ++ch) chans[ch] = Chan{};
+    busy_mask = 0;
+    intr_raw  = 0;
+    rr_next  = 0;
+}
+
+uint64_t next_event(uint64_t t) {
+    for (uint32_t m = busy_mask; m; m &= m - 1u) {
+        if (can_run((uint)__builtin_ctz(m))) return t;
+    }
+    return NEVER;
+}
+
+void skip(uint64_t) {}
+
+void step(uint64_t) {
+    if (!busy_mask) return;
+    int pick = -1;
+
+    for (uint k = 0; k < NUM_DMA_CHANNELS && pick < 0; ++k) {
+        const uint ch = (rr_next + k) % NUM_DMA_CHANNELS;
+        if ((ctrl_of(ch) & DMA_CH0_CTRL_TRIG_HIGH_PRIORITY_BITS) && can_run(ch)) pick = (int)ch;
+    }
+    for (uint k = 0; k < NUM_DMA_CHANNELS && pick < 0; ++k) {
+        const uint ch = (rr_next + k) % NUM_DMA_CHANNELS;
+        if (can_run(ch)) pick = (int)ch;
+    }
+    if (pick < 0) return;
+
+    rr_next = ((uint)pick + 1u) % NUM_DMA_CHANNELS;
+    transfer((uint)pick);
+}
+
+void pwm_wrap(uint slice) {
+    for (uint32_t m = busy_mask; m; m &= m - 1u) {
+        const uint ch = (uint)__builtin_ctz(m);
+        if (treq_of(ctrl_of(ch)) == DREQ_PWM_WRAP0 + slice) chans[ch].credit++;
+    }
+}
+
+bool irq_line(uint index) { return ints(index) != 0; }
+
+bool busy(uint ch) { return chans[ch].busy; }
+
+void start(uint32_t mask) {
+    for (uint ch = 0; ch < NUM_DMA_CHANNELS; ++ch) {
+        if (mask & (1u << ch)) trigger(ch);
+    }
+}
+
+void abort(uint ch) {
+    set_busy(ch, false);
+    chans[ch].credit = 0;
+}
+
+// ============================================================
+// register window
+// ============================================================
+
+uint32_t bus_read(uint32_t reg) {
+    dma_hw_t* h = dma_regs();
+
+    if (reg < REG_INTR) {
+        const uint ch = reg / CH_WINDOW;
+        const uint w  = (reg % CH_WINDOW) / 4u;
+        dma_channel_hw_t& r = regs(ch);
+        switch (WORDS[w].f) {
+            case F_READ:  return r.read_addr;
+            case F_WRITE: return r.write_addr;
+            case F_COUNT: return r.transfer_count;
+            default:      return r.ctrl_trig;
+        }
+    }
+
+    switch (reg) {
+        case REG_INTR:  return intr_raw;
+        case REG_INTS0: return ints(0);
+        case REG_INTS1: return ints(1);
+        default:        return *(const volatile uint32_t*)((const uint8_t*)h + reg);
+    }
+}
+
+void bus_write(uint32_t reg, uint32_t v, uint32_t alias) {
+    dma_hw_t* h = dma_regs();
+
+    if (reg < REG_INTR) {
+        const uint ch = reg / CH_WINDOW;
+        const uint w  = (reg % CH_WINDOW) / 4u;
+        dma_channel_hw_t& r = regs(ch);
+        const WordInfo wi = WORDS[w];
+
+        switch (wi.f) {
+            case F_READ:  r.read_addr  = alias_apply(r.read_addr, v, alias); break;
+            case F_WRITE: r.write_addr = alias_apply(r.write_addr, v, alias); break;
+            case F_COUNT: chans[ch].reload = alias_apply(chans[ch].reload, v, alias); break;
+            default: {
+                const uint32_t busy_bit = r.ctrl_trig & DMA_CH0_CTRL_TRIG_BUSY_BITS;
+                r.ctrl_trig = (alias_apply(ctrl_of(ch), v, alias) & ~DMA_CH0_CTRL_TRIG_BUSY_BITS) | busy_bit;
+                break;
+            }
+        }
+
+        if (wi.trig && alias == ALIAS_RW) {
+            if (v == 0) {
+                if (ctrl_of(ch) & DMA_CH0_CTRL_TRIG_IRQ_QUIET_BITS) intr_raw |= 1u << ch;
+            } else {
+                trigger(ch);
+            }
+        }
+        return;
+    }
+
+    switch (reg) {
+        case REG_INTR:
+        case REG_INTS0:
+        case REG_INTS1:
+            intr_raw &= ~v;   // write 1 to clear
+            return;
+        case REG_INTE0:
+        case REG_INTF0:
+        case REG_INTE1:
+        case REG_INTF1: {
+            volatile uint32_t* p = (volatile uint32_t*)((uint8_t*)h + reg);
+            *p = alias_apply(*p, v, alias);
+            return;
+        }
+        default:
+            fatal("dma: write to unmodelled register 0x%03x", reg);
+    }
+}
+
+} // namespace dma_sim
+} // namespace sim
@@ -0,0 +1,1686 @@
+#include "sim_chip.hpp"
+#include "sim_trace.hpp"
+
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+
+#include "drivers/ps100.hpp"
+#include "drivers/pwm_motor.hpp"
+#include "drivers/radar_sync.hpp"
+#include "pio/pio_exec.hpp"
+#include "pio/pio_resources.hpp"
+#include "pio/motor_exec_variants.hpp"
+#include "timing/pio_timing.hpp"
+#include "timing/axis_units.hpp"
+#include "trajectory/s_curve_planner.hpp"
+#include "trajectory/profile_cache.hpp"
+#include "trajectory/traj_lib_build.hpp"
+#include "trace/trace.hpp"
+#include "firmware/axis_queue.hpp"
+#include "firmware/fw_protocol.hpp"
+#include "firmware/usb_batch.hpp"
+
+#include "hardware/irq.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+// ============================================================
+// sim_runner: scenario regression on the chip model
+//
+//   sim_runner [group] [-n trajectories] [-s seed] [-v out.vcd]
+//
+//   groups (each one in a forked process = fresh chip, program
+//   memory and driver statics, as after a reset):
+//     axis      PIO / PWM / Auto run_steps, S-curve ring + stream,
+//               interrupt / stop mid-pulse, queue_steps
+//     radar     radar_sync Single + Dual next to a moving axis
+//     variant   the motor_exec variants, DIR reversals on device
+//     trace     the hot-path trace ring (PULSE_MODE_TRACE=ON builds)
+//     firmware  servo_fw AxisQueue: segment IDs, credits, telemetry,
+//               USB TX batching
+//     cache     profile cache: shared pool blocks, LRU, pinning
+//     traj_lib  flash trajectory library: image, XIP / staged playback
+//     units     Q16.16 axis units: scale vs double, move_mm / queue_mm
+//   no group: all of them
+//
+// Every check is done on the STEP / DIR / TRIGGER pad edges, not
+// on driver state: pulse counts, widths, periods, DIR setup and
+// trigger alignment against what the drivers report.
+// Exit code: number of failed checks (0 = pass).
+// ============================================================
+
+namespace {
+
+// ------------------------------------------------------------
+// wiring (same as the test programs)
+// ------------------------------------------------------------
+constexpr uint STEP_PIN    = 3;
+constexpr uint DIR_PIN     = 4;
+constexpr uint TRIGGER_PIN = 6;
+
+// ------------------------------------------------------------
+// options / results
+// ------------------------------------------------------------
+unsigned    g_count = 200;       // S-curve trajectories per group
+uint32_t    g_seed  = 1;
+const char* g_vcd   = nullptr;   // trace of the first S-curve run
+
+unsigned g_checks = 0;
+unsigned g_failed = 0;
+
+#define CHECK(cond, ...)                                              \
+    do {                                                              \
+        ++g_checks;                                                   \
+        if (!(cond)) {                                                \
+            ++g_failed;                                               \
+            if (g_failed <= 400) {                                     \
+                std::printf("  FAIL %s:%d: ", __FILE__, __LINE__);    \
+                std::printf(__VA_ARGS__);                             \
+                std::printf("\n");                                    \
+            }                                                         \
+        }                                                             \
+    } while (0)
+
+// xorshift32, reproducible across hosts
+uint32_t g_rng = 1;
+
+uint32_t rnd() {
+    g_rng ^= g_rng << 13;
+    g_rng ^= g_rng >> 17;
+    g_rng ^= g_rng << 5;
+    return g_rng;
+}
+
+uint32_t rnd_range(uint32_t lo, uint32_t hi) { return lo + rnd() % (hi - lo + 1u); }
+
+// log-uniform, for speeds / accelerations
+float rnd_log(float lo, float hi) {
+    const float u = (float)(rnd() & 0xFFFFFF) / (float)0xFFFFFF;
+    return lo * __builtin_powf(hi / lo, u);
+}
+
+sim::Trace trace;
+
+// one line of timing statistics per scenario
+void print_stats(const char* what, uint pin) {
+    const sim::PinStats s = trace.stats(pin);
+    const double ns = 1e9 / (double)sim::f_sys();
+    std::printf("  %-28s edges %7llu  high %7.0f..%-9.0f ns  period %8.0f..%-10.0f ns\n",
+                what, (unsigned long long)s.rising,
+                s.min_high * ns, s.max_high * ns,
+                s.min_period * ns, s.max_period * ns);
+}
+
+// wait for COM2 to drain (timeout in us of simulated time)
+//   polled like a main loop would, every ~1/256 of the timeout: each
+//   poll is a scheduler step, slow moves would otherwise cost more
+//   host time than the pulses themselves
+bool run_to_idle(PS100_P& m, uint64_t timeout_us) {
+    const uint64_t poll_us = timeout_us / 256u > 10u ? timeout_us / 256u : 10u;
+    const uint64_t poll    = poll_us * sim::cycles_per_us();
+    return sim::run_until_true([&] { return !m.busy(); },
+                               timeout_us * sim::cycles_per_us(), poll);
+}
+
+// the checks every motion ends with
+void check_motion(const char* what, PS100_P& m, uint64_t expect_steps,
+                  int32_t pos_before, bool check_counter) {
+    const sim::PinStats s = trace.stats(STEP_PIN);
+    const int64_t moved   = trace.position(STEP_PIN, DIR_PIN);
+
+    CHECK(s.rising == expect_steps, "%s: %llu STEP pulses, expected %llu",
+          what, (unsigned long long)s.rising, (unsigned long long)expect_steps);
+    CHECK(!s.level, "%s: STEP left high", what);
+    if (check_counter) {
+        CHECK(m.steps_done() == s.rising, "%s: steps_done() %u, pads %llu",
+              what, m.steps_done(), (unsigned long long)s.rising);
+    }
+    CHECK((int64_t)(m.position() - pos_before) == moved, "%s: position() moved %d, pads %lld",
+          what, (int)(m.position() - pos_before), (long long)moved);
+}
+
+uint64_t duration_us(uint64_t steps, uint32_t hz) { return steps * 1000000ull / hz; }
+
+// ============================================================
+// group "axis": Exec program on pio0, position register on pio1
+// ============================================================
+
+PS100_P::Config axis_config(MotorExecVariant v, PIO position_pio) {
+    PS100_P::Config cfg{};
+    cfg.step_pin = STEP_PIN;
+    cfg.dir_pin  = DIR_PIN;
+    cfg.pio      = pio0;
+    cfg.sm       = 0;
+    cfg.variant  = v;
+    cfg.program_offset = (uint)pio_res_program(cfg.pio, motor_exec_variant_program(v)->program);
+    cfg.position_pio   = position_pio;
+    return cfg;
+}
+
+void axis_run_steps(PS100_P& m) {
+    std::printf("run_steps (PIO, fixed rate)\n");
+    const PioTiming t = motor_exec_timing_for(1.0f);
+
+    static const uint32_t HZ[] = { 50, 1000, 12345, 100000, 400000, 1000000 };
+    for (uint32_t hz : HZ) {
+        for (int dir = 0; dir < 2; ++dir) {
+            const uint32_t steps = 1 + rnd() % 400;
+            const int32_t  p0    = m.position();
+            m.set_direction(dir == 0);
+
+            trace.clear();
+            m.run_steps(steps, hz, PS100_P::Backend::PIO);
+            CHECK(run_to_idle(m, duration_us(steps, hz) + 10000), "PIO %u Hz: timeout", hz);
+            check_motion("PIO run_steps", m, steps, p0, true);
+
+            const sim::PinStats s = trace.stats(STEP_PIN);
+            const uint64_t period = t.period_cycles(t.hz_to_duty(hz));
+            if (steps > 1) {
+                CHECK(s.min_period == period && s.max_period == period,
+                      "PIO %u Hz: period %llu..%llu cycles, model %llu", hz,
+                      (unsigned long long)s.min_period, (unsigned long long)s.max_period,
+                      (unsigned long long)period);
+            }
+            if (dir == 1) {
+                char what[40];
+                std::snprintf(what, sizeof(what), "PIO %u Hz", hz);
+                print_stats(what, STEP_PIN);
+            }
+        }
+    }
+}
+
+void axis_pwm(PS100_P& m, PwmCountMode mode, const char* name) {
+    std::printf("run_steps (PWM, %s counting)\n", name);
+    pwm_motor_set_count_mode(mode);
+
+    // the divider search stays inside the register range (INT 1..255) down
+    // to frequencies below what the slowest divider can reach
+    for (uint32_t hz = 1; hz <= 64; ++hz) {
+        const PwmDivChoice d = pwm_motor_choose_div(sim::f_sys(), hz);
+        CHECK(d.div16 >= 16 && d.div16 <= 4095, "PWM %u Hz: div16 %u", hz, d.div16);
+    }
+
+    static const uint32_t HZ[] = { 20, 1000, 7777, 20000, 100000 };
+    for (uint32_t hz : HZ) {
+        if (mode == PwmCountMode::Irq && hz > 50000) continue;   // one IRQ per pulse
+
+        static const uint32_t STEPS[] = { 1, 2, 3, 57 };
+        for (uint32_t steps : STEPS) {
+            const int32_t p0 = m.position();
+            trace.clear();
+            m.run_steps(steps, hz, PS100_P::Backend::PWM);
+            CHECK(run_to_idle(m, duration_us(steps, hz) + 100000), "PWM %u Hz: timeout", hz);
+            sim::run_us(duration_us(2, hz) + 10);   // nothing may follow the last pulse
+
+            char what[48];
+            std::snprintf(what, sizeof(what), "PWM %s %u Hz x %u", name, hz, steps);
+            check_motion(what, m, steps, p0, true);
+
+            if (steps > 2) {
+                const sim::PinStats s = trace.stats(STEP_PIN);
+                const PwmDivChoice d = pwm_motor_choose_div(sim::f_sys(), hz);
+                const uint64_t p16   = (uint64_t)(d.wrap + 1u) * d.div16;   // cycles * 16
+                CHECK(s.min_period * 16 + 16 > p16 && s.max_period * 16 < p16 + 16,
+                      "%s: period %llu..%llu cycles, divider %llu/16", what,
+                      (unsigned long long)s.min_period, (unsigned long long)s.max_period,
+                      (unsigned long long)p16);
+            }
+            if (steps == 57) print_stats(what, STEP_PIN);
+        }
+    }
+    pwm_motor_set_count_mode(PwmCountMode::Dma);
+}
+
+void axis_auto(PS100_P& m) {
+    std::printf("run_steps (Auto)\n");
+    for (int i = 0; i < 40; ++i) {
+        const uint32_t hz    = (uint32_t)rnd_log(5.0f, 500000.0f);
+        const uint32_t steps = rnd_range(1, 300);
+        const int32_t  p0    = m.position();
+        m.set_direction(rnd() & 1);
+
+        trace.clear();
+        m.run_steps(steps, hz, PS100_P::Backend::Auto);
+        CHECK(run_to_idle(m, duration_us(steps, hz) + 100000), "Auto %u Hz: timeout", hz);
+        char what[64];
+        std::snprintf(what, sizeof(what), "Auto %u Hz x %u (%s)", hz, steps,
+                      m.auto_backend(hz, steps) == PS100_P::Backend::PWM ? "PWM" : "PIO");
+        check_motion(what, m, steps, p0, true);
+
+        // back-to-back commands: the hand-over itself may not add an edge
+        CHECK(trace.stats(DIR_PIN).rising + trace.stats(DIR_PIN).falling <= 1, "Auto: DIR glitch");
+    }
+    print_stats("Auto (last)", STEP_PIN);
+}
+
+// S-curve trajectories through the DMA ring (planner refill in the
+// DMA IRQ) and as one stream, raw and packed
+void axis_scurve(PS100_P& m, unsigned count) {
+    std::printf("S-curve ring / stream x %u\n", count);
+
+    static SCurvePlanner planner(motor_exec_timing_for(1.0f), 16);
+    static uint32_t ring[2 * 16];
+    static uint32_t words[4096];   // slow packed moves: several words per pulse
+
+    unsigned planned = 0, underruns = 0;
+    uint64_t steps_total = 0, min_high = ~0ull;
+
+    for (unsigned i = 0; i < count; ++i) {
+        SCurvePlanner::Limits lim{};
+        lim.v_max = rnd_log(500.0f, 200000.0f);
+        lim.a_max = rnd_log(5e3f, 5e6f);
+        lim.j_max = rnd_log(1e5f, 1e9f);
+        const uint32_t total = (uint32_t)rnd_log(1.0f, 20000.0f);
+
+        const bool packed = (i % 4) == 3;
+        planner.set_format(packed ? MotorExecFormat::Packed : MotorExecFormat::Raw);
+        if (!planner.plan(lim, total)) continue;
+        ++planned;
+
+        const SCurvePlanner::Profile& pr = planner.profile();
+        const uint64_t est_us = (uint64_t)((2.0f * pr.t_ramp_s + pr.t_cruise_s) * 1e6f) + 1;
+        const int32_t  p0     = m.position();
+        m.set_direction(rnd() & 1);
+
+        trace.clear();
+        const bool use_ring = (i % 2) == 0;
+        if (use_ring) {
+            CHECK(m.run_pio_ring(ring, 16, &SCurvePlanner::refill, &planner, planner.format()),
+                  "ring start failed (%u steps)", total);
+        } else {
+            const size_t n = planner.emit_all(words, sizeof(words) / sizeof(words[0]));
+            if (n == 0) {   // does not fit one stream buffer: ring only
+                --planned;
+                continue;
+            }
+            m.run_pio_stream(words, n, est_us, planner.format());
+        }
+        CHECK(run_to_idle(m, est_us * 2 + 100000), "S-curve: timeout (%u steps, %.0f steps/s)",
+              total, pr.v_peak);
+
+        if (use_ring && m.last_ring_underrun()) ++underruns;
+        check_motion(use_ring ? "S-curve ring" : "S-curve stream", m, total, p0, true);
+
+        const sim::PinStats s = trace.stats(STEP_PIN);
+        if (s.min_high && s.min_high < min_high) min_high = s.min_high;
+        steps_total += total;
+
+        if (i == 0 && g_vcd) {
+            trace.write_vcd(g_vcd);
+            std::printf("  VCD: %s\n", g_vcd);
+        }
+    }
+
+    CHECK(underruns == 0, "S-curve ring: %u underruns", underruns);
+    std::printf("  planned %u / %u, %llu steps, min STEP high %llu cycles\n",
+                planned, count, (unsigned long long)steps_total, (unsigned long long)min_high);
+}
+
+// odd half_words: Raw (two words per command) is refused, Packed runs
+void axis_ring_odd(PS100_P& m) {
+    std::printf("ring, odd half_words\n");
+
+    static SCurvePlanner planner(motor_exec_timing_for(1.0f), 15);
+    static uint32_t ring[2 * 15];
+
+    SCurvePlanner::Limits lim{};
+    lim.v_max = 40000.0f;
+    lim.a_max = 4e5f;
+    lim.j_max = 4e7f;
+    const uint32_t total = 3000;
+
+    planner.set_format(MotorExecFormat::Raw);
+    CHECK(planner.plan(lim, total), "odd ring: plan");
+    const int32_t p0 = m.position();
+    trace.clear();
+    CHECK(!m.run_pio_ring(ring, 15, &SCurvePlanner::refill, &planner, MotorExecFormat::Raw),
+          "odd ring: Raw with 15 words per half accepted");
+    sim::run_us(1000);
+    CHECK(!m.busy() && trace.stats(STEP_PIN).rising == 0 && m.position() == p0,
+          "odd ring: refused Raw ring moved the axis");
+
+    planner.set_format(MotorExecFormat::Packed);
+    CHECK(planner.plan(lim, total), "odd ring: plan");
+    const SCurvePlanner::Profile& pr = planner.profile();
+    const uint64_t est_us = (uint64_t)((2.0f * pr.t_ramp_s + pr.t_cruise_s) * 1e6f) + 1;
+    CHECK(m.run_pio_ring(ring, 15, &SCurvePlanner::refill, &planner, MotorExecFormat::Packed),
+          "odd ring: Packed ring start failed");
+    CHECK(run_to_idle(m, est_us * 2 + 100000), "odd ring: timeout");
+    CHECK(!m.last_ring_underrun(), "odd ring: underrun");
+    check_motion("ring packed, 15 words", m, total, p0, true);
+}
+
+// slow refill in the ring IRQ: the other half is pushed out before the
+// refilled one is published, the control channel reads 0 and the chain
+// stops at the boundary. The published half must still run: no underrun,
+// no lost steps
+struct SlowRefill {
+    uint32_t duty;
+    uint32_t steps;      // per command
+    uint32_t left;       // commands still to emit
+    unsigned calls;
+    unsigned slow_call;  // this call waits slow_us before returning
+    uint32_t slow_us;
+};
+
+size_t slow_refill(uint32_t* dst, size_t cap, void* user) {
+    SlowRefill& s = *(SlowRefill*)user;
+    size_t n = 0;
+    for (; n + 2 <= cap && s.left > 0; n += 2, --s.left) {
+        dst[n]     = s.duty;
+        dst[n + 1] = s.steps;
+    }
+    if (++s.calls == s.slow_call) busy_wait_us_32(s.slow_us);
+    return n;
+}
+
+void axis_ring_late_publish(PS100_P& m) {
+    std::printf("ring, refill published after the chain stopped\n");
+
+    static uint32_t ring[2 * 8];
+    const PioTiming t = motor_exec_timing_for(1.0f);
+
+    // 3rd call = first refill in the IRQ; a half (4 x 10 steps @ 50 kHz)
+    // leaves the DMA in well under 2 ms
+    SlowRefill s{t.hz_to_duty(50000), 10, 24, 0, 3, 2000};
+    const uint32_t total = s.left * s.steps;
+
+    const int32_t p0 = m.position();
+    m.set_direction(true);
+    trace.clear();
+    CHECK(m.run_pio_ring(ring, 8, &slow_refill, &s, MotorExecFormat::Raw), "late publish: ring start");
+    CHECK(run_to_idle(m, 100000), "late publish: timeout");
+    CHECK(s.calls > 3, "late publish: ring stopped after the slow refill");
+    CHECK(!m.last_ring_underrun(), "late publish: underrun reported");
+    check_motion("ring late publish", m, total, p0, true);
+}
+
+// interrupt / stop at a random cycle: every pulse is whole and counted
+void axis_interrupt(PS100_P& m) {
+    std::printf("interrupt / stop mid-motion\n");
+
+    const uint64_t min_high = (uint64_t)PS100_P::Config{}.min_high_us * sim::cycles_per_us();
+    uint64_t shortest = ~0ull;
+
+    for (int i = 0; i < 60; ++i) {
+        const bool     pwm   = (i % 3) == 2;
+        const uint32_t hz    = pwm ? rnd_range(500, 50000) : (uint32_t)rnd_log(200.0f, 200000.0f);
+        const uint32_t steps = rnd_range(50, 2000);
+        const int32_t  p0    = m.position();
+
+        trace.clear();
+        m.run_steps(steps, hz, pwm ? PS100_P::Backend::PWM : PS100_P::Backend::PIO);
+        sim::run_cycles(rnd() % (duration_us(steps, hz) * sim::cycles_per_us() / 2 + 1));
+
+        // stop(), or preempted by a 0-step command (halt, then COM1 Completed
+        // and steps_done() == 0 for the empty command: pads vs position only)
+        const bool stop = (i % 2) != 0;
+        if (stop) {
+            m.stop();
+            CHECK(m.last_completion() == PS100_P::CompletionReason::Stopped, "stop: COM1");
+        } else {
+            m.run_steps(0, hz, PS100_P::Backend::PIO);
+        }
+        const uint32_t done = m.steps_done();
+        sim::run_us(1000);   // nothing may follow the halt
+
+        const sim::PinStats s = trace.stats(STEP_PIN);
+        if (stop) {
+            CHECK(s.rising == done, "stop (%s %u Hz): steps_done() %u, pads %llu",
+                  pwm ? "PWM" : "PIO", hz, done, (unsigned long long)s.rising);
+        }
+        CHECK(!s.level, "halt: STEP left high");
+        CHECK((int64_t)(m.position() - p0) == trace.position(STEP_PIN, DIR_PIN), "halt: position");
+
+        // the cut pulse: its natural width, or at least min_high_us
+        if (s.rising) {
+            const std::vector<sim::Edge>& e = trace.edges(STEP_PIN);
+            const uint64_t high = e.back().cycle - e[e.size() - 2].cycle;
+            if (high < shortest) shortest = high;
+            CHECK(high >= min_high || high >= s.min_high, "halt: runt pulse %llu cycles",
+                  (unsigned long long)high);
+        }
+    }
+    std::printf("  shortest last pulse %llu cycles (min_high_us %llu cycles)\n",
+                (unsigned long long)shortest, (unsigned long long)min_high);
+}
+
+// queue_steps: segments appended to a running command, no gap
+//   the longest STEP period may only be the slowest segment's own
+//   period (+ command overhead): no dwell, no wait between segments
+constexpr uint32_t QUEUE_GAP_US = 2;
+
+void check_queue_gap(const char* what, uint32_t min_hz) {
+    const sim::PinStats s = trace.stats(STEP_PIN);
+    const uint64_t limit  = sim::f_sys() / min_hz + QUEUE_GAP_US * sim::cycles_per_us();
+    CHECK(s.max_period <= limit, "%s: gap of %llu cycles between pulses (slowest %u Hz, limit %llu)",
+          what, (unsigned long long)s.max_period, min_hz, (unsigned long long)limit);
+}
+
+void axis_queue(PS100_P& m) {
+    std::printf("queue_steps blend\n");
+
+    for (int run = 0; run < 20; ++run) {
+        const int32_t p0 = m.position();
+        trace.clear();
+
+        uint64_t total = 0, est = 0;
+        uint32_t hz    = rnd_range(2000, 40000);
+        uint32_t steps = rnd_range(20, 400);
+        uint32_t min_hz = hz;
+        m.run_steps(steps, hz, PS100_P::Backend::PIO);
+        total += steps;
+        est   += duration_us(steps, hz);
+
+        const int segs = rnd_range(2, 10);
+        for (int k = 0; k < segs; ++k) {
+            hz    = rnd_range(2000, 40000);
+            steps = rnd_range(20, 400);
+            if (!m.queue_steps(steps, hz, (run & 1) ? 200000 : 0)) break;
+            total += steps;
+            est   += duration_us(steps, hz);
+            if (hz < min_hz) min_hz = hz;
+        }
+
+        CHECK(run_to_idle(m, est * 2 + 100000), "queue: timeout");
+        check_motion("queue_steps", m, total, p0, false);
+        check_queue_gap("queue_steps", min_hz);
+    }
+    print_stats("queue_steps (last)", STEP_PIN);
+}
+
+// segments queued while the previous one is still executing, at a
+// random point: the ring has run dry (chain ended, or its last half
+// still in flight) and is re-linked without a gap
+void axis_queue_late(PS100_P& m) {
+    std::printf("queue_steps, queued late\n");
+
+    for (int run = 0; run < 60; ++run) {
+        const int32_t p0 = m.position();
+        trace.clear();
+
+        uint32_t hz     = rnd_range(2000, 40000);
+        uint32_t steps  = rnd_range(20, 400);
+        uint32_t min_hz = hz;
+        uint64_t total  = steps;
+        const uint32_t a_max = (run & 1) ? 200000 : 0;
+        CHECK(m.queue_steps(steps, hz), "late: first segment");   // no ramp up from rest
+
+        const int segs = rnd_range(1, 4);
+        uint32_t  fast = hz;   // a blended segment never runs faster than this
+        for (int k = 0; k < segs; ++k) {
+            // somewhere inside the last segment, not at its very end (an
+            // axis that went idle starts over, that gap is the caller's)
+            sim::run_us(rnd() % (duration_us(steps, fast) * 9 / 10 + 1));
+            CHECK(m.busy(), "late: axis idle before segment %d", k);
+
+            const uint32_t prev = hz;
+            hz    = rnd_range(2000, 40000);
+            steps = rnd_range(20, 400);
+            if (!m.queue_steps(steps, hz, a_max)) break;   // queue full
+            total += steps;
+            fast = hz > prev ? hz : prev;
+            if (hz < min_hz) min_hz = hz;
+        }
+
+        CHECK(run_to_idle(m, duration_us(total, min_hz) * 2 + 100000), "late: timeout");
+        check_motion("queue_steps late", m, total, p0, false);
+        check_queue_gap("queue_steps late", min_hz);
+    }
+    print_stats("queue_steps late (last)", STEP_PIN);
+}
+
+int group_axis() {
+    static PS100_P motor(axis_config(MotorExecVariant::Exec, pio1));
+    CHECK(motor.init(), "init");
+    motor.enable();
+    CHECK(motor.has_position(), "no position register");
+
+    axis_run_steps(motor);
+    axis_pwm(motor, PwmCountMode::Dma, "DMA");
+    axis_pwm(motor, PwmCountMode::Irq, "IRQ");
+    axis_auto(motor);
+    axis_scurve(motor, g_count);
+    axis_ring_odd(motor);
+    axis_ring_late_publish(motor);
+    axis_interrupt(motor);
+    axis_queue(motor);
+    axis_queue_late(motor);
+    return 0;
+}
+
+// ============================================================
+// group "radar": motor_exec + step_position on pio0, radar on pio1
+//   trigger k rises after exactly k * ratio STEP falling edges,
+//   its record says seq k, step_index k * ratio, t_us of the edge
+// ============================================================
+
+void radar_case(PS100_P& m, RadarSync& r, const char* name) {
+    std::printf("radar_sync %s\n", name);
+
+    static RadarSync::Trigger rec[RadarSync::RING_SIZE];
+    const uint32_t pulse_us = 5;
+    uint64_t worst_lag = 0;
+
+    for (int i = 0; i < 12; ++i) {
+        const uint32_t ratio = rnd_range(1, 40);
+        // trigger pulses may not overlap: ratio steps take longer than one pulse
+        const uint32_t hz_max = (uint32_t)((uint64_t)ratio * 1000000u / (3u * pulse_us + 5u));
+        uint32_t       hz     = (uint32_t)rnd_log(500.0f, 100000.0f);
+        if (hz > hz_max) hz = hz_max;
+        const uint32_t steps = ratio * rnd_range(1, 200) + rnd() % ratio;
+        if (r.armed()) r.disarm();
+        trace.clear();
+
+        CHECK(r.arm(ratio, pulse_us_to_radar_len(pulse_us)), "arm");
+        m.run_steps(steps, hz, PS100_P::Backend::PIO);
+        CHECK(run_to_idle(m, duration_us(steps, hz) + 10000), "radar: motor timeout");
+        sim::run_us(4 * pulse_us + 50);
+
+        const size_t   n      = r.read(rec, RadarSync::RING_SIZE);
+        const uint32_t expect = steps / ratio + 1;   // + trigger 0 at arm
+
+        CHECK(!r.overrun(), "%s: overrun", name);
+        CHECK(n == expect, "%s: %zu records, expected %u (ratio %u, %u steps)", name, n, expect,
+              ratio, steps);
+
+        const std::vector<sim::Edge>& te = trace.edges(TRIGGER_PIN);
+        size_t k = 0;
+        for (const sim::Edge& e : te) {
+            if (!e.level) continue;
+            if (k < n) {
+                CHECK(rec[k].seq == k && rec[k].step_index == k * ratio,
+                      "%s: record %zu = seq %u step %u", name, k, rec[k].seq, rec[k].step_index);
+                const uint64_t edge_us = e.cycle / sim::cycles_per_us();
+                // stamped when the SM pushes the token (pulse end for Single)
+                CHECK(rec[k].t_us + 2 >= edge_us && rec[k].t_us <= edge_us + pulse_us + 2,
+                      "%s: record %zu at %llu us, edge at %llu us", name, k,
+                      (unsigned long long)rec[k].t_us, (unsigned long long)edge_us);
+            }
+            if (k > 0) {
+                const size_t falls = trace.count_before(STEP_PIN, false, e.cycle);
+                CHECK(falls == k * ratio, "%s: trigger %zu after %zu STEP falls, expected %zu",
+                      name, k, falls, (size_t)(k * ratio));
+
+                // lag from the counted STEP fall to the trigger edge
+                const std::vector<sim::Edge>& se = trace.edges(STEP_PIN);
+                for (size_t j = se.size(); j-- > 0;) {
+                    if (!se[j].level && se[j].cycle < e.cycle) {
+                        if (e.cycle - se[j].cycle > worst_lag) worst_lag = e.cycle - se[j].cycle;
+                        break;
+                    }
+                }
+            }
+            ++k;
+        }
+        CHECK(k == expect, "%s: %zu trigger pulses, expected %u", name, k, expect);
+    }
+    r.disarm();
+    print_stats("TRIGGER (last)", TRIGGER_PIN);
+    std::printf("  worst STEP fall -> TRIGGER rise %llu cycles\n", (unsigned long long)worst_lag);
+}
+
+int group_radar() {
+    // position register on the motor's own PIO: init claims sm0 before
+    // the counter looks for a free SM, so the counter lands elsewhere
+    static PS100_P motor(axis_config(MotorExecVariant::Exec, pio0));
+    CHECK(!pio_sm_is_claimed(pio0, 0), "sm0 claimed before init");
+    CHECK(motor.init(), "init");
+    CHECK(pio_sm_is_claimed(pio0, 0) && motor.has_position(), "init: sm0 / position register");
+    motor.enable();
+
+    RadarSync::Config rcfg{};
+    rcfg.step_pin    = STEP_PIN;
+    rcfg.trigger_pin = TRIGGER_PIN;
+    rcfg.pio         = pio1;
+    rcfg.sm          = 0;
+    pio_sm_claim(rcfg.pio, 0);   // Dual: counter sm0 + pulse sm1
+    pio_sm_claim(rcfg.pio, 1);
+
+    rcfg.mode           = RadarSync::Mode::Single;
+    rcfg.program_offset = (uint)radar_sync_ensure_program(rcfg.pio, rcfg.mode);
+    static RadarSync single(rcfg);
+    CHECK(single.init(), "radar Single init");
+    radar_case(motor, single, "Single");
+    single.deinit();
+
+    rcfg.mode           = RadarSync::Mode::Dual;
+    rcfg.program_offset = (uint)radar_sync_ensure_program(rcfg.pio, rcfg.mode);
+    static RadarSync dual(rcfg);
+    CHECK(dual.init(), "radar Dual init");
+    radar_case(motor, dual, "Dual");
+    dual.deinit();
+    return 0;
+}
+
+// ============================================================
+// group "variant": one forked run per program variant, the whole
+// pio0 for it, position register on pio1
+// ============================================================
+
+int group_variant(MotorExecVariant v) {
+    const MotorExecProgram* prog = motor_exec_variant_program(v);
+    std::printf("variant %s\n", prog->name);
+
+    static PS100_P::Config cfg = axis_config(v, pio1);
+    cfg.pulse_high_us = 4;
+    cfg.dir_setup_us  = 8;   // not the default: the loops follow the Config
+    static PS100_P motor(cfg);
+    CHECK(motor.init(), "%s init", prog->name);
+    motor.enable();
+
+    const bool     has_dir   = (prog->caps & MOTOR_EXEC_CAP_DIR) != 0;
+    const uint64_t min_setup = (uint64_t)cfg.dir_setup_us * sim::cycles_per_us();
+    uint64_t setup = ~0ull;
+
+    for (int i = 0; i < 40; ++i) {
+        MotorExecMove mv[6];
+        const size_t n       = rnd_range(1, 6);
+        const bool   forward = rnd() & 1;
+        uint64_t total = 0, est = 0;
+
+        for (size_t k = 0; k < n; ++k) {
+            mv[k].hz      = (uint32_t)rnd_log(500.0f, 50000.0f);
+            mv[k].steps   = rnd_range(prog->min_steps ? prog->min_steps : 1, 500);
+            mv[k].forward = has_dir ? (rnd() & 1) : forward;
+            total += mv[k].steps;
+            est   += duration_us(mv[k].steps, mv[k].hz);
+        }
+        if (!has_dir) motor.set_direction(forward);
+
+        const int32_t p0 = motor.position();
+        trace.clear();
+        CHECK(motor.run_pio_moves(mv, n), "%s: run_pio_moves", prog->name);
+        CHECK(run_to_idle(motor, est * 2 + 10000), "%s: timeout", prog->name);
+        check_motion(prog->name, motor, total, p0, false);
+
+        const uint64_t s = trace.min_dir_setup(STEP_PIN, DIR_PIN);
+        if (s < setup) setup = s;
+        CHECK(s > 0, "%s: DIR changes on a STEP rising edge", prog->name);
+        // DIR in the stream: every round waits dir_setup_us before its first edge
+        CHECK(!has_dir || s == ~0ull || s >= min_setup,
+              "%s: DIR -> STEP setup %llu cycles, want >= %llu", prog->name,
+              (unsigned long long)s, (unsigned long long)min_setup);
+
+        if (prog->caps & MOTOR_EXEC_CAP_PULSE_WIDTH) {
+            const sim::PinStats st = trace.stats(STEP_PIN);
+            const uint64_t want = 4ull * sim::cycles_per_us();
+            CHECK(st.min_high + sim::cycles_per_us() / 2 >= want && st.max_high <= want + sim::cycles_per_us() / 2,
+                  "%s: STEP high %llu..%llu cycles, want %llu", prog->name,
+                  (unsigned long long)st.min_high, (unsigned long long)st.max_high,
+                  (unsigned long long)want);
+        }
+    }
+    print_stats(prog->name, STEP_PIN);
+    if (setup != ~0ull) std::printf("  min DIR setup %llu cycles\n", (unsigned long long)setup);
+
+    // unload (step_bench cycles the variants through one PIO): the
+    // space is given back, the next load lands at the same offset
+    const int off = pio_res_program(pio1, prog->program);
+    CHECK(off >= 0, "%s: no room on pio1", prog->name);
+    CHECK(pio_res_program_unload(pio1, prog->program) &&
+          !pio_res_program_loaded(pio1, prog->program) &&
+          !pio_res_program_unload(pio1, prog->program), "%s: unload", prog->name);
+    CHECK(pio_res_program(pio1, prog->program) == off, "%s: reload not at %d", prog->name, off);
+    return 0;
+}
+
+// ============================================================
+// group "firmware": AxisQueue as servo_fw drives it (poll loop),
+//   segment IDs / credits against the STEP pad, telemetry frame
+// ============================================================
+
+// rising STEP edges so far, incremental over the edge list
+struct PadCounter {
+    size_t   next  = 0;
+    uint64_t count = 0;
+
+    uint64_t update() {
+        const std::vector<sim::Edge>& e = trace.edges(STEP_PIN);
+        for (; next < e.size(); ++next) count += e[next].level ? 1u : 0u;
+        return count;
+    }
+};
+
+void firmware_ids(AxisQueue& q, PS100_P& m) {
+    std::printf("segment IDs\n");
+
+    for (int run = 0; run < 12; ++run) {
+        const int32_t  p0   = m.position();
+        const uint32_t base = q.head();
+        trace.clear();
+
+        // cumulative pad steps at the end of each segment
+        uint64_t end[AxisQueue::DEPTH];
+        uint64_t total = 0, est = 0;
+        bool     fwd   = rnd() & 1;
+
+        const uint32_t n = rnd_range(2, 12);
+        for (uint32_t k = 0; k < n; ++k) {
+            if ((rnd() & 3) == 0) fwd = !fwd;   // new direction run inside the batch
+            AxisQueue::Segment seg{};
+            seg.hz      = rnd_range(2000, 40000);
+            seg.steps   = rnd_range(5, 300);
+            seg.forward = fwd;
+            CHECK(q.head() < q.credit_limit(), "ids: no credit with %u queued", (unsigned)q.queued());
+            CHECK(q.push(seg), "ids: push");
+            total += seg.steps;
+            end[k] = total;
+            est   += duration_us(seg.steps, seg.hz);
+        }
+
+        PadCounter pads;
+        uint32_t   last = base;
+        unsigned   bad  = 0;
+        const bool ok = sim::run_until_true([&] {
+            q.poll();
+            const uint32_t d = q.done();
+            const uint64_t p = pads.update();
+
+            // everything before d is out, d itself is not finished yet
+            if (d < last || d - base > n) ++bad;
+            else if (d != base && p < end[d - base - 1]) ++bad;
+            else if (d - base < n && p > end[d - base]) ++bad;
+            last = d;
+            return d == q.head() && !q.running();
+        }, (est * 2 + 100000) * sim::cycles_per_us(), 20 * sim::cycles_per_us());
+
+        CHECK(ok, "ids: timeout");
+        CHECK(bad == 0, "ids: %u samples with done() off the STEP pad", bad);
+        CHECK(pads.update() == total, "ids: %llu pulses, expected %llu",
+              (unsigned long long)pads.update(), (unsigned long long)total);
+        CHECK((int64_t)(m.position() - p0) == trace.position(STEP_PIN, DIR_PIN), "ids: position");
+    }
+}
+
+void firmware_credits(AxisQueue& q, PS100_P& m) {
+    std::printf("credits / stop\n");
+
+    // idle queue: exactly DEPTH credits
+    AxisQueue::Segment seg{};
+    seg.hz      = 20000;
+    seg.steps   = 40;
+    seg.forward = true;
+
+    const uint32_t base = q.head();
+    CHECK(q.credit_limit() - base == AxisQueue::DEPTH, "credits: %u on an idle queue",
+          (unsigned)(q.credit_limit() - base));
+    for (size_t k = 0; k < AxisQueue::DEPTH; ++k) CHECK(q.push(seg), "credits: push %u", (unsigned)k);
+    CHECK(q.head() == q.credit_limit() && !q.push(seg), "credits: push beyond the limit accepted");
+
+    // credits come back while the ring copies blocks
+    q.poll();
+    sim::run_until_true([&] { q.poll(); return q.credit_limit() - q.head() >= 8; },
+                        100000 * sim::cycles_per_us(), 20 * sim::cycles_per_us());
+    CHECK(q.credit_limit() - q.head() >= 8, "credits: none returned while running");
+
+    // stop: everything queued is dropped, done() jumps to head()
+    q.flush_stop();
+    CHECK(q.done() == q.head() && q.queued() == 0, "stop: done %u head %u",
+          (unsigned)q.done(), (unsigned)q.head());
+    CHECK(q.credit_limit() - q.head() == AxisQueue::DEPTH, "stop: credits not restored");
+    sim::run_us(1000);
+    CHECK(!trace.stats(STEP_PIN).level && !m.busy(), "stop: axis still moving");
+}
+
+// run the main loop's poll() for `us` of simulated time
+void firmware_poll_us(AxisQueue& q, uint64_t us) {
+    sim::run_until_true([&] { q.poll(); return false; },
+                        us * sim::cycles_per_us(), 20 * sim::cycles_per_us());
+}
+
+// segments pushed while the previous one is still stepping: the dry
+// ring is re-linked by poll(), no drain + restart between them
+void firmware_late(AxisQueue& q, PS100_P& m) {
+    std::printf("pushed late\n");
+
+    for (int run = 0; run < 40; ++run) {
+        const int32_t p0 = m.position();
+        trace.clear();
+
+        AxisQueue::Segment seg{};
+        seg.hz      = rnd_range(2000, 40000);
+        seg.steps   = rnd_range(20, 300);
+        seg.forward = rnd() & 1;
+        CHECK(q.push(seg), "late: first push");
+
+        uint32_t min_hz = seg.hz, fast = seg.hz;
+        uint64_t total  = seg.steps;
+        const int segs = rnd_range(1, 3);
+        for (int k = 0; k < segs; ++k) {
+            // somewhere inside the last segment, not at its very end
+            firmware_poll_us(q, rnd() % (duration_us(seg.steps, fast) * 9 / 10 + 1) + 1);
+            CHECK(q.running() && q.done() != q.head(), "late: axis idle before segment %d", k);
+
+            const uint32_t prev = seg.hz;
+            seg.hz    = rnd_range(2000, 40000);
+            seg.steps = rnd_range(20, 300);
+            CHECK(q.push(seg), "late: push %d", k);
+            total += seg.steps;
+            fast = seg.hz > prev ? seg.hz : prev;
+            if (seg.hz < min_hz) min_hz = seg.hz;
+        }
+
+        const bool ok = sim::run_until_true([&] {
+            q.poll();
+            return q.done() == q.head() && !q.running();
+        }, (duration_us(total, min_hz) * 2 + 100000) * sim::cycles_per_us(), 20 * sim::cycles_per_us());
+        CHECK(ok, "late: timeout");
+        check_motion("pushed late", m, total, p0, false);
+        check_queue_gap("pushed late", min_hz);
+    }
+    print_stats("pushed late (last)", STEP_PIN);
+
+    // after a drain to standstill the blend starts from rest, not from
+    // the speed of the segment before it
+    std::printf("blend from rest\n");
+    {
+        AxisQueue::Segment seg{};
+        seg.hz      = 100000;
+        seg.steps   = 200;
+        seg.forward = true;
+        CHECK(q.push(seg), "rest: push fast");
+        const bool ok = sim::run_until_true([&] {
+            q.poll();
+            return q.done() == q.head() && !q.running();
+        }, 100000 * sim::cycles_per_us(), 20 * sim::cycles_per_us());
+        CHECK(ok, "rest: timeout");
+
+        trace.clear();
+        seg.hz    = 5000;
+        seg.steps = 50;
+        CHECK(q.push(seg), "rest: push slow");
+        sim::run_until_true([&] {
+            q.poll();
+            return q.done() == q.head() && !q.running();
+        }, 100000 * sim::cycles_per_us(), 20 * sim::cycles_per_us());
+
+        const sim::PinStats s = trace.stats(STEP_PIN);
+        const uint64_t limit  = sim::f_sys() / seg.hz - sim::cycles_per_us();
+        CHECK(s.rising == seg.steps, "rest: %llu pulses", (unsigned long long)s.rising);
+        CHECK(s.min_period >= limit, "rest: period %llu cycles, faster than %u Hz",
+              (unsigned long long)s.min_period, seg.hz);
+    }
+}
+
+void firmware_telemetry() {
+    std::printf("telemetry frame\n");
+
+    FwAxisTelemetry axes[2] = {
+        { -123456, 70000, 70003, 70030 },
+        { 42,      5,     400,   37 },
+    };
+    uint8_t out[FW_TELEMETRY_HEADER + 2 * FW_TELEMETRY_AXIS];
+    CHECK(fw_encode_telemetry(9, 0xA1B2C3D4u, axes, 2, out, sizeof(out) - 1) == 0, "telemetry: overflow");
+    const size_t n = fw_encode_telemetry(9, 0xA1B2C3D4u, axes, 2, out, sizeof(out));
+
+    static const uint8_t expect[] = {
+        0xFB, 9, 2, 0xD4, 0xC3, 0xB2, 0xA1,
+        0xC0, 0x1D, 0xFE, 0xFF, 0x70, 0x11, 3,   0x8E, 0x11,
+        0x2A, 0x00, 0x00, 0x00, 0x05, 0x00, 255, 0x25, 0x00,
+    };
+    CHECK(n == sizeof(expect) && std::memcmp(out, expect, n) == 0, "telemetry: encoding");
+}
+
+// UsbTxBatch against a byte-exact host: full packets only, the tail
+// after USB_BATCH_FLUSH_US / flush(), whole frames dropped when full
+void firmware_usb_batch() {
+    std::printf("usb batch\n");
+
+    static UsbTxBatch b;
+    static uint8_t sent[64 * 1024], got[64 * 1024];
+    size_t ns = 0, ng = 0;
+    uint64_t now = 0;
+    unsigned short_early = 0;
+
+    auto pump = [&](bool endpoint_ready) {
+        const uint8_t* p;
+        size_t n;
+        while (endpoint_ready && (n = b.next_packet(p, now)) != 0) {
+            if (n < USB_BATCH_PACKET && b.pending() >= USB_BATCH_PACKET) ++short_early;
+            std::memcpy(got + ng, p, n);
+            ng += n;
+            b.consume(n);
+        }
+    };
+
+    // telemetry-sized frames at 4 kHz, endpoint busy now and then
+    for (int i = 0; i < 1500; ++i) {
+        uint8_t f[25];
+        for (uint8_t& c : f) c = (uint8_t)rnd();
+        CHECK(b.write(f, sizeof(f), now), "batch: frame %d dropped", i);
+        std::memcpy(sent + ns, f, sizeof(f));
+        ns += sizeof(f);
+        now += 250;
+        pump((rnd() & 3) != 0);
+    }
+    CHECK(b.partial() == 0, "batch: %u short packets at 4 kHz", b.partial());
+    CHECK(b.pending() < USB_BATCH_PACKET, "batch: %u bytes left behind", (unsigned)b.pending());
+
+    // a lone frame waits for its deadline, or goes now on flush()
+    b.flush();
+    pump(true);
+    const uint32_t short0 = b.partial();
+    const uint8_t  lone[10] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+    b.write(lone, sizeof(lone), now);
+    std::memcpy(sent + ns, lone, sizeof(lone));
+    ns += sizeof(lone);
+    now += USB_BATCH_FLUSH_US - 1;
+    pump(true);
+    CHECK(b.pending() == sizeof(lone), "batch: tail sent before the deadline");
+    now += 1;
+    pump(true);
+    CHECK(b.pending() == 0 && b.partial() == short0 + 1, "batch: tail not sent at the deadline");
+
+    const uint8_t reply[4] = { 0xFA, 0, 31, 31 };
+    b.write(reply, sizeof(reply), now);
+    std::memcpy(sent + ns, reply, sizeof(reply));
+    ns += sizeof(reply);
+    pump(true);
+    CHECK(b.pending() == sizeof(reply), "batch: reply sent without flush");
+    b.flush();
+    pump(true);
+    CHECK(b.pending() == 0, "batch: flush() ignored");
+
+    // phase shifted by the short packets: packets now wrap around the ring
+    for (int i = 0; i < 400; ++i) {
+        uint8_t f[37];
+        for (uint8_t& c : f) c = (uint8_t)rnd();
+        b.write(f, sizeof(f), now);
+        std::memcpy(sent + ns, f, sizeof(f));
+        ns += sizeof(f);
+        now += 10;
+        pump((rnd() & 7) == 0);
+    }
+    b.flush();
+    pump(true);
+    CHECK(ns == ng && std::memcmp(sent, got, ns) == 0, "batch: byte stream differs (%u / %u bytes)",
+          (unsigned)ng, (unsigned)ns);
+    CHECK(short_early == 0, "batch: %u short packets with a full one pending", short_early);
+
+    // full: whole frames dropped and counted, nothing partial queued
+    uint8_t big[300] = {};
+    unsigned ok = 0;
+    for (int i = 0; i < 10; ++i) ok += b.write(big, sizeof(big), now) ? 1u : 0u;
+    CHECK(ok == USB_BATCH_CAPACITY / sizeof(big) && b.dropped() == 10 - ok &&
+          b.pending() == ok * sizeof(big), "batch: %u accepted, %u dropped, %u pending",
+          ok, b.dropped(), (unsigned)b.pending());
+    b.clear();
+    CHECK(b.pending() == 0 && b.space() == USB_BATCH_CAPACITY, "batch: clear");
+    std::printf("  %u full packets, %u short, %u dropped\n", b.packets(), b.partial(), b.dropped());
+}
+
+int group_firmware() {
+    static PS100_P motor(axis_config(MotorExecVariant::Exec, pio1));
+    CHECK(motor.init(), "init");
+    motor.enable();
+
+    AxisQueue::Config qc{};
+    qc.motor = &motor;
+    qc.a_max = 200000;
+    static AxisQueue queue(qc);
+
+    firmware_ids(queue, motor);
+    firmware_credits(queue, motor);
+    firmware_late(queue, motor);
+    firmware_telemetry();
+    firmware_usb_batch();
+    return 0;
+}
+
+// ============================================================
+// group "cache": ce_config_to_pio_cached() streams on the Exec axis
+// ============================================================
+
+// run one cached move to idle, checked on the pads
+void cache_run(PS100_P& m, StreamBuffer h, uint32_t v_max, uint32_t steps, const char* what) {
+    const int32_t p0 = m.position();
+    trace.clear();
+    m.run_pio_stream(std::move(h), 0);
+    CHECK(run_to_idle(m, duration_us(steps, v_max) * 4 + 100000), "%s: timeout", what);
+    check_motion(what, m, steps, p0, true);
+}
+
+void cache_hits(PS100_P& m) {
+    std::printf("hit / miss\n");
+    const size_t free0 = stream_pool_free_blocks();
+
+    // raster: the same two lines back and forth
+    const uint32_t LINE[2][3] = { { 40000, 3000, 400 }, { 20000, 777, 100 } };
+    const uint32_t* first = nullptr;
+    for (int i = 0; i < 8; ++i) {
+        const uint32_t* l = LINE[i & 1];
+        StreamBuffer h = ce_config_to_pio_cached(l[0], l[1], l[2]);
+        CHECK((bool)h, "hit: no stream");
+        if (i == 0) first = h.data();
+        if (i == 2) CHECK(h.data() == first, "hit: line replanned into another block");
+        m.set_direction(i & 1);
+        cache_run(m, std::move(h), l[0], l[1], "cached line");
+    }
+
+    ProfileCacheStats st = profile_cache_stats();
+    CHECK(st.misses == 2 && st.hits == 6, "hit: %u misses, %u hits", st.misses, st.hits);
+    CHECK(stream_pool_free_blocks() == free0 - 2, "hit: %u blocks free, expected %u",
+          (unsigned)stream_pool_free_blocks(), (unsigned)(free0 - 2));
+
+    // another timing model (clock divider) is another key
+    StreamBuffer slow = ce_config_to_pio_cached(40000, 3000, 400, motor_exec_timing_for(2.0f));
+    CHECK(slow && slow.data() != first, "key: timing model ignored");
+    StreamBuffer packed = ce_config_to_pio_cached(40000, 3000, 400, motor_exec_timing(),
+                                                  MotorExecFormat::Packed);
+    CHECK(packed && packed.data() != first, "key: format ignored");
+    slow.reset();
+    packed.reset();
+
+    profile_cache_clear();
+    CHECK(stream_pool_free_blocks() == free0, "clear: blocks not returned");
+}
+
+void cache_lru(PS100_P& m) {
+    std::printf("LRU / pinning\n");
+    const size_t   free0 = stream_pool_free_blocks();
+    const uint32_t e0    = profile_cache_stats().evictions;
+
+    // PROFILE_CACHE_ENTRIES + 1 keys, key 0 touched again before the overflow
+    for (uint32_t k = 0; k < PROFILE_CACHE_ENTRIES; ++k) ce_config_to_pio_cached(10000, 100 + k, 20);
+    ce_config_to_pio_cached(10000, 100, 20);
+    ce_config_to_pio_cached(10000, 999, 20);   // evicts key 1
+
+    ProfileCacheStats st = profile_cache_stats();
+    CHECK(st.entries == PROFILE_CACHE_ENTRIES && st.evictions - e0 == 1,
+          "lru: %u entries, %u evictions", (unsigned)st.entries, st.evictions - e0);
+    const uint32_t h0 = st.hits;
+    ce_config_to_pio_cached(10000, 100, 20);
+    CHECK(profile_cache_stats().hits == h0 + 1, "lru: recently used entry evicted");
+    ce_config_to_pio_cached(10000, 101, 20);
+    CHECK(profile_cache_stats().hits == h0 + 1, "lru: oldest entry kept");
+
+    // cleared while streaming: the driver's reference keeps the block
+    profile_cache_clear();
+    StreamBuffer h = ce_config_to_pio_cached(5000, 2000, 300);
+    const size_t free_busy = stream_pool_free_blocks();
+    const int32_t p0 = m.position();
+    trace.clear();
+    m.run_pio_stream(std::move(h), 0);
+    sim::run_us(50000);
+    profile_cache_clear();
+    CHECK(m.busy() && stream_pool_free_blocks() == free_busy,
+          "pin: block freed under a running stream");
+    CHECK(run_to_idle(m, 2000000), "pin: timeout");
+    check_motion("pinned stream", m, 2000, p0, true);
+    CHECK(stream_pool_free_blocks() == free0, "pin: %u blocks free after the run, expected %u",
+          (unsigned)stream_pool_free_blocks(), (unsigned)free0);
+
+    // pool exhausted by other users: a miss evicts an idle cached block
+    ce_config_to_pio_cached(10000, 300, 20);
+    StreamBuffer hold[STREAM_POOL_BLOCKS];
+    size_t held = 0;
+    while (held < STREAM_POOL_BLOCKS && (hold[held] = StreamBuffer::acquire(16))) ++held;
+    StreamBuffer again = ce_config_to_pio_cached(10000, 301, 20);
+    CHECK((bool)again, "pool full: no idle block evicted");
+    CHECK(profile_cache_stats().entries == 1, "pool full: %u entries",
+          (unsigned)profile_cache_stats().entries);
+    again.reset();
+    for (size_t i = 0; i < held; ++i) hold[i].reset();
+    profile_cache_clear();
+    CHECK(stream_pool_free_blocks() == free0, "pool full: blocks leaked");
+}
+
+int group_cache() {
+    static PS100_P motor(axis_config(MotorExecVariant::Exec, pio1));
+    CHECK(motor.init(), "init");
+    motor.enable();
+
+    cache_hits(motor);
+    cache_lru(motor);
+    return 0;
+}
+
+// ============================================================
+// group "traj_lib": library image built for the Exec axis, played
+// straight from the image (DMA) and through the staging ring
+// ============================================================
+
+constexpr size_t LIB_WORDS = 8192;
+
+static uint32_t       lib_image[LIB_WORDS];    // "flash": DMA reads it directly
+static uint32_t       lib_copy[LIB_WORDS];     // corrupted / mismatched images
+static TrajLibPlayer  lib_player;
+
+struct LibLine {
+    const char*     name;
+    uint32_t        v_max, steps, ramp;
+    MotorExecFormat fmt;
+};
+
+// "fast": short ramp => ~10 us commands, Auto stages it
+const LibLine LIB_LINES[] = {
+    { "line_a", 40000,  3000, 400, MotorExecFormat::Raw },
+    { "line_b", 20000,  777,  100, MotorExecFormat::Packed },
+    { "fast",   200000, 4000, 40,  MotorExecFormat::Raw },
+};
+
+const MotorExecMove LIB_JOG[] = { { 2000, 50, true }, { 8000, 300, true }, { 500, 5, true } };
+
+void traj_lib_play(PS100_P& m, const TrajLib& lib, const TrajLibEntry& e,
+                   TrajLibMode mode, const char* what) {
+    const int32_t p0 = m.position();
+    trace.clear();
+    CHECK(traj_lib_run(m, lib, e, lib_player, mode), "%s: traj_lib_run", what);
+    CHECK(run_to_idle(m, (uint64_t)e.duration_us * 2 + 100000), "%s: timeout", what);
+    check_motion(what, m, e.steps, p0, true);
+    if (mode == TrajLibMode::Staged) {
+        CHECK(lib_player.left == 0, "%s: %u words not staged", what, (unsigned)lib_player.left);
+        CHECK(!m.last_ring_underrun(), "%s: ring underrun", what);
+    }
+}
+
+int group_traj_lib() {
+    static PS100_P motor(axis_config(MotorExecVariant::Exec, pio1));
+    CHECK(motor.init(), "init");
+    motor.enable();
+
+    // ---------- build ----------
+    std::printf("build / open\n");
+    static TrajLibBuilder b(lib_image, LIB_WORDS, MotorExecVariant::Exec, motor.timing());
+    for (const LibLine& l : LIB_LINES) {
+        CHECK(b.add_scurve(l.name, l.v_max, l.steps, l.ramp, l.fmt), "build %s: %s",
+              l.name, b.error());
+    }
+    CHECK(b.add_moves("jog", LIB_JOG, 3), "build jog: %s", b.error());
+    CHECK(!b.add_scurve("jog", 1000, 10, 2), "build: duplicate name accepted");
+    const size_t bytes = b.finish();
+    CHECK(bytes > 0, "finish: %s", b.error());
+
+    TrajLib lib;
+    CHECK(traj_lib_open(lib_image, bytes, lib), "open");
+    CHECK(lib.count() == 4, "open: %u entries", (unsigned)lib.count());
+    CHECK(traj_lib_compatible(lib, motor), "open: axis not compatible");
+    CHECK(!traj_lib_find(lib, "missing"), "find: unknown name found");
+
+    // ---------- same words as the run-time planner ----------
+    for (const LibLine& l : LIB_LINES) {
+        const TrajLibEntry* e = traj_lib_find(lib, l.name);
+        CHECK(e && e->steps == l.steps, "find %s", l.name);
+        if (!e) continue;
+
+        StreamBuffer ref = ce_config_to_pio(l.v_max, l.steps, l.ramp, motor.timing(), l.fmt);
+        CHECK(ref && ref.size() == e->words &&
+              std::memcmp(ref.data(), traj_lib_words(lib, *e), e->words * 4) == 0,
+              "%s: words differ from ce_config_to_pio", l.name);
+    }
+    const TrajLibEntry* fast = traj_lib_find(lib, "fast");
+    const TrajLibEntry* slow = traj_lib_find(lib, "line_a");
+    CHECK(fast && traj_lib_auto_mode(motor, *fast) == TrajLibMode::Staged,
+          "auto: fast entry (%u us commands) not staged", fast ? fast->min_cmd_us : 0);
+    CHECK(slow && traj_lib_auto_mode(motor, *slow) == TrajLibMode::Direct,
+          "auto: slow entry (%u us commands) staged", slow ? slow->min_cmd_us : 0);
+
+    // ---------- playback ----------
+    std::printf("playback\n");
+    for (size_t i = 0; i < lib.count(); ++i) {
+        const TrajLibEntry& e = lib.dir[i];
+        motor.set_direction(i & 1);
+        traj_lib_play(motor, lib, e, TrajLibMode::Direct, "direct");
+        motor.set_direction(!(i & 1));
+        traj_lib_play(motor, lib, e, TrajLibMode::Staged, "staged");
+    }
+    print_stats("staged jog", STEP_PIN);
+
+    // ---------- rejected images ----------
+    std::printf("reject\n");
+    TrajLib bad;
+    std::memcpy(lib_copy, lib_image, bytes);
+    lib_copy[bytes / 4 - 3] ^= 1u << 7;
+    CHECK(!traj_lib_open(lib_copy, bytes, bad), "crc: corrupted image opened");
+    CHECK(traj_lib_open(lib_copy, bytes, bad, false), "crc: unverified open failed");
+    CHECK(!traj_lib_open(lib_image, bytes - 4, bad), "size: truncated image opened");
+    lib_copy[0] = 0xFFFFFFFFu;   // erased flash
+    CHECK(!traj_lib_open(lib_copy, bytes, bad, false), "magic: erased flash opened");
+
+    // another timing model (clock divider 2) / another variant: refused
+    const TrajLibEntry& e0 = lib.dir[0];
+    static TrajLibBuilder div2(lib_copy, LIB_WORDS, MotorExecVariant::Exec,
+                               motor_exec_timing_for(2.0f));
+    div2.add_scurve("line_a", 40000, 3000, 400);
+    CHECK(div2.finish() && traj_lib_open(lib_copy, LIB_WORDS * 4, bad), "timing: open");
+    CHECK(!bad.header || (!traj_lib_compatible(bad, motor) &&
+                          !traj_lib_run(motor, bad, bad.dir[0], lib_player)),
+          "timing: clk_div 2 image accepted");
+
+    static TrajLibBuilder step_only(lib_copy, LIB_WORDS, MotorExecVariant::StepOnly,
+                                    make_pio_timing(MotorExecVariant::StepOnly, sim::f_sys()));
+    CHECK(!step_only.add_scurve("line_a", 40000, 3000, 400), "variant: scurve for step_only");
+    CHECK(step_only.add_moves("jog", LIB_JOG, 3), "variant: step_only jog: %s", step_only.error());
+    CHECK(step_only.finish() && traj_lib_open(lib_copy, LIB_WORDS * 4, bad), "variant: open");
+    CHECK(!bad.header || !traj_lib_run(motor, bad, bad.dir[0], lib_player),
+          "variant: step_only image accepted");
+    CHECK(!motor.busy(), "reject: axis started");
+
+    // the good image is still usable after the rejects
+    traj_lib_play(motor, lib, e0, TrajLibMode::Auto, "auto");
+    return 0;
+}
+
+// ============================================================
+// group "units": Q16.16 axis units (electronic gear 32767 / rev,
+//   5 mm per rev, 1500 rpm) against double references, then moves
+//   given in mm checked on the pads
+// ============================================================
+
+constexpr uint32_t UNITS_PPR  = 32767;
+constexpr double   UNITS_LEAD = 5.0;
+constexpr uint32_t UNITS_RPM  = 1500;
+
+void units_scale(const AxisScale& s) {
+    std::printf("scale\n");
+    const double spm = UNITS_PPR / UNITS_LEAD;
+
+    CHECK(__builtin_llabs((int64_t)s.steps_per_mm - __builtin_llround(spm * 65536.0)) <= 1,
+          "steps_per_mm %u", s.steps_per_mm);
+    CHECK(s.max_hz == UNITS_RPM * UNITS_PPR / 60u, "max_hz %u", s.max_hz);
+
+    for (int i = 0; i < 2000; ++i) {
+        const q16_16 mm = (q16_16)(rnd() % (q16(300.0) * 2u + 1u)) - q16(300.0);
+        const double ref = (double)mm / 65536.0 * spm;
+        CHECK(__builtin_llabs(s.mm_to_steps(mm) - __builtin_llround(ref)) <= 1,
+              "mm_to_steps(%d): %d, expected %.1f", mm, s.mm_to_steps(mm), ref);
+
+        const double back = (double)s.steps_to_mm((int32_t)__builtin_llround(ref)) / 65536.0;
+        CHECK(__builtin_fabs(back - (double)__builtin_llround(ref) / spm) <= 1.0 / 65536.0,
+              "steps_to_mm(%lld): %.6f", __builtin_llround(ref), back);
+
+        const q16_16 v   = (q16_16)rnd_range(1, q16(120.0));
+        const double hz  = (double)v / 65536.0 * spm;
+        const double lim = hz < s.max_hz ? hz : (double)s.max_hz;
+        CHECK(__builtin_fabs((double)s.mm_s_to_hz(v) - lim) <= 1.0,
+              "mm_s_to_hz(%d): %u, expected %.1f", v, s.mm_s_to_hz(v), lim);
+    }
+
+    // clamp, gear, sign handling
+    CHECK(s.mm_s_to_hz(q16(1000.0)) == s.max_hz, "mm_s_to_hz: no clamp");
+    CHECK(s.mm_s_to_hz(-q16(10.0)) == s.mm_s_to_hz(q16(10.0)), "mm_s_to_hz: sign");
+    CHECK(__builtin_llabs((int64_t)s.rpm_to_hz(q16(1500.0)) - 819175) <= 1,
+          "rpm_to_hz(1500): %u", s.rpm_to_hz(q16(1500.0)));
+    CHECK(s.rpm_to_hz(q16(60.0)) == UNITS_PPR, "rpm_to_hz(60): %u", s.rpm_to_hz(q16(60.0)));
+    CHECK(s.rpm_to_hz(-q16(60.0)) == 0, "rpm_to_hz: negative");
+    CHECK(__builtin_llabs((int64_t)s.mm_s2_to_steps_s2(q16(500.0)) - __builtin_llround(500.0 * spm)) <= 1,
+          "mm_s2_to_steps_s2: %u", s.mm_s2_to_steps_s2(q16(500.0)));
+
+    // steps_per_mm given directly wins over the gear
+    AxisUnits direct{};
+    direct.steps_per_mm   = q16(80.0);
+    direct.pulses_per_rev = UNITS_PPR;
+    direct.mm_per_rev     = q16(UNITS_LEAD);
+    CHECK(make_axis_scale(direct).mm_to_steps(q16(2.5)) == 200, "direct steps_per_mm");
+}
+
+int group_units() {
+    static PS100_P::Config cfg = axis_config(MotorExecVariant::Exec, pio1);
+    cfg.units.pulses_per_rev = UNITS_PPR;
+    cfg.units.mm_per_rev     = q16(UNITS_LEAD);
+    cfg.units.max_rpm        = UNITS_RPM;
+
+    static PS100_P motor(cfg);
+    CHECK(motor.init(), "init");
+    motor.enable();
+    CHECK(motor.has_units(), "no units");
+
+    units_scale(motor.scale());
+
+    std::printf("move_mm\n");
+    const int32_t home = motor.position();
+    static const q16_16 MOVES[] = { q16(2.0), -q16(2.0), q16(0.37), -q16(0.37) };
+    for (q16_16 mm : MOVES) {
+        const int32_t  p0    = motor.position();
+        const int32_t  steps = motor.scale().mm_to_steps(mm);
+        const uint32_t hz    = motor.scale().mm_s_to_hz(q16(50.0));
+        trace.clear();
+
+        CHECK(motor.move_mm(mm, q16(50.0), PS100_P::Backend::PIO), "move_mm refused");
+        CHECK(run_to_idle(motor, duration_us((uint64_t)__builtin_abs(steps), hz) * 2 + 10000),
+              "move_mm: timeout");
+        check_motion("move_mm", motor, (uint64_t)__builtin_abs(steps), p0, true);
+        CHECK(motor.position() - p0 == steps, "move_mm: moved %d, expected %d",
+              (int)(motor.position() - p0), (int)steps);
+    }
+    CHECK(motor.position() == home && motor.position_mm() == motor.scale().steps_to_mm(home),
+          "move_mm: not back home (%d)", (int)motor.position());
+    print_stats("move_mm (last)", STEP_PIN);
+
+    // reversal mid-move: the running command is stopped (its pulse
+    // finished) before DIR changes, no STEP edge under the new DIR
+    // level until the new command starts, dir_setup_us after DIR
+    std::printf("move_mm reversal\n");
+    const uint64_t min_setup = (uint64_t)cfg.dir_setup_us * sim::cycles_per_us();
+    for (int i = 0; i < 40; ++i) {
+        const PS100_P::Backend backend = (i & 1) ? PS100_P::Backend::PWM : PS100_P::Backend::PIO;
+        const char*    what = (i & 1) ? "PWM" : "PIO";
+        const int32_t  p0   = motor.position();
+        const int32_t  back = motor.scale().mm_to_steps(q16(0.5));
+        const uint32_t hz   = motor.scale().mm_s_to_hz(q16(20.0));
+        trace.clear();
+
+        CHECK(motor.move_mm(q16(1.0), q16(20.0), backend), "reversal: first move");
+        sim::run_us(rnd() % (duration_us(motor.scale().mm_to_steps(q16(1.0)), hz) * 8 / 10) + 1);
+        const size_t dirs = trace.edges(DIR_PIN).size();
+        CHECK(motor.move_mm(-q16(0.5), q16(20.0), backend), "reversal: second move");
+        CHECK(run_to_idle(motor, 1000000), "reversal: timeout");
+
+        const std::vector<sim::Edge>& d = trace.edges(DIR_PIN);
+        const std::vector<sim::Edge>& e = trace.edges(STEP_PIN);
+        const uint64_t rising = trace.stats(STEP_PIN).rising;
+        CHECK(d.size() == dirs + 1 && rising > (uint64_t)back, "reversal (%s): %u DIR edges, %llu pulses",
+              what, (unsigned)(d.size() - dirs), (unsigned long long)rising);
+        if (d.size() != dirs + 1 || rising <= (uint64_t)back) continue;
+
+        // first rising edge of the new command: `back` pulses before the end
+        size_t   k = 0;
+        uint64_t r = 0;
+        for (; k < e.size(); ++k) {
+            if (e[k].level && ++r == rising - (uint64_t)back + 1u) break;
+        }
+        const uint64_t t = d[dirs].cycle;
+        CHECK(k == 0 || e[k - 1].cycle <= t, "reversal (%s): STEP edge %llu cycles after the DIR change",
+              what, (unsigned long long)(e[k - 1].cycle - t));
+        CHECK(e[k].cycle >= t + min_setup, "reversal (%s): DIR setup %lld cycles",
+              what, (long long)(e[k].cycle - t));
+        CHECK((int64_t)(motor.position() - p0) == trace.position(STEP_PIN, DIR_PIN),
+              "reversal (%s): position", what);
+        CHECK(motor.position() - p0 == (int32_t)(r - 1u) - back,
+              "reversal (%s): moved %d", what, (int)(motor.position() - p0));
+    }
+    print_stats("move_mm reversal (last)", STEP_PIN);
+
+    std::printf("queue_mm\n");
+    {
+        const int32_t p0    = motor.position();
+        const int32_t steps = 3 * motor.scale().mm_to_steps(q16(1.0));
+        trace.clear();
+
+        CHECK(motor.queue_mm(q16(1.0), q16(20.0)), "queue_mm: first");
+        CHECK(motor.queue_mm(q16(1.0), q16(40.0), q16(500.0)), "queue_mm: blend");
+        CHECK(!motor.queue_mm(-q16(1.0), q16(40.0)), "queue_mm: reversal accepted");
+        CHECK(motor.queue_mm(q16(1.0), q16(10.0), q16(500.0)), "queue_mm: third");
+        CHECK(run_to_idle(motor, 1000000), "queue_mm: timeout");
+        check_motion("queue_mm", motor, (uint64_t)steps, p0, false);
+
+        // idle again: the other direction is taken
+        const int32_t p1 = motor.position();
+        trace.clear();
+        CHECK(motor.queue_mm(-q16(1.0), q16(40.0)), "queue_mm: reverse from idle");
+        CHECK(run_to_idle(motor, 1000000), "queue_mm: timeout");
+        check_motion("queue_mm reverse", motor, (uint64_t)(steps / 3), p1, false);
+        const uint64_t setup = trace.min_dir_setup(STEP_PIN, DIR_PIN);
+        CHECK(trace.edges(DIR_PIN).size() == 1 && setup >= min_setup,
+              "queue_mm: reverse DIR setup %llu cycles", (unsigned long long)setup);
+        CHECK(motor.position() - p1 == -steps / 3, "queue_mm: reverse moved %d",
+              (int)(motor.position() - p1));
+    }
+
+    std::printf("rejects / run_velocity\n");
+    {
+        CHECK(!motor.move_mm(q16(0.00001), q16(50.0)), "move_mm: 0 steps accepted");
+        CHECK(!motor.move_mm(q16(1.0), 0), "move_mm: 0 Hz accepted");
+        CHECK(!motor.busy(), "reject: axis started");
+
+        PS100_P bare(PS100_P::Config{});
+        CHECK(!bare.has_units() && !bare.move_mm(q16(1.0), q16(1.0)) &&
+              !bare.queue_mm(q16(1.0), q16(1.0)) && bare.position_mm() == 0,
+              "no units: move accepted");
+
+        // integer steps = hz * ms / 1000, rounded: 1234 Hz * 77 ms = 95.018
+        CHECK(duration_ms_to_steps(77, 1234) == 95, "duration_ms_to_steps");
+        CHECK(duration_ms_to_steps(0xFFFFFFFFu, 0xFFFFFFFFu) == 0xFFFFFFFFu,
+              "duration_ms_to_steps: saturation");
+
+        const int32_t p0 = motor.position();
+        trace.clear();
+        motor.run_velocity(1234, 77, PS100_P::Backend::PIO);
+        CHECK(run_to_idle(motor, 200000), "run_velocity: timeout");
+        check_motion("run_velocity", motor, 95, p0, true);
+    }
+    return 0;
+}
+
+// ============================================================
+// group "trace": records of a few commands, decoded from the
+//   drain block the firmware sends (not from the ring itself)
+// ============================================================
+
+#if PULSE_MODE_TRACE
+
+struct TraceCheck {
+    unsigned begins[256];
+    unsigned ends[256];
+    unsigned in_irq[256];     // records with exception != 0
+    unsigned exc_bad;         // IRQ events outside their handler
+    unsigned count;
+    uint32_t dropped;
+    bool     ordered;
+};
+
+uint32_t le32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+TraceCheck trace_decode() {
+    static uint8_t block[TRACE_BLOCK_HEADER + PULSE_MODE_TRACE_RING * sizeof(TraceRecord)];
+    const size_t n = trace_encode_block(0, block, sizeof(block));
+
+    TraceCheck c{};
+    c.ordered = true;
+    CHECK(n >= TRACE_BLOCK_HEADER && le32(block) == TRACE_BLOCK_MAGIC &&
+          block[4] == 0 && block[5] == TRACE_BLOCK_VERSION, "trace: block header");
+    if (n < TRACE_BLOCK_HEADER) return c;
+
+    c.count   = (uint32_t)block[6] | ((uint32_t)block[7] << 8);
+    c.dropped = le32(block + 8);
+    CHECK(n == TRACE_BLOCK_HEADER + c.count * sizeof(TraceRecord), "trace: block size %zu", n);
+
+    uint32_t last = 0;
+    for (unsigned i = 0; i < c.count; ++i) {
+        const uint8_t* r   = block + TRACE_BLOCK_HEADER + i * sizeof(TraceRecord);
+        const uint32_t t   = le32(r);
+        const uint8_t  ev  = r[4];
+        const uint8_t  exc = r[5];
+        const uint8_t  id  = ev & (uint8_t)~TRACE_END;
+
+        if (i && t < last) c.ordered = false;
+        last = t;
+
+        if (ev & TRACE_END) c.ends[id]++;
+        else                c.begins[id]++;
+        if (exc) c.in_irq[id]++;
+
+        if (id == (uint8_t)TraceEvent::PwmWrapIrq && exc != 16 + PWM_IRQ_WRAP) c.exc_bad++;
+        if (id == (uint8_t)TraceEvent::PwmDmaIrq && exc != 16 + DMA_IRQ_1) c.exc_bad++;
+    }
+    return c;
+}
+
+inline unsigned begins(const TraceCheck& c, TraceEvent ev) { return c.begins[(uint8_t)ev]; }
+inline unsigned ends(const TraceCheck& c, TraceEvent ev) { return c.ends[(uint8_t)ev]; }
+
+int group_trace() {
+    static PS100_P motor(axis_config(MotorExecVariant::Exec, nullptr));
+    CHECK(motor.init(), "init");
+    motor.enable();
+
+    std::printf("commands\n");
+    trace_clear();
+
+    motor.run_steps(100, 20000, PS100_P::Backend::PIO);
+    CHECK(run_to_idle(motor, 20000), "PIO: timeout");
+
+    pwm_motor_set_count_mode(PwmCountMode::Dma);
+    motor.run_steps(20, 10000, PS100_P::Backend::PWM);
+    CHECK(run_to_idle(motor, 20000), "PWM DMA: timeout");
+
+    pwm_motor_set_count_mode(PwmCountMode::Irq);
+    motor.run_steps(5, 10000, PS100_P::Backend::PWM);
+    CHECK(run_to_idle(motor, 20000), "PWM IRQ: timeout");
+    pwm_motor_set_count_mode(PwmCountMode::Dma);
+
+    motor.run_steps(1000, 10000, PS100_P::Backend::PIO);
+    sim::run_us(5000);
+    motor.stop();
+
+    const TraceCheck c = trace_decode();
+    std::printf("  %u records, %u dropped\n", c.count, c.dropped);
+
+    CHECK(c.ordered, "trace: timestamps not monotonic");
+    CHECK(c.dropped == 0, "trace: %u dropped", c.dropped);
+    CHECK(begins(c, TraceEvent::RunSteps) == 4 && ends(c, TraceEvent::RunSteps) == 4,
+          "trace: RunSteps %u / %u", begins(c, TraceEvent::RunSteps), ends(c, TraceEvent::RunSteps));
+    CHECK(begins(c, TraceEvent::PwmRun) == 2, "trace: PwmRun %u", begins(c, TraceEvent::PwmRun));
+    CHECK(begins(c, TraceEvent::PwmDmaArm) == 1, "trace: PwmDmaArm %u", begins(c, TraceEvent::PwmDmaArm));
+    CHECK(begins(c, TraceEvent::PwmDmaIrq) == 1 && ends(c, TraceEvent::PwmDmaIrq) == 1,
+          "trace: PwmDmaIrq %u / %u", begins(c, TraceEvent::PwmDmaIrq), ends(c, TraceEvent::PwmDmaIrq));
+    CHECK(begins(c, TraceEvent::PwmWrapIrq) >= 5, "trace: PwmWrapIrq %u", begins(c, TraceEvent::PwmWrapIrq));
+    CHECK(begins(c, TraceEvent::Halt) >= 1, "trace: no Halt");
+    CHECK(c.exc_bad == 0, "trace: %u IRQ records with a wrong exception number", c.exc_bad);
+    CHECK(c.in_irq[(uint8_t)TraceEvent::RunSteps] == 0, "trace: RunSteps in IRQ context");
+    for (unsigned id = 0; id < 128; ++id) {
+        if (id == (uint8_t)TraceEvent::RingUnderrun) continue;   // point event
+        CHECK(c.begins[id] == c.ends[id], "trace: event 0x%02x %u begin / %u end",
+              id, c.begins[id], c.ends[id]);
+    }
+
+    std::printf("ring full\n");
+    trace_clear();
+    for (unsigned i = 0; i < PULSE_MODE_TRACE_RING + 37; ++i) PM_TRACE(RunSteps, i);
+    const TraceCheck f = trace_decode();
+    CHECK(f.count == PULSE_MODE_TRACE_RING && f.dropped == 37,
+          "ring full: %u records, %u dropped", f.count, f.dropped);
+
+    const TraceCheck e = trace_decode();
+    CHECK(e.count == 0 && e.dropped == 0, "drained: %u records, %u dropped", e.count, e.dropped);
+    return 0;
+}
+
+#else
+
+int group_trace() {
+    std::printf("built with PULSE_MODE_TRACE=0: nothing recorded\n");
+    return 0;
+}
+
+#endif
+
+// ============================================================
+// group dispatch
+// ============================================================
+
+struct Group {
+    const char*      name;
+    int              (*run)();
+};
+
+int group_step_only()     { return group_variant(MotorExecVariant::StepOnly); }
+int group_half_duty()     { return group_variant(MotorExecVariant::HalfDuty); }
+int group_half_duty_v2()  { return group_variant(MotorExecVariant::HalfDutyV2); }
+int group_adjustable()    { return group_variant(MotorExecVariant::AdjustableDuty); }
+
+const Group GROUPS[] = {
+    { "axis",                group_axis },
+    { "radar",               group_radar },
+    { "variant:step_only",   group_step_only },
+    { "variant:half_duty",   group_half_duty },
+    { "variant:half_duty_v2", group_half_duty_v2 },
+    { "variant:adjustable",  group_adjustable },
+    { "trace",               group_trace },
+    { "firmware",            group_firmware },
+    { "cache",               group_cache },
+    { "traj_lib",            group_traj_lib },
+    { "units",               group_units },
+};
+
+int run_group(const Group& g) {
+    std::printf("==== %s ====\n", g.name);
+    const auto t0 = std::chrono::steady_clock::now();
+
+    g_rng = g_seed * 2654435761u + 1u;
+    pio_timing_configure(clock_get_hz(clk_sys));
+    trace.watch(STEP_PIN, "step");
+    trace.watch(DIR_PIN, "dir");
+    trace.watch(TRIGGER_PIN, "trigger");
+    trace.attach();
+
+    g.run();
+
+    const double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    const sim::Counters& c = sim::counters();
+    std::printf("---- %s: %u / %u checks failed, %.3f s simulated in %.2f s\n"
+                "     %llu events, %llu PIO instr, %llu DMA transfers, %llu IRQs\n",
+                g.name, g_failed, g_checks, (double)sim::now() / sim::f_sys(), wall,
+                (unsigned long long)c.events, (unsigned long long)c.pio_instructions,
+                (unsigned long long)c.dma_transfers, (unsigned long long)c.irqs);
+    std::fflush(stdout);
+    return g_failed > 255 ? 255 : (int)g_failed;
+}
+
+void usage() {
+    std::printf("usage: sim_runner [group] [-n trajectories] [-s seed] [-v out.vcd]\ngroups:");
+    for (const Group& g : GROUPS) std::printf(" %s", g.name);
+    std::printf("\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const char* only = nullptr;
+
+    for (int i = 1; i < argc; ++i) {
+        if (!std::strcmp(argv[i], "-n") && i + 1 < argc) {
+            g_count = (unsigned)std::strtoul(argv[++i], nullptr, 0);
+        } else if (!std::strcmp(argv[i], "-s") && i + 1 < argc) {
+            g_seed = (uint32_t)std::strtoul(argv[++i], nullptr, 0);
+        } else if (!std::strcmp(argv[i], "-v") && i + 1 < argc) {
+            g_vcd = argv[++i];
+        } else if (argv[i][0] != '-' && !only) {
+            only = argv[i];
+        } else {
+            usage();
+            return 2;
+        }
+    }
+
+    if (only) {
+        for (const Group& g : GROUPS) {
+            if (!std::strcmp(g.name, only)) return run_group(g);
+        }
+        usage();
+        return 2;
+    }
+
+    // every group in its own process: fresh chip + driver statics
+    int failed = 0;
+    for (const Group& g : GROUPS) {
+        std::fflush(stdout);
+        const pid_t pid = fork();
+        if (pid < 0) {
+            std::perror("fork");
+            return 2;
+        }
+        if (pid == 0) std::_Exit(run_group(g));
+
+        int status = 0;
+        waitpid(pid, &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            std::printf("**** %s failed (%s %d)\n", g.name,
+                        WIFEXITED(status) ? "exit" : "signal",
+                        WIFEXITED(status) ? WEXITSTATUS(status) : WTERMSIG(status));
+            ++failed;
+        }
+    }
+    std::printf(failed ? "\n%d group(s) FAILED\n" : "\nall groups passed\n", failed);
+    return failed;
+}
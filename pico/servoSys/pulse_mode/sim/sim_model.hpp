@@ -0,0 +1,143 @@
+#pragma once
+
+// ============================================================
+// sim internals: interfaces between the component models
+//
+// Scheduler contract (sim_chip.cpp), per component:
+//   next_event(t) : first cycle >= t at which the component may
+//                   change anything another component or the CPU
+//                   can observe (NEVER = not before some input moves)
+//   skip(to)      : cycles up to `to` contain no such change:
+//                   advance internal state (counters, delays, loops)
+//   step(t)       : simulate cycle t exactly
+// ============================================================
+
+#include "sim_chip.hpp"
+
+#include "hardware/pio.h"
+#include "hardware/dma.h"
+#include "hardware/pwm.h"
+#include "hardware/structs/timer.h"
+#include "hardware/irq.h"
+#include "hardware/gpio.h"
+
+namespace sim {
+
+constexpr uint64_t NEVER = ~0ull;
+
+// register window of one peripheral (4 aliases x 4 KiB)
+constexpr uint32_t BLOCK_SIZE  = 0x4000u;
+constexpr uint32_t ALIAS_SHIFT = 12u;
+constexpr uint32_t REG_MASK    = 0x0FFFu;
+
+enum Alias : uint32_t {
+    ALIAS_RW  = 0,
+    ALIAS_XOR = 1,
+    ALIAS_SET = 2,
+    ALIAS_CLR = 3
+};
+
+// new register value for an aliased write
+static inline uint32_t alias_apply(uint32_t old, uint32_t v, uint32_t alias) {
+    switch (alias) {
+        case ALIAS_XOR: return old ^ v;
+        case ALIAS_SET: return old | v;
+        case ALIAS_CLR: return old & ~v;
+        default:        return v;
+    }
+}
+
+[[noreturn]] void fatal(const char* fmt, ...);
+
+// ------------------------------------------------------------
+// chip (sim_chip.cpp)
+// ------------------------------------------------------------
+Counters& counters_mut();
+
+// pad of `pin` must be recomputed (function select or a peripheral output moved)
+void pad_refresh(uint pin, uint64_t cycle);
+
+// level the PIO input synchronizer delivers at `cycle` (2 cycles late)
+bool pad_synced(uint pin, uint64_t cycle);
+
+// most recent pad change (any pin)
+uint64_t pad_last_change();
+
+gpio_function_t pad_function(uint pin);
+
+// NVIC stand-in (SDK shims in sim_sdk.cpp)
+void irq_mask(bool disable);          // PRIMASK; unmasking runs due handlers
+bool irq_masked();
+int  irq_active();                   // IRQ number of the running handler, -1 = thread
+void irq_enable_line(uint num, bool enabled);
+bool irq_line_enabled(uint num);
+void irq_set_handler(uint num, irq_handler_t h);
+void irq_add_handler(uint num, irq_handler_t h, uint8_t order);
+void irq_drop_handler(uint num, irq_handler_t h);
+
+// ------------------------------------------------------------
+// PIO (sim_pio.cpp)
+// ------------------------------------------------------------
+namespace pio_sim {
+
+void     reset();
+uint64_t next_event(uint64_t t);
+void     skip(uint64_t to);
+void     step(uint64_t t);
+
+// pad drive of PIO `p` on `pin`
+bool out_level(uint p, uint pin);
+bool out_enable(uint p, uint pin);
+
+// DREQ levels
+bool tx_ready(uint p, uint sm);   // TX FIFO not full
+bool rx_ready(uint p, uint sm);   // RX FIFO not empty
+
+uint32_t bus_read(uint p, uint32_t reg);
+void     bus_write(uint p, uint32_t reg, uint32_t v, uint32_t alias);
+
+} // namespace pio_sim
+
+// ------------------------------------------------------------
+// DMA (sim_dma.cpp)
+// ------------------------------------------------------------
+namespace dma_sim {
+
+void     reset();
+uint64_t next_event(uint64_t t);
+void     skip(uint64_t to);
+void     step(uint64_t t);
+
+// a PWM slice wrapped (DREQ_PWM_WRAP0 + slice)
+void pwm_wrap(uint slice);
+
+bool irq_line(uint index);   // DMA_IRQ_0 / DMA_IRQ_1
+
+uint32_t bus_read(uint32_t reg);
+void     bus_write(uint32_t reg, uint32_t v, uint32_t alias);
+
+bool busy(uint ch);
+void start(uint32_t mask);   // MULTI_CHAN_TRIGGER
+void abort(uint ch);         // CHAN_ABORT
+
+} // namespace dma_sim
+
+// ------------------------------------------------------------
+// PWM (sim_pwm.cpp)
+// ------------------------------------------------------------
+namespace pwm_sim {
+
+void     reset();
+uint64_t next_event(uint64_t t);
+void     skip(uint64_t to);
+void     step(uint64_t t);
+
+bool out_level(uint pin);
+bool irq_line();
+
+uint32_t bus_read(uint32_t reg);
+void     bus_write(uint32_t reg, uint32_t v, uint32_t alias);
+
+} // namespace pwm_sim
+
+} // namespace sim
@@ -0,0 +1,831 @@
+#include "sim_model.hpp"
+
+#include <cstddef>
+
+// ============================================================
+// PIO model
+//   Instruction semantics as in the RP2040 datasheet (3.4):
+//   stalls re-execute the same instruction on the next SM clock,
+//   side-set applies at issue, delay only after completion,
+//   wrap only when no jump is taken, exec'd instructions do not
+//   advance the PC.
+//
+//   SM clock: fractional divider kept as the next tick time in
+//   1/256 cycles (8.8 CLKDIV).
+//
+//   Fast-forward (skip):
+//     delay cycles, stalls whose condition cannot change, and
+//     counted loops  top: [mov r, r ...] jmp x--/y-- top [d]
+//     (nop bodies, no side-set), i.e. every delay loop in pio/.
+//     A loop may start behind a pending delay (jmp x-- top [1]).
+// ============================================================
+
+namespace sim {
+namespace pio_sim {
+
+namespace {
+
+struct Fifo {
+    uint32_t d[8];
+    uint8_t  head;
+    uint8_t  count;
+
+    void     clear() { head = 0; count = 0; }
+    void     push(uint32_t v) { d[(head + count) & 7u] = v; ++count; }
+    uint32_t pop() { const uint32_t v = d[head]; head = (head + 1u) & 7u; --count; return v; }
+};
+
+struct Sm {
+    uint8_t  pc;
+    uint32_t x, y, isr, osr;
+    uint8_t  isr_cnt;        // bits shifted in
+    uint8_t  osr_cnt;        // bits shifted out (32 = empty)
+    uint32_t delay;          // delay ticks left
+    uint64_t nt;             // next tick, 1/256 cycle
+    bool     enabled;
+    bool     irq_wait;       // `irq wait` set its flag, waiting for the clear
+    bool     exec_pending;   // stalled exec'd instruction
+    uint16_t exec_instr;
+    Fifo     tx, rx;
+};
+
+struct Pio {
+    Sm       sm[NUM_PIO_STATE_MACHINES];
+    uint32_t pad_out;
+    uint32_t pad_oe;
+    uint8_t  irq;
+};
+
+Pio pios[NUM_PIOS];
+
+inline pio_hw_t* hw(uint p) { return pio_regs(p); }
+
+// ------------------------------------------------------------
+// config fields (read from the register window)
+// ------------------------------------------------------------
+
+inline uint32_t field(uint32_t v, uint lsb, uint32_t mask) { return (v >> lsb) & mask; }
+
+inline uint32_t div256(uint p, uint i) {
+    const uint32_t c  = hw(p)->sm[i].clkdiv;
+    uint32_t       di = field(c, PIO_SM0_CLKDIV_INT_LSB, 0xFFFFu);
+    const uint32_t df = field(c, PIO_SM0_CLKDIV_FRAC_LSB, 0xFFu);
+    if (di == 0) di = 0x10000u;   // INT 0 = 65536
+    return (di << 8) + df;
+}
+
+inline uint tx_cap(uint p, uint i) {
+    const uint32_t s = hw(p)->sm[i].shiftctrl;
+    if (s & PIO_SM0_SHIFTCTRL_FJOIN_TX_BITS) return 8;
+    if (s & PIO_SM0_SHIFTCTRL_FJOIN_RX_BITS) return 0;
+    return 4;
+}
+
+inline uint rx_cap(uint p, uint i) {
+    const uint32_t s = hw(p)->sm[i].shiftctrl;
+    if (s & PIO_SM0_SHIFTCTRL_FJOIN_RX_BITS) return 8;
+    if (s & PIO_SM0_SHIFTCTRL_FJOIN_TX_BITS) return 0;
+    return 4;
+}
+
+inline uint pull_thresh(uint p, uint i) {
+    const uint t = field(hw(p)->sm[i].shiftctrl, PIO_SM0_SHIFTCTRL_PULL_THRESH_LSB, 0x1Fu);
+    return t ? t : 32u;
+}
+
+inline uint push_thresh(uint p, uint i) {
+    const uint t = field(hw(p)->sm[i].shiftctrl, PIO_SM0_SHIFTCTRL_PUSH_THRESH_LSB, 0x1Fu);
+    return t ? t : 32u;
+}
+
+inline uint wrap_top(uint p, uint i) {
+    return field(hw(p)->sm[i].execctrl, PIO_SM0_EXECCTRL_WRAP_TOP_LSB, 0x1Fu);
+}
+
+inline uint wrap_bottom(uint p, uint i) {
+    return field(hw(p)->sm[i].execctrl, PIO_SM0_EXECCTRL_WRAP_BOTTOM_LSB, 0x1Fu);
+}
+
+// side-set field width (incl. enable bit) and delay width
+inline uint sideset_bits(uint p, uint i) {
+    return field(hw(p)->sm[i].pinctrl, PIO_SM0_PINCTRL_SIDESET_COUNT_LSB, 0x7u);
+}
+
+inline uint32_t delay_of(uint p, uint i, uint16_t ins) {
+    const uint db = 5u - sideset_bits(p, i);
+    return ((uint32_t)ins >> 8) & ((1u << db) - 1u);
+}
+
+// ------------------------------------------------------------
+// pins
+// ------------------------------------------------------------
+
+void write_pins(uint p, uint base, uint count, uint32_t v, bool dirs, uint64_t t) {
+    Pio& P = pios[p];
+    uint32_t& reg = dirs ? P.pad_oe : P.pad_out;
+
+    for (uint k = 0; k < count; ++k) {
+        const uint     pin = (base + k) & 31u;
+        const uint32_t bit = 1u << pin;
+        const uint32_t val = ((v >> k) & 1u) ? bit : 0u;
+        if ((reg & bit) == val) continue;
+
+        reg = (reg & ~bit) | val;
+        if (pin < NUM_BANK0_GPIOS) pad_refresh(pin, t);
+    }
+}
+
+uint32_t read_pins(uint p, uint i, uint n, uint64_t t) {
+    const uint base = field(hw(p)->sm[i].pinctrl, PIO_SM0_PINCTRL_IN_BASE_LSB, 0x1Fu);
+    (void)p;
+
+    uint32_t v = 0;
+    for (uint k = 0; k < n; ++k) {
+        const uint pin = (base + k) & 31u;
+        if (pin < NUM_BANK0_GPIOS && pad_synced(pin, t)) v |= 1u << k;
+    }
+    return v;
+}
+
+inline uint irq_index(uint i, uint idx) {
+    uint n = idx & 7u;
+    if (idx & 0x10u) n = (n & 4u) | ((n + i) & 3u);
+    return n;
+}
+
+void apply_sideset(uint p, uint i, uint16_t ins, uint64_t t) {
+    const uint bits = sideset_bits(p, i);
+    if (bits == 0) return;
+
+    const uint32_t exec = hw(p)->sm[i].execctrl;
+    const bool     opt  = (exec & PIO_SM0_EXECCTRL_SIDE_EN_BITS) != 0;
+
+    uint32_t f = ((uint32_t)ins >> (13u - bits)) & ((1u << bits) - 1u);
+    uint     n = bits;
+    if (opt) {
+        if (!(f & (1u << (bits - 1u)))) return;
+        n -= 1u;
+        f &= (1u << n) - 1u;
+    }
+
+    const uint base = field(hw(p)->sm[i].pinctrl, PIO_SM0_PINCTRL_SIDESET_BASE_LSB, 0x1Fu);
+    write_pins(p, base, n, f, (exec & PIO_SM0_EXECCTRL_SIDE_PINDIR_BITS) != 0, t);
+}
+
+// ------------------------------------------------------------
+// stall conditions (no side effects)
+// ------------------------------------------------------------
+
+enum class Block : uint8_t { None, Fifo, Pad, Irq };
+
+Block blocked(uint p, uint i, uint16_t ins, uint64_t t) {
+    const Pio& P = pios[p];
+    const Sm&  s = P.sm[i];
+
+    switch (ins >> 13) {
+        case 1: {   // WAIT
+            const uint pol = (ins >> 7) & 1u;
+            const uint src = (ins >> 5) & 3u;
+            const uint idx = ins & 0x1Fu;
+            if (src == 2) {
+                const bool set = (P.irq >> irq_index(i, idx)) & 1u;
+                return (set == (pol != 0)) ? Block::None : Block::Irq;
+            }
+            uint pin = idx;
+            if (src == 1) {
+                pin = (field(hw(p)->sm[i].pinctrl, PIO_SM0_PINCTRL_IN_BASE_LSB, 0x1Fu) + idx) & 31u;
+            }
+            const bool lvl = pin < NUM_BANK0_GPIOS && pad_synced(pin, t);
+            return (lvl == (pol != 0)) ? Block::None : Block::Pad;
+        }
+        case 2: {   // IN (autopush)
+            if (!(hw(p)->sm[i].shiftctrl & PIO_SM0_SHIFTCTRL_AUTOPUSH_BITS)) return Block::None;
+            uint n = ins & 0x1Fu;
+            if (n == 0) n = 32;
+            if (s.isr_cnt + n >= push_thresh(p, i) && s.rx.count >= rx_cap(p, i)) return Block::Fifo;
+            return Block::None;
+        }
+        case 3: {   // OUT (autopull)
+            if (!(hw(p)->sm[i].shiftctrl & PIO_SM0_SHIFTCTRL_AUTOPULL_BITS)) return Block::None;
+            if (s.osr_cnt >= pull_thresh(p, i) && s.tx.count == 0) return Block::Fifo;
+            return Block::None;
+        }
+        case 4: {   // PUSH / PULL
+            const bool pull  = (ins >> 7) & 1u;
+            const bool iff   = (ins >> 6) & 1u;
+            const bool block = (ins >> 5) & 1u;
+            if (!block) return Block::None;
+            if (pull) {
+                if (iff && s.osr_cnt < pull_thresh(p, i)) return Block::None;
+                return (s.tx.count == 0) ? Block::Fifo : Block::None;
+            }
+            if (iff && s.isr_cnt < push_thresh(p, i)) return Block::None;
+            return (s.rx.count >= rx_cap(p, i)) ? Block::Fifo : Block::None;
+        }
+        case 6: {   // IRQ wait
+            const bool clr  = (ins >> 6) & 1u;
+            const bool wait = (ins >> 5) & 1u;
+            if (clr || !wait || !s.irq_wait) return Block::None;
+            return ((P.irq >> irq_index(i, ins & 0x1Fu)) & 1u) ? Block::Irq : Block::None;
+        }
+        default:
+            return Block::None;
+    }
+}
+
+// ------------------------------------------------------------
+// execution
+// ------------------------------------------------------------
+
+// true: completed; false: stalled (re-executed next tick)
+bool execute(uint p, uint i, uint16_t ins, uint64_t t, bool& jumped) {
+    Pio& P = pios[p];
+    Sm&  s = P.sm[i];
+    pio_sm_hw_t& r = hw(p)->sm[i];
+
+    jumped = false;
+
+    switch (ins >> 13) {
+        case 0: {   // JMP
+            const uint cond = (ins >> 5) & 7u;
+            bool take = false;
+            switch (cond) {
+                case 0: take = true; break;
+                case 1: take = (s.x == 0); break;
+                case 2: take = (s.x != 0); s.x--; break;
+                case 3: take = (s.y == 0); break;
+                case 4: take = (s.y != 0); s.y--; break;
+                case 5: take = (s.x != s.y); break;
+                case 6: {
+                    const uint pin = field(r.execctrl, PIO_SM0_EXECCTRL_JMP_PIN_LSB, 0x1Fu);
+                    take = pin < NUM_BANK0_GPIOS && pad_synced(pin, t);
+                    break;
+                }
+                default: take = (s.osr_cnt < pull_thresh(p, i)); break;
+            }
+            if (take) {
+                s.pc   = ins & 0x1Fu;
+                jumped = true;
+            }
+            return true;
+        }
+
+        case 1: {   // WAIT
+            if (blocked(p, i, ins, t) != Block::None) return false;
+            if (((ins >> 5) & 3u) == 2 && ((ins >> 7) & 1u)) {
+                P.irq &= (uint8_t)~(1u << irq_index(i, ins & 0x1Fu));
+            }
+            return true;
+        }
+
+        case 2: {   // IN
+            if (blocked(p, i, ins, t) != Block::None) return false;
+            uint n = ins & 0x1Fu;
+            if (n == 0) n = 32;
+
+            uint32_t v = 0;
+            switch ((ins >> 5) & 7u) {
+                case 0: v = read_pins(p, i, n, t); break;
+                case 1: v = s.x; break;
+                case 2: v = s.y; break;
+                case 6: v = s.isr; break;
+                case 7: v = s.osr; break;
+                default: v = 0; break;
+            }
+            if (n < 32) v &= (1u << n) - 1u;
+
+            if (r.shiftctrl & PIO_SM0_SHIFTCTRL_IN_SHIFTDIR_BITS) {
+                s.isr = (n == 32) ? v : (s.isr >> n) | (v << (32u - n));
+            } else {
+                s.isr = (n == 32) ? v : (s.isr << n) | v;
+            }
+            s.isr_cnt = (uint8_t)((s.isr_cnt + n > 32u) ? 32u : s.isr_cnt + n);
+
+            if ((r.shiftctrl & PIO_SM0_SHIFTCTRL_AUTOPUSH_BITS) && s.isr_cnt >= push_thresh(p, i)) {
+                s.rx.push(s.isr);
+                s.isr     = 0;
+                s.isr_cnt = 0;
+            }
+            return true;
+        }
+
+        case 3: {   // OUT
+            if (blocked(p, i, ins, t) != Block::None) return false;
+            if ((r.shiftctrl & PIO_SM0_SHIFTCTRL_AUTOPULL_BITS) && s.osr_cnt >= pull_thresh(p, i)) {
+                s.osr     = s.tx.pop();
+                s.osr_cnt = 0;
+            }
+
+            uint n = ins & 0x1Fu;
+            if (n == 0) n = 32;
+
+            uint32_t v;
+            if (r.shiftctrl & PIO_SM0_SHIFTCTRL_OUT_SHIFTDIR_BITS) {
+                v     = (n == 32) ? s.osr : s.osr & ((1u << n) - 1u);
+                s.osr = (n == 32) ? 0u : s.osr >> n;
+            } else {
+                v     = (n == 32) ? s.osr : s.osr >> (32u - n);
+                s.osr = (n == 32) ? 0u : s.osr << n;
+            }
+            s.osr_cnt = (uint8_t)((s.osr_cnt + n > 32u) ? 32u : s.osr_cnt + n);
+
+            switch ((ins >> 5) & 7u) {
+                case 0:
+                    write_pins(p, field(r.pinctrl, PIO_SM0_PINCTRL_OUT_BASE_LSB, 0x1Fu),
+                               field(r.pinctrl, PIO_SM0_PINCTRL_OUT_COUNT_LSB, 0x3Fu), v, false, t);
+                    break;
+                case 1: s.x = v; break;
+                case 2: s.y = v; break;
+                case 3: break;
+                case 4:
+                    write_pins(p, field(r.pinctrl, PIO_SM0_PINCTRL_OUT_BASE_LSB, 0x1Fu),
+                               field(r.pinctrl, PIO_SM0_PINCTRL_OUT_COUNT_LSB, 0x3Fu), v, true, t);
+                    break;
+                case 5: s.pc = v & 0x1Fu; jumped = true; break;
+                case 6: s.isr = v; s.isr_cnt = (uint8_t)n; break;
+                default:
+                    s.exec_pending = true;
+                    s.exec_instr   = (uint16_t)v;
+                    break;
+            }
+            return true;
+        }
+
+        case 4: {   // PUSH / PULL
+            const bool pull  = (ins >> 7) & 1u;
+            const bool iff   = (ins >> 6) & 1u;
+            const bool block = (ins >> 5) & 1u;
+
+            if (pull) {
+                if (iff && s.osr_cnt < pull_thresh(p, i)) return true;
+                if (s.tx.count == 0) {
+                    if (block) return false;
+                    s.osr = s.x;                 // noblock on empty: X
+                } else {
+                    s.osr = s.tx.pop();
+                }
+                s.osr_cnt = 0;
+                return true;
+            }
+
+            if (iff && s.isr_cnt < push_thresh(p, i)) return true;
+            if (s.rx.count >= rx_cap(p, i)) {
+                if (block) return false;
+            } else {
+                s.rx.push(s.isr);
+            }
+            s.isr     = 0;                       // cleared even if the word was dropped
+            s.isr_cnt = 0;
+            return true;
+        }
+
+        case 5: {   // MOV
+            uint32_t v = 0;
+            switch (ins & 7u) {
+                case 0: v = read_pins(p, i, 32, t); break;
+                case 1: v = s.x; break;
+                case 2: v = s.y; break;
+                case 3: v = 0; break;
+                case 5: {
+                    const uint lvl = (r.execctrl & PIO_SM0_EXECCTRL_STATUS_SEL_BITS) ? s.rx.count : s.tx.count;
+                    v = (lvl < (r.execctrl & 0xFu)) ? ~0u : 0u;
+                    break;
+                }
+                case 6: v = s.isr; break;
+                case 7: v = s.osr; break;
+                default: v = 0; break;
+            }
+
+            switch ((ins >> 3) & 3u) {
+                case 1: v = ~v; break;
+                case 2: {
+                    uint32_t rv = 0;
+                    for (uint k = 0; k < 32; ++k) rv |= ((v >> k) & 1u) << (31u - k);
+                    v = rv;
+                    break;
+                }
+                default: break;
+            }
+
+            switch ((ins >> 5) & 7u) {
+                case 0:
+                    write_pins(p, field(r.pinctrl, PIO_SM0_PINCTRL_OUT_BASE_LSB, 0x1Fu),
+                               field(r.pinctrl, PIO_SM0_PINCTRL_OUT_COUNT_LSB, 0x3Fu), v, false, t);
+                    break;
+                case 1: s.x = v; break;
+                case 2: s.y = v; break;
+                case 4:
+                    s.exec_pending = true;
+                    s.exec_instr   = (uint16_t)v;
+                    break;
+                case 5: s.pc = v & 0x1Fu; jumped = true; break;
+                case 6: s.isr = v; s.isr_cnt = 0; break;
+                case 7: s.osr = v; s.osr_cnt = 0; break;
+                default: break;
+            }
+            return true;
+        }
+
+        case 6: {   // IRQ
+            const bool    clr  = (ins >> 6) & 1u;
+            const bool    wait = (ins >> 5) & 1u;
+            const uint8_t bit  = (uint8_t)(1u << irq_index(i, ins & 0x1Fu));
+
+            if (clr) {
+                P.irq &= (uint8_t)~bit;
+                return true;
+            }
+            if (!s.irq_wait) {
+                P.irq |= bit;
+                if (!wait) return true;
+                s.irq_wait = true;
+            }
+            if (P.irq & bit) return false;
+            s.irq_wait = false;
+            return true;
+        }
+
+        default: {  // SET
+            const uint32_t v = ins & 0x1Fu;
+            switch ((ins >> 5) & 7u) {
+                case 0:
+                    write_pins(p, field(r.pinctrl, PIO_SM0_PINCTRL_SET_BASE_LSB, 0x1Fu),
+                               field(r.pinctrl, PIO_SM0_PINCTRL_SET_COUNT_LSB, 0x7u), v, false, t);
+                    break;
+                case 1: s.x = v; break;
+                case 2: s.y = v; break;
+                case 4:
+                    write_pins(p, field(r.pinctrl, PIO_SM0_PINCTRL_SET_BASE_LSB, 0x1Fu),
+                               field(r.pinctrl, PIO_SM0_PINCTRL_SET_COUNT_LSB, 0x7u), v, true, t);
+                    break;
+                default: break;
+            }
+            return true;
+        }
+    }
+}
+
+inline uint16_t current(uint p, uint i) {
+    const Sm& s = pios[p].sm[i];
+    return s.exec_pending ? s.exec_instr : (uint16_t)hw(p)->instr_mem[s.pc];
+}
+
+// one SM clock
+void tick(uint p, uint i, uint64_t t) {
+    Sm& s = pios[p].sm[i];
+    s.nt += div256(p, i);
+
+    if (s.delay > 0) {
+        s.delay--;
+        return;
+    }
+
+    const bool     from_exec = s.exec_pending;
+    const uint16_t ins       = current(p, i);
+
+    apply_sideset(p, i, ins, t);
+
+    bool jumped = false;
+    if (!execute(p, i, ins, t, jumped)) return;   // stalled
+
+    counters_mut().pio_instructions++;
+
+    if (from_exec) {
+        // out exec / mov exec may have queued the next one
+        if (s.exec_instr == ins) s.exec_pending = false;
+        return;
+    }
+
+    if (!jumped) {
+        s.pc = (s.pc == wrap_top(p, i)) ? (uint8_t)wrap_bottom(p, i) : (uint8_t)((s.pc + 1u) & 31u);
+    }
+    s.delay = delay_of(p, i, ins);
+}
+
+// ------------------------------------------------------------
+// loop fast-forward
+// ------------------------------------------------------------
+
+inline bool is_nop(uint16_t ins) {
+    // mov x, x / mov y, y (op none): no state change
+    if ((ins >> 13) != 5) return false;
+    const uint dst = (ins >> 5) & 7u;
+    const uint op  = (ins >> 3) & 3u;
+    const uint src = ins & 7u;
+    return op == 0 && dst == src && (dst == 1 || dst == 2);
+}
+
+struct Loop {
+    uint8_t  reg;        // 1 = X, 2 = Y
+    uint32_t period;     // ticks per iteration
+    uint8_t  length;     // instructions per iteration
+};
+
+// SM at the first instruction of a counted delay loop (after s.delay)?
+bool loop_at(uint p, uint i, Loop& out) {
+    const Sm& s = pios[p].sm[i];
+    if (s.exec_pending) return false;
+    if (sideset_bits(p, i) != 0) return false;
+
+    const uint top = s.pc;
+    const uint wt  = wrap_top(p, i);
+
+    uint32_t period = 0;
+    uint     pc     = top;
+    for (uint n = 0; n < 8; ++n) {
+        const uint16_t ins = (uint16_t)hw(p)->instr_mem[pc];
+        period += 1u + delay_of(p, i, ins);
+
+        if ((ins >> 13) == 0) {
+            const uint cond = (ins >> 5) & 7u;
+            if ((cond != 2 && cond != 4) || (ins & 0x1Fu) != top) return false;
+            out.reg    = (cond == 2) ? 1 : 2;
+            out.period = period;
+            out.length = (uint8_t)(n + 1);
+            return true;
+        }
+        if (!is_nop(ins) || pc == wt) return false;
+        pc = (pc + 1u) & 31u;
+    }
+    return false;
+}
+
+// ------------------------------------------------------------
+// tick arithmetic
+// ------------------------------------------------------------
+
+inline uint64_t tick_time(const Sm& s, uint32_t d, uint64_t k) {
+    return (s.nt + k * d) >> 8;
+}
+
+// ticks at cycles <= to
+inline uint64_t ticks_until(const Sm& s, uint32_t d, uint64_t to) {
+    const uint64_t lim = (to + 1) << 8;
+    if (lim <= s.nt) return 0;
+    return (lim - s.nt + d - 1) / d;
+}
+
+uint64_t sm_next_event(uint p, uint i) {
+    const Sm& s = pios[p].sm[i];
+    if (!s.enabled) return NEVER;
+
+    const uint32_t d  = div256(p, i);
+    const uint64_t t0 = tick_time(s, d, 0);
+
+    Loop lp;
+    if (loop_at(p, i, lp)) {
+        const uint32_t v = (lp.reg == 1) ? s.x : s.y;
+        return tick_time(s, d, s.delay + (uint64_t)v * lp.period);
+    }
+
+    if (s.delay > 0) return tick_time(s, d, s.delay);
+
+    switch (blocked(p, i, current(p, i), t0)) {
+        case Block::None: return t0;
+        case Block::Pad:
+            // synchronizer still settling: follow it cycle by cycle
+            return (pad_last_change() + 3 >= t0) ? t0 : NEVER;
+        default:
+            return NEVER;
+    }
+}
+
+void sm_skip(uint p, uint i, uint64_t to) {
+    Sm& s = pios[p].sm[i];
+    if (!s.enabled) return;
+
+    const uint32_t d = div256(p, i);
+
+    while (tick_time(s, d, 0) <= to) {
+        const uint64_t avail = ticks_until(s, d, to);
+
+        if (s.delay > 0) {
+            const uint64_t n = (s.delay < avail) ? s.delay : avail;
+            s.delay -= (uint32_t)n;
+            s.nt    += n * d;
+            continue;
+        }
+
+        Loop lp;
+        if (loop_at(p, i, lp)) {
+            uint32_t& reg = (lp.reg == 1) ? s.x : s.y;
+            uint64_t  k   = avail / lp.period;
+            if (k > reg) k = reg;
+            if (k > 0) {
+                reg  -= (uint32_t)k;
+                s.nt += k * lp.period * d;
+                counters_mut().pio_instructions += k * lp.length;
+                continue;
+            }
+        }
+
+        const uint16_t ins = current(p, i);
+        if (blocked(p, i, ins, tick_time(s, d, 0)) != Block::None) {
+            s.nt += avail * d;
+            return;
+        }
+
+        // inside a loop iteration: only register work may happen here
+        const bool pure = is_nop(ins) ||
+                          ((ins >> 13) == 0 && (((ins >> 5) & 7u) == 2 || ((ins >> 5) & 7u) == 4));
+        if (!pure) fatal("pio%u sm%u: skip reached pc %u (0x%04x)", p, i, s.pc, ins);
+
+        tick(p, i, tick_time(s, d, 0));
+    }
+}
+
+void restart(uint p, uint i) {
+    Sm& s = pios[p].sm[i];
+    s.isr          = 0;
+    s.isr_cnt      = 0;
+    s.osr_cnt      = 0;
+    s.delay        = 0;
+    s.irq_wait     = false;
+    s.exec_pending = false;
+}
+
+void clear_fifos(uint p, uint i) {
+    pios[p].sm[i].tx.clear();
+    pios[p].sm[i].rx.clear();
+}
+
+// CPU / INSTR write: runs now, a stall leaves it pending
+void exec_now(uint p, uint i, uint16_t ins) {
+    Sm& s = pios[p].sm[i];
+    const uint64_t t = now();
+
+    apply_sideset(p, i, ins, t);
+
+    bool jumped = false;
+    s.exec_pending = false;
+    if (!execute(p, i, ins, t, jumped)) {
+        s.exec_pending = true;
+        s.exec_instr   = ins;
+        return;
+    }
+    counters_mut().pio_instructions++;
+}
+
+} // namespace
+
+// ============================================================
+// scheduler interface
+// ============================================================
+
+void reset() {
+    for (uint p = 0; p < NUM_PIOS; ++p) {
+        pios[p] = Pio{};
+        for (uint i = 0; i < NUM_PIO_STATE_MACHINES; ++i) {
+            pios[p].sm[i].osr_cnt = 32;
+        }
+    }
+}
+
+uint64_t next_event(uint64_t t) {
+    uint64_t e = NEVER;
+    for (uint p = 0; p < NUM_PIOS; ++p) {
+        for (uint i = 0; i < NUM_PIO_STATE_MACHINES; ++i) {
+            const uint64_t n = sm_next_event(p, i);
+            if (n < e) e = n;
+        }
+    }
+    return (e < t) ? t : e;
+}
+
+void skip(uint64_t to) {
+    for (uint p = 0; p < NUM_PIOS; ++p) {
+        for (uint i = 0; i < NUM_PIO_STATE_MACHINES; ++i) sm_skip(p, i, to);
+    }
+}
+
+void step(uint64_t t) {
+    for (uint p = 0; p < NUM_PIOS; ++p) {
+        for (uint i = 0; i < NUM_PIO_STATE_MACHINES; ++i) {
+            Sm& s = pios[p].sm[i];
+            if (!s.enabled) continue;
+            if (tick_time(s, div256(p, i), 0) == t) tick(p, i, t);
+        }
+    }
+}
+
+bool out_level(uint p, uint pin) { return (pios[p].pad_out >> pin) & 1u; }
+bool out_enable(uint p, uint pin) { return (pios[p].pad_oe >> pin) & 1u; }
+
+bool tx_ready(uint p, uint sm) { return pios[p].sm[sm].tx.count < tx_cap(p, sm); }
+bool rx_ready(uint p, uint sm) { return pios[p].sm[sm].rx.count > 0; }
+
+// ============================================================
+// register window
+// ============================================================
+
+#define PIO_REG(f) ((uint32_t)offsetof(pio_hw_t, f))
+
+constexpr uint32_t EXEC_STALLED = 1u << 31;   // EXECCTRL.EXEC_STALLED (RO)
+
+uint32_t bus_read(uint p, uint32_t reg) {
+    Pio&      P = pios[p];
+    pio_hw_t* h = hw(p);
+
+    if (reg == PIO_REG(fstat)) {
+        uint32_t v = 0;
+        for (uint i = 0; i < NUM_PIO_STATE_MACHINES; ++i) {
+            const Sm& s = P.sm[i];
+            if (s.rx.count >= rx_cap(p, i)) v |= 1u << (0 + i);
+            if (s.rx.count == 0)            v |= 1u << (8 + i);
+            if (s.tx.count >= tx_cap(p, i)) v |= 1u << (16 + i);
+            if (s.tx.count == 0)            v |= 1u << (24 + i);
+        }
+        return v;
+    }
+    if (reg == PIO_REG(flevel)) {
+        uint32_t v = 0;
+        for (uint i = 0; i < NUM_PIO_STATE_MACHINES; ++i) {
+            v |= (uint32_t)(P.sm[i].tx.count & 0xFu) << (8 * i);
+            v |= (uint32_t)(P.sm[i].rx.count & 0xFu) << (8 * i + 4);
+        }
+        return v;
+    }
+    if (reg == PIO_REG(irq)) return P.irq;
+    if (reg == PIO_REG(dbg_padout)) return P.pad_out;
+    if (reg == PIO_REG(dbg_padoe)) return P.pad_oe;
+
+    for (uint i = 0; i < NUM_PIO_STATE_MACHINES; ++i) {
+        if (reg == PIO_REG(rxf[0]) + 4 * i) {
+            Sm& s = P.sm[i];
+            return s.rx.count ? s.rx.pop() : 0u;   // RXUNDER
+        }
+        if (reg == PIO_REG(sm[0].addr) + i * sizeof(pio_sm_hw_t)) return P.sm[i].pc;
+        if (reg == PIO_REG(sm[0].instr) + i * sizeof(pio_sm_hw_t)) return current(p, i);
+        if (reg == PIO_REG(sm[0].execctrl) + i * sizeof(pio_sm_hw_t)) {
+            return (h->sm[i].execctrl & ~EXEC_STALLED) | (P.sm[i].exec_pending ? EXEC_STALLED : 0u);
+        }
+    }
+
+    if (reg == PIO_REG(ctrl)) {
+        uint32_t v = 0;
+        for (uint i = 0; i < NUM_PIO_STATE_MACHINES; ++i) {
+            if (P.sm[i].enabled) v |= 1u << i;
+        }
+        return v;
+    }
+
+    return *(const volatile uint32_t*)((const uint8_t*)h + reg);
+}
+
+void bus_write(uint p, uint32_t reg, uint32_t v, uint32_t alias) {
+    Pio&      P = pios[p];
+    pio_hw_t* h = hw(p);
+    volatile uint32_t* field_p = (volatile uint32_t*)((uint8_t*)h + reg);
+
+    if (reg == PIO_REG(ctrl)) {
+        const uint32_t cur = bus_read(p, reg);
+        const uint32_t nv  = alias_apply(cur, v, alias);
+        // RESTART / CLKDIV_RESTART are strobes: the written bits, not the merged value
+        const uint32_t strobe = (alias == ALIAS_CLR) ? 0u : v;
+
+        for (uint i = 0; i < NUM_PIO_STATE_MACHINES; ++i) {
+            Sm& s = P.sm[i];
+            if (strobe & (1u << (4 + i))) restart(p, i);
+            const bool en = (nv >> i) & 1u;
+            if ((strobe & (1u << (8 + i))) || (en && !s.enabled)) s.nt = (now() + 1) << 8;
+            s.enabled = en;
+        }
+        h->ctrl = nv & 0xFu;
+        return;
+    }
+
+    if (reg == PIO_REG(irq)) {
+        P.irq &= (uint8_t)~(v & 0xFFu);
+        return;
+    }
+    if (reg == PIO_REG(irq_force)) {
+        P.irq |= (uint8_t)(v & 0xFFu);
+        return;
+    }
+
+    for (uint i = 0; i < NUM_PIO_STATE_MACHINES; ++i) {
+        if (reg == PIO_REG(txf[0]) + 4 * i) {
+            Sm& s = P.sm[i];
+            if (s.tx.count < tx_cap(p, i)) s.tx.push(v);   // else TXOVER: dropped
+            return;
+        }
+        const uint32_t base = PIO_REG(sm[0]) + i * (uint32_t)sizeof(pio_sm_hw_t);
+        if (reg == base + offsetof(pio_sm_hw_t, instr)) {
+            exec_now(p, i, (uint16_t)v);
+            return;
+        }
+        if (reg == base + offsetof(pio_sm_hw_t, shiftctrl)) {
+            const uint32_t old = h->sm[i].shiftctrl;
+            const uint32_t nv  = alias_apply(old, v, alias);
+            h->sm[i].shiftctrl = nv;
+            const uint32_t join = PIO_SM0_SHIFTCTRL_FJOIN_TX_BITS | PIO_SM0_SHIFTCTRL_FJOIN_RX_BITS;
+            if ((old ^ nv) & join) clear_fifos(p, i);
+            return;
+        }
+    }
+
+    *field_p = alias_apply(*field_p, v, alias);
+}
+
+} // namespace pio_sim
+} // namespace sim
@@ -0,0 +1,241 @@
+#include "sim_model.hpp"
+
+#include <cstddef>
+
+// ============================================================
+// PWM model
+//   - free-running, trailing edge: output = (ctr < CC), counter
+//     0..TOP, fractional divider 8.4 (INT 0 = 256)
+//   - CC / TOP registers are the buffers, latched at wrap
+//     (immediately while the slice is disabled)
+//   - wrap: INTR bit, DREQ_PWM_WRAP0 + slice
+//   - a stopped slice keeps driving its last compare result
+//   Phase-correct and the B-input divider modes are not modelled.
+// ============================================================
+
+namespace sim {
+namespace pwm_sim {
+
+namespace {
+
+struct Slice {
+    bool     enabled;
+    uint32_t ctr;
+    uint32_t top;       // active (latched)
+    uint32_t cc;        // active (latched)
+    uint64_t nt;        // next count, 1/16 cycle
+};
+
+Slice    slices[NUM_PWM_SLICES];
+uint32_t intr_raw;
+
+inline pwm_slice_hw_t& regs(uint s) { return pwm_regs()->slice[s]; }
+
+inline uint32_t div16(uint s) {
+    uint32_t d = regs(s).div & 0xFFFu;
+    if ((d >> PWM_CH0_DIV_INT_LSB) == 0) d += 256u << PWM_CH0_DIV_INT_LSB;
+    return d;
+}
+
+inline bool chan_out(uint s, uint chan) {
+    const Slice& sl = slices[s];
+    const uint32_t cc  = (sl.cc >> (chan ? PWM_CH0_CC_B_LSB : 0u)) & 0xFFFFu;
+    const uint32_t inv = chan ? PWM_CH0_CSR_B_INV_BITS : PWM_CH0_CSR_A_INV_BITS;
+    return (sl.ctr < cc) != ((regs(s).csr & inv) != 0);
+}
+
+// both pads of a slice (GPIO n and n + 16 share slice (n >> 1) & 7)
+void refresh_pads(uint s, uint64_t t) {
+    for (uint pin = 0; pin < NUM_BANK0_GPIOS; ++pin) {
+        if (pwm_gpio_to_slice_num(pin) == s) pad_refresh(pin, t);
+    }
+}
+
+void latch(uint s) {
+    slices[s].top = regs(s).top & 0xFFFFu;
+    slices[s].cc  = regs(s).cc;
+}
+
+// counts until the next output edge or wrap (>= 1)
+uint32_t counts_to_event(uint s) {
+    const Slice& sl = slices[s];
+    if (sl.ctr >= sl.top) return 1;
+    uint32_t k = sl.top - sl.ctr + 1u;   // wrap
+
+    for (uint chan = 0; chan < 2; ++chan) {
+        const uint32_t cc = (sl.cc >> (chan ? PWM_CH0_CC_B_LSB : 0u)) & 0xFFFFu;
+        if (sl.ctr < cc && cc <= sl.top) {
+            const uint32_t kc = cc - sl.ctr;
+            if (kc < k) k = kc;
+        }
+    }
+    return k;
+}
+
+inline uint64_t count_time(const Slice& sl, uint s, uint64_t k) {
+    return (sl.nt + k * div16(s)) >> 4;
+}
+
+void count(uint s, uint64_t t) {
+    Slice& sl = slices[s];
+    sl.nt += div16(s);
+
+    if (sl.ctr >= sl.top) {
+        sl.ctr = 0;
+        latch(s);
+        intr_raw |= 1u << s;
+        dma_sim::pwm_wrap(s);
+    } else {
+        sl.ctr++;
+    }
+    refresh_pads(s, t);
+}
+
+void set_enabled(uint s, bool en) {
+    Slice& sl = slices[s];
+    if (en == sl.enabled) return;
+
+    if (en) {
+        if (regs(s).csr & PWM_CH0_CSR_PH_CORRECT_BITS) fatal("pwm slice %u: phase-correct mode not modelled", s);
+        if ((regs(s).csr >> PWM_CH0_CSR_DIVMODE_LSB) & 3u) fatal("pwm slice %u: divider mode not modelled", s);
+        sl.nt = ((now() + 1) << 4) + div16(s) - 16u;
+    }
+    sl.enabled = en;
+}
+
+constexpr uint32_t SLICE_WINDOW = sizeof(pwm_slice_hw_t);
+constexpr uint32_t REG_EN   = NUM_PWM_SLICES * SLICE_WINDOW;
+constexpr uint32_t REG_INTR = REG_EN + 4;
+constexpr uint32_t REG_INTE = REG_EN + 8;
+constexpr uint32_t REG_INTF = REG_EN + 12;
+constexpr uint32_t REG_INTS = REG_EN + 16;
+
+inline uint32_t ints() {
+    return (intr_raw & pwm_regs()->inte) | pwm_regs()->intf;
+}
+
+} // namespace
+
+// ============================================================
+// scheduler interface
+// ============================================================
+
+void reset() {
+    for (uint s = 0; s < NUM_PWM_SLICES; ++s) slices[s] = Slice{};
+    intr_raw = 0;
+}
+
+uint64_t next_event(uint64_t t) {
+    uint64_t e = NEVER;
+    for (uint s = 0; s < NUM_PWM_SLICES; ++s) {
+        const Slice& sl = slices[s];
+        if (!sl.enabled) continue;
+        const uint64_t n = count_time(sl, s, counts_to_event(s) - 1u);
+        if (n < e) e = n;
+    }
+    return (e < t) ? t : e;
+}
+
+void skip(uint64_t to) {
+    for (uint s = 0; s < NUM_PWM_SLICES; ++s) {
+        Slice& sl = slices[s];
+        if (!sl.enabled || (sl.nt >> 4) > to) continue;
+
+        // counts at cycles <= to, all before the next event
+        const uint64_t d = div16(s);
+        uint64_t n = (((to + 1) << 4) - sl.nt + d - 1) / d;
+        const uint32_t k = counts_to_event(s) - 1u;
+        if (n > k) fatal("pwm slice %u: skip crosses an edge", s);
+
+        sl.ctr += (uint32_t)n;
+        sl.nt  += n * d;
+    }
+}
+
+void step(uint64_t t) {
+    for (uint s = 0; s < NUM_PWM_SLICES; ++s) {
+        Slice& sl = slices[s];
+        if (sl.enabled && (sl.nt >> 4) == t) count(s, t);
+    }
+}
+
+bool out_level(uint pin) {
+    return chan_out(pwm_gpio_to_slice_num(pin), pwm_gpio_to_channel(pin));
+}
+
+bool irq_line() { return ints() != 0; }
+
+// ============================================================
+// register window
+// ============================================================
+
+uint32_t bus_read(uint32_t reg) {
+    if (reg < REG_EN) {
+        const uint s = reg / SLICE_WINDOW;
+        const uint32_t off = reg % SLICE_WINDOW;
+        if (off == offsetof(pwm_slice_hw_t, ctr)) return slices[s].ctr;
+        if (off == offsetof(pwm_slice_hw_t, csr)) {
+            return (regs(s).csr & ~PWM_CH0_CSR_EN_BITS) | (slices[s].enabled ? PWM_CH0_CSR_EN_BITS : 0u);
+        }
+        return *(const volatile uint32_t*)((const uint8_t*)pwm_regs() + reg);
+    }
+
+    switch (reg) {
+        case REG_EN: {
+            uint32_t v = 0;
+            for (uint s = 0; s < NUM_PWM_SLICES; ++s) {
+                if (slices[s].enabled) v |= 1u << s;
+            }
+            return v;
+        }
+        case REG_INTR: return intr_raw;
+        case REG_INTS: return ints();
+        default:       return *(const volatile uint32_t*)((const uint8_t*)pwm_regs() + reg);
+    }
+}
+
+void bus_write(uint32_t reg, uint32_t v, uint32_t alias) {
+    const uint64_t t = now();
+
+    if (reg < REG_EN) {
+        const uint s = reg / SLICE_WINDOW;
+        const uint32_t off = reg % SLICE_WINDOW;
+        pwm_slice_hw_t& r = regs(s);
+
+        if (off == offsetof(pwm_slice_hw_t, ctr)) {
+            slices[s].ctr = alias_apply(slices[s].ctr, v, alias) & 0xFFFFu;
+        } else if (off == offsetof(pwm_slice_hw_t, csr)) {
+            const uint32_t nv = alias_apply(bus_read(reg), v, alias);
+            r.csr = nv & ~PWM_CH0_CSR_EN_BITS;
+            set_enabled(s, (nv & PWM_CH0_CSR_EN_BITS) != 0);
+        } else {
+            volatile uint32_t* p = (volatile uint32_t*)((uint8_t*)pwm_regs() + reg);
+            *p = alias_apply(*p, v, alias);
+            if (!slices[s].enabled) latch(s);
+        }
+        refresh_pads(s, t);
+        return;
+    }
+
+    switch (reg) {
+        case REG_EN: {
+            const uint32_t nv = alias_apply(bus_read(reg), v, alias);
+            for (uint s = 0; s < NUM_PWM_SLICES; ++s) set_enabled(s, (nv >> s) & 1u);
+            return;
+        }
+        case REG_INTR:
+            intr_raw &= ~v;   // write 1 to clear
+            return;
+        case REG_INTE:
+        case REG_INTF: {
+            volatile uint32_t* p = (volatile uint32_t*)((uint8_t*)pwm_regs() + reg);
+            *p = alias_apply(*p, v, alias);
+            return;
+        }
+        default:
+            fatal("pwm: write to unmodelled register 0x%03x", reg);
+    }
+}
+
+} // namespace pwm_sim
+} // namespace sim
@@ -0,0 +1,548 @@
+#include "sim_model.hpp"
+
+#include "pico/stdlib.h"
+#include "pico/platform.h"
+#include "hardware/clocks.h"
+#include "hardware/sync.h"
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+
+// ============================================================
+// SDK functions of the shim headers
+//   Everything goes through the register windows (sim::bus_*),
+//   the same accesses the real SDK performs, so the models see
+//   the side effects (FIFO push, trigger, enable, W1C).
+// ============================================================
+
+namespace {
+
+inline uint32_t rd(const volatile void* reg) {
+    return sim::bus_read(sim::bus_addr(reg), 4);
+}
+
+inline void wr(const volatile void* reg, uint32_t v) {
+    sim::bus_write(sim::bus_addr(reg), v, 4);
+}
+
+inline void wr_masked(io_rw_32* reg, uint32_t v, uint32_t mask) {
+    hw_xor_bits(reg, (rd(reg) ^ v) & mask);
+}
+
+uint32_t pio_program_mask[NUM_PIOS];
+uint32_t pio_claimed[NUM_PIOS];
+uint32_t dma_claimed;
+spin_lock_t spin_locks[NUM_SPIN_LOCKS];
+
+} // namespace
+
+// ============================================================
+// pico/stdlib.h, timer, clocks
+// ============================================================
+
+bool stdio_init_all() { return true; }
+
+void sleep_us(uint64_t us) { sim::run_us(us); }
+void sleep_ms(uint32_t ms) { sim::run_us((uint64_t)ms * 1000u); }
+
+void busy_wait_us_32(uint32_t us) { sim::run_us(us); }
+void busy_wait_us(uint64_t us) { sim::run_us(us); }
+
+void tight_loop_contents() { sim::run_cycles(sim::options().poll_cycles); }
+
+uint64_t time_us_64() { return sim::now() / sim::cycles_per_us(); }
+uint32_t time_us_32() { return (uint32_t)time_us_64(); }
+
+void panic(const char* fmt, ...) {
+    std::fprintf(stderr, "*** PANIC ***\n");
+    va_list ap;
+    va_start(ap, fmt);
+    std::vfprintf(stderr, fmt, ap);
+    va_end(ap);
+    std::fputc('\n', stderr);
+    std::exit(4);
+}
+
+uint32_t clock_get_hz(enum clock_index clk_index) {
+    switch (clk_index) {
+        case clk_sys:
+        case clk_peri: return sim::f_sys();
+        case clk_ref:  return 12000000u;
+        case clk_rtc:  return 46875u;
+        default:       return 48000000u;
+    }
+}
+
+// ============================================================
+// pico/platform.h, hardware/sync.h, hardware/irq.h
+// ============================================================
+
+uint __get_current_exception() {
+    const int irq = sim::irq_active();
+    return (irq < 0) ? 0u : 16u + (uint)irq;
+}
+
+uint32_t save_and_disable_interrupts() {
+    const uint32_t was = sim::irq_masked() ? 1u : 0u;
+    sim::irq_mask(true);
+    return was;
+}
+
+void restore_interrupts(uint32_t status) {
+    sim::irq_mask(status != 0);
+}
+
+spin_lock_t* spin_lock_instance(uint lock_num) { return &spin_locks[lock_num]; }
+
+uint32_t spin_lock_blocking(spin_lock_t* lock) {
+    const uint32_t saved = save_and_disable_interrupts();
+    if (*lock) panic("spin lock %u taken twice (single core)", (uint)(lock - spin_locks));
+    *lock = 1;
+    return saved;
+}
+
+void spin_unlock(spin_lock_t* lock, uint32_t saved_irq) {
+    *lock = 0;
+    restore_interrupts(saved_irq);
+}
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler) { sim::irq_set_handler(num, handler); }
+
+void irq_add_shared_handler(uint num, irq_handler_t handler, uint8_t order_priority) {
+    sim::irq_add_handler(num, handler, order_priority);
+}
+
+void irq_remove_handler(uint num, irq_handler_t handler) { sim::irq_drop_handler(num, handler); }
+
+void irq_set_enabled(uint num, bool enabled) { sim::irq_enable_line(num, enabled); }
+
+bool irq_is_enabled(uint num) { return sim::irq_line_enabled(num); }
+
+// ============================================================
+// hardware/pio.h
+// ============================================================
+
+PIO pio_get_instance(uint instance) { return sim::pio_regs(instance); }
+
+uint pio_get_index(PIO pio) {
+    for (uint i = 0; i < NUM_PIOS; ++i) {
+        if (sim::pio_regs(i) == pio) return i;
+    }
+    panic("not a PIO instance");
+}
+
+uint pio_get_dreq(PIO pio, uint sm, bool is_tx) {
+    return DREQ_PIO0_TX0 + pio_get_index(pio) * 8u + (is_tx ? 0u : 4u) + sm;
+}
+
+namespace {
+
+inline uint32_t program_mask(const pio_program_t* program) {
+    return (program->length >= 32) ? ~0u : (1u << program->length) - 1u;
+}
+
+// SDK placement: fixed origin, else the highest free offset
+int find_offset(PIO pio, const pio_program_t* program) {
+    const uint32_t used = pio_program_mask[pio_get_index(pio)];
+    const uint32_t mask = program_mask(program);
+
+    if (program->origin >= 0) {
+        if ((uint)program->origin + program->length > 32) return -1;
+        return (used & (mask << program->origin)) ? -1 : program->origin;
+    }
+    for (int off = 32 - program->length; off >= 0; --off) {
+        if (!(used & (mask << off))) return off;
+    }
+    return -1;
+}
+
+} // namespace
+
+bool pio_can_add_program(PIO pio, const pio_program_t* program) {
+    return find_offset(pio, program) >= 0;
+}
+
+bool pio_can_add_program_at_offset(PIO pio, const pio_program_t* program, uint offset) {
+    if (program->origin >= 0 && (uint)program->origin != offset) return false;
+    if (offset + program->length > 32) return false;
+    return !(pio_program_mask[pio_get_index(pio)] & (program_mask(program) << offset));
+}
+
+void pio_add_program_at_offset(PIO pio, const pio_program_t* program, uint offset) {
+    if (!pio_can_add_program_at_offset(pio, program, offset)) panic("No program space");
+
+    for (uint i = 0; i < program->length; ++i) {
+        uint16_t ins = program->instructions[i];
+        if ((ins >> 13) == 0) ins = (uint16_t)(ins + offset);   // relocate JMP
+        wr(&pio->instr_mem[offset + i], ins);
+    }
+    pio_program_mask[pio_get_index(pio)] |= program_mask(program) << offset;
+}
+
+uint pio_add_program(PIO pio, const pio_program_t* program) {
+    const int off = find_offset(pio, program);
+    if (off < 0) panic("No program space");
+    pio_add_program_at_offset(pio, program, (uint)off);
+    return (uint)off;
+}
+
+void pio_remove_program(PIO pio, const pio_program_t* program, uint loaded_offset) {
+    pio_program_mask[pio_get_index(pio)] &= ~(program_mask(program) << loaded_offset);
+}
+
+void pio_clear_instruction_memory(PIO pio) {
+    for (uint i = 0; i < 32; ++i) wr(&pio->instr_mem[i], pio_encode_jmp(i));
+    pio_program_mask[pio_get_index(pio)] = 0;
+}
+
+void pio_sm_claim(PIO pio, uint sm) {
+    uint32_t& m = pio_claimed[pio_get_index(pio)];
+    if (m & (1u << sm)) panic("PIO %u SM %u already claimed", pio_get_index(pio), sm);
+    m |= 1u << sm;
+}
+
+void pio_sm_unclaim(PIO pio, uint sm) {
+    pio_claimed[pio_get_index(pio)] &= ~(1u << sm);
+}
+
+int pio_claim_unused_sm(PIO pio, bool required) {
+    uint32_t& m = pio_claimed[pio_get_index(pio)];
+    for (uint sm = 0; sm < NUM_PIO_STATE_MACHINES; ++sm) {
+        if (!(m & (1u << sm))) {
+            m |= 1u << sm;
+            return (int)sm;
+        }
+    }
+    if (required) panic("No PIO state machines are available");
+    return -1;
+}
+
+bool pio_sm_is_claimed(PIO pio, uint sm) {
+    return (pio_claimed[pio_get_index(pio)] >> sm) & 1u;
+}
+
+void pio_gpio_init(PIO pio, uint pin) {
+    gpio_set_function(pin, (gpio_function_t)((uint)GPIO_FUNC_PIO0 + pio_get_index(pio)));
+}
+
+void pio_sm_set_config(PIO pio, uint sm, const pio_sm_config* config) {
+    wr(&pio->sm[sm].clkdiv, config->clkdiv);
+    wr(&pio->sm[sm].execctrl, config->execctrl);
+    wr(&pio->sm[sm].shiftctrl, config->shiftctrl);
+    wr(&pio->sm[sm].pinctrl, config->pinctrl);
+}
+
+int pio_sm_init(PIO pio, uint sm, uint initial_pc, const pio_sm_config* config) {
+    pio_sm_set_enabled(pio, sm, false);
+
+    if (config) {
+        pio_sm_set_config(pio, sm, config);
+    } else {
+        const pio_sm_config c = pio_get_default_sm_config();
+        pio_sm_set_config(pio, sm, &c);
+    }
+
+    pio_sm_clear_fifos(pio, sm);
+    pio_sm_restart(pio, sm);
+    pio_sm_clkdiv_restart(pio, sm);
+    pio_sm_exec(pio, sm, pio_encode_jmp(initial_pc));
+    return 0;
+}
+
+void pio_sm_set_enabled(PIO pio, uint sm, bool enabled) {
+    if (enabled) hw_set_bits(&pio->ctrl, 1u << sm);
+    else         hw_clear_bits(&pio->ctrl, 1u << sm);
+}
+
+void pio_set_sm_mask_enabled(PIO pio, uint32_t mask, bool enabled) {
+    if (enabled) hw_set_bits(&pio->ctrl, mask & 0xFu);
+    else         hw_clear_bits(&pio->ctrl, mask & 0xFu);
+}
+
+void pio_enable_sm_mask_in_sync(PIO pio, uint32_t mask) {
+    hw_set_bits(&pio->ctrl, (mask & 0xFu) | ((mask & 0xFu) << 8));
+}
+
+void pio_sm_restart(PIO pio, uint sm) { hw_set_bits(&pio->ctrl, 1u << (4 + sm)); }
+
+void pio_sm_clkdiv_restart(PIO pio, uint sm) { hw_set_bits(&pio->ctrl, 1u << (8 + sm)); }
+
+void pio_sm_exec(PIO pio, uint sm, uint instr) { wr(&pio->sm[sm].instr, instr); }
+
+bool pio_sm_is_exec_stalled(PIO pio, uint sm) { return (rd(&pio->sm[sm].execctrl) >> 31) != 0; }
+
+void pio_sm_exec_wait_blocking(PIO pio, uint sm, uint instr) {
+    pio_sm_exec(pio, sm, instr);
+    while (pio_sm_is_exec_stalled(pio, sm)) tight_loop_contents();
+}
+
+void pio_sm_set_wrap(PIO pio, uint sm, uint wrap_target, uint wrap) {
+    wr_masked(&pio->sm[sm].execctrl,
+              (wrap_target << PIO_SM0_EXECCTRL_WRAP_BOTTOM_LSB) | (wrap << PIO_SM0_EXECCTRL_WRAP_TOP_LSB),
+              (0x1Fu << PIO_SM0_EXECCTRL_WRAP_BOTTOM_LSB) | (0x1Fu << PIO_SM0_EXECCTRL_WRAP_TOP_LSB));
+}
+
+void pio_sm_set_clkdiv_int_frac(PIO pio, uint sm, uint16_t div_int, uint8_t div_frac) {
+    wr(&pio->sm[sm].clkdiv, ((uint32_t)div_frac << PIO_SM0_CLKDIV_FRAC_LSB) |
+                            ((uint32_t)div_int << PIO_SM0_CLKDIV_INT_LSB));
+}
+
+void pio_sm_set_clkdiv(PIO pio, uint sm, float div) {
+    const uint16_t di = (uint16_t)div;
+    const uint8_t  df = (di == 0) ? 0 : (uint8_t)((div - (float)di) * 256.0f);
+    pio_sm_set_clkdiv_int_frac(pio, sm, di, df);
+}
+
+uint8_t pio_sm_get_pc(PIO pio, uint sm) { return (uint8_t)rd(&pio->sm[sm].addr); }
+
+// SDK approach: one exec'd SET per pin with a 1-pin SET window
+namespace {
+
+void set_pins_exec(PIO pio, uint sm, uint32_t values, uint32_t mask, enum pio_src_dest dest) {
+    const uint32_t pinctrl_saved  = rd(&pio->sm[sm].pinctrl);
+    const uint32_t execctrl_saved = rd(&pio->sm[sm].execctrl);
+    hw_clear_bits(&pio->sm[sm].execctrl, PIO_SM0_EXECCTRL_OUT_STICKY_BITS);
+
+    while (mask) {
+        const uint base = (uint)__builtin_ctz(mask);
+        wr(&pio->sm[sm].pinctrl, (1u << PIO_SM0_PINCTRL_SET_COUNT_LSB) | (base << PIO_SM0_PINCTRL_SET_BASE_LSB));
+        pio_sm_exec(pio, sm, pio_encode_set(dest, (values >> base) & 1u));
+        mask &= mask - 1u;
+    }
+
+    wr(&pio->sm[sm].pinctrl, pinctrl_saved);
+    wr(&pio->sm[sm].execctrl, execctrl_saved);
+}
+
+} // namespace
+
+void pio_sm_set_pins(PIO pio, uint sm, uint32_t pin_values) {
+    set_pins_exec(pio, sm, pin_values, (1u << NUM_BANK0_GPIOS) - 1u, pio_pins);
+}
+
+void pio_sm_set_pins_with_mask(PIO pio, uint sm, uint32_t pin_values, uint32_t pin_mask) {
+    set_pins_exec(pio, sm, pin_values, pin_mask, pio_pins);
+}
+
+void pio_sm_set_pindirs_with_mask(PIO pio, uint sm, uint32_t pin_dirs, uint32_t pin_mask) {
+    set_pins_exec(pio, sm, pin_dirs, pin_mask, pio_pindirs);
+}
+
+int pio_sm_set_consecutive_pindirs(PIO pio, uint sm, uint pin_base, uint pin_count, bool is_out) {
+    const uint32_t mask = ((pin_count >= 32) ? ~0u : (1u << pin_count) - 1u) << pin_base;
+    pio_sm_set_pindirs_with_mask(pio, sm, is_out ? mask : 0u, mask);
+    return 0;
+}
+
+void pio_interrupt_clear(PIO pio, uint pio_interrupt_num) { wr(&pio->irq, 1u << pio_interrupt_num); }
+
+bool pio_interrupt_get(PIO pio, uint pio_interrupt_num) { return (rd(&pio->irq) >> pio_interrupt_num) & 1u; }
+
+bool pio_sm_is_rx_fifo_full(PIO pio, uint sm) { return (rd(&pio->fstat) >> (0 + sm)) & 1u; }
+bool pio_sm_is_rx_fifo_empty(PIO pio, uint sm) { return (rd(&pio->fstat) >> (8 + sm)) & 1u; }
+bool pio_sm_is_tx_fifo_full(PIO pio, uint sm) { return (rd(&pio->fstat) >> (16 + sm)) & 1u; }
+bool pio_sm_is_tx_fifo_empty(PIO pio, uint sm) { return (rd(&pio->fstat) >> (24 + sm)) & 1u; }
+
+uint pio_sm_get_rx_fifo_level(PIO pio, uint sm) { return (rd(&pio->flevel) >> (8 * sm + 4)) & 0xFu; }
+uint pio_sm_get_tx_fifo_level(PIO pio, uint sm) { return (rd(&pio->flevel) >> (8 * sm)) & 0xFu; }
+
+void pio_sm_put(PIO pio, uint sm, uint32_t data) { wr(&pio->txf[sm], data); }
+
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data) {
+    while (pio_sm_is_tx_fifo_full(pio, sm)) tight_loop_contents();
+    pio_sm_put(pio, sm, data);
+}
+
+uint32_t pio_sm_get(PIO pio, uint sm) { return rd(&pio->rxf[sm]); }
+
+uint32_t pio_sm_get_blocking(PIO pio, uint sm) {
+    while (pio_sm_is_rx_fifo_empty(pio, sm)) tight_loop_contents();
+    return pio_sm_get(pio, sm);
+}
+
+void pio_sm_clear_fifos(PIO pio, uint sm) {
+    hw_xor_bits(&pio->sm[sm].shiftctrl, PIO_SM0_SHIFTCTRL_FJOIN_RX_BITS);
+    hw_xor_bits(&pio->sm[sm].shiftctrl, PIO_SM0_SHIFTCTRL_FJOIN_RX_BITS);
+}
+
+void pio_sm_drain_tx_fifo(PIO pio, uint sm) {
+    const uint instr = (rd(&pio->sm[sm].shiftctrl) & PIO_SM0_SHIFTCTRL_AUTOPULL_BITS)
+                           ? pio_encode_out(pio_null, 32)
+                           : pio_encode_pull(false, false);
+    while (!pio_sm_is_tx_fifo_empty(pio, sm)) pio_sm_exec(pio, sm, instr);
+}
+
+// ============================================================
+// hardware/dma.h
+// ============================================================
+
+dma_channel_config dma_channel_get_default_config(uint channel) {
+    dma_channel_config c = {0};
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, DREQ_FORCE);
+    channel_config_set_chain_to(&c, channel);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_ring(&c, false, 0);
+    channel_config_set_bswap(&c, false);
+    channel_config_set_irq_quiet(&c, false);
+    channel_config_set_enable(&c, true);
+    channel_config_set_sniff_enable(&c, false);
+    channel_config_set_high_priority(&c, false);
+    return c;
+}
+
+dma_channel_config dma_get_channel_config(uint channel) {
+    dma_channel_config c = {rd(&dma_hw->ch[channel].al1_ctrl) & ~DMA_CH0_CTRL_TRIG_BUSY_BITS};
+    return c;
+}
+
+void dma_channel_claim(uint channel) {
+    if (dma_claimed & (1u << channel)) panic("DMA channel %u is already claimed", channel);
+    dma_claimed |= 1u << channel;
+}
+
+void dma_channel_unclaim(uint channel) { dma_claimed &= ~(1u << channel); }
+
+int dma_claim_unused_channel(bool required) {
+    for (uint ch = 0; ch < NUM_DMA_CHANNELS; ++ch) {
+        if (!(dma_claimed & (1u << ch))) {
+            dma_claimed |= 1u << ch;
+            return (int)ch;
+        }
+    }
+    if (required) panic("No DMA channels are available");
+    return -1;
+}
+
+bool dma_channel_is_claimed(uint channel) { return (dma_claimed >> channel) & 1u; }
+
+void dma_channel_set_config(uint channel, const dma_channel_config* config, bool trigger) {
+    if (trigger) wr(&dma_hw->ch[channel].ctrl_trig, config->ctrl);
+    else         wr(&dma_hw->ch[channel].al1_ctrl, config->ctrl);
+}
+
+void dma_channel_set_read_addr(uint channel, const volatile void* read_addr, bool trigger) {
+    const uint32_t a = sim::bus_addr(read_addr);
+    if (trigger) wr(&dma_hw->ch[channel].al3_read_addr_trig, a);
+    else         wr(&dma_hw->ch[channel].read_addr, a);
+}
+
+void dma_channel_set_write_addr(uint channel, volatile void* write_addr, bool trigger) {
+    const uint32_t a = sim::bus_addr(write_addr);
+    if (trigger) wr(&dma_hw->ch[channel].al2_write_addr_trig, a);
+    else         wr(&dma_hw->ch[channel].write_addr, a);
+}
+
+void dma_channel_set_trans_count(uint channel, uint32_t trans_count, bool trigger) {
+    if (trigger) wr(&dma_hw->ch[channel].al1_transfer_count_trig, trans_count);
+    else         wr(&dma_hw->ch[channel].transfer_count, trans_count);
+}
+
+void dma_channel_configure(uint channel, const dma_channel_config* config,
+                           volatile void* write_addr, const volatile void* read_addr,
+                           uint transfer_count, bool trigger) {
+    dma_channel_set_read_addr(channel, read_addr, false);
+    dma_channel_set_write_addr(channel, write_addr, false);
+    dma_channel_set_trans_count(channel, transfer_count, false);
+    dma_channel_set_config(channel, config, trigger);
+}
+
+void dma_channel_start(uint channel) { dma_start_channel_mask(1u << channel); }
+
+void dma_start_channel_mask(uint32_t chan_mask) { sim::dma_sim::start(chan_mask); }
+
+void dma_channel_abort(uint channel) { sim::dma_sim::abort(channel); }
+
+bool dma_channel_is_busy(uint channel) {
+    return (rd(&dma_hw->ch[channel].al1_ctrl) & DMA_CH0_CTRL_TRIG_BUSY_BITS) != 0;
+}
+
+void dma_channel_wait_for_finish_blocking(uint channel) {
+    while (dma_channel_is_busy(channel)) tight_loop_contents();
+}
+
+void dma_channel_set_irq0_enabled(uint channel, bool enabled) {
+    if (enabled) hw_set_bits(&dma_hw->inte0, 1u << channel);
+    else         hw_clear_bits(&dma_hw->inte0, 1u << channel);
+}
+
+void dma_channel_set_irq1_enabled(uint channel, bool enabled) {
+    if (enabled) hw_set_bits(&dma_hw->inte1, 1u << channel);
+    else         hw_clear_bits(&dma_hw->inte1, 1u << channel);
+}
+
+bool dma_channel_get_irq0_status(uint channel) { return (rd(&dma_hw->ints0) >> channel) & 1u; }
+bool dma_channel_get_irq1_status(uint channel) { return (rd(&dma_hw->ints1) >> channel) & 1u; }
+
+void dma_channel_acknowledge_irq0(uint channel) { wr(&dma_hw->ints0, 1u << channel); }
+void dma_channel_acknowledge_irq1(uint channel) { wr(&dma_hw->ints1, 1u << channel); }
+
+// ============================================================
+// hardware/pwm.h
+// ============================================================
+
+void pwm_init(uint slice_num, const pwm_config* c, bool start) {
+    pwm_slice_hw_t& s = pwm_hw->slice[slice_num];
+    wr(&s.csr, 0);
+    wr(&s.ctr, 0);
+    wr(&s.cc, 0);
+    wr(&s.top, c->top);
+    wr(&s.div, c->div);
+    wr(&s.csr, c->csr | (start ? PWM_CH0_CSR_EN_BITS : 0u));
+}
+
+void pwm_set_enabled(uint slice_num, bool enabled) {
+    wr_masked(&pwm_hw->slice[slice_num].csr, enabled ? PWM_CH0_CSR_EN_BITS : 0u, PWM_CH0_CSR_EN_BITS);
+}
+
+void pwm_set_mask_enabled(uint32_t mask) { wr(&pwm_hw->en, mask); }
+
+void pwm_set_clkdiv_int_frac(uint slice_num, uint8_t integer, uint8_t fract) {
+    // SDK: valid_params_if(HARDWARE_PWM, integer >= 1)
+    if (integer == 0) panic("pwm_set_clkdiv_int_frac: integer 0 (slice %u)", slice_num);
+    wr(&pwm_hw->slice[slice_num].div, ((uint32_t)integer << PWM_CH0_DIV_INT_LSB) | (fract & 0xFu));
+}
+
+void pwm_set_clkdiv(uint slice_num, float divider) {
+    const uint8_t i = (uint8_t)divider;
+    const uint8_t f = (uint8_t)((divider - (float)i) * 16.0f);
+    pwm_set_clkdiv_int_frac(slice_num, i, f);
+}
+
+void pwm_set_wrap(uint slice_num, uint16_t wrap) { wr(&pwm_hw->slice[slice_num].top, wrap); }
+
+void pwm_set_chan_level(uint slice_num, uint chan, uint16_t level) {
+    const uint shift = chan ? PWM_CH0_CC_B_LSB : 0u;
+    wr_masked(&pwm_hw->slice[slice_num].cc, (uint32_t)level << shift, 0xFFFFu << shift);
+}
+
+void pwm_set_both_levels(uint slice_num, uint16_t level_a, uint16_t level_b) {
+    wr(&pwm_hw->slice[slice_num].cc, ((uint32_t)level_b << PWM_CH0_CC_B_LSB) | level_a);
+}
+
+void pwm_set_gpio_level(uint gpio, uint16_t level) {
+    pwm_set_chan_level(pwm_gpio_to_slice_num(gpio), pwm_gpio_to_channel(gpio), level);
+}
+
+void pwm_set_counter(uint slice_num, uint16_t c) { wr(&pwm_hw->slice[slice_num].ctr, c); }
+
+uint16_t pwm_get_counter(uint slice_num) { return (uint16_t)rd(&pwm_hw->slice[slice_num].ctr); }
+
+void pwm_set_output_polarity(uint slice_num, bool a, bool b) {
+    wr_masked(&pwm_hw->slice[slice_num].csr,
+              (a ? PWM_CH0_CSR_A_INV_BITS : 0u) | (b ? PWM_CH0_CSR_B_INV_BITS : 0u),
+              PWM_CH0_CSR_A_INV_BITS | PWM_CH0_CSR_B_INV_BITS);
+}
+
+void pwm_set_irq_enabled(uint slice_num, bool enabled) {
+    if (enabled) hw_set_bits(&pwm_hw->inte, 1u << slice_num);
+    else         hw_clear_bits(&pwm_hw->inte, 1u << slice_num);
+}
+
+void pwm_clear_irq(uint slice_num) { wr(&pwm_hw->intr, 1u << slice_num); }
+
+uint32_t pwm_get_irq_status_mask() { return rd(&pwm_hw->ints); }
+
+uint pwm_get_dreq(uint slice_num) { return DREQ_PWM_WRAP0 + slice_num; }
@@ -0,0 +1,163 @@
+#include "sim_trace.hpp"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace sim {
+
+Trace::Trace() : pins_() {}
+
+Trace::~Trace() { detach(); }
+
+void Trace::watch(uint pin, const char* name) {
+    Watched& w = pins_[pin];
+    w.on      = true;
+    w.name    = name;
+    w.initial = pad(pin);
+    w.edges.clear();
+}
+
+void Trace::attach() { set_pad_listener(&Trace::on_pad, this); }
+
+void Trace::detach() { set_pad_listener(nullptr, nullptr); }
+
+void Trace::clear() {
+    for (uint pin = 0; pin < NUM_BANK0_GPIOS; ++pin) {
+        Watched& w = pins_[pin];
+        if (!w.on) continue;
+        w.initial = pad(pin);
+        w.edges.clear();
+    }
+}
+
+void Trace::on_pad(uint64_t cycle, uint pin, bool level, void* user) {
+    Watched& w = static_cast<Trace*>(user)->pins_[pin];
+    if (w.on) w.edges.push_back(Edge{cycle, level});
+}
+
+const std::vector<Edge>& Trace::edges(uint pin) const { return pins_[pin].edges; }
+
+PinStats Trace::stats(uint pin) const {
+    const Watched& w = pins_[pin];
+    PinStats s{};
+    s.level = w.initial;
+
+    uint64_t rise = 0, fall = 0;
+    bool     have_rise = false, have_fall = false;
+
+    for (const Edge& e : w.edges) {
+        if (e.level == s.level) continue;   // same-cycle glitch merged
+        s.level = e.level;
+
+        if (e.level) {
+            if (have_rise) {
+                const uint64_t p = e.cycle - rise;
+                if (!s.min_period || p < s.min_period) s.min_period = p;
+                if (p > s.max_period) s.max_period = p;
+            }
+            if (have_fall) {
+                const uint64_t l = e.cycle - fall;
+                if (!s.min_low || l < s.min_low) s.min_low = l;
+            }
+            if (!s.rising) s.first_rise = e.cycle;
+            s.rising++;
+            rise      = e.cycle;
+            have_rise = true;
+        } else {
+            if (have_rise) {
+                const uint64_t h = e.cycle - rise;
+                if (!s.min_high || h < s.min_high) s.min_high = h;
+                if (h > s.max_high) s.max_high = h;
+            }
+            s.falling++;
+            s.last_fall = e.cycle;
+            fall        = e.cycle;
+            have_fall   = true;
+        }
+    }
+    return s;
+}
+
+int64_t Trace::position(uint step_pin, uint dir_pin, bool dir_invert) const {
+    const std::vector<Edge>& st = pins_[step_pin].edges;
+    const std::vector<Edge>& di = pins_[dir_pin].edges;
+
+    bool    dir = pins_[dir_pin].initial;
+    size_t  k   = 0;
+    int64_t pos = 0;
+
+    for (const Edge& e : st) {
+        if (!e.level) continue;
+        // DIR as sampled at the STEP edge (changes in the same cycle count)
+        while (k < di.size() && di[k].cycle <= e.cycle) dir = di[k++].level;
+        pos += (dir != dir_invert) ? 1 : -1;
+    }
+    return pos;
+}
+
+uint64_t Trace::min_dir_setup(uint step_pin, uint dir_pin) const {
+    const std::vector<Edge>& st = pins_[step_pin].edges;
+    const std::vector<Edge>& di = pins_[dir_pin].edges;
+
+    uint64_t best = ~0ull;
+    size_t   k    = 0;
+    for (const Edge& d : di) {
+        while (k < st.size() && (st[k].cycle < d.cycle || !st[k].level)) ++k;
+        if (k == st.size()) break;
+        best = std::min(best, st[k].cycle - d.cycle);
+    }
+    return best;
+}
+
+size_t Trace::count_before(uint pin, bool level, uint64_t cycle) const {
+    size_t n = 0;
+    for (const Edge& e : pins_[pin].edges) {
+        if (e.cycle >= cycle) break;
+        if (e.level == level) ++n;
+    }
+    return n;
+}
+
+bool Trace::write_vcd(const char* path) const {
+    FILE* f = std::fopen(path, "w");
+    if (!f) return false;
+
+    const double ns = 1e9 / (double)f_sys();
+
+    std::fprintf(f, "$timescale 1ns $end\n$scope module pulse_mode $end\n");
+    for (uint pin = 0; pin < NUM_BANK0_GPIOS; ++pin) {
+        if (pins_[pin].on) std::fprintf(f, "$var wire 1 %c %s $end\n", (char)('!' + pin), pins_[pin].name);
+    }
+    std::fprintf(f, "$upscope $end\n$enddefinitions $end\n#0\n");
+    for (uint pin = 0; pin < NUM_BANK0_GPIOS; ++pin) {
+        if (pins_[pin].on) std::fprintf(f, "%d%c\n", pins_[pin].initial ? 1 : 0, (char)('!' + pin));
+    }
+
+    // merge the per-pin edge lists by time
+    size_t pos[NUM_BANK0_GPIOS] = {};
+    uint64_t last = ~0ull;
+    for (;;) {
+        int      pick = -1;
+        uint64_t at   = ~0ull;
+        for (uint pin = 0; pin < NUM_BANK0_GPIOS; ++pin) {
+            const Watched& w = pins_[pin];
+            if (w.on && pos[pin] < w.edges.size() && w.edges[pos[pin]].cycle < at) {
+                at   = w.edges[pos[pin]].cycle;
+                pick = (int)pin;
+            }
+        }
+        if (pick < 0) break;
+
+        const Edge& e = pins_[pick].edges[pos[pick]++];
+        if (e.cycle != last) {
+            std::fprintf(f, "#%llu\n", (unsigned long long)((double)e.cycle * ns));
+            last = e.cycle;
+        }
+        std::fprintf(f, "%d%c\n", e.level ? 1 : 0, (char)('!' + pick));
+    }
+
+    std::fclose(f);
+    return true;
+}
+
+} // namespace sim
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "sim_chip.hpp"
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+// ============================================================
+// sim::Trace
+//   Edge recorder on top of the pad listener: every change of a
+//   watched pad with its cycle, plus the statistics the scenarios
+//   check (pulse counts, widths, periods, DIR setup, positions).
+//   One Trace attached at a time (it owns the pad listener).
+// ============================================================
+
+namespace sim {
+
+struct Edge {
+    uint64_t cycle;
+    bool     level;   // level after the edge
+};
+
+// widths / periods in cycles (0 if not measured)
+struct PinStats {
+    uint64_t rising;
+    uint64_t falling;
+    uint64_t min_high;
+    uint64_t max_high;
+    uint64_t min_low;      // between two pulses
+    uint64_t min_period;   // rising to rising
+    uint64_t max_period;
+    uint64_t first_rise;
+    uint64_t last_fall;
+    bool     level;        // current level
+};
+
+class Trace {
+public:
+    Trace();
+    ~Trace();
+
+    void watch(uint pin, const char* name);
+
+    void attach();   // become the pad listener
+    void detach();
+    void clear();    // drop edges, keep the watch list
+
+    const std::vector<Edge>& edges(uint pin) const;
+    PinStats stats(uint pin) const;
+
+    // STEP rising edges weighted by the DIR pad level at each edge
+    // (DIR high = +1), what the drive counts
+    int64_t position(uint step_pin, uint dir_pin, bool dir_invert = false) const;
+
+    // shortest DIR change -> next STEP rising edge (cycles, ~0 if no DIR change)
+    uint64_t min_dir_setup(uint step_pin, uint dir_pin) const;
+
+    // edges of `pin` to `level` strictly before `cycle`
+    size_t count_before(uint pin, bool level, uint64_t cycle) const;
+
+    // Value Change Dump of the watched pins (1 ns timescale)
+    bool write_vcd(const char* path) const;
+
+private:
+    static void on_pad(uint64_t cycle, uint pin, bool level, void* user);
+
+    struct Watched {
+        bool              on;
+        bool              initial;
+        const char*       name;
+        std::vector<Edge> edges;
+    };
+
+    Watched pins_[NUM_BANK0_GPIOS];
+};
+
+} // namespace sim
@@ -0,0 +1,106 @@
+// Axis units: mm / mm/s / mm/s^2 <-> STEP domain, Q16.16 fixed point
+//
+//   steps      = mm      * steps_per_mm
+//   Hz         = mm/s    * steps_per_mm      (clamped to max_rpm)
+//   steps/s^2  = mm/s^2  * steps_per_mm
+//   mm         = steps   * mm_per_step       (precomputed reciprocal)
+//
+// steps_per_mm either given directly or derived from the servo's
+// electronic gear (command pulses per motor revolution, e.g. 32767)
+// and the travel per revolution (screw lead / belt).
+//
+// Everything is computed once (make_axis_scale, PS100_P constructor);
+// a conversion is one 64-bit multiply and a shift, no division,
+// nothing touches float/double (no soft-float on the command path).
+
+#pragma once
+#include <cstdint>
+
+// signed Q16.16: 1.0 == 0x10000 (mm: +-32767, 1/65536 mm resolution)
+using q16_16 = int32_t;
+
+constexpr q16_16 Q16_ONE = 0x10000;
+
+// literals only (evaluated by the compiler): q16(2.5)
+constexpr q16_16 q16(double v) {
+    return (q16_16)(v * 65536.0 + (v < 0 ? -0.5 : 0.5));
+}
+
+// ------------------------------------------------------------
+// Configuration (PS100_P::Config::units)
+// ------------------------------------------------------------
+struct AxisUnits {
+    uint32_t steps_per_mm   = 0;   // Q16.16; 0 => pulses_per_rev / mm_per_rev
+    uint32_t pulses_per_rev = 0;   // electronic gear: command pulses per motor rev
+    uint32_t mm_per_rev     = 0;   // Q16.16, travel per motor rev
+    uint32_t max_rpm        = 0;   // motor speed limit (0 = none, needs pulses_per_rev)
+};
+
+// ------------------------------------------------------------
+// Precomputed scale
+// ------------------------------------------------------------
+struct AxisScale {
+    uint32_t steps_per_mm;      // Q16.16, 0 = no units configured
+    uint64_t mm_per_step_q32;   // reciprocal, Q32.32 (mm per step; steps_per_mm >= 1)
+    uint32_t hz_per_rpm;        // Q16.16, pulses_per_rev / 60
+    uint32_t max_hz;            // from max_rpm, 0 = none
+
+    // |x| * steps_per_mm, rounded to an integer (Q16.16 * Q16.16 >> 32)
+    constexpr uint64_t scale_abs(q16_16 x) const {
+        const uint64_t m = (x < 0) ? (uint64_t)(-(int64_t)x) : (uint64_t)x;
+        return (m * steps_per_mm + 0x80000000ull) >> 32;
+    }
+
+    // distance -> signed steps (saturated)
+    constexpr int32_t mm_to_steps(q16_16 mm) const {
+        const uint64_t s = scale_abs(mm);
+        const int32_t  v = (s > 0x7FFFFFFFull) ? 0x7FFFFFFF : (int32_t)s;
+        return (mm < 0) ? -v : v;
+    }
+
+    // speed (sign ignored) -> STEP Hz, clamped to max_hz
+    constexpr uint32_t mm_s_to_hz(q16_16 mm_s) const {
+        uint64_t hz = scale_abs(mm_s);
+        if (max_hz && hz > max_hz) hz = max_hz;
+        return (hz > 0xFFFFFFFFull) ? 0xFFFFFFFFu : (uint32_t)hz;
+    }
+
+    // acceleration (sign ignored) -> steps/s^2 (queue_steps a_max)
+    constexpr uint32_t mm_s2_to_steps_s2(q16_16 mm_s2) const {
+        const uint64_t a = scale_abs(mm_s2);
+        return (a > 0xFFFFFFFFull) ? 0xFFFFFFFFu : (uint32_t)a;
+    }
+
+    // motor speed (Q16.16 rpm) -> STEP Hz through the electronic gear
+    constexpr uint32_t rpm_to_hz(q16_16 rpm) const {
+        if (rpm <= 0) return 0;
+        const uint64_t hz = ((uint64_t)rpm * hz_per_rpm + 0x80000000ull) >> 32;
+        return (hz > 0xFFFFFFFFull) ? 0xFFFFFFFFu : (uint32_t)hz;
+    }
+
+    // steps -> signed Q16.16 mm (saturated)
+    constexpr q16_16 steps_to_mm(int32_t steps) const {
+        const uint64_t m  = (steps < 0) ? (uint64_t)(-(int64_t)steps) : (uint64_t)steps;
+        const uint64_t mm = (m * mm_per_step_q32 + 0x8000u) >> 16;
+        const q16_16   v  = (mm > 0x7FFFFFFFull) ? 0x7FFFFFFF : (q16_16)mm;
+        return (steps < 0) ? -v : v;
+    }
+};
+
+constexpr AxisScale make_axis_scale(const AxisUnits& u) {
+    uint64_t spm = u.steps_per_mm;
+    if (spm == 0 && u.pulses_per_rev && u.mm_per_rev) {
+        // ppr / (mm_per_rev / 2^16), in Q16.16
+        spm = (((uint64_t)u.pulses_per_rev << 32) + u.mm_per_rev / 2) / u.mm_per_rev;
+        if (spm > 0xFFFFFFFFull) spm = 0xFFFFFFFFull;
+    }
+
+    AxisScale s{};
+    s.steps_per_mm    = (uint32_t)spm;
+    s.mm_per_step_q32 = spm ? ((1ull << 48) + spm / 2) / spm : 0;
+    s.hz_per_rpm      = (uint32_t)((((uint64_t)u.pulses_per_rev << 16) + 30u) / 60u);
+    s.max_hz          = (u.max_rpm && u.pulses_per_rev)
+                      ? (uint32_t)((uint64_t)u.max_rpm * u.pulses_per_rev / 60u)
+                      : 0;
+    return s;
+}
@@ -2,33 +2,51 @@
  * This file defines the timing model of STEP/RADAR pulses
  * generated by RP2040 PIO.
  *
- * All conversions assume:
- *  - Register-loop delay (jmp x--)
- *  - 2 PIO cycles per loop
+ * The per-program cycle formulas live in pio_timing.hpp;
+ * this unit only holds the active clock configuration and
+ * the legacy conversion helpers built on top of it.
  *
  * Changing this file changes the physical timing behavior.
  */
 #include "pio_timing.hpp"
 #include <limits.h>
-#include <math.h>
 
-// ===== PIO timing constants =====
+// ===== Active clock configuration =====
 // ⚠️ 这些是“硬件模型参数”，不是协议参数
-constexpr float PIO_CLK_SYS = 125e6f;
-constexpr float PIO_CLKDIV  = 1.0f;
-constexpr float PIO_FREQ    = PIO_CLK_SYS / PIO_CLKDIV;
+static uint32_t g_f_sys = 125000000u;   // 由 pio_exec 在启动时用 clock_get_hz 覆盖
 
-// STEP pulse high width in PIO loop units (625 == 10us)
+// STEP pulse high width in PIO loop units (625 == 10us @ 125 MHz)
 constexpr uint32_t PULSE_WIDTH = 625;
 
+void pio_timing_configure(uint32_t f_sys_hz)
+{
+    if (f_sys_hz != 0) g_f_sys = f_sys_hz;
+}
+
+uint32_t pio_timing_f_sys()
+{
+    return g_f_sys;
+}
+
+void pio_timing_split_clkdiv(float clk_div, uint32_t& div_int, uint32_t& div_frac)
+{
+    if (!(clk_div >= 1.0f)) clk_div = 1.0f;
+
+    div_int  = (uint32_t)clk_div;
+    div_frac = (uint32_t)((clk_div - (float)div_int) * 256.0f);
+
+    if (div_int > 65535) { div_int = 65535; div_frac = 0; }
+    if (div_frac > 255) div_frac = 255;
+}
+
 uint32_t pulse_us_to_radar_len(uint32_t pulse_us)
 {
-    // pulse_len ≈ (pulse_us * f_pio) / (2 * 1e6)
-    float len = (pulse_us * PIO_FREQ) / (2.0f * 1e6f);
-    uint32_t pulse_len = (uint32_t)(len + 0.5f);
+    const uint64_t f_pio  = pio_timing_f_pio(g_f_sys, 1, 0);
+    const uint64_t cycles = ((uint64_t)pulse_us * f_pio + 500000u) / 1000000u;
 
-    if (pulse_len < 1) pulse_len = 1;
-    return pulse_len;
+    // high = 2 * len + 4 cycles
+    if (cycles <= RADAR_PULSE_FIXED + RADAR_PULSE_PER_LEN) return 1;
+    return (uint32_t)((cycles - RADAR_PULSE_FIXED + 1) / RADAR_PULSE_PER_LEN);
 }
 
 uint32_t speed_hz_to_delay(uint32_t speed_hz)
@@ -38,13 +56,8 @@ uint32_t speed_hz_to_delay(uint32_t speed_hz)
         return UINT32_MAX;
     }
 
-    // f_step = f_pio / (7 + PULSE_WIDTH + 2 * delay)
-    // => delay = 0.5 * (f_pio / f_step - (7 + PW))
-    float d = 0.5f * (PIO_FREQ / (float)speed_hz
-                      - (7.0f + (float)PULSE_WIDTH));
-
-    int32_t delay = (int32_t)(d + 0.5f);
-    if (delay < 1) delay = 1;
+    const PioTiming t = make_pio_timing(
+        MotorExecVariant::AdjustableDuty, g_f_sys, 1, 0, PULSE_WIDTH);
 
-    return (uint32_t)delay;
+    return t.hz_to_duty(speed_hz);   // >= 1
 }
@@ -1,9 +1,202 @@
 // RP2040 PIO timing model utilities
+//
+// Single source of truth for STEP / RADAR timing of every PIO program.
+// Changing this file changes the physical timing behavior.
+//
+//   T_step = (per_duty * duty + per_high * pulse_high + fixed) / f_pio
+//   f_pio  = f_sys / (div_int + div_frac / 256)
+//
+// Cycle counts per motor_exec variant (from the .pio sources):
+//   Exec            high d+4,    low d+4    => 2d + 8
+//   HalfDuty        high d+3,    low d+4    => 2d + 7
+//   HalfDutyV2      high d+4,    low d+4    => 2d + 8
+//   StepOnly        high d+3,    low d+4    => 2d + 7
+//   AdjustableDuty  high 2p+4,   low 2d+8   => 2d + 2p + 12
+//
+// All conversions are 32-bit integer (hardware divider) or a
+// precomputed Q32 reciprocal; nothing here touches float/double.
 
 #pragma once
 #include <cstdint>
 
-// Convert desired STEP frequency (Hz) to PIO delay loop count.
+// ------------------------------------------------------------
+// Program variants
+// ------------------------------------------------------------
+enum class MotorExecVariant : uint8_t {
+    Exec,            // pio/motor_exec.pio (default, progress tokens)
+    HalfDuty,        // pio/motor_exec/motor_exec_half_duty_cycle.pio
+    HalfDutyV2,      // pio/motor_exec/motor_exec_half_duty_cycle_v2.pio
+    StepOnly,        // pio/motor_exec/motor_exec_step_only.pio
+    AdjustableDuty   // pio/motor_exec/motor_exec_ajustable_duty_cycle.pio
+};
+
+template <MotorExecVariant V> struct MotorExecCycles;
+
+template <> struct MotorExecCycles<MotorExecVariant::Exec> {
+    static constexpr uint32_t per_duty = 2, per_high = 0, fixed = 8;
+};
+template <> struct MotorExecCycles<MotorExecVariant::HalfDuty> {
+    static constexpr uint32_t per_duty = 2, per_high = 0, fixed = 7;
+};
+template <> struct MotorExecCycles<MotorExecVariant::HalfDutyV2> {
+    static constexpr uint32_t per_duty = 2, per_high = 0, fixed = 8;
+};
+template <> struct MotorExecCycles<MotorExecVariant::StepOnly> {
+    static constexpr uint32_t per_duty = 2, per_high = 0, fixed = 7;
+};
+template <> struct MotorExecCycles<MotorExecVariant::AdjustableDuty> {
+    static constexpr uint32_t per_duty = 2, per_high = 2, fixed = 12;
+};
+
+// motor_exec.pio command framing (Exec variant, raw and packed alike)
+//   entry (pull .. mov osr) + jmp !y + jmp y--   => +7 cycles per command
+//   [duty, 0] dwell: entry + jmp !y + low half   => duty + 10 cycles
+constexpr uint32_t MOTOR_EXEC_CMD_OVERHEAD = 7;
+constexpr uint32_t MOTOR_EXEC_DWELL_FIXED  = 10;
+
+// radar_sync pulse: set + mov + (nop + jmp) * (len + 1)  => 2len + 4
+constexpr uint32_t RADAR_PULSE_PER_LEN = 2;
+constexpr uint32_t RADAR_PULSE_FIXED   = 4;
+
+// ------------------------------------------------------------
+// Runtime-selectable model (constexpr-capable)
+// ------------------------------------------------------------
+struct PioTiming {
+    uint32_t f_pio;         // effective PIO clock (Hz, rounded)
+    uint32_t per_duty;      // cycles per duty unit
+    uint32_t fixed;         // fixed cycles per step (incl. pulse_high part)
+    uint32_t us_q32;        // 1e6 / f_pio in Q32 (us per cycle)
+
+    // STEP period in PIO cycles -> duty (>= 1)
+    constexpr uint32_t cycles_to_duty(uint32_t cycles) const {
+        if (cycles < fixed + per_duty) return 1;
+        return (cycles - fixed + per_duty / 2) / per_duty;
+    }
+
+    // Hz -> duty; 0 Hz => 0 (invalid command)
+    constexpr uint32_t hz_to_duty(uint32_t hz) const {
+        if (hz == 0) return 0;
+        return cycles_to_duty((f_pio + hz / 2) / hz);
+    }
+
+    constexpr uint32_t period_cycles(uint32_t duty) const {
+        return per_duty * duty + fixed;
+    }
+
+    // duty -> achieved STEP frequency (Hz, rounded)
+    constexpr uint32_t duty_to_hz(uint32_t duty) const {
+        const uint32_t c = period_cycles(duty);
+        return (f_pio + c / 2) / c;
+    }
+
+    // cycles -> us via the Q32 reciprocal (no division)
+    constexpr uint64_t cycles_to_us(uint64_t cycles) const {
+        const uint64_t hi = cycles >> 32;
+        const uint64_t lo = cycles & 0xFFFFFFFFull;
+        return hi * us_q32 + ((lo * us_q32 + 0x80000000ull) >> 32);
+    }
+
+    // exact execution time of one [duty, steps] command
+    constexpr uint64_t duration_us(uint32_t duty, uint32_t steps) const {
+        return cycles_to_us((uint64_t)period_cycles(duty) * steps);
+    }
+};
+
+constexpr uint32_t pio_timing_f_pio(uint32_t f_sys_hz,
+                                    uint32_t div_int,
+                                    uint32_t div_frac) {
+    // f_sys * 256 / (div_int * 256 + div_frac), rounded
+    return (uint32_t)((((uint64_t)f_sys_hz << 8) + ((div_int << 8) + div_frac) / 2)
+                      / ((div_int << 8) + div_frac));
+}
+
+constexpr PioTiming make_pio_timing(uint32_t per_duty,
+                                    uint32_t fixed,
+                                    uint32_t f_sys_hz,
+                                    uint32_t div_int,
+                                    uint32_t div_frac) {
+    const uint32_t f = pio_timing_f_pio(f_sys_hz, div_int, div_frac);
+    return PioTiming{
+        f,
+        per_duty,
+        fixed,
+        (uint32_t)(((1000000ull << 32) + f / 2) / f)
+    };
+}
+
+constexpr PioTiming make_pio_timing(MotorExecVariant v,
+                                    uint32_t f_sys_hz,
+                                    uint32_t div_int = 1,
+                                    uint32_t div_frac = 0,
+                                    uint32_t pulse_high = 0) {
+    using V = MotorExecVariant;
+
+    uint32_t pd = 0, ph = 0, fx = 0;
+    switch (v) {
+        case V::HalfDuty:
+            pd = MotorExecCycles<V::HalfDuty>::per_duty;
+            ph = MotorExecCycles<V::HalfDuty>::per_high;
+            fx = MotorExecCycles<V::HalfDuty>::fixed;
+            break;
+        case V::HalfDutyV2:
+            pd = MotorExecCycles<V::HalfDutyV2>::per_duty;
+            ph = MotorExecCycles<V::HalfDutyV2>::per_high;
+            fx = MotorExecCycles<V::HalfDutyV2>::fixed;
+            break;
+        case V::StepOnly:
+            pd = MotorExecCycles<V::StepOnly>::per_duty;
+            ph = MotorExecCycles<V::StepOnly>::per_high;
+            fx = MotorExecCycles<V::StepOnly>::fixed;
+            break;
+        case V::AdjustableDuty:
+            pd = MotorExecCycles<V::AdjustableDuty>::per_duty;
+            ph = MotorExecCycles<V::AdjustableDuty>::per_high;
+            fx = MotorExecCycles<V::AdjustableDuty>::fixed;
+            break;
+        case V::Exec:
+        default:
+            pd = MotorExecCycles<V::Exec>::per_duty;
+            ph = MotorExecCycles<V::Exec>::per_high;
+            fx = MotorExecCycles<V::Exec>::fixed;
+            break;
+    }
+
+    return make_pio_timing(pd, fx + ph * pulse_high, f_sys_hz, div_int, div_frac);
+}
+
+// ------------------------------------------------------------
+// Compile-time specialized model
+//   constexpr PioTimingModel<MotorExecVariant::Exec> k(125000000);
+//   static_assert(k.hz_to_duty(1000) == ...);
+// ------------------------------------------------------------
+template <MotorExecVariant V, uint32_t DivInt = 1, uint32_t DivFrac = 0>
+struct PioTimingModel : PioTiming {
+    static_assert(DivInt >= 1 && DivInt <= 65535, "PIO clkdiv int out of range");
+    static_assert(DivFrac < 256, "PIO clkdiv frac is 8 bit");
+    static_assert(DivInt < 65535 || DivFrac == 0, "PIO clkdiv > 65536");
+
+    using Cycles = MotorExecCycles<V>;
+    static constexpr MotorExecVariant variant = V;
+
+    constexpr explicit PioTimingModel(uint32_t f_sys_hz, uint32_t pulse_high = 0)
+        : PioTiming(make_pio_timing(Cycles::per_duty,
+                                    Cycles::fixed + Cycles::per_high * pulse_high,
+                                    f_sys_hz, DivInt, DivFrac)) {}
+};
+
+// ------------------------------------------------------------
+// Active configuration
+//   configured once at startup (pio_exec does it from clock_get_hz);
+//   before that a 125 MHz / div 1 model is used.
+// ------------------------------------------------------------
+void pio_timing_configure(uint32_t f_sys_hz);
+uint32_t pio_timing_f_sys();
+
+// float clkdiv (SDK style) -> 8.8 fixed point, done once per SM config
+void pio_timing_split_clkdiv(float clk_div, uint32_t& div_int, uint32_t& div_frac);
+
+// Convert desired STEP frequency (Hz) to PIO delay loop count
+// (AdjustableDuty program, pulse_high = PULSE_WIDTH).
 // delay=0 is reserved and never returned for valid speed.
 uint32_t speed_hz_to_delay(uint32_t speed_hz);
 
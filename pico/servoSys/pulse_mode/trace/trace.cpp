@@ -0,0 +1,151 @@
+#include "trace.hpp"
+
+#if PULSE_MODE_TRACE
+
+#include "pico/platform.h"    // get_core_num, __get_current_exception
+#include "hardware/sync.h"    // save_and_disable_interrupts, __dmb
+#include "hardware/timer.h"   // time_us_32
+
+// ------------------------------------------------------------
+// per-core rings (file-local)
+// ------------------------------------------------------------
+
+namespace {
+
+constexpr uint32_t RING_MASK = PULSE_MODE_TRACE_RING - 1u;
+
+// head / dropped: written only by the owning core (thread + IRQs of that core)
+// tail / dropped_seen: written only by the reader
+struct Ring {
+    TraceRecord       rec[PULSE_MODE_TRACE_RING];
+    volatile uint32_t head;
+    volatile uint32_t tail;
+    volatile uint32_t dropped;
+    uint32_t          dropped_seen;
+};
+
+Ring rings[NUM_CORES];
+
+static inline void put_le16(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static inline void put_le32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+} // namespace
+
+// ------------------------------------------------------------
+// writer (hot path)
+// ------------------------------------------------------------
+
+void trace_record(TraceEvent ev, uint8_t flags, uint32_t arg) {
+    Ring& r = rings[get_core_num()];
+
+    // 只屏蔽本核中断：同核的 IRQ 不会插进同一个 slot，另一个核不受影响
+    const uint32_t irq = save_and_disable_interrupts();
+
+    const uint32_t h = r.head;
+    if (h - r.tail >= PULSE_MODE_TRACE_RING) {
+        r.dropped = r.dropped + 1u;
+        restore_interrupts(irq);
+        return;
+    }
+
+    // 时间戳在临界区内取：环内记录按时间有序
+    TraceRecord& e = r.rec[h & RING_MASK];
+    e.t_us      = time_us_32();
+    e.event     = (uint8_t)((uint8_t)ev | flags);
+    const uint exc = __get_current_exception();
+    e.exception = (uint8_t)((exc > 0xFFu) ? 0xFFu : exc);
+    e.arg       = (uint16_t)((arg > 0xFFFFu) ? 0xFFFFu : arg);
+
+    __dmb();   // record complete before the reader (maybe the other core) sees head
+    r.head = h + 1u;
+
+    restore_interrupts(irq);
+}
+
+// ------------------------------------------------------------
+// reader (single reader, any core)
+// ------------------------------------------------------------
+
+size_t trace_drain(uint32_t core, TraceRecord* out, size_t capacity, uint32_t* dropped) {
+    if (dropped) *dropped = 0;
+    if (core >= NUM_CORES || !out) return 0;
+
+    Ring& r = rings[core];
+
+    const uint32_t h = r.head;
+    __dmb();   // records below h are complete
+
+    uint32_t t = r.tail;
+    size_t   n = 0;
+    while (t != h && n < capacity) {
+        out[n++] = r.rec[t & RING_MASK];
+        ++t;
+    }
+
+    __dmb();   // copies done before the slots are handed back
+    r.tail = t;
+
+    if (dropped) {
+        const uint32_t d = r.dropped;
+        *dropped = d - r.dropped_seen;
+        r.dropped_seen = d;
+    }
+    return n;
+}
+
+size_t trace_encode_block(uint32_t core, uint8_t* out, size_t capacity) {
+    if (!out || capacity < TRACE_BLOCK_HEADER) return 0;
+
+    size_t max = (capacity - TRACE_BLOCK_HEADER) / sizeof(TraceRecord);
+    if (max > 0xFFFFu) max = 0xFFFFu;
+
+    uint32_t dropped = 0;
+    size_t   count   = 0;
+    uint8_t* p       = out + TRACE_BLOCK_HEADER;
+
+    // 分块搬出，避免在栈上放整个 ring
+    TraceRecord tmp[16];
+    while (count < max) {
+        const size_t want = (max - count < 16) ? (max - count) : 16;
+        uint32_t d = 0;
+        const size_t got = trace_drain(core, tmp, want, &d);
+        dropped += d;
+
+        for (size_t i = 0; i < got; ++i) {
+            put_le32(p, tmp[i].t_us);
+            p[4] = tmp[i].event;
+            p[5] = tmp[i].exception;
+            put_le16(p + 6, tmp[i].arg);
+            p += sizeof(TraceRecord);
+        }
+        count += got;
+        if (got < want) break;
+    }
+
+    put_le32(out, TRACE_BLOCK_MAGIC);
+    out[4] = (uint8_t)core;
+    out[5] = TRACE_BLOCK_VERSION;
+    put_le16(out + 6, (uint32_t)count);
+    put_le32(out + 8, dropped);
+
+    return TRACE_BLOCK_HEADER + count * sizeof(TraceRecord);
+}
+
+void trace_clear() {
+    for (uint32_t core = 0; core < NUM_CORES; ++core) {
+        Ring& r = rings[core];
+        r.tail         = r.head;
+        r.dropped_seen = r.dropped;
+    }
+}
+
+#endif // PULSE_MODE_TRACE
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+// ============================================================
+// Hot-path trace ring (compile-time switch)
+//
+//   PULSE_MODE_TRACE=1 : PM_TRACE* write one 8-byte record
+//                        {time_us_32, event, exception, arg}
+//                        into a static ring of the calling core
+//   PULSE_MODE_TRACE=0 : macros expand to ((void)0), arguments are
+//                        not evaluated, nothing is linked in
+//
+//   - one ring per core, single writer per ring: a slot is reserved
+//     with interrupts masked on that core only (no spin lock, the
+//     other core never waits)
+//   - ring full: the new record is dropped and counted, the old
+//     ones are kept (the start of a burst is the interesting part)
+//   - drained by one reader (any core) with trace_encode_block(),
+//     binary, no formatting on the target (trace/trace_dump.py)
+//
+//   记录时间戳用 time_us_32()（1 us，约 71 分钟回绕），
+//   主机侧按相邻记录差值展开。
+// ============================================================
+
+#ifndef PULSE_MODE_TRACE
+#define PULSE_MODE_TRACE 0
+#endif
+
+// records per core, power of two
+#ifndef PULSE_MODE_TRACE_RING
+#define PULSE_MODE_TRACE_RING 512
+#endif
+
+static_assert((PULSE_MODE_TRACE_RING & (PULSE_MODE_TRACE_RING - 1)) == 0,
+              "PULSE_MODE_TRACE_RING must be a power of two");
+
+// ------------------------------------------------------------
+// Event IDs (fixed: the host decoder keeps the same table)
+//   begin / end pairs: PM_TRACE_SCOPE or PM_TRACE + PM_TRACE_END
+//   (end record = id | TRACE_END)
+// ------------------------------------------------------------
+enum class TraceEvent : uint8_t {
+    // PS100_P commands                 arg (saturated to 0xFFFF)
+    RunSteps        = 0x01,   // steps
+    RunStream       = 0x02,   // words
+    RunRing         = 0x03,   // half_words
+    QueueSteps      = 0x04,   // steps
+    Halt            = 0x05,   // ActiveBackend being frozen
+    Terminate       = 0x06,   // ActiveBackend being stopped
+
+    // pwm_motor
+    PwmRun          = 0x10,   // slice
+    PwmDmaArm       = 0x11,   // slice
+    PwmWrapIrq      = 0x12,   // serviced slices (mask)
+    PwmDmaIrq       = 0x13,   // END: completed slices (mask)
+
+    // pio_exec DMA
+    StreamStart     = 0x20,   // words
+    RingStart       = 0x21,   // half_words
+    RingIrq         = 0x22,   // END: refilled halves (ring slot mask)
+    RingUnderrun    = 0x23,   // ring slot
+};
+
+constexpr uint8_t TRACE_END = 0x80;
+
+struct TraceRecord {
+    uint32_t t_us;
+    uint8_t  event;       // TraceEvent, | TRACE_END for the end of a scope
+    uint8_t  exception;   // IPSR: 0 = thread, 16 + n = IRQ n
+    uint16_t arg;
+};
+
+static_assert(sizeof(TraceRecord) == 8, "TraceRecord is part of the wire format");
+
+// ------------------------------------------------------------
+// Drain block (little endian)
+//   [magic u32 'PMTR'][core u8][version u8][count u16][dropped u32]
+//   [TraceRecord x count]
+// ------------------------------------------------------------
+constexpr uint32_t TRACE_BLOCK_MAGIC   = 0x52544D50u;   // "PMTR"
+constexpr uint8_t  TRACE_BLOCK_VERSION = 1;
+constexpr size_t   TRACE_BLOCK_HEADER  = 12;
+
+#if PULSE_MODE_TRACE
+
+void trace_record(TraceEvent ev, uint8_t flags, uint32_t arg);
+
+// move up to `capacity` records of `core` out of its ring (oldest first)
+// dropped: records lost since the last drain (read and cleared)
+size_t trace_drain(uint32_t core, TraceRecord* out, size_t capacity, uint32_t* dropped);
+
+// header + drained records into `out`; returns bytes written
+// (TRACE_BLOCK_HEADER + 8 * count, 0 if capacity < header)
+size_t trace_encode_block(uint32_t core, uint8_t* out, size_t capacity);
+
+// discard everything recorded so far (both cores)
+void trace_clear();
+
+// end record on scope exit: every return path of the function is covered
+class TraceScope {
+public:
+    TraceScope(TraceEvent ev, uint32_t arg) : ev_(ev) { trace_record(ev, 0, arg); }
+    ~TraceScope() { trace_record(ev_, TRACE_END, 0); }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    TraceEvent ev_;
+};
+
+#define PM_TRACE_CAT_(a, b) a##b
+#define PM_TRACE_CAT(a, b)  PM_TRACE_CAT_(a, b)
+
+#define PM_TRACE(ev, arg)       trace_record(TraceEvent::ev, 0, (uint32_t)(arg))
+#define PM_TRACE_END(ev, arg)   trace_record(TraceEvent::ev, TRACE_END, (uint32_t)(arg))
+#define PM_TRACE_SCOPE(ev, arg) TraceScope PM_TRACE_CAT(pm_trace_scope_, __LINE__)(TraceEvent::ev, (uint32_t)(arg))
+
+#else
+
+#define PM_TRACE(ev, arg)       ((void)0)
+#define PM_TRACE_END(ev, arg)   ((void)0)
+#define PM_TRACE_SCOPE(ev, arg) ((void)0)
+
+#endif
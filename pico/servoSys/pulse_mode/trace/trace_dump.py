@@ -0,0 +1,179 @@
+import argparse
+import struct
+import sys
+
+# ============================================================
+# trace ring 导出 / 解码（trace/trace.hpp）
+#
+#   python trace_dump.py COM7            # servo_fw: FwControl::TraceDump
+#   python trace_dump.py --file dump.bin # 解码保存下来的原始数据
+#
+#   每条记录一行：时间（相对第一条）、核、上下文、事件、arg；
+#   末尾按事件统计 begin -> end 耗时（min / avg / max us）
+# ============================================================
+
+BLOCK_MAGIC   = 0x52544D50   # "PMTR"
+BLOCK_VERSION = 1
+BLOCK_HEADER  = struct.Struct("<IBBHI")
+RECORD        = struct.Struct("<IBBH")
+TRACE_END     = 0x80
+POINT_EVENTS  = {0x23}       # 单点事件，没有 end
+
+NUM_CORES = 2
+NUM_AXES  = 2                # servo_fw 的 NUM_AXES（应答帧长度 2 + NUM_AXES）
+
+# 与 TraceEvent 保持一致
+EVENTS = {
+    0x01: "RunSteps",
+    0x02: "RunStream",
+    0x03: "RunRing",
+    0x04: "QueueSteps",
+    0x05: "Halt",
+    0x06: "Terminate",
+    0x10: "PwmRun",
+    0x11: "PwmDmaArm",
+    0x12: "PwmWrapIrq",
+    0x13: "PwmDmaIrq",
+    0x20: "StreamStart",
+    0x21: "RingStart",
+    0x22: "RingIrq",
+    0x23: "RingUnderrun",
+}
+
+# ===============================
+# 解析
+# ===============================
+def parse_blocks(data):
+    """[(core, dropped, [(t_us, event, exception, arg), ...]), ...]"""
+    blocks = []
+    pos = 0
+    while pos + BLOCK_HEADER.size <= len(data):
+        magic, core, version, count, dropped = BLOCK_HEADER.unpack_from(data, pos)
+        if magic != BLOCK_MAGIC or version != BLOCK_VERSION:
+            raise ValueError(f"bad block header at byte {pos}")
+        pos += BLOCK_HEADER.size
+
+        end = pos + count * RECORD.size
+        if end > len(data):
+            raise ValueError(f"core {core}: {count} records, data truncated")
+        records = [RECORD.unpack_from(data, p) for p in range(pos, end, RECORD.size)]
+        blocks.append((core, dropped, records))
+        pos = end
+    return blocks
+
+
+def unwrap(records):
+    """32 位 us 时间戳展开为单调的 64 位"""
+    out = []
+    base = 0
+    last = None
+    for t, ev, exc, arg in records:
+        if last is not None and t < last:
+            base += 1 << 32
+        last = t
+        out.append((base + t, ev, exc, arg))
+    return out
+
+
+def context(exc):
+    return "thread" if exc == 0 else f"irq{exc - 16}"
+
+# ===============================
+# 输出
+# ===============================
+def dump(blocks):
+    rows = []
+    for core, dropped, records in blocks:
+        if dropped:
+            print(f"core {core}: {dropped} records dropped (ring full)")
+        rows += [(t, core, ev, exc, arg) for t, ev, exc, arg in unwrap(records)]
+
+    if not rows:
+        print("no records")
+        return
+
+    rows.sort(key=lambda r: r[0])
+    t0 = rows[0][0]
+
+    open_scopes = {}   # (core, exc, id) -> [t_begin, ...]
+    spans = {}         # id -> [us, ...]
+
+    for t, core, ev, exc, arg in rows:
+        eid  = ev & ~TRACE_END
+        name = EVENTS.get(eid, f"0x{eid:02x}")
+        key  = (core, exc, eid)
+
+        if ev & TRACE_END:
+            stack = open_scopes.get(key)
+            dt = t - stack.pop() if stack else None
+            if dt is not None:
+                spans.setdefault(eid, []).append(dt)
+            took = f"  ({dt} us)" if dt is not None else ""
+            print(f"{t - t0:>10} us  core{core}  {context(exc):<7} {name:<13} end   {arg:>5}{took}")
+        else:
+            if eid not in POINT_EVENTS:
+                open_scopes.setdefault(key, []).append(t)
+            kind = "mark " if eid in POINT_EVENTS else "begin"
+            print(f"{t - t0:>10} us  core{core}  {context(exc):<7} {name:<13} {kind} {arg:>5}")
+
+    print("\nevent          count    min     avg     max  (us)")
+    for eid in sorted(spans):
+        s = spans[eid]
+        print(f"{EVENTS.get(eid, hex(eid)):<13} {len(s):>6} {min(s):>6} {sum(s) / len(s):>7.1f} {max(s):>7}")
+
+# ===============================
+# 串口（servo_fw）
+# ===============================
+def read_exact(ser, n):
+    data = ser.read(n)
+    if len(data) != n:
+        raise TimeoutError(f"expected {n} bytes, got {len(data)}")
+    return data
+
+
+def fetch(port):
+    import serial
+
+    with serial.Serial(port, 115200, timeout=1.0) as ser:
+        ser.reset_input_buffer()
+        # CF | motorMask | FwControl::TraceDump | 0 | 0
+        ser.write(struct.pack("<BBBii", 0xCF, 0, 2, 0, 0))
+
+        reply = read_exact(ser, 2 + NUM_AXES)
+        if reply[0] != 0xFA or reply[1] != 0:
+            raise RuntimeError("TraceDump rejected (firmware built without PULSE_MODE_TRACE?)")
+
+        data = b""
+        for _ in range(NUM_CORES):
+            header = read_exact(ser, BLOCK_HEADER.size)
+            count = BLOCK_HEADER.unpack(header)[3]
+            data += header + read_exact(ser, count * RECORD.size)
+        return data
+
+
+def main():
+    ap = argparse.ArgumentParser(description="dump the pulse_mode trace rings")
+    ap.add_argument("port", nargs="?", help="servo_fw USB CDC port")
+    ap.add_argument("--file", help="decode raw blocks from a file instead")
+    ap.add_argument("--save", help="also write the raw blocks to this file")
+    args = ap.parse_args()
+
+    if args.file:
+        with open(args.file, "rb") as f:
+            data = f.read()
+    elif args.port:
+        data = fetch(args.port)
+    else:
+        ap.print_usage()
+        return 2
+
+    if args.save:
+        with open(args.save, "wb") as f:
+            f.write(data)
+
+    dump(parse_blocks(data))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
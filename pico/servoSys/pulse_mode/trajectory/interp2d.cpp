@@ -0,0 +1,374 @@
+#include "interp2d.hpp"
+
+#include "pio/pio_exec.hpp"
+
+#include <math.h>
+
+// ------------------------------------------------------------
+// helpers
+// ------------------------------------------------------------
+
+namespace {
+
+constexpr float QUARTER = 1.57079632679f;   // pi / 2
+constexpr float TWO_PI  = 6.28318530718f;
+
+// angle tolerance when a segment starts right on a quadrant boundary
+constexpr float BOUNDARY_EPS = 1e-4f;
+
+// tolerated timing error: 1/16 of a period (<= 0.0625 step)
+constexpr uint64_t ERROR_BAND_DIV = 16;
+
+static inline int32_t round_pos(float v) {
+    return (int32_t)lroundf(v);
+}
+
+static inline uint32_t abs_diff(int32_t a, int32_t b) {
+    return (a > b) ? (uint32_t)(a - b) : (uint32_t)(b - a);
+}
+
+} // namespace
+
+// ------------------------------------------------------------
+// ctor
+// ------------------------------------------------------------
+
+Interp2D::Interp2D()
+    : Interp2D(motor_exec_timing()) {}
+
+Interp2D::Interp2D(const PioTiming& timing)
+    : timing_(timing) {}
+
+// ------------------------------------------------------------
+// planning
+// ------------------------------------------------------------
+
+bool Interp2D::plan_line(int32_t dx, int32_t dy, float feed) {
+    planned_  = false;
+    finished_ = false;
+
+    if (dx == 0 && dy == 0) return false;
+    // path feed bounds every axis rate (|v_axis| <= feed)
+    if (!(feed > 0.0f) || feed > (float)timing_.duty_to_hz(1)) return false;
+
+    is_arc_     = false;
+    feed_       = feed;
+    target_[0]  = dx;
+    target_[1]  = dy;
+
+    axis_[0] = Axis{};
+    axis_[1] = Axis{};
+
+    planned_ = true;
+    return true;
+}
+
+bool Interp2D::plan_arc(int32_t dx, int32_t dy,
+                        int32_t i, int32_t j,
+                        bool cw, float feed,
+                        float tol) {
+    planned_  = false;
+    finished_ = false;
+
+    if (i == 0 && j == 0) return false;
+    if (!(feed > 0.0f) || feed > (float)timing_.duty_to_hz(1)) return false;
+    if (!(tol > 0.0f)) tol = 0.5f;
+
+    is_arc_    = true;
+    feed_      = feed;
+    target_[0] = dx;
+    target_[1] = dy;
+
+    cx_ = (float)i;
+    cy_ = (float)j;
+    r_  = sqrtf(cx_ * cx_ + cy_ * cy_);
+
+    th_start_ = atan2f(-cy_, -cx_);
+
+    // ---------- sweep (signed, CCW > 0) ----------
+    if (dx == 0 && dy == 0) {
+        sweep_ = cw ? -TWO_PI : TWO_PI;
+    } else {
+        sweep_ = atan2f((float)dy - cy_, (float)dx - cx_) - th_start_;
+        if (cw) {
+            while (sweep_ >= 0.0f) sweep_ -= TWO_PI;
+        } else {
+            while (sweep_ <= 0.0f) sweep_ += TWO_PI;
+        }
+    }
+
+    // ---------- chord angle: sagitta r * (1 - cos(th / 2)) <= tol ----------
+    th_max_ = (tol >= r_) ? QUARTER : 2.0f * acosf(1.0f - tol / r_);
+    if (th_max_ > QUARTER) th_max_ = QUARTER;
+
+    swept_ = 0.0f;
+
+    axis_[0] = Axis{};
+    axis_[1] = Axis{};
+
+    planned_ = true;
+    return true;
+}
+
+// ------------------------------------------------------------
+// segments
+// ------------------------------------------------------------
+
+void Interp2D::reset_axis(uint32_t axis, int32_t start, int32_t end) {
+    Axis& a = axis_[axis];
+    a = Axis{};
+
+    a.start = start;
+    a.end   = end;
+    a.dir   = (end >= start) ? 1 : -1;
+    a.total = abs_diff(end, start);
+    a.p0    = start;
+}
+
+bool Interp2D::next_segment() {
+    if (!planned_ || finished_) return false;
+
+    // ---------- line: one segment, one chord ----------
+    if (!is_arc_) {
+        const float fx  = (float)target_[0];
+        const float fy  = (float)target_[1];
+        const float len = sqrtf(fx * fx + fy * fy);
+
+        chords_     = 1;
+        seg_cycles_ = (uint64_t)(len / feed_ * (float)timing_.f_pio + 0.5f);
+
+        reset_axis(0, 0, target_[0]);
+        reset_axis(1, 0, target_[1]);
+
+        finished_ = true;
+        return true;
+    }
+
+    // ---------- arc: next monotone piece ----------
+    while (!finished_) {
+        const bool  ccw   = sweep_ > 0.0f;
+        const float th_e  = th_start_ + sweep_;
+
+        th_a_ = th_start_ + swept_;
+
+        // next axis reversal in sweep direction
+        float b = ccw ? (floorf(th_a_ / QUARTER + BOUNDARY_EPS) + 1.0f) * QUARTER
+                      : (ceilf(th_a_ / QUARTER - BOUNDARY_EPS) - 1.0f) * QUARTER;
+
+        if (ccw ? (b >= th_e - BOUNDARY_EPS) : (b <= th_e + BOUNDARY_EPS)) {
+            b = th_e;
+            finished_ = true;
+        }
+
+        th_b_  = b;
+        swept_ = finished_ ? sweep_ : (th_b_ - th_start_);
+
+        const float span = fabsf(th_b_ - th_a_);
+
+        chords_ = (uint32_t)ceilf(span / th_max_);
+        if (chords_ == 0) chords_ = 1;
+
+        seg_cycles_ = (uint64_t)(r_ * span / feed_ * (float)timing_.f_pio + 0.5f);
+
+        // segment ends chain exactly: start = previous end
+        const int32_t sx = axis_[0].end;
+        const int32_t sy = axis_[1].end;
+
+        const int32_t ex = finished_ ? target_[0] : round_pos(cx_ + r_ * cosf(th_b_));
+        const int32_t ey = finished_ ? target_[1] : round_pos(cy_ + r_ * sinf(th_b_));
+
+        reset_axis(0, sx, ex);
+        reset_axis(1, sy, ey);
+
+        if (axis_[0].total || axis_[1].total) return true;
+    }
+
+    return false;
+}
+
+// rounded chord knot position (monotone inside the segment)
+int32_t Interp2D::knot(uint32_t axis, uint32_t chord) const {
+    const Axis& a = axis_[axis];
+
+    if (chord == 0)       return a.start;
+    if (chord >= chords_) return a.end;
+
+    const float th = th_a_ + (th_b_ - th_a_) * (float)chord / (float)chords_;
+    const int32_t p = (axis == 0) ? round_pos(cx_ + r_ * cosf(th))
+                                  : round_pos(cy_ + r_ * sinf(th));
+
+    // clamp into [start, end] so the chord steps sum to total exactly
+    if (a.dir > 0) {
+        if (p < a.start) return a.start;
+        if (p > a.end)   return a.end;
+    } else {
+        if (p > a.start) return a.start;
+        if (p < a.end)   return a.end;
+    }
+    return p;
+}
+
+// ------------------------------------------------------------
+// step schedule
+// ------------------------------------------------------------
+
+// ideal time of the next step (cycles from segment start)
+bool Interp2D::next_step_time(Axis& a, uint32_t axis, uint64_t& t) {
+    while (a.k >= a.n) {
+        if (a.chord >= chords_) return false;
+
+        int32_t p1 = knot(axis, a.chord + 1);
+        // never step backwards inside a segment
+        if ((a.dir > 0) ? (p1 < a.p0) : (p1 > a.p0)) p1 = a.p0;
+
+        const uint64_t t1 = seg_cycles_ * (a.chord + 1) / chords_;
+        a.t0 = seg_cycles_ * a.chord / chords_;
+        a.d  = t1 - a.t0;
+        a.n  = abs_diff(p1, a.p0);
+        a.k  = 0;
+        a.p0 = p1;
+        a.chord++;
+    }
+
+    // steps centered in the chord time slice
+    t = a.t0 + ((2u * (uint64_t)a.k + 1u) * a.d) / (2u * (uint64_t)a.n);
+    a.k++;
+    return true;
+}
+
+// period of the pulse scheduled at a.t_cur
+//   candidates, first one that keeps |error| <= band wins:
+//     1. duty of the command being merged (or the last one)
+//     2. nominal duty of the ideal interval (rate only)
+//     3. full correction of the accumulated error
+//   every new command costs MOTOR_EXEC_CMD_OVERHEAD, so small errors
+//   are tolerated instead of chased (no 1 command / step limit cycle)
+void Interp2D::next_pulse(Axis& a, uint32_t axis) {
+    uint64_t t;
+    const bool more = next_step_time(a, axis, t);
+    if (!more) t = seg_cycles_;   // trailing low up to segment end
+    if (t < a.t_cur) t = a.t_cur;
+
+    auto duty_of = [this](uint64_t cycles) {
+        if (cycles > 0xFFFFFFFFull) cycles = 0xFFFFFFFFull;
+        return timing_.cycles_to_duty((uint32_t)cycles);
+    };
+    auto error_of = [&](uint32_t duty) {
+        const uint64_t end = a.emitted + timing_.period_cycles(duty);
+        return (end > t) ? (end - t) : (t - end);
+    };
+
+    const uint32_t nominal = duty_of(t - a.t_cur);
+
+    uint64_t band = timing_.period_cycles(nominal) / ERROR_BAND_DIV;
+    const uint64_t band_min = 2u * (MOTOR_EXEC_CMD_OVERHEAD + timing_.per_duty);
+    if (band < band_min) band = band_min;
+
+    const uint32_t keep = a.pend_steps ? a.pend_duty : a.last_duty;
+
+    uint32_t duty;
+    if (keep && error_of(keep) <= band) {
+        duty = keep;
+    } else if (error_of(nominal) <= band) {
+        duty = nominal;
+    } else {
+        duty = duty_of((t > a.emitted) ? (t - a.emitted) : 0);
+    }
+
+    a.emitted += timing_.period_cycles(duty);
+    a.t_cur    = t;
+
+    a.next_duty = duty;
+    a.next_last = !more;
+    a.have_next = true;
+}
+
+// ------------------------------------------------------------
+// emission
+// ------------------------------------------------------------
+
+size_t Interp2D::emit(uint32_t axis, uint32_t* dst, size_t capacity) {
+    axis &= 1u;
+    Axis& a = axis_[axis];
+
+    if (!planned_ || a.done || capacity < 2) return 0;
+
+    size_t   n      = 0;
+    uint32_t budget = MAX_PULSES_PER_EMIT;
+
+    if (!a.primed) {
+        uint64_t t;
+        if (!next_step_time(a, axis, t)) {
+            a.done = true;
+            return 0;
+        }
+        a.primed = true;
+        a.t_cur  = t;
+
+        // first pulse on time: leading dwell [duty, 0] (no pulse)
+        if (t > MOTOR_EXEC_DWELL_FIXED) {
+            uint64_t d = t - MOTOR_EXEC_DWELL_FIXED;
+            if (d > 0xFFFFFFFFull) d = 0xFFFFFFFFull;
+
+            dst[n++] = (uint32_t)d;
+            dst[n++] = 0;
+            a.emitted = d + MOTOR_EXEC_DWELL_FIXED;
+        }
+    }
+
+    while (!a.done) {
+        if (a.draining) {
+            if (n + 2 > capacity) break;
+            dst[n++] = a.pend_duty;
+            dst[n++] = a.pend_steps;
+            a.done = true;
+            break;
+        }
+
+        if (!a.have_next) {
+            if (budget == 0) {
+                // long uniform run: hand out what we have, continue next call
+                if (a.pend_steps && n + 2 <= capacity) {
+                    dst[n++] = a.pend_duty;
+                    dst[n++] = a.pend_steps;
+                    a.last_duty  = a.pend_duty;
+                    a.pend_steps = 0;
+                    a.emitted += MOTOR_EXEC_CMD_OVERHEAD;
+                }
+                break;
+            }
+            next_pulse(a, axis);
+            budget--;
+        }
+
+        // run-length merge of equal periods
+        if (a.pend_steps && a.next_duty == a.pend_duty) {
+            a.pend_steps++;
+        } else {
+            if (a.pend_steps) {
+                if (n + 2 > capacity) break;   // lookahead is kept
+                dst[n++] = a.pend_duty;
+                dst[n++] = a.pend_steps;
+                a.last_duty = a.pend_duty;
+
+                // this pulse starts a new command: framing delays it
+                a.emitted += MOTOR_EXEC_CMD_OVERHEAD;
+            }
+            a.pend_duty  = a.next_duty;
+            a.pend_steps = 1;
+        }
+
+        a.have_next = false;
+        if (a.next_last) a.draining = true;
+    }
+
+    return n;
+}
+
+size_t Interp2D::refill_x(uint32_t* dst, size_t capacity, void* user) {
+    return static_cast<Interp2D*>(user)->emit(0, dst, capacity);
+}
+
+size_t Interp2D::refill_y(uint32_t* dst, size_t capacity, void* user) {
+    return static_cast<Interp2D*>(user)->emit(1, dst, capacity);
+}
@@ -0,0 +1,145 @@
+#pragma once
+
+#include "timing/pio_timing.hpp"
+
+#include <cstdint>
+#include <cstddef>
+
+// ============================================================
+// Interp2D
+//   - Two-axis linear / circular interpolation in STEP domain
+//   - Output: one motor_exec raw stream [duty_period, steps] per axis,
+//     generated incrementally (ring refill source, no heap)
+//   - Both streams share ONE integer time base (PIO cycles), so two
+//     SMs started in sync (PS100_Group) stay on the path:
+//       axis step times are placed on the ideal line / chord,
+//       quantization error is carried, never accumulated
+//
+// Segments:
+//   DIR is a GPIO, it cannot change inside a stream. A move is cut
+//   into segments on which both axes are monotone:
+//     line : 1 segment
+//     arc  : split at every axis reversal (quadrant boundary)
+//   For each segment: set DIR from forward(), stage both rings,
+//   start the group, wait for !busy(), then next_segment().
+//
+// Arc discretization:
+//   each segment is cut into chords with sagitta <= tol steps;
+//   chord end points are rounded to the step grid, steps of one
+//   chord are centered in its time slice (Bresenham on time).
+//
+// Timing:
+//   a leading dwell [duty, 0] delays the first pulse of each axis;
+//   motor_exec command framing (MOTOR_EXEC_CMD_OVERHEAD) is carried
+//   like any other quantization error.
+// ============================================================
+
+class Interp2D {
+public:
+    static constexpr uint32_t AXES = 2;
+
+    // max pulses examined per emit() call (bounds IRQ refill time)
+    static constexpr uint32_t MAX_PULSES_PER_EMIT = 2048;
+
+public:
+    Interp2D();
+    explicit Interp2D(const PioTiming& timing);
+
+    void set_timing(const PioTiming& timing) { timing_ = timing; }
+
+    // ------------------------------------------------------------
+    // Planning (relative to the current position, feed in steps/s
+    // along the path). false on zero move / feed out of range.
+    // ------------------------------------------------------------
+    bool plan_line(int32_t dx, int32_t dy, float feed);
+
+    // (i, j): center offset from start, (dx, dy): end offset from start
+    // dx == dy == 0 => full circle
+    bool plan_arc(int32_t dx, int32_t dy,
+                  int32_t i, int32_t j,
+                  bool cw, float feed,
+                  float tol = 0.5f);
+
+    // ------------------------------------------------------------
+    // Segment iteration
+    //   false when the move is finished; the first call selects
+    //   the first segment. Segments without any step are skipped.
+    // ------------------------------------------------------------
+    bool next_segment();
+
+    bool     forward(uint32_t axis) const { return axis_[axis & 1u].dir > 0; }
+    uint32_t steps(uint32_t axis) const   { return axis_[axis & 1u].total; }
+    uint64_t duration_cycles() const      { return seg_cycles_; }
+
+    // ------------------------------------------------------------
+    // Emission (current segment, whole commands only, 0 = done)
+    // ------------------------------------------------------------
+    size_t emit(uint32_t axis, uint32_t* dst, size_t capacity);
+
+    // motor_exec_refill_fn trampolines (user = Interp2D*)
+    static size_t refill_x(uint32_t* dst, size_t capacity, void* user);
+    static size_t refill_y(uint32_t* dst, size_t capacity, void* user);
+
+private:
+    // ------------------------------------------------------------
+    // Per-axis step schedule -> run-length commands
+    // ------------------------------------------------------------
+    struct Axis {
+        // segment (positions relative to the move start)
+        int32_t  start;      // position at segment start
+        int32_t  end;        // position at segment end
+        int32_t  dir;        // +1 / -1
+        uint32_t total;      // steps in segment
+
+        // chord walk
+        uint32_t chord;      // current chord
+        int32_t  p0;         // rounded position at chord start
+        uint32_t n;          // steps in current chord
+        uint32_t k;          // next step in current chord
+        uint64_t t0;         // chord start time (cycles)
+        uint64_t d;          // chord duration (cycles)
+
+        // stream
+        bool     primed;     // first pulse scheduled
+        bool     draining;   // last pulse consumed, pending not flushed
+        bool     done;
+        uint64_t t_cur;      // ideal time of the next pulse to period
+        uint64_t emitted;    // actual start time of that pulse (cycles)
+
+        bool     have_next;  // lookahead pulse
+        uint32_t next_duty;
+        bool     next_last;
+
+        uint32_t pend_duty;  // command being merged
+        uint32_t pend_steps;
+        uint32_t last_duty;  // last flushed command (0 = none)
+    };
+
+    int32_t  knot(uint32_t axis, uint32_t chord) const;
+    bool     next_step_time(Axis& a, uint32_t axis, uint64_t& t);
+    void     next_pulse(Axis& a, uint32_t axis);
+    void     reset_axis(uint32_t axis, int32_t start, int32_t end);
+
+private:
+    PioTiming timing_;
+
+    // ---------- move ----------
+    bool    is_arc_ = false;
+    bool    planned_ = false;
+    bool    finished_ = false;   // last segment already selected
+    int32_t target_[AXES]{};     // end offset
+
+    float   feed_ = 0.0f;
+    float   cx_ = 0.0f, cy_ = 0.0f, r_ = 0.0f;
+    float   th_start_ = 0.0f;   // start angle
+    float   sweep_ = 0.0f;      // signed total sweep
+    float   th_max_ = 0.0f;     // max chord angle
+    float   swept_ = 0.0f;      // signed angle covered by previous segments
+
+    // ---------- current segment ----------
+    float    th_a_ = 0.0f, th_b_ = 0.0f;
+    uint32_t chords_ = 1;
+    uint64_t seg_cycles_ = 0;
+
+    Axis     axis_[AXES]{};
+};
@@ -0,0 +1,123 @@
+#include "profile_cache.hpp"
+
+#include <utility>
+
+// ------------------------------------------------------------
+// Internal state
+// ------------------------------------------------------------
+
+namespace {
+
+struct Key {
+    uint32_t        v_max;
+    uint32_t        total_steps;
+    uint32_t        ramp_steps;
+    uint32_t        f_pio;
+    uint32_t        per_duty;
+    uint32_t        fixed;
+    MotorExecFormat fmt;
+
+    bool operator==(const Key& o) const {
+        return v_max == o.v_max && total_steps == o.total_steps && ramp_steps == o.ramp_steps
+            && f_pio == o.f_pio && per_duty == o.per_duty && fixed == o.fixed && fmt == o.fmt;
+    }
+};
+
+struct Entry {
+    Key          key;
+    StreamBuffer buf;         // empty = free slot
+    uint32_t     last_use;
+};
+
+static Entry    entries[PROFILE_CACHE_ENTRIES];
+static uint32_t tick      = 0;
+static uint32_t hits      = 0;
+static uint32_t misses    = 0;
+static uint32_t evictions = 0;
+
+static void evict(Entry& e) {
+    e.buf.reset();
+    ++evictions;
+}
+
+// least recently used entry; idle_only: only blocks nobody else holds
+// (dropping those actually returns a block to the pool)
+static Entry* lru(bool idle_only) {
+    Entry* best = nullptr;
+    for (Entry& e : entries) {
+        if (!e.buf) continue;
+        if (idle_only && e.buf.use_count() > 1) continue;
+        if (!best || (int32_t)(e.last_use - best->last_use) < 0) best = &e;
+    }
+    return best;
+}
+
+} // namespace
+
+// ------------------------------------------------------------
+// Public API
+// ------------------------------------------------------------
+
+StreamBuffer ce_config_to_pio_cached(uint32_t v_max,
+                                     uint32_t total_steps,
+                                     uint32_t ramp_steps_per_side,
+                                     const PioTiming& timing,
+                                     MotorExecFormat fmt)
+{
+    const Key key{ v_max, total_steps, ramp_steps_per_side,
+                   timing.f_pio, timing.per_duty, timing.fixed, fmt };
+
+    // ---------- hit ----------
+    for (Entry& e : entries) {
+        if (e.buf && e.key == key) {
+            e.last_use = ++tick;
+            ++hits;
+            return e.buf.share();
+        }
+    }
+
+    // ---------- miss: plan into a fresh block ----------
+    ++misses;
+
+    // pool empty: give back an idle cached block first
+    if (stream_pool_free_blocks() == 0) {
+        if (Entry* e = lru(true)) evict(*e);
+    }
+
+    StreamBuffer buf = ce_config_to_pio(v_max, total_steps, ramp_steps_per_side, timing, fmt);
+    if (!buf) return StreamBuffer();
+
+    // free slot, else the least recently used (maybe still streaming:
+    // the driver keeps its own reference)
+    Entry* slot = nullptr;
+    for (Entry& e : entries) {
+        if (!e.buf) {
+            slot = &e;
+            break;
+        }
+    }
+    if (!slot) {
+        slot = lru(false);
+        evict(*slot);
+    }
+
+    slot->key      = key;
+    slot->buf      = std::move(buf);
+    slot->last_use = ++tick;
+    return slot->buf.share();
+}
+
+ProfileCacheStats profile_cache_stats() {
+    ProfileCacheStats s{};
+    s.hits      = hits;
+    s.misses    = misses;
+    s.evictions = evictions;
+    for (const Entry& e : entries) {
+        if (e.buf) ++s.entries;
+    }
+    return s;
+}
+
+void profile_cache_clear() {
+    for (Entry& e : entries) e.buf.reset();
+}
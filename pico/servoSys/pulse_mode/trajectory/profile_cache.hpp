@@ -0,0 +1,45 @@
+#pragma once
+
+#include "servoSys.hpp"
+
+#include <cstdint>
+#include <cstddef>
+
+// =======================================================
+// Motion profile cache (LRU over stream pool blocks)
+//   - raster scans repeat the same few moves: same line length,
+//     v_max and ramp on the same axis. A move is planned and
+//     encoded once; later requests get a shared handle of the
+//     same pool block (key compare + refcount, no planner, no copy)
+//   - key: v_max, total_steps, ramp_steps_per_side, timing model
+//     (f_pio / per_duty / fixed: program variant + clock divider),
+//     word format
+//   - at most PROFILE_CACHE_ENTRIES blocks are held; a miss with
+//     a full cache / pool evicts the least recently used entry
+//   - eviction only drops the cache's reference: a block handed to
+//     run_pio_stream(std::move(h)) stays valid until its DMA is done
+//   - call from one context (the planning core, not from an IRQ);
+//     handles may be released anywhere (pool refcount is locked)
+// =======================================================
+
+constexpr size_t PROFILE_CACHE_ENTRIES = 4;   // of STREAM_POOL_BLOCKS
+
+// Same result as ce_config_to_pio(), as a shared read-only handle.
+// Empty handle on invalid parameters / no pool block left.
+StreamBuffer ce_config_to_pio_cached(uint32_t v_max,
+                                     uint32_t total_steps,
+                                     uint32_t ramp_steps_per_side,
+                                     const PioTiming& timing = motor_exec_timing(),
+                                     MotorExecFormat fmt = MotorExecFormat::Raw);
+
+struct ProfileCacheStats {
+    uint32_t hits;
+    uint32_t misses;      // planned (including failed plans)
+    uint32_t evictions;
+    size_t   entries;     // held right now
+};
+
+ProfileCacheStats profile_cache_stats();
+
+// drop every entry (blocks still streaming are freed by their driver)
+void profile_cache_clear();
@@ -0,0 +1,282 @@
+#include "s_curve_planner.hpp"
+
+#include <math.h>
+
+// ------------------------------------------------------------
+// helpers
+// ------------------------------------------------------------
+
+namespace {
+
+// Ramp shape of one symmetric jerk-limited acceleration 0 -> v_peak
+struct Ramp {
+    float tj;    // jerk phase duration
+    float ta;    // whole ramp duration
+    float j;     // jerk
+    float ap;    // peak acceleration (= j * tj)
+    float v;     // v_peak
+};
+
+// position inside the accel ramp at time t (0 <= t <= ta)
+static inline float ramp_position(const Ramp& r, float t) {
+    if (t <= r.tj) {
+        return r.j * t * t * t * (1.0f / 6.0f);
+    }
+
+    if (t <= r.ta - r.tj) {
+        const float v1  = 0.5f * r.j * r.tj * r.tj;
+        const float s1  = r.j * r.tj * r.tj * r.tj * (1.0f / 6.0f);
+        const float tau = t - r.tj;
+        return s1 + v1 * tau + 0.5f * r.ap * tau * tau;
+    }
+
+    // last jerk phase: mirror of the first one around the ramp end
+    const float u  = r.ta - t;
+    const float sa = 0.5f * r.v * r.ta;
+    return sa - (r.v * u - r.j * u * u * u * (1.0f / 6.0f));
+}
+
+// ramp timing for a given peak velocity
+static inline Ramp make_ramp(float v, float a, float j) {
+    Ramp r{};
+    r.j = j;
+    r.v = v;
+
+    if (v * j >= a * a) {
+        // a_max reached: jerk / const-accel / jerk
+        r.tj = a / j;
+        r.ta = r.tj + v / a;
+        r.ap = a;
+    } else {
+        // a_max never reached: pure jerk ramp
+        r.tj = sqrtf(v / j);
+        r.ta = 2.0f * r.tj;
+        r.ap = j * r.tj;
+    }
+    return r;
+}
+
+} // namespace
+
+// ------------------------------------------------------------
+// ctor
+// ------------------------------------------------------------
+
+SCurvePlanner::SCurvePlanner(uint32_t segments_per_ramp)
+    : SCurvePlanner(motor_exec_timing(), segments_per_ramp) {}
+
+SCurvePlanner::SCurvePlanner(const PioTiming& timing, uint32_t segments_per_ramp)
+    : m_(segments_per_ramp), timing_(timing) {
+    if (m_ == 0) m_ = 1;
+    if (m_ > MAX_SEGMENTS_PER_RAMP) m_ = MAX_SEGMENTS_PER_RAMP;
+}
+
+// ------------------------------------------------------------
+// planning
+// ------------------------------------------------------------
+
+bool SCurvePlanner::plan(const Limits& lim, uint32_t total_steps) {
+    planned_    = false;
+    ramp_count_ = 0;
+    cruise_     = Segment{};
+    rewind();
+
+    if (total_steps == 0) return false;
+    if (!(lim.v_max > 0.0f) || !(lim.a_max > 0.0f) || !(lim.j_max > 0.0f)) {
+        return false;
+    }
+
+    const float d = (float)total_steps;
+    const float a = lim.a_max;
+    const float j = lim.j_max;
+
+    // ---------- full-speed ramp ----------
+    Ramp r = make_ramp(lim.v_max, a, j);
+    float sa = 0.5f * r.v * r.ta;
+
+    // ---------- short move: lower v_peak so that 2 * sa == d ----------
+    if (2.0f * sa > d) {
+        // with const-accel phase: v^2/a + v*a/j = d
+        const float b  = a / j;
+        const float vc = 0.5f * a * (-b + sqrtf(b * b + 4.0f * d / a));
+
+        if (vc * j >= a * a) {
+            r = make_ramp(vc, a, j);
+        } else {
+            // pure jerk ramp: v^1.5 / sqrt(j) = d / 2
+            r = make_ramp(cbrtf(0.25f * d * d * j), a, j);
+        }
+        sa = 0.5f * r.v * r.ta;
+    }
+
+    // ---------- STEP budget (exact total) ----------
+    uint32_t ramp_steps = (uint32_t)(sa + 0.5f);
+    if (ramp_steps > total_steps / 2) ramp_steps = total_steps / 2;
+
+    const uint32_t cruise_steps = total_steps - 2u * ramp_steps;
+
+    // ---------- accel slices ----------
+    uint32_t m = m_;
+    if (m > ramp_steps) m = ramp_steps;
+
+    if (m > 0) {
+        const float dt    = r.ta / (float)m;
+        const float scale = (float)ramp_steps / sa;   // hit ramp_steps exactly
+        const float f_pio = (float)timing_.f_pio;
+
+        uint32_t prev   = 0;
+        float    acc_dt = 0.0f;
+
+        for (uint32_t i = 1; i <= m; ++i) {
+            uint32_t s = ramp_steps;
+            if (i < m) {
+                s = (uint32_t)(ramp_position(r, dt * (float)i) * scale + 0.5f);
+                if (s > ramp_steps) s = ramp_steps;
+            }
+
+            acc_dt += dt;
+            if (s <= prev) continue;   // empty slice: merge its time into the next
+
+            // slice period in PIO cycles (mean velocity over the slice)
+            const uint32_t steps  = s - prev;
+            const float    cycles = acc_dt * f_pio / (float)steps;
+
+            ramp_[ramp_count_].duty  = timing_.cycles_to_duty(
+                (cycles >= 4294967295.0f) ? 0xFFFFFFFFu : (uint32_t)(cycles + 0.5f));
+            ramp_[ramp_count_].steps = steps;
+            ramp_count_++;
+
+            prev   = s;
+            acc_dt = 0.0f;
+        }
+    }
+
+    // ---------- cruise ----------
+    if (cruise_steps > 0) {
+        cruise_.duty  = timing_.hz_to_duty((uint32_t)(r.v + 0.5f));
+        cruise_.steps = cruise_steps;
+    }
+
+    // packed words carry a 16-bit duty_period; very slow pulses need dwell words
+    if (format_ == MotorExecFormat::Packed) {
+        for (uint32_t i = 0; i < ramp_count_; ++i) {
+            if (motor_exec_packed_step_words(ramp_[i].duty) > MAX_PACKED_STEP_WORDS) return false;
+        }
+        if (cruise_.steps &&
+            motor_exec_packed_step_words(cruise_.duty) > MAX_PACKED_STEP_WORDS) {
+            return false;
+        }
+    }
+
+    profile_.v_peak       = r.v;
+    profile_.t_ramp_s     = (ramp_steps > 0) ? r.ta : 0.0f;
+    profile_.t_cruise_s   = (float)cruise_steps / r.v;
+    profile_.ramp_steps   = ramp_steps;
+    profile_.cruise_steps = cruise_steps;
+
+    planned_ = true;
+    return true;
+}
+
+// ------------------------------------------------------------
+// emission
+// ------------------------------------------------------------
+
+size_t SCurvePlanner::seg_words(const Segment& seg) const {
+    if (format_ == MotorExecFormat::Raw) return 2u;
+
+    if (seg.duty > MOTOR_EXEC_PACKED_MAX) {
+        return (size_t)seg.steps * motor_exec_packed_step_words(seg.duty);
+    }
+    return (seg.steps + MOTOR_EXEC_PACKED_MAX - 1u) / MOTOR_EXEC_PACKED_MAX;
+}
+
+size_t SCurvePlanner::words() const {
+    if (!planned_) return 0;
+
+    size_t n = 0;
+    for (uint32_t i = 0; i < ramp_count_; ++i) {
+        n += 2u * seg_words(ramp_[i]);
+    }
+    if (cruise_.steps) n += seg_words(cruise_);
+    return n;
+}
+
+void SCurvePlanner::rewind() {
+    cursor_     = 0;
+    split_left_ = 0;
+    slow_len_   = 0;
+    slow_pos_   = 0;
+}
+
+bool SCurvePlanner::next(Segment& seg) {
+    if (!planned_) return false;
+
+    const uint32_t n  = ramp_count_;
+    const uint32_t hc = cruise_.steps ? 1u : 0u;
+
+    if (cursor_ >= 2u * n + hc) return false;
+
+    if (cursor_ < n) {
+        seg = ramp_[cursor_];
+    } else if (hc && cursor_ == n) {
+        seg = cruise_;
+    } else {
+        // decel = accel reversed
+        seg = ramp_[n - 1u - (cursor_ - n - hc)];
+    }
+
+    cursor_++;
+    return true;
+}
+
+size_t SCurvePlanner::emit(uint32_t* dst, size_t capacity) {
+    size_t n = 0;
+
+    if (format_ == MotorExecFormat::Raw) {
+        Segment seg;
+        while (n + 2 <= capacity && next(seg)) {
+            dst[n++] = seg.duty;
+            dst[n++] = seg.steps;
+        }
+        return n;
+    }
+
+    // packed: 1 word per command, long commands split at 0xFFFF steps
+    while (n < capacity) {
+        if (split_left_ == 0) {
+            if (!next(cur_)) break;
+            split_left_ = cur_.steps;
+        }
+
+        if (cur_.duty > MOTOR_EXEC_PACKED_MAX) {
+            // slow pulse: [M, 1] + dwell words, drained across calls
+            if (slow_pos_ == slow_len_) {
+                slow_len_ = (uint8_t)motor_exec_pack_slow_step(
+                    cur_.duty, slow_buf_, MAX_PACKED_STEP_WORDS);
+                slow_pos_ = 0;
+            }
+
+            dst[n++] = slow_buf_[slow_pos_++];
+            if (slow_pos_ == slow_len_) split_left_--;
+            continue;
+        }
+
+        const uint32_t s = (split_left_ > MOTOR_EXEC_PACKED_MAX) ? MOTOR_EXEC_PACKED_MAX
+                                                                 : split_left_;
+        dst[n++] = motor_exec_pack(cur_.duty, s);
+        split_left_ -= s;
+    }
+    return n;
+}
+
+size_t SCurvePlanner::emit_all(uint32_t* out, size_t capacity) {
+    if (!out || capacity < words()) return 0;
+
+    rewind();
+    return emit(out, capacity);
+}
+
+size_t SCurvePlanner::refill(uint32_t* dst, size_t capacity, void* user) {
+    return static_cast<SCurvePlanner*>(user)->emit(dst, capacity);
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "timing/pio_timing.hpp"
+#include "pio/pio_exec.hpp"
+
+#include <cstdint>
+#include <cstddef>
+
+// ============================================================
+// SCurvePlanner
+//   - Constant-jerk (7-phase) point-to-point profile in STEP domain
+//   - Emits motor_exec raw words [duty_period, steps] directly
+//   - No heap: all state lives in the object (fixed segment table)
+//   - Works one-shot (plan into a buffer) or incrementally
+//     (emit() as a ring refill source, see motor_exec_ring_start)
+//
+// Discretization:
+//   accel ramp is cut into `segments_per_ramp` equal time slices;
+//   each slice becomes one command whose rate is the slice's mean
+//   velocity (exact step integral, cumulative rounding).
+//   decel mirrors accel, cruise is a single command.
+//   => total pulses == total_steps exactly.
+//
+// duty_period comes from the PioTiming model of the target SM
+// (default: motor_exec_timing()), so emitted words match the
+// program variant and clock divider actually running.
+//
+// Output format:
+//   Raw (default) or Packed (1 word / command, see MotorExecFormat).
+//   Packed: commands with steps > 0xFFFF are split, slow commands
+//   (duty_period > 0xFFFF) use the per-pulse slow encoding, limited
+//   to MAX_PACKED_STEP_WORDS words per pulse (plan() fails beyond).
+// ============================================================
+
+class SCurvePlanner {
+public:
+    static constexpr uint32_t MAX_SEGMENTS_PER_RAMP = 64;
+    static constexpr size_t   MAX_PACKED_STEP_WORDS = 64;   // down to ~30 Hz @ 125 MHz
+
+    // worst case words for one move (accel + cruise + decel), raw format
+    static constexpr size_t max_words(uint32_t segments_per_ramp) {
+        return 2u * (2u * segments_per_ramp + 1u);
+    }
+
+    // ------------------------------------------------------------
+    // Kinematic limits (STEP domain)
+    // ------------------------------------------------------------
+    struct Limits {
+        float v_max;   // steps/s
+        float a_max;   // steps/s^2
+        float j_max;   // steps/s^3
+    };
+
+    // ------------------------------------------------------------
+    // Planned profile summary
+    // ------------------------------------------------------------
+    struct Profile {
+        float    v_peak;        // reached velocity (<= v_max for short moves)
+        float    t_ramp_s;      // duration of one ramp (accel == decel)
+        float    t_cruise_s;    // duration of constant-velocity part
+        uint32_t ramp_steps;    // pulses per ramp
+        uint32_t cruise_steps;  // pulses at v_peak
+    };
+
+public:
+    explicit SCurvePlanner(uint32_t segments_per_ramp = 16);
+    SCurvePlanner(const PioTiming& timing, uint32_t segments_per_ramp = 16);
+
+    void set_timing(const PioTiming& timing) { timing_ = timing; }
+
+    // takes effect on the next plan()
+    void set_format(MotorExecFormat fmt) { format_ = fmt; }
+    MotorExecFormat format() const       { return format_; }
+
+    // ------------------------------------------------------------
+    // Planning (no output yet). false on invalid limits / zero move.
+    // ------------------------------------------------------------
+    bool plan(const Limits& lim, uint32_t total_steps);
+
+    // ------------------------------------------------------------
+    // Emission
+    // ------------------------------------------------------------
+
+    // One-shot: write the whole move; returns words (0 if capacity too small)
+    size_t emit_all(uint32_t* out, size_t capacity);
+
+    // Incremental: writes whole commands only, returns 0 when finished
+    size_t emit(uint32_t* dst, size_t capacity);
+
+    // motor_exec_refill_fn trampoline (user = SCurvePlanner*)
+    static size_t refill(uint32_t* dst, size_t capacity, void* user);
+
+    // rewind emission to the first command of the current plan
+    void rewind();
+
+    const Profile& profile() const { return profile_; }
+    size_t         words() const;   // words of the current plan (in format())
+
+private:
+    struct Segment {
+        uint32_t duty;
+        uint32_t steps;
+    };
+
+    bool next(Segment& seg);
+    size_t seg_words(const Segment& seg) const;
+
+private:
+    uint32_t        m_;                         // segments per ramp (config)
+    PioTiming       timing_;
+    MotorExecFormat format_ = MotorExecFormat::Raw;
+
+    Profile  profile_{};
+
+    Segment  ramp_[MAX_SEGMENTS_PER_RAMP]{};    // accel commands (decel = reversed)
+    uint32_t ramp_count_ = 0;
+    Segment  cruise_{};
+
+    // emission cursor: [0, n) accel, n cruise, (n, 2n] decel
+    uint32_t cursor_ = 0;
+    Segment  cur_{};           // packed split: command being emitted
+    uint32_t split_left_ = 0;  //   and its steps not yet written
+
+    // packed slow pulse being drained (resumable at any capacity)
+    uint32_t slow_buf_[MAX_PACKED_STEP_WORDS]{};
+    uint8_t  slow_len_ = 0;
+    uint8_t  slow_pos_ = 0;
+    bool     planned_ = false;
+};
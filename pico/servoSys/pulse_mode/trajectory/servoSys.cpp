@@ -1,141 +1,69 @@
-#include <stdint.h>
-#include <stdlib.h>
-#include <math.h>
-
-#define PULSE_WIDTH 625   // ≈10us @ 125MHz PIO (2 cycles/loop)
-#define PROFILE_SEGMENTS 32   // S 曲线段数（每侧）
-
-// motor_exec FIFO format: [delay_count, steps]
-typedef struct {
-    uint32_t delay;
-    uint32_t steps;
-} pio_cmd_t;
-
+#include "servoSys.hpp"
 
 // =======================================================
 // CE trajectory discretization (STEP domain only)
 // =======================================================
-pio_cmd_t* ce_config_to_pio(uint32_t v_max,
-                            uint32_t total_steps,
-                            uint32_t ramp_steps_per_side,
-                            uint32_t radar_ratio)
+StreamBuffer ce_config_to_pio(uint32_t v_max,
+                              uint32_t total_steps,
+                              uint32_t ramp_steps_per_side,
+                              uint32_t radar_ratio)
 {
     (void)radar_ratio; // radar_sync consumes this elsewhere
 
+    return ce_config_to_pio(v_max, total_steps, ramp_steps_per_side,
+                            motor_exec_timing(), MotorExecFormat::Raw);
+}
+
+StreamBuffer ce_config_to_pio(uint32_t v_max,
+                              uint32_t total_steps,
+                              uint32_t ramp_steps_per_side,
+                              const PioTiming& timing,
+                              MotorExecFormat fmt)
+{
     // ---------- 基本防护 ----------
     if (v_max == 0 || total_steps == 0) {
-        return NULL;
-    }
-
-    // ---------- ramp 步数（STEP 空间） ----------
-    uint32_t Sr_nominal = ramp_steps_per_side;
-    uint32_t Sr = Sr_nominal;
-    int has_cruise = 1;
-
-    if (Sr_nominal == 0 || total_steps <= 2 * Sr_nominal) {
-        // 短行程：对称 S 曲线，无匀速段
-        Sr = total_steps / 2;
-        has_cruise = 0;
+        return StreamBuffer();
     }
 
-    uint32_t S_cruise = has_cruise ? (total_steps - 2 * Sr) : 0;
-
-    // ---------- 分段数调整 ----------
-    uint32_t M = PROFILE_SEGMENTS;
-    if (Sr < M) {
-        M = Sr;
-        if (M < 4) M = Sr; // 极短行程退化
+    SCurvePlanner planner(timing, CE_PROFILE_SEGMENTS);
+    planner.set_format(fmt);
+    if (!planner.plan(ce_ramp_limits(v_max, total_steps, ramp_steps_per_side), total_steps)) {
+        return StreamBuffer();
     }
 
-    // ---------- 分配输出缓冲 ----------
-    uint32_t max_cmds = 2 * M + (has_cruise ? 1 : 0) + 1;
-    pio_cmd_t* cmds = calloc(max_cmds + 1, sizeof(pio_cmd_t));
-    if (!cmds) return NULL;
-
-    // ---------- 生成 S 型速度模板 ----------
-    float weight_sum = 0.0f;
-    float w[PROFILE_SEGMENTS];
+    // ---------- 从静态池取输出缓冲（+1 end marker）----------
+    const size_t words = planner.words();
+    StreamBuffer buf = StreamBuffer::acquire(words + 2);
+    if (!buf) return StreamBuffer();
 
-    for (uint32_t i = 0; i < M; i++) {
-        float u = ((float)i + 0.5f) / (float)M;
-        float g = 6.0f * u * (1.0f - u);   // bell-shape
-        w[i] = g;
-        weight_sum += g;
-    }
-
-    if (weight_sum <= 0.0f) {
-        free(cmds);
-        return NULL;
-    }
-
-    // ---------- 短行程峰值缩放 ----------
-    float alpha = 1.0f;
-    if (!has_cruise && Sr_nominal > 0) {
-        alpha = (float)Sr / (float)Sr_nominal;
-        if (alpha > 1.0f) alpha = 1.0f;
-    }
-
-    // ---------- 分配加速段 steps ----------
-    uint32_t steps_accum = 0;
-    uint32_t steps_acc[PROFILE_SEGMENTS];
-    uint32_t rem[PROFILE_SEGMENTS];
-
-    for (uint32_t i = 0; i < M; i++) {
-        float exact = (w[i] / weight_sum) * Sr;
-        uint32_t s = (uint32_t)floorf(exact);
-        steps_acc[i] = s;
-        rem[i] = (uint32_t)((exact - s) * 1e6f);
-        steps_accum += s;
-    }
-
-    // ---------- 余数补齐 ----------
-    while (steps_accum < Sr) {
-        uint32_t best = 0;
-        for (uint32_t i = 1; i < M; i++) {
-            if (rem[i] > rem[best]) best = i;
-        }
-        steps_acc[best]++;
-        rem[best] = 0;
-        steps_accum++;
-    }
-
-    // ---------- 输出指令 ----------
-    uint32_t idx = 0;
-
-    // --- 加速段 ---
-    for (uint32_t i = 0; i < M; i++) {
-        if (steps_acc[i] == 0) continue;
-
-        uint32_t speed = (uint32_t)lroundf(v_max * alpha * w[i]);
-        if (speed < 1) speed = 1;
-
-        cmds[idx].delay = speed_hz_to_delay(speed);
-        cmds[idx].steps = steps_acc[i];
-        idx++;
-    }
-
-    // --- 匀速段 ---
-    if (has_cruise && S_cruise > 0) {
-        cmds[idx].delay = speed_hz_to_delay(v_max);
-        cmds[idx].steps = S_cruise;
-        idx++;
-    }
-
-    // --- 减速段 ---
-    for (int32_t i = (int32_t)M - 1; i >= 0; i--) {
-        if (steps_acc[i] == 0) continue;
-
-        uint32_t speed = (uint32_t)lroundf(v_max * alpha * w[i]);
-        if (speed < 1) speed = 1;
-
-        cmds[idx].delay = speed_hz_to_delay(speed);
-        cmds[idx].steps = steps_acc[i];
-        idx++;
-    }
+    planner.emit_all(buf.data(), words);
 
     // --- End marker ---
-    cmds[idx].delay = 0;
-    cmds[idx].steps = 0;
+    buf.data()[words]     = 0;
+    buf.data()[words + 1] = 0;
+
+    buf.set_size(words);
+    return buf;
+}
 
-    return cmds;
+SCurvePlanner::Limits ce_ramp_limits(uint32_t v_max,
+                                     uint32_t total_steps,
+                                     uint32_t ramp_steps_per_side)
+{
+    // ---------- ramp 步数 -> 运动学限制 ----------
+    // 旧接口以 “每侧 ramp 步数” 描述加减速；换算成纯 jerk 斜坡：
+    //   Sr = v * Tj, a = v^2 / Sr, j = v^3 / Sr^2   (v*j == a^2, 无匀加速段)
+    // 短行程由 planner 自行降低峰值速度。
+    uint32_t Sr = ramp_steps_per_side;
+    if (Sr == 0 || Sr > total_steps / 2) Sr = total_steps / 2;
+    if (Sr == 0) Sr = 1;
+
+    const float v  = (float)v_max;
+    const float sr = (float)Sr;
+
+    SCurvePlanner::Limits lim{};
+    lim.v_max = v;
+    lim.a_max = v * v / sr;
+    lim.j_max = v * v * v / (sr * sr);
+    return lim;
 }
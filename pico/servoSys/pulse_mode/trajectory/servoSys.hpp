@@ -0,0 +1,41 @@
+#pragma once
+
+#include "pio/stream_pool.hpp"
+#include "pio/pio_exec.hpp"
+#include "timing/pio_timing.hpp"
+#include "s_curve_planner.hpp"
+#include <cstdint>
+
+// motor_exec FIFO format: [duty_period, steps]
+typedef struct {
+    uint32_t duty;
+    uint32_t steps;
+} pio_cmd_t;
+
+constexpr uint32_t CE_PROFILE_SEGMENTS = 32;   // S 曲线段数（每侧）
+
+// =======================================================
+// CE trajectory discretization (STEP domain only)
+//   - legacy entry point, backed by SCurvePlanner
+//   - returns a stream pool block (no heap): size() raw words,
+//     followed by a {0, 0} end marker; released with the handle
+//     (or by PS100_P::run_pio_stream once the move has run)
+//   - empty handle on invalid parameters / pool exhausted
+// =======================================================
+StreamBuffer ce_config_to_pio(uint32_t v_max,
+                              uint32_t total_steps,
+                              uint32_t ramp_steps_per_side,
+                              uint32_t radar_ratio);
+
+// Same move for an explicit timing model (program variant + clock
+// divider of the target SM, motor_exec_timing_for()) and word format.
+StreamBuffer ce_config_to_pio(uint32_t v_max,
+                              uint32_t total_steps,
+                              uint32_t ramp_steps_per_side,
+                              const PioTiming& timing,
+                              MotorExecFormat fmt);
+
+// "ramp steps per side" -> pure jerk-limited ramp limits (as used above)
+SCurvePlanner::Limits ce_ramp_limits(uint32_t v_max,
+                                     uint32_t total_steps,
+                                     uint32_t ramp_steps_per_side);
@@ -0,0 +1,174 @@
+#include "traj_lib.hpp"
+
+#include "pio/motor_exec_variants.hpp"
+
+#include <cstring>
+
+// ------------------------------------------------------------
+// Internal helpers
+// ------------------------------------------------------------
+
+namespace {
+
+static size_t player_refill(uint32_t* dst, size_t capacity, void* user) {
+    TrajLibPlayer* p = static_cast<TrajLibPlayer*>(user);
+
+    const size_t n = (p->left < capacity) ? p->left : capacity;
+    if (n) {
+        std::memcpy(dst, p->src, n * sizeof(uint32_t));
+        p->src  += n;
+        p->left -= n;
+    }
+    return n;   // short half: zero padded by the ring (no-op words)
+}
+
+// words as DMA should read them: flash through the no-allocate alias,
+// so a long stream does not evict code from the XIP cache
+static const uint32_t* dma_address(const uint32_t* p) {
+#if defined(XIP_BASE) && defined(XIP_NOCACHE_NOALLOC_BASE)
+    constexpr uintptr_t XIP_WINDOW = 0x01000000u;   // 16 MiB flash window
+
+    const uintptr_t a = reinterpret_cast<uintptr_t>(p);
+    if (a >= XIP_BASE && a < XIP_BASE + XIP_WINDOW) {
+        return reinterpret_cast<const uint32_t*>(a - XIP_BASE + XIP_NOCACHE_NOALLOC_BASE);
+    }
+#endif
+    return p;
+}
+
+} // namespace
+
+// ------------------------------------------------------------
+// Image
+// ------------------------------------------------------------
+
+uint32_t traj_lib_crc32(const void* data, size_t bytes, uint32_t crc) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+
+    crc = ~crc;
+    while (bytes--) {
+        crc ^= *p++;
+        for (int k = 0; k < 8; ++k) {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+        }
+    }
+    return ~crc;
+}
+
+uint32_t traj_lib_id(const char* name) {
+    uint32_t h = 2166136261u;
+    while (*name) {
+        h ^= (uint8_t)*name++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+bool traj_lib_open(const void* image, size_t max_bytes, TrajLib& lib, bool verify) {
+    lib = TrajLib();
+
+    if (!image || ((uintptr_t)image & 3u)) return false;
+    if (max_bytes < sizeof(TrajLibHeader)) return false;
+
+    const TrajLibHeader* h = static_cast<const TrajLibHeader*>(image);
+    if (h->magic != TRAJ_LIB_MAGIC || h->version != TRAJ_LIB_VERSION) return false;
+    if (h->count > TRAJ_LIB_MAX_ENTRIES) return false;
+
+    // ---------- size (erased flash reads 0xFF..: bounded by max_bytes) ----------
+    const size_t dir_bytes   = (size_t)h->count * sizeof(TrajLibEntry);
+    const size_t avail_words = (max_bytes - sizeof(TrajLibHeader)) / sizeof(uint32_t);
+    if (dir_bytes > max_bytes - sizeof(TrajLibHeader)) return false;
+    if (h->words > avail_words - dir_bytes / sizeof(uint32_t)) return false;
+
+    const TrajLibEntry* dir   = reinterpret_cast<const TrajLibEntry*>(h + 1);
+    const uint32_t*     words = reinterpret_cast<const uint32_t*>(dir + h->count);
+
+    for (size_t i = 0; i < h->count; ++i) {
+        const TrajLibEntry& e = dir[i];
+        if (e.words == 0 || e.offset > h->words || e.words > h->words - e.offset) return false;
+        if (e.format > (uint8_t)MotorExecFormat::Packed) return false;
+    }
+
+    if (verify) {
+        uint32_t crc = traj_lib_crc32(dir, dir_bytes);
+        crc = traj_lib_crc32(words, (size_t)h->words * sizeof(uint32_t), crc);
+        if (crc != h->crc32) return false;
+    }
+
+    lib.header = h;
+    lib.dir    = dir;
+    lib.words  = words;
+    return true;
+}
+
+#ifdef XIP_BASE
+bool traj_lib_open_partition(TrajLib& lib, bool verify) {
+    return traj_lib_open(reinterpret_cast<const void*>(XIP_BASE + TRAJ_LIB_FLASH_OFFSET),
+                         TRAJ_LIB_FLASH_SIZE, lib, verify);
+}
+#endif
+
+const TrajLibEntry* traj_lib_find(const TrajLib& lib, uint32_t id) {
+    for (size_t i = 0; i < lib.count(); ++i) {
+        if (lib.dir[i].id == id) return &lib.dir[i];
+    }
+    return nullptr;
+}
+
+const TrajLibEntry* traj_lib_find(const TrajLib& lib, const char* name) {
+    return traj_lib_find(lib, traj_lib_id(name));
+}
+
+const uint32_t* traj_lib_words(const TrajLib& lib, const TrajLibEntry& e) {
+    return lib.words + e.offset;
+}
+
+bool traj_lib_compatible(const TrajLib& lib, const PS100_P& axis) {
+    if (!lib.header || !axis.program()) return false;
+
+    const TrajLibHeader& h = *lib.header;
+    const PioTiming&     t = axis.timing();
+    return h.variant == (uint8_t)axis.program()->variant
+        && h.f_pio == t.f_pio && h.per_duty == t.per_duty && h.fixed == t.fixed;
+}
+
+// ------------------------------------------------------------
+// Playback
+// ------------------------------------------------------------
+
+TrajLibMode traj_lib_auto_mode(const PS100_P& axis, const TrajLibEntry& e) {
+    const MotorExecProgram* p = axis.program();
+    if (e.min_cmd_us < TRAJ_LIB_XIP_MIN_CMD_US && p && (p->caps & MOTOR_EXEC_CAP_DWELL)) {
+        return TrajLibMode::Staged;
+    }
+    return TrajLibMode::Direct;
+}
+
+bool traj_lib_run(PS100_P& axis,
+                  const TrajLib& lib,
+                  const TrajLibEntry& e,
+                  TrajLibPlayer& player,
+                  TrajLibMode mode)
+{
+    if (!traj_lib_compatible(lib, axis)) return false;
+
+    const MotorExecFormat fmt = (MotorExecFormat)e.format;
+    const uint32_t*       src = traj_lib_words(lib, e);
+
+    if (mode == TrajLibMode::Auto) mode = traj_lib_auto_mode(axis, e);
+
+    // ---------- Direct: DMA reads the flash ----------
+    if (mode == TrajLibMode::Direct) {
+        axis.run_pio_stream(dma_address(src), e.words, e.duration_us, fmt);
+        return axis.busy();
+    }
+
+    // ---------- Staged: refill copies one half at a time ----------
+    // (zero padding of the last half needs no-op words: Exec only)
+    if (!(axis.program()->caps & MOTOR_EXEC_CAP_DWELL)) return false;
+
+    player.src  = src;
+    player.left = e.words;
+    return axis.run_pio_ring(player.ring, TrajLibPlayer::HALF_WORDS,
+                             player_refill, &player, fmt);
+}
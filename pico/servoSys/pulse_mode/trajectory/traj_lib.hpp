@@ -0,0 +1,145 @@
+#pragma once
+
+#include "drivers/ps100.hpp"
+#include "pio/pio_exec.hpp"
+#include "timing/pio_timing.hpp"
+
+#include <cstdint>
+#include <cstddef>
+
+// =======================================================
+// Flash trajectory library (pre-encoded motor_exec streams)
+//   - fixed scans are planned + encoded on the host (sim build:
+//     traj_lib_build, same planner / encoder sources as the
+//     firmware) into one image: header, directory, stream words
+//   - the image lives in flash: a partition written with picotool
+//     (TRAJ_LIB_FLASH_OFFSET) or a const array linked into the
+//     firmware (traj_lib_build --cpp); it is read in place, nothing
+//     is copied to SRAM and nothing is planned at run time
+//   - playback (traj_lib_run):
+//       Direct : DMA streams the words straight out of XIP
+//                (no-allocate alias: code stays in the XIP cache)
+//       Staged : CPU copies into a small SRAM ring in the DMA IRQ,
+//                for commands too short to survive XIP misses
+//       Auto   : Staged if the entry's shortest command is below
+//                TRAJ_LIB_XIP_MIN_CMD_US (Exec variant), else Direct
+//   - an image is encoded for ONE timing model (variant + f_sys +
+//     clock divider); traj_lib_run refuses an axis that differs
+//
+// Image layout (little endian, word aligned, read as structs):
+//   TrajLibHeader
+//   TrajLibEntry x count
+//   uint32_t words[header.words]      entry streams, back to back
+//   crc32 (IEEE) over directory + words in header.crc32
+// =======================================================
+
+constexpr uint32_t TRAJ_LIB_MAGIC       = 0x4C544D50u;   // "PMTL"
+constexpr uint16_t TRAJ_LIB_VERSION     = 1;
+constexpr size_t   TRAJ_LIB_MAX_ENTRIES = 256;
+
+// below this a command is too short to be fetched from XIP on demand
+constexpr uint32_t TRAJ_LIB_XIP_MIN_CMD_US = 20;
+
+// default partition: last 512 KiB of a 2 MiB flash (keep the firmware below it)
+#ifndef TRAJ_LIB_FLASH_OFFSET
+#define TRAJ_LIB_FLASH_OFFSET (1536u * 1024u)
+#endif
+#ifndef TRAJ_LIB_FLASH_SIZE
+#define TRAJ_LIB_FLASH_SIZE (512u * 1024u)
+#endif
+
+struct TrajLibHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t count;        // directory entries
+    uint32_t f_pio;        // timing model the words are encoded for
+    uint16_t per_duty;
+    uint16_t fixed;
+    uint8_t  variant;      // MotorExecVariant
+    uint8_t  reserved[3];
+    uint32_t words;        // stream words after the directory
+    uint32_t crc32;        // directory + words
+};
+
+struct TrajLibEntry {
+    uint32_t id;           // traj_lib_id(name)
+    uint32_t offset;       // first word, from the start of the stream words
+    uint32_t words;        // stream length
+    uint32_t steps;        // pulses
+    uint32_t min_cmd_us;   // shortest command (FIFO demand when fed from XIP)
+    uint32_t duration_us;  // whole move
+    uint8_t  format;       // MotorExecFormat
+    uint8_t  reserved[3];
+};
+
+static_assert(sizeof(TrajLibHeader) == 28, "TrajLibHeader is part of the image format");
+static_assert(sizeof(TrajLibEntry) == 28, "TrajLibEntry is part of the image format");
+
+// opened image (pointers into flash)
+struct TrajLib {
+    const TrajLibHeader* header = nullptr;
+    const TrajLibEntry*  dir    = nullptr;
+    const uint32_t*      words  = nullptr;
+
+    size_t count() const { return header ? header->count : 0; }
+};
+
+enum class TrajLibMode : uint8_t { Auto, Direct, Staged };
+
+// SRAM staging ring: caller keeps it alive (static) until !busy()
+struct TrajLibPlayer {
+    static constexpr size_t HALF_WORDS = 64;   // even: raw commands are never split
+
+    uint32_t        ring[2 * HALF_WORDS];
+    const uint32_t* src  = nullptr;
+    size_t          left = 0;
+};
+
+// generated by traj_lib_build --cpp (link the file to use it)
+extern const uint32_t traj_lib_image[];
+extern const size_t   traj_lib_image_bytes;
+
+// ------------------------------------------------------------
+// Image
+// ------------------------------------------------------------
+
+// validate an image at `image` (at most max_bytes); verify: check the crc
+// (reads the whole image once). false: not a library / corrupt / truncated
+bool traj_lib_open(const void* image, size_t max_bytes, TrajLib& lib, bool verify = true);
+
+#ifdef XIP_BASE
+// image in the flash partition at TRAJ_LIB_FLASH_OFFSET
+bool traj_lib_open_partition(TrajLib& lib, bool verify = true);
+#endif
+
+// entry id of a name (FNV-1a 32, same as traj_lib_build)
+uint32_t traj_lib_id(const char* name);
+
+// nullptr if not in the library
+const TrajLibEntry* traj_lib_find(const TrajLib& lib, uint32_t id);
+const TrajLibEntry* traj_lib_find(const TrajLib& lib, const char* name);
+
+// words of an entry, as addressed by the CPU
+const uint32_t* traj_lib_words(const TrajLib& lib, const TrajLibEntry& e);
+
+// image encoded for this axis (variant + timing model)?
+bool traj_lib_compatible(const TrajLib& lib, const PS100_P& axis);
+
+// IEEE crc32 (reflected 0xEDB88320), shared with the builder
+uint32_t traj_lib_crc32(const void* data, size_t bytes, uint32_t crc = 0);
+
+// ------------------------------------------------------------
+// Playback
+// ------------------------------------------------------------
+
+// Start entry `e` on `axis` (replaces the running command, like run_*).
+// DIR: the stream carries it for DIR variants, else set_direction() first.
+// false: incompatible axis / Staged without ring support / start failed
+bool traj_lib_run(PS100_P& axis,
+                  const TrajLib& lib,
+                  const TrajLibEntry& e,
+                  TrajLibPlayer& player,
+                  TrajLibMode mode = TrajLibMode::Auto);
+
+// mode Auto picks for this entry on this axis
+TrajLibMode traj_lib_auto_mode(const PS100_P& axis, const TrajLibEntry& e);
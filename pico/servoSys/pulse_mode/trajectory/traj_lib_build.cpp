@@ -0,0 +1,153 @@
+#include "traj_lib_build.hpp"
+
+#include "servoSys.hpp"
+
+#include <cstring>
+
+TrajLibBuilder::TrajLibBuilder(uint32_t* out,
+                               size_t cap_words,
+                               MotorExecVariant variant,
+                               const PioTiming& timing,
+                               uint32_t high,
+                               bool dir_invert,
+                               uint32_t dir_setup_us)
+    : out_(out),
+      cap_(cap_words),
+      prog_(motor_exec_variant_program(variant)),
+      timing_(timing),
+      high_(high),
+      setup_(motor_exec_variant_setup_loops(timing, dir_setup_us)),
+      dir_invert_(dir_invert)
+{
+    if (!out_)                                                        error_ = "no output buffer";
+    else if (!prog_)                                                  error_ = "unknown variant";
+    else if (timing_.per_duty > 0xFFFFu || timing_.fixed > 0xFFFFu)   error_ = "timing model out of range";
+    closed_ = (error_ != nullptr);
+}
+
+bool TrajLibBuilder::fail(const char* why) {
+    error_ = why;
+    return false;
+}
+
+bool TrajLibBuilder::add_entry(const char* name, size_t words, uint32_t steps,
+                               uint64_t min_cmd_us, uint64_t duration_us,
+                               MotorExecFormat fmt)
+{
+    const uint32_t id = traj_lib_id(name);
+    for (size_t i = 0; i < count_; ++i) {
+        if (dir_[i].id == id) return fail("duplicate name (or id collision)");
+    }
+
+    TrajLibEntry& e = dir_[count_++];
+    e.id          = id;
+    e.offset      = (uint32_t)used_;
+    e.words       = (uint32_t)words;
+    e.steps       = steps;
+    e.min_cmd_us  = (min_cmd_us > UINT32_MAX) ? UINT32_MAX : (uint32_t)min_cmd_us;
+    e.duration_us = (duration_us > UINT32_MAX) ? UINT32_MAX : (uint32_t)duration_us;
+    e.format      = (uint8_t)fmt;
+
+    used_ += words;
+    return true;
+}
+
+bool TrajLibBuilder::add_scurve(const char* name,
+                                uint32_t v_max,
+                                uint32_t total_steps,
+                                uint32_t ramp_steps_per_side,
+                                MotorExecFormat fmt)
+{
+    if (closed_) return false;
+    if (!name || !*name) return fail("empty name");
+    if (count_ >= TRAJ_LIB_MAX_ENTRIES) return fail("directory full");
+    if (prog_->variant != MotorExecVariant::Exec) return fail("scurve needs the exec variant");
+    if (v_max == 0 || total_steps == 0) return fail("scurve: zero v_max / steps");
+
+    const SCurvePlanner::Limits lim = ce_ramp_limits(v_max, total_steps, ramp_steps_per_side);
+    SCurvePlanner planner(timing_, CE_PROFILE_SEGMENTS);
+
+    // ---------- raw pass: command timing ----------
+    if (!planner.plan(lim, total_steps)) return fail("scurve: plan failed");
+
+    const size_t room = cap_ - used_;
+    uint32_t*    dst  = out_ + used_;
+
+    size_t words = planner.words();
+    if (words > room || planner.emit_all(dst, room) != words) return fail("image buffer full");
+
+    uint64_t min_us = UINT64_MAX, total_us = 0;
+    for (size_t i = 0; i + 1 < words; i += 2) {
+        const uint64_t us = timing_.duration_us(dst[i], dst[i + 1]);
+        if (us < min_us) min_us = us;
+        total_us += us;
+    }
+
+    // ---------- packed: same plan, re-emitted ----------
+    if (fmt == MotorExecFormat::Packed) {
+        planner.set_format(fmt);
+        if (!planner.plan(lim, total_steps)) return fail("scurve: packed plan failed");
+
+        words = planner.words();
+        if (words > room || planner.emit_all(dst, room) != words) return fail("image buffer full");
+    }
+
+    return add_entry(name, words, total_steps, min_us, total_us, fmt);
+}
+
+bool TrajLibBuilder::add_moves(const char* name, const MotorExecMove* moves, size_t n) {
+    if (closed_) return false;
+    if (!name || !*name) return fail("empty name");
+    if (count_ >= TRAJ_LIB_MAX_ENTRIES) return fail("directory full");
+    if (!moves || n == 0) return fail("moves: empty");
+
+    const size_t words = motor_exec_variant_encode(*prog_, timing_, high_, setup_, dir_invert_,
+                                                   moves, n, out_ + used_, cap_ - used_);
+    if (words == 0) return fail("moves: invalid for this variant / image buffer full");
+
+    uint64_t min_us = UINT64_MAX, total_us = 0;
+    uint64_t steps  = 0;
+    for (size_t i = 0; i < n; ++i) {
+        const uint64_t us = timing_.duration_us(timing_.hz_to_duty(moves[i].hz), moves[i].steps);
+        if (us < min_us) min_us = us;
+        total_us += us;
+        steps    += moves[i].steps;
+    }
+    if (steps > UINT32_MAX) return fail("moves: too many steps");
+
+    return add_entry(name, words, (uint32_t)steps, min_us, total_us, MotorExecFormat::Raw);
+}
+
+size_t TrajLibBuilder::finish() {
+    if (closed_) return 0;
+
+    const size_t head_words = (sizeof(TrajLibHeader) + count_ * sizeof(TrajLibEntry))
+                              / sizeof(uint32_t);
+    if (head_words + used_ > cap_) {
+        fail("image buffer full");
+        return 0;
+    }
+
+    // words were written from out_[0]: move them behind the directory
+    std::memmove(out_ + head_words, out_, used_ * sizeof(uint32_t));
+    std::memcpy(out_ + sizeof(TrajLibHeader) / sizeof(uint32_t), dir_,
+                count_ * sizeof(TrajLibEntry));
+
+    TrajLibHeader h{};
+    h.magic    = TRAJ_LIB_MAGIC;
+    h.version  = TRAJ_LIB_VERSION;
+    h.count    = (uint16_t)count_;
+    h.f_pio    = timing_.f_pio;
+    h.per_duty = (uint16_t)timing_.per_duty;
+    h.fixed    = (uint16_t)timing_.fixed;
+    h.variant  = (uint8_t)prog_->variant;
+    h.words    = (uint32_t)used_;
+    h.crc32    = traj_lib_crc32(out_ + head_words, used_ * sizeof(uint32_t),
+                                traj_lib_crc32(dir_, count_ * sizeof(TrajLibEntry)));
+    std::memcpy(out_, &h, sizeof(h));
+
+    // the builder is spent: a second finish() would move the words again
+    closed_ = true;
+    error_  = "finished";
+    return (head_words + used_) * sizeof(uint32_t);
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "traj_lib.hpp"
+#include "pio/motor_exec_variants.hpp"
+
+#include <cstdint>
+#include <cstddef>
+
+// =======================================================
+// Trajectory library builder (host side, see traj_lib.hpp)
+//   - plans + encodes with the firmware's own sources, for an
+//     explicit timing model (make_pio_timing: no clock reads)
+//   - add_scurve(): SCurvePlanner exactly as ce_config_to_pio()
+//     (same segments, same ramp limits) => same words (Exec only)
+//   - add_moves():  motor_exec_variant_encode() (any variant)
+//   - finish() lays out header + directory + words in `out`
+//   - no heap; the directory is kept in the object (large: static)
+// =======================================================
+
+class TrajLibBuilder {
+public:
+    // out: image buffer (word aligned), cap_words: its size
+    // high: PULSE_WIDTH loops (AdjustableDuty), baked into `timing`
+    // dir_invert, dir_setup_us: as PS100_P::Config of the target axis (DIR variants)
+    TrajLibBuilder(uint32_t* out,
+                   size_t cap_words,
+                   MotorExecVariant variant,
+                   const PioTiming& timing,
+                   uint32_t high = 0,
+                   bool dir_invert = false,
+                   uint32_t dir_setup_us = MOTOR_EXEC_DIR_SETUP_US);
+
+    // false: invalid move / wrong variant / duplicate name / full
+    // (error() says why; nothing is added, later calls still work)
+    bool add_scurve(const char* name,
+                    uint32_t v_max,
+                    uint32_t total_steps,
+                    uint32_t ramp_steps_per_side,
+                    MotorExecFormat fmt = MotorExecFormat::Raw);
+
+    bool add_moves(const char* name, const MotorExecMove* moves, size_t n);
+
+    // image size in bytes, 0 on a bad constructor argument or no room.
+    // Once only: the builder is closed afterwards
+    size_t finish();
+
+    const char* error() const { return error_; }
+    size_t      count() const { return count_; }
+
+private:
+    bool fail(const char* why);
+    bool add_entry(const char* name, size_t words, uint32_t steps,
+                   uint64_t min_cmd_us, uint64_t duration_us, MotorExecFormat fmt);
+
+    uint32_t*               out_;
+    size_t                  cap_;
+    size_t                  used_ = 0;     // stream words so far (at out_[0..])
+    const MotorExecProgram* prog_;
+    PioTiming               timing_;
+    uint32_t                high_;
+    uint32_t                setup_;        // DIR word setup loops
+    bool                    dir_invert_;
+
+    TrajLibEntry dir_[TRAJ_LIB_MAX_ENTRIES]{};
+    size_t       count_ = 0;
+    const char*  error_ = nullptr;    // last failure
+    bool         closed_ = false;     // bad config / finished
+};
@@ -0,0 +1,227 @@
+#include "traj_lib_build.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// ============================================================
+// traj_lib_build: trajectory library image from a text spec
+//
+//   traj_lib_build spec.txt [-o lib.bin] [--cpp lib.cpp]
+//                  [--variant exec] [--clk-div 1.0] [--f-sys 125000000]
+//                  [--pulse-us 10] [--dir-invert] [--dir-setup-us 5]
+//
+//   spec (one entry per line, '#' comments):
+//     scurve <name> <v_max> <steps> <ramp_steps> [packed]
+//     moves  <name> <hz>:<steps>[:r] ...          (r = reverse)
+//
+//   -o    : raw image (flash partition: picotool load -o 0x10180000)
+//   --cpp : const array for the firmware (traj_lib_image[])
+//   the timing options must match the target axis' Config
+//   (traj_lib_run refuses an axis with another timing model)
+//
+// Built in the sim tree (sim/CMakeLists.txt): same planner and
+// encoder sources as the firmware, no pico-sdk needed.
+// ============================================================
+
+namespace {
+
+constexpr size_t IMAGE_WORDS = TRAJ_LIB_FLASH_SIZE / sizeof(uint32_t);
+constexpr size_t MAX_MOVES   = 256;
+
+static uint32_t       image[IMAGE_WORDS];
+static MotorExecMove  moves[MAX_MOVES];
+
+struct Options {
+    const char*      spec      = nullptr;
+    const char*      bin       = nullptr;
+    const char*      cpp       = nullptr;
+    MotorExecVariant variant   = MotorExecVariant::Exec;
+    float            clk_div   = 1.0f;
+    uint32_t         f_sys     = SIM_SYS_CLK_HZ;
+    uint32_t         pulse_us  = 10;
+    bool             dir_inv   = false;
+    uint32_t         setup_us  = MOTOR_EXEC_DIR_SETUP_US;
+};
+
+static bool parse_variant(const char* s, MotorExecVariant& v) {
+    const MotorExecVariant all[] = {
+        MotorExecVariant::Exec, MotorExecVariant::StepOnly, MotorExecVariant::HalfDuty,
+        MotorExecVariant::HalfDutyV2, MotorExecVariant::AdjustableDuty
+    };
+    for (MotorExecVariant c : all) {
+        const MotorExecProgram* p = motor_exec_variant_program(c);
+        if (p && std::strcmp(p->name, s) == 0) {
+            v = c;
+            return true;
+        }
+    }
+    return false;
+}
+
+static int usage() {
+    std::fprintf(stderr,
+                 "usage: traj_lib_build spec.txt [-o lib.bin] [--cpp lib.cpp]\n"
+                 "       [--variant exec|step_only|half_duty|half_duty_v2|adjustable]\n"
+                 "       [--clk-div D] [--f-sys HZ] [--pulse-us US] [--dir-invert]\n"
+                 "       [--dir-setup-us US]\n");
+    return 2;
+}
+
+// one spec line; false + message on error
+static bool add_line(TrajLibBuilder& b, char* line, unsigned lineno) {
+    char* tok[2 + MAX_MOVES];
+    size_t n = 0;
+    for (char* t = std::strtok(line, " \t\r\n"); t && n < 2 + MAX_MOVES;
+         t = std::strtok(nullptr, " \t\r\n")) {
+        if (t[0] == '#') break;
+        tok[n++] = t;
+    }
+    if (n == 0) return true;
+
+    if (std::strcmp(tok[0], "scurve") == 0 && (n == 5 || n == 6)) {
+        MotorExecFormat fmt = MotorExecFormat::Raw;
+        if (n == 6) {
+            if (std::strcmp(tok[5], "packed") != 0) goto bad;
+            fmt = MotorExecFormat::Packed;
+        }
+        if (b.add_scurve(tok[1], std::strtoul(tok[2], nullptr, 0),
+                         std::strtoul(tok[3], nullptr, 0),
+                         std::strtoul(tok[4], nullptr, 0), fmt)) {
+            return true;
+        }
+    } else if (std::strcmp(tok[0], "moves") == 0 && n >= 3) {
+        size_t m = 0;
+        for (size_t i = 2; i < n; ++i) {
+            char* end = nullptr;
+            MotorExecMove& mv = moves[m++];
+            mv.hz = std::strtoul(tok[i], &end, 0);
+            if (*end != ':') goto bad;
+            mv.steps   = std::strtoul(end + 1, &end, 0);
+            mv.forward = true;
+            if (*end == ':' && std::strcmp(end, ":r") == 0) mv.forward = false;
+            else if (*end != '\0') goto bad;
+        }
+        if (b.add_moves(tok[1], moves, m)) return true;
+    } else {
+        goto bad;
+    }
+
+    std::fprintf(stderr, "line %u: %s\n", lineno, b.error());
+    return false;
+
+bad:
+    std::fprintf(stderr, "line %u: syntax error\n", lineno);
+    return false;
+}
+
+static bool write_bin(const char* path, size_t bytes) {
+    FILE* f = std::fopen(path, "wb");
+    if (!f) return false;
+    const bool ok = std::fwrite(image, 1, bytes, f) == bytes;
+    return (std::fclose(f) == 0) && ok;
+}
+
+static bool write_cpp(const char* path, size_t bytes) {
+    FILE* f = std::fopen(path, "w");
+    if (!f) return false;
+
+    std::fprintf(f,
+                 "// generated by traj_lib_build, do not edit\n"
+                 "#include \"trajectory/traj_lib.hpp\"\n\n"
+                 "#ifdef __in_flash\n"
+                 "__in_flash(\"traj_lib\")\n"
+                 "#endif\n"
+                 "alignas(4) const uint32_t traj_lib_image[%zu] = {\n",
+                 bytes / sizeof(uint32_t));
+    for (size_t i = 0; i < bytes / sizeof(uint32_t); ++i) {
+        std::fprintf(f, "%s0x%08x,%s", (i % 8) ? " " : "    ", image[i],
+                     (i % 8 == 7) ? "\n" : "");
+    }
+    std::fprintf(f, "%s};\n\nconst size_t traj_lib_image_bytes = %zu;\n",
+                 (bytes / sizeof(uint32_t)) % 8 ? "\n" : "", bytes);
+
+    return std::fclose(f) == 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options o;
+
+    for (int i = 1; i < argc; ++i) {
+        const char* a    = argv[i];
+        const char* next = (i + 1 < argc) ? argv[i + 1] : nullptr;
+
+        if (std::strcmp(a, "--dir-invert") == 0) {
+            o.dir_inv = true;
+        } else if (a[0] == '-' && !next) {
+            return usage();
+        } else if (std::strcmp(a, "-o") == 0) {
+            o.bin = argv[++i];
+        } else if (std::strcmp(a, "--cpp") == 0) {
+            o.cpp = argv[++i];
+        } else if (std::strcmp(a, "--variant") == 0) {
+            if (!parse_variant(argv[++i], o.variant)) return usage();
+        } else if (std::strcmp(a, "--clk-div") == 0) {
+            o.clk_div = std::strtof(argv[++i], nullptr);
+        } else if (std::strcmp(a, "--f-sys") == 0) {
+            o.f_sys = std::strtoul(argv[++i], nullptr, 0);
+        } else if (std::strcmp(a, "--pulse-us") == 0) {
+            o.pulse_us = std::strtoul(argv[++i], nullptr, 0);
+        } else if (std::strcmp(a, "--dir-setup-us") == 0) {
+            o.setup_us = std::strtoul(argv[++i], nullptr, 0);
+        } else if (a[0] != '-' && !o.spec) {
+            o.spec = a;
+        } else {
+            return usage();
+        }
+    }
+    if (!o.spec || (!o.bin && !o.cpp) || o.clk_div < 1.0f || o.f_sys == 0) return usage();
+
+    // ---------- timing model of the target SM ----------
+    uint32_t di = 1, df = 0;
+    pio_timing_split_clkdiv(o.clk_div, di, df);
+
+    PioTiming t     = make_pio_timing(o.variant, o.f_sys, di, df);
+    uint32_t  high  = 0;
+    const MotorExecProgram* p = motor_exec_variant_program(o.variant);
+    if (p->caps & MOTOR_EXEC_CAP_PULSE_WIDTH) {
+        high = motor_exec_variant_high_loops(t, o.pulse_us);
+        t    = make_pio_timing(o.variant, o.f_sys, di, df, high);
+    }
+
+    static TrajLibBuilder b(image, IMAGE_WORDS, o.variant, t, high, o.dir_inv, o.setup_us);
+
+    // ---------- spec ----------
+    FILE* f = std::fopen(o.spec, "r");
+    if (!f) {
+        std::fprintf(stderr, "%s: cannot open\n", o.spec);
+        return 1;
+    }
+    char     line[4096];
+    unsigned lineno = 0;
+    bool     ok     = true;
+    while (ok && std::fgets(line, sizeof(line), f)) ok = add_line(b, line, ++lineno);
+    std::fclose(f);
+    if (!ok) return 1;
+
+    const size_t bytes = b.finish();
+    if (bytes == 0) {
+        std::fprintf(stderr, "%s\n", b.error() ? b.error() : "empty library");
+        return 1;
+    }
+
+    if (o.bin && !write_bin(o.bin, bytes)) {
+        std::fprintf(stderr, "%s: write failed\n", o.bin);
+        return 1;
+    }
+    if (o.cpp && !write_cpp(o.cpp, bytes)) {
+        std::fprintf(stderr, "%s: write failed\n", o.cpp);
+        return 1;
+    }
+
+    std::printf("%zu entries, %zu bytes, %s @ f_pio %u Hz\n",
+                b.count(), bytes, p->name, (unsigned)t.f_pio);
+    return 0;
+}
@@ -0,0 +1,263 @@
+"""
+rail_stream.py
+------------------------------------------------------------
+Host side of the servo_fw streaming channel (pico/servoSys/pulse_mode).
+
+Instead of reconstructing the pose from send times, the rail reports
+it: servo_fw sends a telemetry frame at a fixed rate with, per axis,
+the hardware step position, the ID of the executing segment and the
+queue credits. Every sample is time stamped on the device (t_us).
+
+Flow control is credit based:
+- the k-th segment sent on an axis has ID k (mod 2^16)
+- the device reports a credit limit per axis: IDs below it fit
+- send() blocks until every masked axis has a credit, then sends
+  without waiting for a reply (quiet mode: accepted frames are not
+  answered, rejections are)
+
+Wire formats: firmware/fw_protocol.hpp.
+"""
+
+from __future__ import annotations
+
+from dataclasses import dataclass
+from pathlib import Path
+import csv
+import struct
+import threading
+import time
+from typing import Callable, List, Optional
+
+
+# ============================================================
+# Protocol constants (firmware/fw_protocol.hpp)
+# ============================================================
+
+HEADER_PULSE     = 0xAF
+HEADER_CONTROL   = 0xCF
+HEADER_REPLY     = 0xFA
+HEADER_TELEMETRY = 0xFB
+
+CONTROL_STOP      = 0
+CONTROL_STATUS    = 1
+CONTROL_TELEMETRY = 3
+
+TELEMETRY_QUIET = 1 << 0
+
+TELEMETRY_HEADER = struct.Struct("<BBBI")    # header, seq, axes, t_us
+TELEMETRY_AXIS   = struct.Struct("<iHBH")    # position, segment, depth, limit
+
+
+# ============================================================
+# Data structures
+# ============================================================
+
+@dataclass
+class AxisSample:
+    """One axis of one telemetry frame."""
+    position: int      # steps (step_position register)
+    segment: int       # ID of the executing segment (16 bit)
+    depth: int         # accepted but not finished
+    limit: int         # credit limit (16 bit)
+
+
+@dataclass
+class TelemetryFrame:
+    t_host: float      # monotonic() at reception
+    t_us: int          # device time (32 bit, wraps)
+    seq: int
+    axes: List[AxisSample]
+
+
+def _ahead(a: int, b: int) -> int:
+    """a - b for 16 bit wrapping IDs, signed"""
+    d = (a - b) & 0xFFFF
+    return d - 0x10000 if d >= 0x8000 else d
+
+
+# ============================================================
+# Stream
+# ============================================================
+
+class RailStream:
+    """
+    Streaming client for servo_fw.
+
+    Usage:
+        with RailStream("COM7", period_us=1000, log_path="pose.csv") as rail:
+            rail.send(0b01, 0b01, 2000, 400)
+            ...
+            rail.wait_idle()
+    """
+
+    def __init__(self, port: str, *, axes: int = 2, period_us: int = 1000,
+                 log_path: str | Path | None = None,
+                 on_frame: Optional[Callable[[TelemetryFrame], None]] = None):
+        self.port = port
+        self.axes = axes
+        self.period_us = period_us
+        self.log_path = Path(log_path) if log_path else None
+        self.on_frame = on_frame
+
+        self._ser = None
+        self._reader: threading.Thread | None = None
+        self._running = False
+
+        self._cv = threading.Condition()
+        self._last: TelemetryFrame | None = None
+        self._sent = [0] * axes                 # next segment ID per axis
+        self._synced = False                    # _sent taken from the device
+        self.rejected = 0                       # frames answered with Full / BadArgs
+
+        self._log_file = None
+        self._log = None
+
+    # ---------------- lifecycle ----------------
+
+    def open(self):
+        import serial
+
+        self._ser = serial.Serial(self.port, 115200, timeout=0.05)
+        self._ser.reset_input_buffer()
+
+        if self.log_path:
+            self.log_path.parent.mkdir(parents=True, exist_ok=True)
+            self._log_file = open(self.log_path, "w", newline="", encoding="utf-8")
+            self._log = csv.writer(self._log_file)
+            self._log.writerow(["t_host", "t_us", "seq", "axis", "position", "segment", "depth", "limit"])
+
+        self._running = True
+        self._reader = threading.Thread(target=self._read_loop, daemon=True)
+        self._reader.start()
+
+        self._control(CONTROL_TELEMETRY, 0, self.period_us, TELEMETRY_QUIET)
+        self._wait(lambda: self._synced, 1.0, "no telemetry from the rail")
+
+    def close(self):
+        if self._ser:
+            try:
+                self._control(CONTROL_TELEMETRY, 0, 0, 0)
+            finally:
+                self._running = False
+                if self._reader:
+                    self._reader.join()
+                self._ser.close()
+        if self._log_file:
+            self._log_file.close()
+        self._ser = None
+        self._log_file = None
+        self._log = None
+
+    def __enter__(self):
+        self.open()
+        return self
+
+    def __exit__(self, exc_type, exc, tb):
+        self.close()
+
+    # ---------------- motion ----------------
+
+    def credits(self, axis: int) -> int:
+        """segments axis `axis` accepts right now"""
+        with self._cv:
+            if not self._last:
+                return 0
+            return max(0, _ahead(self._last.axes[axis].limit, self._sent[axis]))
+
+    def send(self, motor_mask: int, direction_mask: int, speed_hz: int, pulses: int,
+             timeout: float = 10.0) -> List[int]:
+        """
+        Queue one 0xAF segment on every axis in motor_mask; blocks for credits.
+        Returns the segment ID per masked axis (match with AxisSample.segment).
+        """
+        masked = [i for i in range(self.axes) if motor_mask & (1 << i)]
+        self._wait(lambda: all(self._credit_locked(i) > 0 for i in masked), timeout,
+                   "no credit (rail not consuming?)")
+
+        with self._cv:
+            ids = [self._sent[i] for i in masked]
+            for i in masked:
+                self._sent[i] = (self._sent[i] + 1) & 0xFFFF
+
+        self._ser.write(struct.pack("<BBBii", HEADER_PULSE, motor_mask, direction_mask,
+                                    int(speed_hz), int(pulses)))
+        return ids
+
+    def stop(self, motor_mask: int):
+        """stop + flush; IDs resync from the next telemetry frame"""
+        with self._cv:
+            self._synced = False
+        self._control(CONTROL_STOP, motor_mask, 0, 0)
+        self._wait(lambda: self._synced, 1.0, "no telemetry after stop")
+
+    def wait_idle(self, timeout: float = 60.0):
+        """every sent segment stepped out"""
+        self._wait(lambda: all(self._last.axes[i].depth == 0 and self._last.axes[i].segment == self._sent[i]
+                               for i in range(self.axes)), timeout, "rail still moving")
+
+    def last(self) -> TelemetryFrame | None:
+        with self._cv:
+            return self._last
+
+    # ---------------- internals ----------------
+
+    def _credit_locked(self, axis: int) -> int:
+        return _ahead(self._last.axes[axis].limit, self._sent[axis]) if self._last else 0
+
+    def _wait(self, pred, timeout: float, what: str):
+        with self._cv:
+            if not self._cv.wait_for(pred, timeout):
+                raise TimeoutError(what)
+
+    def _control(self, op: int, mask: int, a: int, b: int):
+        self._ser.write(struct.pack("<BBBii", HEADER_CONTROL, mask, op, a, b))
+
+    def _read_loop(self):
+        buf = bytearray()
+        frame_len = TELEMETRY_HEADER.size + TELEMETRY_AXIS.size * self.axes
+        reply_len = 2 + self.axes
+
+        while self._running:
+            buf += self._ser.read(256)
+
+            while buf:
+                if buf[0] == HEADER_TELEMETRY:
+                    if len(buf) < frame_len:
+                        break
+                    self._on_telemetry(bytes(buf[:frame_len]))
+                    del buf[:frame_len]
+                elif buf[0] == HEADER_REPLY:
+                    if len(buf) < reply_len:
+                        break
+                    self._on_reply(buf[1])
+                    del buf[:reply_len]
+                else:
+                    del buf[0]   # resync on a header byte
+
+    def _on_telemetry(self, raw: bytes):
+        _, seq, axes, t_us = TELEMETRY_HEADER.unpack_from(raw, 0)
+        samples = [AxisSample(*TELEMETRY_AXIS.unpack_from(raw, TELEMETRY_HEADER.size + i * TELEMETRY_AXIS.size))
+                   for i in range(min(axes, self.axes))]
+        frame = TelemetryFrame(time.monotonic(), t_us, seq, samples)
+
+        with self._cv:
+            if not self._synced:
+                # next ID = device head = executing segment + depth
+                self._sent = [(s.segment + s.depth) & 0xFFFF for s in samples]
+                self._synced = True
+            self._last = frame
+            self._cv.notify_all()
+
+        if self._log:
+            for i, s in enumerate(samples):
+                self._log.writerow([f"{frame.t_host:.6f}", t_us, seq, i, s.position, s.segment, s.depth, s.limit])
+        if self.on_frame:
+            self.on_frame(frame)
+
+    def _on_reply(self, status: int):
+        if status == 0:
+            return
+        # quiet mode: only rejections are answered; resync IDs from the device
+        with self._cv:
+            self.rejected += 1
+            self._synced = False